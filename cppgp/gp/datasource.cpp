@@ -0,0 +1,155 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <cppgp/gp/datasource.hpp>
+#include <cppgp/util/exceptions.hpp>
+#include <cppgp/util/stringutil.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+gp::DataSource::DataSource()
+{}
+
+gp::DataSource::~DataSource()
+{}
+
+
+gp::GPDataSource::GPDataSource(const std::shared_ptr<const GPData>& gpdata, const bool shuffle, const unsigned int seed) :
+    data(gpdata),
+    shuffle(shuffle),
+    rng(seed),
+    position(0)
+{
+    if(gpdata == nullptr){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The data must not be nullptr.");
+    }
+    this->rewind();
+}
+
+Eigen::Index gp::GPDataSource::nextBatch(Eigen::MatrixXd& X, Eigen::MatrixXd& Y, const Eigen::Index batchSize)
+{
+    const Eigen::Index k = std::min<Eigen::Index>(batchSize, this->order.size() - this->position);
+    const auto [dataX, dataY] = this->data->getData();
+    X.resize(k, dataX.cols());
+    Y.resize(k, dataY.cols());
+    for(Eigen::Index i = 0; i < k; ++i){
+        X.row(i) = dataX.row(this->order[this->position + i]);
+        Y.row(i) = dataY.row(this->order[this->position + i]);
+    }
+    this->position += k;
+    return k;
+}
+
+void gp::GPDataSource::rewind()
+{
+    this->order.resize(this->data->getN());
+    std::iota(this->order.begin(), this->order.end(), 0);
+    if(this->shuffle){
+        std::shuffle(this->order.begin(), this->order.end(), this->rng);
+    }
+    this->position = 0;
+}
+
+unsigned int gp::GPDataSource::getDimX() const
+{
+    return this->data->getDimX();
+}
+
+unsigned int gp::GPDataSource::getDimY() const
+{
+    return this->data->getDimY();
+}
+
+
+gp::TextFileDataSource::TextFileDataSource(const std::string& filename, const unsigned int dimX) :
+    filename(filename),
+    dimX(dimX),
+    dimY(0)
+{
+    this->stream.open(filename, std::ios::in);
+    if(!this->stream){
+        util::exceptions::throwException<util::exceptions::FileReaderError>(filename);
+    }
+    std::vector<double> values;
+    if(this->readLine(values)){
+        if(values.size() <= dimX){
+            util::exceptions::throwException<util::exceptions::InconsistentInputError>("The lines of the file hold no targets.");
+        }
+        this->dimY = values.size() - dimX;
+    }
+    this->rewind();
+}
+
+Eigen::Index gp::TextFileDataSource::nextBatch(Eigen::MatrixXd& X, Eigen::MatrixXd& Y, const Eigen::Index batchSize)
+{
+    X.resize(batchSize, this->dimX);
+    Y.resize(batchSize, this->dimY);
+    std::vector<double> values;
+    Eigen::Index k = 0;
+    while(k < batchSize && this->readLine(values)){
+        if(values.size() != this->dimX + this->dimY){
+            util::exceptions::throwException<util::exceptions::InconsistentInputError>("Inconsistent number of values in the lines of the file.");
+        }
+        X.row(k) = Eigen::Map<const Eigen::RowVectorXd>(values.data(), this->dimX);
+        Y.row(k) = Eigen::Map<const Eigen::RowVectorXd>(values.data() + this->dimX, this->dimY);
+        ++k;
+    }
+    X.conservativeResize(k, Eigen::NoChange);
+    Y.conservativeResize(k, Eigen::NoChange);
+    return k;
+}
+
+void gp::TextFileDataSource::rewind()
+{
+    this->stream.clear();
+    this->stream.seekg(0);
+}
+
+unsigned int gp::TextFileDataSource::getDimX() const
+{
+    return this->dimX;
+}
+
+unsigned int gp::TextFileDataSource::getDimY() const
+{
+    return this->dimY;
+}
+
+bool gp::TextFileDataSource::readLine(std::vector<double>& values)
+{
+    std::string line;
+    while(std::getline(this->stream, line)){
+        std::vector<std::string> tokens;
+        util::string::tokenize(tokens, line);
+        tokens.erase(std::remove(tokens.begin(), tokens.end(), ""), tokens.end());
+        if(tokens.empty()){
+            continue;
+        }
+        values.resize(tokens.size());
+        std::transform(tokens.begin(), tokens.end(), values.begin(), [](const std::string& s){ return std::stod(s); });
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,127 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Eigen/Eigen>
+
+#include <cppgp/gp/gpdata.hpp>
+
+namespace gp {
+
+/**
+ * Sequential source of observations that are read in batches, e.g. for the minibatch training of SVGP.
+ * A pass over the data ends when #nextBatch returns 0, #rewind starts the next pass.
+ * Only the current batch needs to be held in memory.
+ */
+class DataSource {
+public:
+    DataSource();
+    virtual ~DataSource();
+
+    /**
+     * Read the next batch of observations.
+     *
+     * @param X Returns the inputs, size [k, getDimX()].
+     * @param Y Returns the targets, size [k, getDimY()].
+     * @param batchSize The maximum number of observations k.
+     * @return The number of observations k, 0 at the end of the pass.
+     */
+    virtual Eigen::Index nextBatch(Eigen::MatrixXd& X, Eigen::MatrixXd& Y, const Eigen::Index batchSize)=0;
+
+    /**
+     * Start a new pass over the data.
+     */
+    virtual void rewind()=0;
+
+    virtual unsigned int getDimX() const=0;
+    virtual unsigned int getDimY() const=0;
+};
+
+
+/**
+ * Batches of the observations in a GPData object, in a random order that is drawn anew for every pass.
+ * The targets are not normalized.
+ */
+class GPDataSource : public DataSource {
+public:
+    /**
+     * @param gpdata The data, it must not be changed during a pass.
+     * @param shuffle Visit the observations in a random order if true, else in the stored order.
+     * @param seed The seed of the random order.
+     */
+    GPDataSource(const std::shared_ptr<const GPData>& gpdata, const bool shuffle=true, const unsigned int seed=0);
+
+    virtual Eigen::Index nextBatch(Eigen::MatrixXd& X, Eigen::MatrixXd& Y, const Eigen::Index batchSize) override;
+    virtual void rewind() override;
+    virtual unsigned int getDimX() const override;
+    virtual unsigned int getDimY() const override;
+
+private:
+    std::shared_ptr<const GPData> data;
+    bool shuffle;
+    std::mt19937 rng;
+    std::vector<Eigen::Index> order;    // order of the observations in the current pass
+    Eigen::Index position;              // number of observations read in the current pass
+};
+
+
+/**
+ * Observations that are streamed line by line from a text file, in the format of util::io::read_textfile.
+ * Each line holds the dimX inputs followed by the targets of one observation, separated by spaces.
+ * The dimension of the targets is determined from the first line. The file is read in its stored order,
+ * so it should be shuffled beforehand for stochastic training.
+ */
+class TextFileDataSource : public DataSource {
+public:
+    /**
+     * @param filename The name of the file.
+     * @param dimX The dimension of the inputs.
+     */
+    TextFileDataSource(const std::string& filename, const unsigned int dimX);
+
+    virtual Eigen::Index nextBatch(Eigen::MatrixXd& X, Eigen::MatrixXd& Y, const Eigen::Index batchSize) override;
+    virtual void rewind() override;
+    virtual unsigned int getDimX() const override;
+    virtual unsigned int getDimY() const override;
+
+private:
+    /**
+     * Read the values of the next non-empty line, returns false at the end of the file.
+     */
+    bool readLine(std::vector<double>& values);
+
+    std::string filename;
+    std::ifstream stream;
+    unsigned int dimX;
+    unsigned int dimY;
+};
+
+} // namespace gp
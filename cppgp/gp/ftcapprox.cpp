@@ -0,0 +1,96 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <cppgp/gp/ftcapprox.hpp>
+#include <cppgp/math/cholesky.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+gp::FTC::FTC()
+{}
+
+std::shared_ptr<util::Prototype> gp::FTC::copy() const
+{
+    return std::make_shared<FTC>(*this);
+}
+
+void gp::FTC::getParameters(Eigen::VectorXd& params) const
+{
+    params.resize(0);
+}
+
+void gp::FTC::setParameters(const Eigen::VectorXd& params)
+{
+    if(params.size() != 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("FTC has no parameters.");
+    }
+}
+
+size_t gp::FTC::nParameters() const
+{
+    return 0;
+}
+
+void gp::FTC::posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const
+{
+    Eigen::MatrixXd kXStar;
+    this->covfun->K(kXStar, this->X, Xin);
+    mu.noalias() = kXStar.transpose()*this->alpha;
+}
+
+void gp::FTC::posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::VectorXd& var, const Eigen::MatrixXd& Xin) const
+{
+    Eigen::MatrixXd kXStar;
+    this->covfun->K(kXStar, this->X, Xin);
+    mu.noalias() = kXStar.transpose()*this->alpha;
+    this->covfun->diagK(var, Xin);
+    this->K.triangularView<Eigen::Lower>().solveInPlace(kXStar);
+    var -= kXStar.colwise().squaredNorm().transpose();
+}
+
+void gp::FTC::updateK(const std::shared_ptr<kernel::GPKernel>& kernel, const Eigen::Ref<const Eigen::MatrixXd>& obsX)
+{
+    this->covfun = kernel->getCovarianceFunction();
+    this->X = obsX;
+    this->covfun->K(this->K, this->X);
+    this->K.diagonal().array() += kernel->getNoise();
+
+    const double meanDiag = (this->K.rows() > 0) ? this->K.diagonal().mean() : 0.0;
+    const double scale = (meanDiag > 0) ? meanDiag : 1.0;
+    double jitter;
+    if(!math::cholJitter(this->K, this->diag, jitter, 1e-10*scale, 20)){
+        util::exceptions::throwException<util::exceptions::Error>("Failed to invert the kernel matrix.");
+    }
+    this->logDetK = math::cholLogDet(this->K);
+}
+
+void gp::FTC::updateAD(const Eigen::Ref<const Eigen::MatrixXd>& obsYNormalized)
+{
+    this->innerProducts = this->K.triangularView<Eigen::Lower>().solve(obsYNormalized).colwise().squaredNorm().transpose();
+}
+
+void gp::FTC::updateAlpha(const Eigen::Ref<const Eigen::MatrixXd>& obsYNormalized)
+{
+    this->alpha = this->K.triangularView<Eigen::Lower>().solve(obsYNormalized);
+    this->K.triangularView<Eigen::Lower>().transpose().solveInPlace(this->alpha);
+}
@@ -0,0 +1,66 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+
+#include <Eigen/Eigen>
+
+#include <cppgp/gp/gpapproximation.hpp>
+#include <cppgp/kernels/covfun.hpp>
+
+namespace gp {
+
+/**
+ * Fully independent training conditional without approximation, i.e. exact inference with the dense
+ * Cholesky factorization of the noised covariance matrix. It costs O(n^3) for fitting and O(n) per predicted mean,
+ * and serves as the reference for the sparse approximations.
+ */
+class FTC : public GPApproximation {
+public:
+    FTC();
+
+    virtual std::shared_ptr<util::Prototype> copy() const override;
+
+    virtual void getParameters(Eigen::VectorXd& params) const override;
+    virtual void setParameters(const Eigen::VectorXd& params) override;
+    virtual size_t nParameters() const override;
+
+    virtual void posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const override;
+    virtual void posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::VectorXd& var, const Eigen::MatrixXd& Xin) const override;
+
+private:
+    virtual void updateK(const std::shared_ptr<kernel::GPKernel>& kernel, const Eigen::Ref<const Eigen::MatrixXd>& obsX) override;
+    virtual void updateAD(const Eigen::Ref<const Eigen::MatrixXd>& obsYNormalized) override;
+    virtual void updateAlpha(const Eigen::Ref<const Eigen::MatrixXd>& obsYNormalized) override;
+
+    std::shared_ptr<kernel::CovarianceFunction> covfun;
+    Eigen::MatrixXd X;      // [nData x dimX], inputs of the observations
+    Eigen::MatrixXd K;      // [nData x nData], holds the Cholesky factor of the noised covariance in its lower triangle
+    Eigen::VectorXd diag;   // [nData], workspace for the jitter retries
+    Eigen::MatrixXd alpha;  // [nData x dimY], K^-1 y
+};
+
+} // namespace gp
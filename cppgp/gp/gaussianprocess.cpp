@@ -2,8 +2,33 @@
 #include <cppgp/gp/gaussianprocess.hpp>
 #include <cppgp/util/exceptions.hpp>
 
+#include <cppgp/util/threadpool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
 using namespace gp;
 
+namespace {
+    /**
+     * Move non-positive parameters, e.g. the default noise of 0, onto the feasible side before their logarithms are taken.
+     * They are set to the lower bound, but at least to a small fraction of the largest parameter.
+     */
+    Eigen::VectorXd positiveParameters(const Eigen::VectorXd& params, const Eigen::VectorXd& lower)
+    {
+        const double floor = 1e-6*std::max(params.cwiseAbs().maxCoeff(), 1.0);
+        Eigen::VectorXd p = params;
+        for(Eigen::Index i = 0; i < p.size(); ++i){
+            if(p(i) <= 0.0){
+                p(i) = (lower.size() == p.size()) ? std::max(lower(i), floor) : floor;
+            }
+        }
+        return p;
+    }
+}
+
 
 const Eigen::VectorXd nullvector = Eigen::VectorXd(0);
 const Eigen::MatrixXd nullmatrix = Eigen::MatrixXd(0, 0);
@@ -14,6 +39,9 @@ inline bool isNullmatrix(const Eigen::MatrixXd& M){
 
 /**
  * Implementation class of GaussianProcesses.
+ * All solves with the covariance matrix use the factorization owned by the kernel,
+ * which is kept up to date with the observation data by the kernel itself.
+ * If an approximation is set, it replaces the factorization and is refitted on demand.
  */
 struct GaussianProcess::GaussianProcess_Impl {
 
@@ -21,19 +49,13 @@ struct GaussianProcess::GaussianProcess_Impl {
     // store observation data
     std::shared_ptr<GPData> obsData;
     std::shared_ptr<kernel::GPKernel> kernel;
-    //std::shared_ptr<GPApproximation> approx;
-
-    Eigen::LLT<Eigen::MatrixXd> llt;
-    Eigen::MatrixXd K;    // [nData x nData]
-    bool is_inverseK_computed; // true, if the inverse of K has been successfully computed, else false
-    double inverseNoise;
-    bool is_noise_fixed;
-
-    Eigen::MatrixXd alpha; // [nData x nY]
-    bool is_alpha_computed;
+    std::shared_ptr<GPApproximation> approx; // nullptr for exact inference
+    bool isApproxFitted;
+    unsigned long approxDataVersion;         // versions of the data and the kernel parameters the approximation is fitted to
+    unsigned long approxParameterVersion;
 
-    bool is_logDetK_computed;
-    double logDetK;
+    mutable Eigen::MatrixXd covGrad; // [nData x nData], workspace for the gradient of the nlml
+    Precision precision;
 
 
     /*
@@ -44,111 +66,155 @@ struct GaussianProcess::GaussianProcess_Impl {
         const std::shared_ptr<GPData>& obsData,
         const std::shared_ptr<kernel::GPKernel>& kernel
         ) :
-        obsData(obsData), kernel(kernel)
+        obsData(obsData), kernel(kernel), approx(nullptr),
+        isApproxFitted(false), approxDataVersion(0), approxParameterVersion(0),
+        precision(Precision::DOUBLE)
     {
+        if(this->kernel != nullptr && this->obsData != nullptr){
+            this->kernel->registerData(this->obsData);
+        }
     }
 
     void dataChange_trigger()
     {
         kernel->registerData(obsData);
-        updateKernelComputations();
+        if(approx == nullptr){
+            kernel->getFactorization();
+        }
     }
 
-
-    void rescaleMuInplace(Eigen::MatrixXd& mu) const
+    /**
+     * Fit the approximation to the observations unless it is fitted to the current data and parameters.
+     */
+    GPApproximation& fittedApproximation()
     {
-        Eigen::RowVectorXd scale, bias;
-        obsData->getScale(scale);
-        obsData->getBias(bias);
-        mu = (mu.array().rowwise()*scale.array()).rowwise() + bias.array(); //TODO check dimensions
+        if(!isApproxFitted || approxDataVersion != obsData->getVersion() || approxParameterVersion != kernel->getParameterVersion()){
+            isApproxFitted = false;
+            approx->updateKernelPrecomputations(kernel, obsData->getXView(), std::get<1>(obsData->getNormalizedData()));
+            approxDataVersion = obsData->getVersion();
+            approxParameterVersion = kernel->getParameterVersion();
+            isApproxFitted = true;
+        }
+        return *approx;
     }
 
 
-    void rescaleMuSigmaInplace(Eigen::MatrixXd& mu, Eigen::MatrixXd& sigma) const
-    {
-        Eigen::RowVectorXd scale, bias;
-        obsData->getScale(scale);
-        obsData->getBias(bias);
-        mu = (mu.array().rowwise()*scale.array()).rowwise() + bias.array(); //TODO check dimensions
-        sigma = sigma.array().rowwise()*(scale.array()*scale.array());
-    }
-
     /**
-     * Computations taken from former gpapproximation.
+     * Compute the posterior mean of the normalized targets from the cross covariance,
+     * in the precision of the cross covariance.
      */
-
-    void updateKernelComputations()
+    void posteriorMeanNormalized(Eigen::MatrixXd& mu, const Eigen::MatrixXd& kXStar, const kernel::CovFactorization& factorization) const
     {
-        this->kernel->computeCov(this->K);
-        this->computeInverse();
-        this->updateAlpha();
-        this->computeLogDetK();
+        mu.noalias() = kXStar.transpose()*factorization.getAlpha();
     }
 
-    void updateAlpha()
+    void posteriorMeanNormalized(Eigen::MatrixXd& mu, const Eigen::MatrixXf& kXStar, const kernel::CovFactorization& factorization) const
     {
-        Eigen::MatrixXd obsYNormalized;
-        this->obsData->getYNormalized(obsYNormalized);
-        this->alpha = this->llt.solve(obsYNormalized.transpose()).transpose();// this->Kinv*obsYNormalized;
+        const Eigen::MatrixXf alpha = factorization.getAlpha().cast<float>();
+        mu = (kXStar.transpose()*alpha).cast<double>();
     }
 
-    void alphaProduct(Eigen::MatrixXd& prod, const Eigen::MatrixXd& lfactor) const {
-        prod = lfactor*this->alpha;
+    /**
+     * Compute the posterior variance of the normalized targets, diag(k**) - diag(k*^T K^-1 k*).
+     * A single precision cross covariance is converted to double precision in blocks of test points.
+     */
+    void posteriorVarNormalized(Eigen::VectorXd& var, const Eigen::MatrixXd& kXStar, const Eigen::MatrixXd& Xin, const kernel::CovFactorization& factorization) const
+    {
+        kernel->getCovarianceFunction()->diagK(var, Xin);
+        Eigen::VectorXd q;
+        factorization.quadraticForm(q, kXStar);
+        var -= q;
     }
 
-    void KinvScalarProduct(Eigen::VectorXd& XTKinvX, const Eigen::MatrixXd& X) const {
-        XTKinvX = (X.array()*(this->llt.solve(X).array())).colwise().sum();
+    void posteriorVarNormalized(Eigen::VectorXd& var, const Eigen::MatrixXf& kXStar, const Eigen::MatrixXd& Xin, const kernel::CovFactorization& factorization) const
+    {
+        const Eigen::Index blockSize = 256;
+        kernel->getCovarianceFunction()->diagK(var, Xin);
+        Eigen::VectorXd q;
+        for(Eigen::Index j = 0; j < kXStar.cols(); j += blockSize){
+            const Eigen::Index bj = std::min(blockSize, kXStar.cols()-j);
+            factorization.quadraticForm(q, kXStar.middleCols(j, bj).cast<double>());
+            var.segment(j, bj) -= q;
+        }
     }
 
-     void computeInverse() {
-        int maxTries = (is_noise_fixed) ? 1 : 20;
+    void rescaleMuInplace(Eigen::MatrixXd& mu) const
+    {
+        Eigen::RowVectorXd scale, bias;
+        obsData->getScale(scale);
+        obsData->getBias(bias);
+        mu = (mu.array().rowwise()*scale.array()).rowwise() + bias.array(); //TODO check dimensions
+    }
 
-        Eigen::VectorXd diag;
-        bool success = false;
-        for(int i = 0; i < maxTries; ++i){
-            auto K2 = this->K;
-            if(i > 0){
-                inverseNoise *= 10;
-            }
-            diag = inverseNoise * Eigen::VectorXd::Ones(this->K.rows());
-            K2 += diag.asDiagonal().toDenseMatrix();
 
-            this->llt.compute(K2);
-            if(llt.info() == Eigen::Success){
-                success = true;
-                break;
-            }
-        }
-        if(!success){
-            util::exceptions::throwException<util::exceptions::Error>("Failed to invert the kernel matrix.");
-        }
-        this->is_inverseK_computed = true;
+    void rescaleSigmaInplace(Eigen::MatrixXd& sigma) const
+    {
+        Eigen::RowVectorXd scale;
+        obsData->getScale(scale);
+        sigma = sigma.array().rowwise()*(scale.array()*scale.array());
     }
 
-    void computeLogDetK(){
-        if(!is_inverseK_computed){
-            this->computeInverse();
+    /**
+     * Compute the negative log marginal likelihood of the normalized observations
+     * \f[
+     * \frac{1}{2} \sum_{c} \bar{y}_c^T \alpha_c + \frac{d_y}{2}\log\det(K + \sigma I) + \frac{n d_y}{2}\log(2\pi)
+     * \f]
+     * from the shared factorization of the kernel.
+     */
+    double computeNegativeLogMarginalLikelihood() {
+        if(approx != nullptr){
+            return fittedApproximation().computeNegativeLogMarginalLikelihood(std::get<1>(obsData->getNormalizedData()));
         }
-        this->logDetK = 2*this->llt.matrixL().determinant();
-        this->is_logDetK_computed = true;
+        const kernel::CovFactorization& factorization = this->kernel->getFactorization();
+        const GPData::ConstView obsYnormalized = std::get<1>(obsData->getNormalizedData());
+        const double dimY = obsYnormalized.cols();
+        double nlml = 0.5*(obsYnormalized.array()*factorization.getAlpha().array()).sum();
+        nlml += 0.5*dimY*factorization.logDet();
+        nlml += 0.5*dimY*obsYnormalized.rows()*std::log(2*M_PI);
+        return nlml;
     }
 
-    double getLogDetK() {
-        if(!is_logDetK_computed){
-            computeLogDetK();
+    /**
+     * Gradient of computeNegativeLogMarginalLikelihood with respect to the kernel parameters.
+     */
+    void computeNegativeLogMarginalLikelihoodGradient(Eigen::VectorXd& gradient) const {
+        const kernel::CovFactorization& factorization = this->kernel->getFactorization();
+        const Eigen::MatrixXd& alpha = factorization.getAlpha();
+
+        if(factorization.isIterative()){
+            // covGrad = A B^T of low rank, with K^-1 estimated from the probe vectors of the log determinant
+            const Eigen::MatrixXd& probeSolves = factorization.getProbeSolves();
+            const Eigen::MatrixXd& preconditionedProbes = factorization.getPreconditionedProbes();
+            const Eigen::Index t = probeSolves.cols();
+            Eigen::MatrixXd A(probeSolves.rows(), t + alpha.cols());
+            Eigen::MatrixXd B(probeSolves.rows(), t + alpha.cols());
+            A << (0.5*alpha.cols()/t)*preconditionedProbes, -0.5*alpha;
+            B << probeSolves, alpha;
+            this->kernel->computeNoisedCovGradient(gradient, A, B);
+            return;
         }
-        return this->logDetK;
-    }
 
-    double computeNegativeLogMarginalLikelihood() {
-        const Eigen::MatrixXd& obsYnormalized = std::get<1>(obsData->getNormalizedData());
-        Eigen::VectorXd vectorprod;
-        this->KinvScalarProduct(vectorprod, obsYnormalized.transpose());
-        double nlml = -0.5*vectorprod.sum();
-        nlml -= 0.5*obsYnormalized.cols()*this->getLogDetK();
-        return -nlml;
+        if(factorization.isSparse()){
+            // only the entries on the pattern of K contribute, K^-1 is computed on the pattern of its sparse factor
+            Eigen::SparseMatrix<double> covGradSparse;
+            factorization.selectedInverse(covGradSparse);
+            covGradSparse *= 0.5*alpha.cols();
+            for(Eigen::Index j = 0; j < covGradSparse.outerSize(); ++j){
+                for(Eigen::SparseMatrix<double>::InnerIterator it(covGradSparse, j); it; ++it){
+                    it.valueRef() -= 0.5*alpha.row(it.row()).dot(alpha.row(it.col()));
+                }
+            }
+            this->kernel->computeNoisedCovGradient(gradient, covGradSparse);
+            return;
         }
 
+        // covGrad = 1/2 (dimY K^-1 - alpha alpha^T), assembled in place
+        factorization.inverse(covGrad);
+        covGrad *= 0.5*alpha.cols();
+        covGrad.noalias() -= 0.5*alpha*alpha.transpose();
+        this->kernel->computeNoisedCovGradient(gradient, covGrad);
+    }
+
 };
 
 
@@ -159,9 +225,15 @@ GaussianProcess::GaussianProcess() :
 {}
 
 
-GaussianProcess::GaussianProcess(const GaussianProcess & m) : GaussianProcess()
+GaussianProcess::GaussianProcess(const GaussianProcess & m) :
+    _gp_impl(std::make_unique<GaussianProcess_Impl>(
+        m._gp_impl->obsData,
+        (m._gp_impl->kernel == nullptr) ? nullptr : std::dynamic_pointer_cast<kernel::GPKernel>(m._gp_impl->kernel->copy())))
 {
-    //TODO
+    _gp_impl->precision = m._gp_impl->precision;
+    if(m._gp_impl->approx != nullptr){
+        _gp_impl->approx = std::dynamic_pointer_cast<GPApproximation>(m._gp_impl->approx->copy());
+    }
 }
 
 
@@ -213,12 +285,12 @@ std::shared_ptr<util::Prototype> GaussianProcess::copy() const
 void GaussianProcess::setObservation(const std::shared_ptr<GPData>& obsData){
     auto old_data = this->_gp_impl->obsData;
     this->_gp_impl->obsData = obsData;
-    //TODO: connect to event system to detect data changes
     try {
         this->_gp_impl->dataChange_trigger();
     }
     catch(...){ //TODO: Replace with appropriate exceptions ...?
         this->_gp_impl->obsData = old_data;
+        this->_gp_impl->kernel->registerData(old_data);
     }
 }
 
@@ -244,76 +316,254 @@ const std::shared_ptr<const kernel::GPKernel> GaussianProcess::getKernel(){
 }
 
 
+void GaussianProcess::setApproximation(const std::shared_ptr<GPApproximation>& approximation) {
+    _gp_impl->approx = approximation;
+    _gp_impl->isApproxFitted = false;
+}
+
+
+std::shared_ptr<const GPApproximation> GaussianProcess::getApproximation() const {
+    return _gp_impl->approx;
+}
+
+
 void GaussianProcess::setParameters(const Eigen::VectorXd& params) {
-    auto nk = _gp_impl->kernel->nParameters();
-    //auto na = _gp_impl->approx->nParameters();
-    _gp_impl->kernel->setParameters(params(Eigen::seq(0, nk)));
-    //_gp_impl->approx->setParameters(params(Eigen::seq(nk, na)));
-    _gp_impl->updateKernelComputations();
+    const auto nk = _gp_impl->kernel->nParameters();
+    _gp_impl->kernel->setParameters(params, 0);
+    if(_gp_impl->approx != nullptr){
+        _gp_impl->approx->setParameters(params.tail(params.size() - nk));
+        _gp_impl->isApproxFitted = false;
+    }
 }
 
 
 size_t GaussianProcess::nParameters() const {
-    return this->_gp_impl->kernel->nParameters();
+    const size_t na = (_gp_impl->approx != nullptr) ? _gp_impl->approx->nParameters() : 0;
+    return this->_gp_impl->kernel->nParameters() + na;
 }
 
 
 void GaussianProcess::getParameters(Eigen::VectorXd& params) const {
-    size_t n = 0;
-    //Eigen::VectorXd aparam;
-    //_gp_impl->approx->getParameters(aparam);
-    // n += aparam.size();
-    Eigen::VectorXd kparam;
+    Eigen::VectorXd aparam(0);
+    if(_gp_impl->approx != nullptr){
+        _gp_impl->approx->getParameters(aparam);
+    }
+    Eigen::VectorXd kparam(_gp_impl->kernel->nParameters());
     _gp_impl->kernel->getParameters(kparam);
-    n += kparam.size();
 
-    params.resize(n);
-    params << kparam;//, aparam;
+    params.resize(kparam.size() + aparam.size());
+    params << kparam, aparam;
 }
 
 
-void GaussianProcess::posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::MatrixXd& varSigma, const Eigen::MatrixXd& Xin) const
+void GaussianProcess::setPrecision(const Precision precision)
 {
-    Eigen::MatrixXd obsY;
-    _gp_impl->obsData->getYNormalized(obsY);
+    _gp_impl->precision = precision;
+}
+
 
-    mu.resize(Xin.rows(), obsY.cols());
-    varSigma.resize(Xin.rows(), obsY.cols());
+GaussianProcess::Precision GaussianProcess::getPrecision() const
+{
+    return _gp_impl->precision;
+}
 
-    Eigen::MatrixXd kXStar;
-    _gp_impl->kernel->computeCrossCov(kXStar, Xin);
-    _gp_impl->alphaProduct(mu, kXStar.transpose());
 
-    Eigen::VectorXd diagK;
-    _gp_impl->kernel->computeCovDiag(diagK);
+void GaussianProcess::posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::MatrixXd& varSigma, const Eigen::MatrixXd& Xin) const
+{
+    const unsigned int dimY = _gp_impl->obsData->getDimY();
+
     Eigen::VectorXd varsig;
-    _gp_impl->KinvScalarProduct(varsig, kXStar.transpose());
-    varsig = diagK - varsig;
-    varSigma = varsig.replicate(1, Xin.cols());
+    if(_gp_impl->approx != nullptr){
+        _gp_impl->fittedApproximation().posteriorMeanVar(mu, varsig, Xin);
+    }
+    else if(_gp_impl->precision == Precision::SINGLE){
+        const kernel::CovFactorization& factorization = _gp_impl->kernel->getFactorization();
+        Eigen::MatrixXf kXStar;
+        _gp_impl->kernel->computeCrossCov(kXStar, Xin.cast<float>());
+        _gp_impl->posteriorMeanNormalized(mu, kXStar, factorization);
+        _gp_impl->posteriorVarNormalized(varsig, kXStar, Xin, factorization);
+    }
+    else {
+        const kernel::CovFactorization& factorization = _gp_impl->kernel->getFactorization();
+        Eigen::MatrixXd kXStar;
+        _gp_impl->kernel->computeCrossCov(kXStar, Xin);
+        _gp_impl->posteriorMeanNormalized(mu, kXStar, factorization);
+        _gp_impl->posteriorVarNormalized(varsig, kXStar, Xin, factorization);
+    }
+    varSigma = varsig.replicate(1, dimY);
 
     _gp_impl->rescaleMuInplace(mu);
-    _gp_impl->rescaleMuSigmaInplace(mu, varSigma);
+    _gp_impl->rescaleSigmaInplace(varSigma);
 }
 
 
 void GaussianProcess::posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const
 {
-    Eigen::MatrixXd obsY;
-    _gp_impl->obsData->getYNormalized(obsY);
-
-    mu.resize(Xin.rows(), obsY.cols());
+    if(_gp_impl->approx != nullptr){
+        _gp_impl->fittedApproximation().posteriorMean(mu, Xin);
+        _gp_impl->rescaleMuInplace(mu);
+        return;
+    }
+    const kernel::CovFactorization& factorization = _gp_impl->kernel->getFactorization();
 
-    Eigen::MatrixXd kXStar;
-    _gp_impl->kernel->computeCrossCov(kXStar, Xin);
-    _gp_impl->alphaProduct(mu, kXStar.transpose());
+    if(_gp_impl->precision == Precision::SINGLE){
+        Eigen::MatrixXf kXStar;
+        _gp_impl->kernel->computeCrossCov(kXStar, Xin.cast<float>());
+        _gp_impl->posteriorMeanNormalized(mu, kXStar, factorization);
+    }
+    else {
+        Eigen::MatrixXd kXStar;
+        _gp_impl->kernel->computeCrossCov(kXStar, Xin);
+        _gp_impl->posteriorMeanNormalized(mu, kXStar, factorization);
+    }
 
     _gp_impl->rescaleMuInplace(mu);
 }
 
 
 double GaussianProcess::computeNegativeLogMarginalLikelihood() {
-    if(this->getKernel() == nullptr){
+    if(this->getKernel() == nullptr || this->getObservation() == nullptr){
         return std::numeric_limits<double>::quiet_NaN();
     }
-    return -this->getKernel()->computeNoisedLogDetCov();
+    return this->_gp_impl->computeNegativeLogMarginalLikelihood();
+}
+
+
+double GaussianProcess::computeNegativeLogMarginalLikelihood(Eigen::VectorXd& gradient) {
+    if(this->getKernel() == nullptr || this->getObservation() == nullptr){
+        gradient = Eigen::VectorXd(0);
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    const double nlml = this->_gp_impl->computeNegativeLogMarginalLikelihood();
+    // the analytic gradient requires the exact factorization, the Nystrom factor depends on the parameters differently
+    if(this->_gp_impl->approx == nullptr && !this->_gp_impl->kernel->getFactorization().isLowRank()){
+        this->_gp_impl->computeNegativeLogMarginalLikelihoodGradient(gradient);
+        return nlml;
+    }
+
+    // central differences of the approximated nlml
+    Eigen::VectorXd params;
+    this->getParameters(params);
+    gradient.resize(params.size());
+    for(Eigen::Index i = 0; i < params.size(); ++i){
+        const double h = 1e-6*std::max(std::abs(params(i)), 1e-6);
+        Eigen::VectorXd p = params;
+        p(i) = params(i) + h;
+        this->setParameters(p);
+        const double nlmlPlus = this->_gp_impl->computeNegativeLogMarginalLikelihood();
+        p(i) = params(i) - h;
+        this->setParameters(p);
+        const double nlmlMinus = this->_gp_impl->computeNegativeLogMarginalLikelihood();
+        gradient(i) = (nlmlPlus - nlmlMinus)/(2*h);
+    }
+    this->setParameters(params);
+    return nlml;
+}
+
+
+optim::OptimizationStats GaussianProcess::optimizeParameters(const optim::LBFGS& optimizer, const Eigen::VectorXd& lower, const Eigen::VectorXd& upper, const bool logParameters) {
+    Eigen::VectorXd params;
+    this->getParameters(params);
+    Eigen::VectorXd x = params;
+    Eigen::VectorXd lowerX = lower;
+    Eigen::VectorXd upperX = upper;
+    if(logParameters){
+        // non-positive lower bounds become -inf
+        x = positiveParameters(params, lower).array().log();
+        lowerX = lower.cwiseMax(0.0).array().log();
+        upperX = upper.array().log();
+    }
+
+    auto objective = [this, logParameters, &params](const Eigen::VectorXd& x, Eigen::VectorXd& grad) -> double {
+        params = (logParameters) ? Eigen::VectorXd(x.array().exp()) : x;
+        this->setParameters(params);
+        double nlml;
+        try {
+            nlml = this->computeNegativeLogMarginalLikelihood(grad);
+        }
+        catch(const util::exceptions::Error&){
+            return std::numeric_limits<double>::infinity();
+        }
+        if(logParameters){
+            grad.array() *= params.array();
+        }
+        return nlml;
+    };
+
+    optim::OptimizationStats stats = optimizer.minimize(objective, x, lowerX, upperX);
+    this->setParameters((logParameters) ? Eigen::VectorXd(x.array().exp()) : x);
+    return stats;
+}
+
+
+std::vector<optim::OptimizationStats> GaussianProcess::optimizeParametersMultiStart(const unsigned int nStarts, const optim::LBFGS& optimizer,
+                                                                                   const Eigen::VectorXd& lower, const Eigen::VectorXd& upper,
+                                                                                   const bool logParameters, const unsigned int nThreads,
+                                                                                   const unsigned int seed) {
+    if(nStarts == 0){
+        return std::vector<optim::OptimizationStats>();
+    }
+    const size_t np = this->nParameters();
+    Eigen::VectorXd params;
+    this->getParameters(params);
+    if(logParameters){
+        params = positiveParameters(params, lower);
+    }
+
+    // sample the starting points in the (log-)parameter space, the first start is the current parameter vector
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<Eigen::VectorXd> starts(nStarts, params);
+    for(unsigned int s = 1; s < nStarts; ++s){
+        for(size_t i = 0; i < np; ++i){
+            const double center = (logParameters) ? std::log(params(i)) : params(i);
+            const double width = (logParameters) ? 3.0 : std::max(std::abs(params(i)), 1.0);
+            double lo = center - width;
+            double hi = center + width;
+            if(lower.size() == static_cast<Eigen::Index>(np)){
+                lo = std::max(lo, (logParameters) ? std::log(std::max(lower(i), 0.0)) : lower(i));
+            }
+            if(upper.size() == static_cast<Eigen::Index>(np)){
+                hi = std::min(hi, (logParameters) ? std::log(upper(i)) : upper(i));
+            }
+            const double value = lo + (hi-lo)*uniform(rng);
+            starts[s](i) = (logParameters) ? std::exp(value) : value;
+        }
+    }
+
+    // the copies and their subscriptions at the shared data are created in this thread,
+    // the data is read-only during the optimization
+    if(this->getObservation() != nullptr){
+        this->getObservation()->precomputeNormalization();
+    }
+    std::vector<std::unique_ptr<GaussianProcess>> models;
+    for(unsigned int s = 0; s < nStarts; ++s){
+        models.push_back(std::make_unique<GaussianProcess>(*this));
+        models.back()->setParameters(starts[s]);
+    }
+
+    std::vector<optim::OptimizationStats> stats(nStarts);
+    {
+        util::ThreadPool pool(std::min(nThreads > 0 ? nThreads : std::thread::hardware_concurrency(), nStarts));
+        std::vector<std::future<optim::OptimizationStats>> results;
+        for(unsigned int s = 0; s < nStarts; ++s){
+            GaussianProcess* model = models[s].get();
+            results.push_back(pool.submit([model, &optimizer, &lower, &upper, logParameters](){
+                return model->optimizeParameters(optimizer, lower, upper, logParameters);
+            }));
+        }
+        for(unsigned int s = 0; s < nStarts; ++s){
+            stats[s] = results[s].get();
+        }
+    }
+
+    unsigned int best = 0;
+    for(unsigned int s = 1; s < nStarts; ++s){
+        if(!std::isfinite(stats[best].value) || stats[s].value < stats[best].value){
+            best = s;
+        }
+    }
+    models[best]->getParameters(params);
+    this->setParameters(params);
+    return stats;
 }
@@ -1,18 +1,31 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include <Eigen/Eigen>
 
 #include <cppgp/util/prototype.hpp>
 #include <cppgp/gp/gpdata.hpp>
+#include <cppgp/gp/gpapproximation.hpp>
 #include <cppgp/kernels/gpkernel.hpp>
+#include <cppgp/optim/lbfgs.hpp>
 
 namespace gp {
 
 
 class GaussianProcess : public util::Prototype {
 public:
+    /**
+     * Floating point precision of the predictions.
+     * - DOUBLE: Everything is computed in double precision.
+     * - SINGLE: The cross covariance between the training and the test inputs and the product with alpha are computed
+     *           in single precision, which halves the memory traffic of the prediction. The factorization and alpha
+     *           are computed in double precision, and the predictive variance is accumulated in double precision,
+     *           because it is the difference of two nearly equal terms.
+     */
+    enum class Precision {DOUBLE, SINGLE};
+
     GaussianProcess();
     GaussianProcess(const GaussianProcess & m);
     GaussianProcess(const std::shared_ptr<GPData>& data);
@@ -33,16 +46,103 @@ public:
     void setKernel(const std::shared_ptr<kernel::GPKernel>& kernel);
     const std::shared_ptr<const kernel::GPKernel> getKernel();
 
+    /**
+     * Set an approximate inference scheme, e.g. InducingPointApprox or VecchiaApprox.
+     * The approximation is fitted lazily to the observations whenever they or the parameters have changed.
+     * Its parameters follow the parameters of the kernel in #getParameters.
+     * With an approximation, the predictions are computed in double precision and the gradient of the
+     * negative log marginal likelihood is computed by central differences.
+     *
+     * @param approximation The approximation, nullptr for exact inference with the factorization that is shared with the kernel (default).
+     */
+    void setApproximation(const std::shared_ptr<GPApproximation>& approximation);
+
+    /**
+     * @return The approximation, nullptr for exact inference.
+     */
+    std::shared_ptr<const GPApproximation> getApproximation() const;
+
     virtual void setParameters(const Eigen::VectorXd& params);
     virtual void getParameters(Eigen::VectorXd& params) const;
     virtual size_t nParameters() const;
 
+    /**
+     * Set the floating point precision of #posteriorMean and #posteriorMeanVar, see #Precision.
+     *
+     * @param precision The precision, default Precision::DOUBLE.
+     */
+    void setPrecision(const Precision precision);
+
+    /**
+     * @return The floating point precision of the predictions.
+     */
+    Precision getPrecision() const;
+
 
     // evaluate and optimize
     void posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::MatrixXd& varSigma, const Eigen::MatrixXd& Xin) const;
     void posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const;
     double computeNegativeLogMarginalLikelihood();
 
+    /**
+     * Compute the negative log marginal likelihood together with its gradient with respect to the parameters
+     * (see #getParameters). The gradient is computed analytically from the factorization
+     * that is shared with the kernel, such that both cost a single factorization:
+     * \f[
+     * \frac{\partial \mathrm{nlml}}{\partial p_i} = \frac{1}{2} \mathrm{tr}\left( \left(d_y K^{-1} - \alpha \alpha^T\right) \frac{\partial K}{\partial p_i} \right)
+     * \f]
+     * In the matrix-free mode of the kernel (see kernel::GPKernel::setMatrixFree), the trace is estimated from the
+     * probe vectors of the log determinant estimate and the gradient is accumulated in tiles without n x n matrices.
+     * For covariance functions with compact support, \f$ K^{-1} \f$ is computed on the pattern of the sparse
+     * Cholesky factor only, see kernel::CovFactorization::selectedInverse.
+     * With an approximation or the Nystrom mode of the kernel (see kernel::GPKernel::setNystrom),
+     * the gradient is computed by central differences.
+     *
+     * @param gradient Returns the gradient, size [nParameters()].
+     * @return The negative log marginal likelihood.
+     */
+    double computeNegativeLogMarginalLikelihood(Eigen::VectorXd& gradient);
+
+    /**
+     * Optimize the parameters by minimizing the negative log marginal likelihood with the given optimizer,
+     * subject to lower <= parameters <= upper. Each evaluation costs one factorization of the covariance matrix,
+     * whose storage is reused between the evaluations.
+     * With log-parameterization, the optimizer works on the logarithms of the (positive) parameters.
+     * Parameters at which the factorization fails are rejected by the line search.
+     * The parameters are set to the optimum found.
+     *
+     * @param optimizer The optimizer.
+     * @param lower Lower bounds of the parameters, size [nParameters()] or 0 for no bounds.
+     * @param upper Upper bounds of the parameters, size [nParameters()] or 0 for no bounds.
+     * @param logParameters Optimize the logarithms of the parameters if true. Non-positive parameters, e.g. the default
+     *                      noise of 0, start at their lower bound, but at least at 1e-6 times the largest parameter.
+     * @return The convergence statistics of the optimizer.
+     */
+    optim::OptimizationStats optimizeParameters(const optim::LBFGS& optimizer=optim::LBFGS(),
+                                                const Eigen::VectorXd& lower=Eigen::VectorXd(0), const Eigen::VectorXd& upper=Eigen::VectorXd(0),
+                                                const bool logParameters=true);
+
+    /**
+     * Optimize the parameters from several starting points in parallel and keep the best result.
+     * The first start is the current parameter vector, the others are drawn uniformly from a box around it
+     * in the (log-)parameter space, clipped to the bounds. Each start optimizes its own copy of this GaussianProcess
+     * (see #optimizeParameters), the observation data is shared read-only between the threads.
+     * The parameters of the run with the lowest negative log marginal likelihood are set.
+     *
+     * @param nStarts The number of starting points.
+     * @param optimizer The optimizer.
+     * @param lower Lower bounds of the parameters, size [nParameters()] or 0 for no bounds.
+     * @param upper Upper bounds of the parameters, size [nParameters()] or 0 for no bounds.
+     * @param logParameters Optimize the logarithms of the parameters if true.
+     * @param nThreads The number of threads, 0 for the number of hardware threads.
+     * @param seed The seed for drawing the starting points.
+     * @return The convergence statistics of all runs, in the order of the starting points.
+     */
+    std::vector<optim::OptimizationStats> optimizeParametersMultiStart(const unsigned int nStarts, const optim::LBFGS& optimizer=optim::LBFGS(),
+                                                                       const Eigen::VectorXd& lower=Eigen::VectorXd(0), const Eigen::VectorXd& upper=Eigen::VectorXd(0),
+                                                                       const bool logParameters=true, const unsigned int nThreads=0,
+                                                                       const unsigned int seed=0);
+
 protected:
     class GaussianProcess_Impl;
     std::unique_ptr<GaussianProcess_Impl> _gp_impl;
@@ -0,0 +1,296 @@
+#include <cppgp/gp/gaussianprocess.hpp>
+#include <cppgp/gp/inducingapprox.hpp>
+#include <cppgp/kernels/covfun_rbf.hpp>
+#include <cppgp/kernels/covfun_wendland.hpp>
+#include <cppgp/util/exceptions.hpp>
+#include <iostream>
+#include <gtest/gtest.h>
+
+using namespace gp;
+
+std::shared_ptr<GPData> get_random_data(const int n)
+{
+    auto gpdata = std::make_shared<GPData>(2, 2);
+    const Eigen::MatrixXd X = Eigen::MatrixXd::Random(n, 2);
+    Eigen::MatrixXd Y(n, 2);
+    Y.col(0) = X.col(0).array().sin() + X.col(1).array();
+    Y.col(1) = X.rowwise().squaredNorm() + 0.1*Eigen::VectorXd::Random(n);
+    gpdata->addData(X, Y);
+    return gpdata;
+}
+
+TEST(gp_gaussianprocess, nlml){
+    auto gpdata = get_random_data(10);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    GaussianProcess gaussianprocess(gpdata, gpkernel);
+
+    Eigen::MatrixXd K, Y;
+    gpkernel->computeNoisedCov(K);
+    gpdata->getYNormalized(Y);
+    const double nlml = 0.5*(Y.transpose()*K.inverse()*Y).trace()
+                      + std::log(K.determinant())
+                      + 10*std::log(2*M_PI);
+
+    EXPECT_NEAR(gaussianprocess.computeNegativeLogMarginalLikelihood(), nlml, 1e-10);
+}
+
+TEST(gp_gaussianprocess, nlml_gradient){
+    auto gpdata = get_random_data(12);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    GaussianProcess gaussianprocess(gpdata, gpkernel);
+
+    Eigen::VectorXd params, gradient;
+    gaussianprocess.getParameters(params);
+    const double nlml = gaussianprocess.computeNegativeLogMarginalLikelihood(gradient);
+    EXPECT_EQ(nlml, gaussianprocess.computeNegativeLogMarginalLikelihood());
+    ASSERT_EQ(gradient.size(), gaussianprocess.nParameters());
+
+    // compare against central differences
+    const double h = 1e-6;
+    for(int i = 0; i < params.size(); ++i){
+        Eigen::VectorXd p = params;
+        p(i) += h;
+        gaussianprocess.setParameters(p);
+        const double nlmlPlus = gaussianprocess.computeNegativeLogMarginalLikelihood();
+        p(i) -= 2*h;
+        gaussianprocess.setParameters(p);
+        const double nlmlMinus = gaussianprocess.computeNegativeLogMarginalLikelihood();
+        EXPECT_NEAR(gradient(i), (nlmlPlus-nlmlMinus)/(2*h), 1e-5);
+    }
+}
+
+TEST(gp_gaussianprocess, optimize_parameters){
+    auto gpdata = get_random_data(30);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(10.0, 0.2), 0.5);
+    GaussianProcess gaussianprocess(gpdata, gpkernel);
+
+    const double nlmlStart = gaussianprocess.computeNegativeLogMarginalLikelihood();
+    Eigen::VectorXd lower = Eigen::VectorXd::Constant(3, 1e-4);
+    Eigen::VectorXd upper = Eigen::VectorXd::Constant(3, 1e4);
+    optim::OptimizationStats stats = gaussianprocess.optimizeParameters(optim::LBFGS(), lower, upper);
+
+    Eigen::VectorXd params, gradient;
+    gaussianprocess.getParameters(params);
+    const double nlml = gaussianprocess.computeNegativeLogMarginalLikelihood(gradient);
+    EXPECT_TRUE(stats.converged());
+    EXPECT_LT(nlml, nlmlStart);
+    EXPECT_DOUBLE_EQ(nlml, stats.value);
+    EXPECT_TRUE((params.array() >= lower.array()).all());
+    EXPECT_TRUE((params.array() <= upper.array()).all());
+    // stationary with respect to the log-parameters
+    EXPECT_LT((gradient.array()*params.array()).abs().maxCoeff(), 1e-3);
+}
+
+TEST(gp_gaussianprocess, optimize_parameters_default_noise){
+    // the default noise of 0 has no logarithm, the optimization starts from a small positive noise
+    auto gpdata = get_random_data(30);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(10.0, 0.2));
+    GaussianProcess gaussianprocess(gpdata, gpkernel);
+    ASSERT_EQ(gpkernel->getNoise(), 0.0);
+    optim::OptimizationStats stats = gaussianprocess.optimizeParameters();
+
+    Eigen::VectorXd params;
+    gaussianprocess.getParameters(params);
+    EXPECT_TRUE(stats.converged());
+    EXPECT_GT(stats.iterations, 0);
+    EXPECT_TRUE(std::isfinite(stats.value));
+    EXPECT_GT(params(0), 1e-8);
+}
+
+TEST(gp_gaussianprocess, copy){
+    auto gpdata = get_random_data(10);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    GaussianProcess gaussianprocess(gpdata, gpkernel);
+    auto gpcopy = std::dynamic_pointer_cast<GaussianProcess>(gaussianprocess.copy());
+
+    // the data is shared, the kernel is copied
+    EXPECT_EQ(gpcopy->getObservation(), gpdata);
+    EXPECT_NE(gpcopy->getKernel(), gaussianprocess.getKernel());
+    const Eigen::MatrixXd Xtest = Eigen::MatrixXd::Random(4, 2);
+    Eigen::MatrixXd mu, muCopy;
+    gaussianprocess.posteriorMean(mu, Xtest);
+    gpcopy->posteriorMean(muCopy, Xtest);
+    EXPECT_TRUE(mu.isApprox(muCopy));
+
+    Eigen::VectorXd params;
+    gpcopy->getParameters(params);
+    params(1) = 5.0;
+    gpcopy->setParameters(params);
+    EXPECT_NE(gaussianprocess.computeNegativeLogMarginalLikelihood(), gpcopy->computeNegativeLogMarginalLikelihood());
+
+    // the copy follows changes of the shared data
+    gpdata->addDatum(Eigen::Vector2d(0.1, 0.2), Eigen::Vector2d(0.3, 0.4));
+    gpcopy->setParameters(Eigen::Vector3d(0.1, 2.0, 1.5));
+    EXPECT_DOUBLE_EQ(gaussianprocess.computeNegativeLogMarginalLikelihood(), gpcopy->computeNegativeLogMarginalLikelihood());
+}
+
+TEST(gp_gaussianprocess, optimize_parameters_multistart){
+    auto gpdata = get_random_data(30);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(10.0, 0.2), 0.5);
+    GaussianProcess gaussianprocess(gpdata, gpkernel);
+    GaussianProcess single(gaussianprocess);
+
+    Eigen::VectorXd lower = Eigen::VectorXd::Constant(3, 1e-4);
+    Eigen::VectorXd upper = Eigen::VectorXd::Constant(3, 1e4);
+    const optim::OptimizationStats singleStats = single.optimizeParameters(optim::LBFGS(), lower, upper);
+    std::vector<optim::OptimizationStats> stats = gaussianprocess.optimizeParametersMultiStart(4, optim::LBFGS(), lower, upper, true, 2);
+
+    ASSERT_EQ(stats.size(), 4);
+    // the first start is the current parameter vector
+    EXPECT_DOUBLE_EQ(stats[0].value, singleStats.value);
+    const double nlml = gaussianprocess.computeNegativeLogMarginalLikelihood();
+    for(const optim::OptimizationStats& s : stats){
+        EXPECT_LE(nlml, s.value + 1e-12);
+    }
+    EXPECT_EQ(gpdata->getN(), 30);
+
+    // the starts are drawn around a positive noise if the noise is 0
+    GaussianProcess defaultNoise(gpdata, std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(10.0, 0.2)));
+    stats = defaultNoise.optimizeParametersMultiStart(3, optim::LBFGS(), Eigen::VectorXd(0), Eigen::VectorXd(0), true, 2);
+    ASSERT_EQ(stats.size(), 3);
+    for(const optim::OptimizationStats& s : stats){
+        EXPECT_NE(s.status, optim::Status::INVALID_START);
+        EXPECT_TRUE(std::isfinite(s.value));
+    }
+}
+
+TEST(gp_gaussianprocess, predict_single_precision){
+    auto gpdata = get_random_data(300);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    GaussianProcess gaussianprocess(gpdata, gpkernel);
+    const Eigen::MatrixXd Xtest = Eigen::MatrixXd::Random(400, 2);
+
+    Eigen::MatrixXd mu, var, muSingle, varSingle;
+    gaussianprocess.posteriorMeanVar(mu, var, Xtest);
+    gaussianprocess.setPrecision(GaussianProcess::Precision::SINGLE);
+    EXPECT_EQ(gaussianprocess.getPrecision(), GaussianProcess::Precision::SINGLE);
+    gaussianprocess.posteriorMeanVar(muSingle, varSingle, Xtest);
+    ASSERT_EQ(muSingle.rows(), 400);
+    ASSERT_EQ(varSingle.rows(), 400);
+    EXPECT_LT((muSingle - mu).cwiseAbs().maxCoeff(), 1e-4);
+    EXPECT_LT((varSingle - var).cwiseAbs().maxCoeff(), 1e-4);
+
+    Eigen::MatrixXd muMean;
+    gaussianprocess.posteriorMean(muMean, Xtest);
+    EXPECT_EQ(muMean, muSingle);
+}
+
+TEST(gp_gaussianprocess, approximation){
+    auto gpdata = get_random_data(25);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    GaussianProcess exact(gpdata, gpkernel);
+    GaussianProcess approximated(gpdata, std::dynamic_pointer_cast<kernel::GPKernel>(gpkernel->copy()));
+    // with the observations as inducing inputs, FITC is exact
+    approximated.setApproximation(std::make_shared<InducingPointApprox>(gpdata->getXView(), InducingPointApprox::Method::FITC));
+    ASSERT_NE(approximated.getApproximation(), nullptr);
+    EXPECT_EQ(approximated.nParameters(), exact.nParameters());
+
+    const Eigen::MatrixXd Xtest = Eigen::MatrixXd::Random(6, 2);
+    Eigen::MatrixXd mu, var, muExact, varExact;
+    approximated.posteriorMeanVar(mu, var, Xtest);
+    exact.posteriorMeanVar(muExact, varExact, Xtest);
+    EXPECT_TRUE(mu.isApprox(muExact, 1e-5));
+    EXPECT_LT((var - varExact).cwiseAbs().maxCoeff(), 1e-6);
+
+    // the gradient by central differences
+    Eigen::VectorXd gradient, gradientExact;
+    EXPECT_NEAR(approximated.computeNegativeLogMarginalLikelihood(gradient), exact.computeNegativeLogMarginalLikelihood(gradientExact), 1e-5);
+    EXPECT_LT((gradient - gradientExact).cwiseAbs().maxCoeff(), 1e-3);
+
+    // refitted after changes of the parameters, the copy keeps the approximation
+    const Eigen::Vector3d params(0.2, 3.0, 1.0);
+    approximated.setParameters(params);
+    exact.setParameters(params);
+    auto copy = std::dynamic_pointer_cast<GaussianProcess>(approximated.copy());
+    ASSERT_NE(copy->getApproximation(), nullptr);
+    EXPECT_NE(copy->getApproximation(), approximated.getApproximation());
+    EXPECT_NEAR(copy->computeNegativeLogMarginalLikelihood(), exact.computeNegativeLogMarginalLikelihood(), 1e-5);
+
+    // refitted after changes of the data, the inducing inputs stay fixed
+    gpdata->addDatum(Eigen::Vector2d(0.1, 0.2), Eigen::Vector2d(0.3, 0.4));
+    approximated.posteriorMean(mu, Xtest);
+    exact.posteriorMean(muExact, Xtest);
+    EXPECT_FALSE(mu.isApprox(muExact, 1e-5));
+    EXPECT_TRUE(mu.isApprox(muExact, 1e-2));
+}
+
+TEST(gp_gaussianprocess, nystrom){
+    auto gpdata = get_random_data(40);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    gpkernel->setNystrom(8, kernel::LandmarkSelection::UNIFORM, 1);
+    GaussianProcess gaussianprocess(gpdata, gpkernel);
+
+    Eigen::MatrixXd alpha, Y;
+    gpkernel->getAlpha(alpha);
+    gpdata->getYNormalized(Y);
+    const double nlml = 0.5*(Y.array()*alpha.array()).sum() + gpkernel->computeNoisedLogDetCov() + 40*std::log(2*M_PI);
+    EXPECT_NEAR(gaussianprocess.computeNegativeLogMarginalLikelihood(), nlml, 1e-10);
+
+    // the gradient of the approximated nlml, with landmarks that do not depend on the parameters
+    Eigen::VectorXd params, gradient;
+    gaussianprocess.getParameters(params);
+    gaussianprocess.computeNegativeLogMarginalLikelihood(gradient);
+    for(Eigen::Index i = 0; i < params.size(); ++i){
+        const double h = 1e-4*params(i);
+        Eigen::VectorXd p = params;
+        p(i) = params(i) + h;
+        gaussianprocess.setParameters(p);
+        const double nlmlPlus = gaussianprocess.computeNegativeLogMarginalLikelihood();
+        p(i) = params(i) - h;
+        gaussianprocess.setParameters(p);
+        const double nlmlMinus = gaussianprocess.computeNegativeLogMarginalLikelihood();
+        EXPECT_NEAR(gradient(i), (nlmlPlus - nlmlMinus)/(2*h), 1e-4*std::max(1.0, std::abs(gradient(i))));
+    }
+}
+
+TEST(gp_gaussianprocess, matrix_free){
+    auto gpdata = get_random_data(120);
+    auto covfun = std::make_shared<kernel::RBFCovFun>(2.0, 1.5);
+    covfun->setTileSize(32);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(covfun, 0.1);
+    GaussianProcess gaussianprocess(gpdata, gpkernel);
+    Eigen::VectorXd gradient, gradientDense;
+    const double nlmlDense = gaussianprocess.computeNegativeLogMarginalLikelihood(gradientDense);
+    const double logDet = gpkernel->computeNoisedLogDetCov();
+
+    kernel::IterativeOptions options;
+    options.tolerance = 1e-10;
+    options.preconditionerRank = 10;
+    options.nProbes = 200;
+    gpkernel->setMatrixFree(true, options);
+    const double nlml = gaussianprocess.computeNegativeLogMarginalLikelihood(gradient);
+    // the error of the nlml is that of the log determinant estimate
+    EXPECT_NEAR(nlml, nlmlDense, 0.02*std::abs(logDet));
+    ASSERT_EQ(gradient.size(), gradientDense.size());
+    for(Eigen::Index i = 0; i < gradient.size(); ++i){
+        EXPECT_NEAR(gradient(i), gradientDense(i), 0.1*std::max(1.0, std::abs(gradientDense(i)))) << "i = " << i;
+    }
+
+    // the dense inverse is never formed
+    Eigen::MatrixXd Kinv;
+    EXPECT_THROW(gpkernel->getFactorization().inverse(Kinv), util::exceptions::Error);
+}
+
+TEST(gp_gaussianprocess, compact_support){
+    auto gpdata = get_random_data(80);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::WendlandCovFun>(1, 0.8, 1.5), 0.1);
+    GaussianProcess gaussianprocess(gpdata, gpkernel);
+
+    // the gradient from the selected inverse by central differences
+    Eigen::VectorXd params, gradient;
+    gaussianprocess.getParameters(params);
+    gaussianprocess.computeNegativeLogMarginalLikelihood(gradient);
+    EXPECT_TRUE(gpkernel->getFactorization().isSparse());
+    ASSERT_EQ(gradient.size(), params.size());
+    for(Eigen::Index i = 0; i < params.size(); ++i){
+        const double h = 1e-6*params(i);
+        Eigen::VectorXd p = params;
+        p(i) = params(i) + h;
+        gaussianprocess.setParameters(p);
+        const double nlmlPlus = gaussianprocess.computeNegativeLogMarginalLikelihood();
+        p(i) = params(i) - h;
+        gaussianprocess.setParameters(p);
+        const double nlmlMinus = gaussianprocess.computeNegativeLogMarginalLikelihood();
+        EXPECT_NEAR(gradient(i), (nlmlPlus - nlmlMinus)/(2*h), 1e-5*std::max(1.0, std::abs(gradient(i)))) << "i = " << i;
+    }
+}
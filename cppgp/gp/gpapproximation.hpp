@@ -5,45 +5,79 @@
 #include <Eigen/Eigen>
 
 #include <cppgp/kernels/gpkernel.hpp>
+#include <cppgp/util/prototype.hpp>
 
 namespace gp {
 
-class GPApproximation {
+/**
+ * Interface of the inference schemes of a Gaussian process, e.g. exact inference (see FTC) or sparse approximations.
+ *
+ * An approximation is fitted to the normalized observations by #updateKernelPrecomputations, which calls the hooks
+ * #updateK (covariance and its factorization), #updateAD (data fit terms) and #updateAlpha (prediction weights)
+ * in this order. Afterwards it predicts the normalized targets at new inputs and evaluates the negative log marginal
+ * likelihood of the approximated model. The covariance function and the noise variance are taken from the kernel.
+ */
+class GPApproximation : public util::Prototype {
 public:
-    GPApproximation(){};
+    GPApproximation();
+    virtual ~GPApproximation();
+
+    virtual std::shared_ptr<util::Prototype> copy() const override = 0;
+
     virtual void getParameters(Eigen::VectorXd& params) const=0;
     virtual void setParameters(const Eigen::VectorXd& params)=0;
     virtual size_t nParameters() const=0;
-    void updateKernelPrecomputations(const std::shared_ptr<kernel::GPKernel>& kernel, const Eigen::MatrixXd& obsX, const Eigen::MatrixXd& obsYnormalized);
 
-    void KinvScalarProduct(Eigen::VectorXd& XTKinvX, const Eigen::MatrixXd& Xin) const;
-    void alphaProduct(Eigen::MatrixXd& prod, const Eigen::MatrixXd& lfactor) const;
+    /**
+     * Fit the approximation to the observations.
+     *
+     * @param kernel The kernel, it provides the covariance function and the noise variance.
+     * @param obsX The inputs of the observations, size [nData, dimX].
+     * @param obsYnormalized The normalized targets of the observations, size [nData, dimY].
+     */
+    void updateKernelPrecomputations(const std::shared_ptr<kernel::GPKernel>& kernel, const Eigen::Ref<const Eigen::MatrixXd>& obsX, const Eigen::Ref<const Eigen::MatrixXd>& obsYnormalized);
 
-    virtual double computeNegativeLogMarginalLikelihood(const Eigen::MatrixXd& obsYnormalized)=0;
+    /**
+     * Predict the posterior mean of the normalized targets.
+     *
+     * @param mu Returns the posterior mean, size [nIn, dimY].
+     * @param Xin The inputs, size [nIn, dimX].
+     */
+    virtual void posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const=0;
 
-    bool setNoise(const double noise);
-    double getNoise() const;
-    void setNoiseFixed(bool isNoiseFixed);
-    bool isNoiseFixed() const;
-    double getLogDetK();
-protected:
-    Eigen::LLT<Eigen::MatrixXd> llt;
-    Eigen::MatrixXd K;    // [nData x nData]
-    double logDetK;
-    Eigen::VectorXd innerProducts; // [nY]
-    Eigen::MatrixXd alpha; // [nData x nY]
-    bool isInverseKComputed() const;
-private:
-    double noise;
-    bool fixedNoise;
-    bool isInverseK; // true, if the inverse of K has been successfully computed, else false
+    /**
+     * Predict the posterior mean and the posterior variance of the latent function of the normalized targets.
+     *
+     * @param mu Returns the posterior mean, size [nIn, dimY].
+     * @param var Returns the posterior variance, which is shared by all target dimensions, size [nIn].
+     * @param Xin The inputs, size [nIn, dimX].
+     */
+    virtual void posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::VectorXd& var, const Eigen::MatrixXd& Xin) const=0;
 
-    virtual void updateK(const std::shared_ptr<kernel::GPKernel>& kernel, const Eigen::MatrixXd& obsX)=0;
-    virtual void updateAD(const Eigen::MatrixXd& obsYNormalized)=0;
-    virtual void updateAlpha(const Eigen::MatrixXd& obsYNormalized)=0;
+    /**
+     * Compute the negative log marginal likelihood of the normalized observations under the approximated model.
+     * The default implementation evaluates the Gaussian likelihood
+     * \f[
+     * \frac{1}{2} \sum_{c} \bar{y}_c^T K^{-1} \bar{y}_c + \frac{d_y}{2}\log\det(K) + \frac{n d_y}{2}\log(2\pi)
+     * \f]
+     * from the inner products of #updateAD and the log determinant of #updateK.
+     *
+     * @param obsYnormalized The normalized targets that have been passed to #updateKernelPrecomputations.
+     * @return The negative log marginal likelihood.
+     */
+    virtual double computeNegativeLogMarginalLikelihood(const Eigen::Ref<const Eigen::MatrixXd>& obsYnormalized);
 
-    void computeInverse();
-    void computeLogDetK();
+    /**
+     * @return The log determinant of the (approximated) noised covariance matrix.
+     */
+    double getLogDetK() const;
+protected:
+    double logDetK;                // log determinant of the noised covariance matrix, set by updateK
+    Eigen::VectorXd innerProducts; // [dimY], y_c^T K^-1 y_c of the normalized targets, set by updateAD
+private:
+    virtual void updateK(const std::shared_ptr<kernel::GPKernel>& kernel, const Eigen::Ref<const Eigen::MatrixXd>& obsX)=0;
+    virtual void updateAD(const Eigen::Ref<const Eigen::MatrixXd>& obsYNormalized)=0;
+    virtual void updateAlpha(const Eigen::Ref<const Eigen::MatrixXd>& obsYNormalized)=0;
 };
 
 } // namespace GP
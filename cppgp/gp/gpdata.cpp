@@ -24,9 +24,15 @@
 
 #include <cppgp/gp/gpdata.hpp>
 
+#include <algorithm>
+#include <atomic>
+
+namespace {
+    std::atomic<unsigned long> versionCounter(0); // source of the data versions, unique across all GPData objects
+}
 
 gp::GPData::GPData(const unsigned int dimX, const unsigned int dimY) :
-    X(0, dimX), Y(0, dimY)
+    X(0, dimX), Y(0, dimY), n(0), windowSize(0), lastChange({Change::Type::APPEND, 0, 0}), version(++versionCounter), computed_single(false)
 {
     resetNormalization();
 }
@@ -34,84 +40,40 @@ gp::GPData::GPData(const unsigned int dimX, const unsigned int dimY) :
 
 void gp::GPData::addData(const Eigen::VectorXd& X, const Eigen::VectorXd& Y)
 {
-    int n = this->getN();
-    int dimx = this->getDimX();
-    int dimy = this->getDimY();
-
-    assert(dimx == 1);
-    assert(dimy == 1);
+    assert(this->getDimX() == 1);
+    assert(this->getDimY() == 1);
     assert(X.size() == Y.size());
 
-    Eigen::MatrixXd newX(n+X.size(), dimx);
-    newX << this->X, X;
-    Eigen::MatrixXd newY(n+X.size(), dimy);
-    newY << this->Y, Y;
-
-    this->X = newX;
-    this->Y = newY;
-    updatedData_trigger();
+    this->append(X, Y);
 }
 
 
 void gp::GPData::addData(const Eigen::MatrixXd& X, const Eigen::VectorXd& Y){
-    int n = this->getN();
-    int dimx = this->getDimX();
-    int dimy = this->getDimY();
-
-    assert(X.cols() == dimx);
-    assert(dimy == 1);
+    assert(X.cols() == this->getDimX());
+    assert(this->getDimY() == 1);
     assert(X.rows() == Y.size());
 
-    Eigen::MatrixXd newX(n+X.rows(), dimx);
-    newX << this->X, X;
-    Eigen::MatrixXd newY(n+X.size(), dimy);
-    newY << this->Y, Y;
-
-    this->X = newX;
-    this->Y = newY;
-    updatedData_trigger();
+    this->append(X, Y);
 }
 
 
 
 void gp::GPData::addData(const Eigen::VectorXd& X, const Eigen::MatrixXd& Y){
-    int n = this->getN();
-    int dimx = this->getDimX();
-    int dimy = this->getDimY();
-
-    assert(dimx == 1);
-    assert(Y.cols() == dimy);
+    assert(this->getDimX() == 1);
+    assert(Y.cols() == this->getDimY());
     assert(X.size() == Y.rows());
 
-    Eigen::MatrixXd newX(n+X.size(), dimx);
-    newX << this->X, X;
-    Eigen::MatrixXd newY(n+X.rows(), dimy);
-    newY << this->Y, Y;
-
-    this->X = newX;
-    this->Y = newY;
-    updatedData_trigger();
+    this->append(X, Y);
 }
 
 
 
 void gp::GPData::addData(const Eigen::MatrixXd& X, const Eigen::MatrixXd& Y){
-    int n = this->getN();
-    int dimx = this->getDimX();
-    int dimy = this->getDimY();
-
-    assert(X.cols() == dimx);
-    assert(Y.cols() == dimy);
+    assert(X.cols() == this->getDimX());
+    assert(Y.cols() == this->getDimY());
     assert(X.rows() == Y.rows());
 
-    Eigen::MatrixXd newX(n+X.rows(), dimx);
-    newX << this->X, X;
-    Eigen::MatrixXd newY(n+X.rows(), dimy);
-    newY << this->Y, Y;
-
-    this->X = newX;
-    this->Y = newY;
-    updatedData_trigger();
+    this->append(X, Y);
 }
 
 
@@ -143,31 +105,122 @@ void gp::GPData::addDatum(const double x, const Eigen::VectorXd& y){
 
 
 void gp::GPData::addDatum(const Eigen::VectorXd& x, const Eigen::VectorXd& y){
-    int n = this->getN();
-    int dimx = this->getDimX();
-    int dimy = this->getDimY();
+    assert(x.rows() == this->getDimX());
+    assert(y.rows() == this->getDimY());
+
+    this->append(x.transpose(), y.transpose());
+}
+
 
-    assert(x.rows() == dimx);
-    assert(y.rows() == dimy);
 
-    Eigen::MatrixXd newX(n+1, dimx);
-    newX << this->X, x.transpose();
-    Eigen::MatrixXd newY(n+1, dimy);
-    newY << this->Y, y.transpose();
+void gp::GPData::removeData(const unsigned int index, const unsigned int count)
+{
+    assert(index+count <= this->n);
+    if(count == 0){
+        return;
+    }
+
+    // move the subsequent rows forward, column by column in the column-major buffers
+    const unsigned int tail = this->n-index-count;
+    for(Eigen::Index j = 0; j < this->X.cols(); ++j){
+        double* col = this->X.col(j).data();
+        std::copy(col+index+count, col+index+count+tail, col+index);
+    }
+    for(Eigen::Index j = 0; j < this->Y.cols(); ++j){
+        double* col = this->Y.col(j).data();
+        std::copy(col+index+count, col+index+count+tail, col+index);
+    }
+    this->n -= count;
 
-    this->X = newX;
-    this->Y = newY;
+    this->lastChange = {Change::Type::REMOVE, index, count};
     updatedData_trigger();
 }
 
 
 
-unsigned int gp::GPData::getN() const{
+void gp::GPData::removeOldest(const unsigned int count)
+{
+    this->removeData(0, count);
+}
+
+
+
+void gp::GPData::setWindowSize(const unsigned int windowSize)
+{
+    this->windowSize = windowSize;
+    if(windowSize > 0 && this->getN() > windowSize){
+        this->removeOldest(this->getN()-windowSize);
+    }
+}
+
+
+
+unsigned int gp::GPData::getWindowSize() const
+{
+    return this->windowSize;
+}
+
+
+
+void gp::GPData::append(const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::Ref<const Eigen::MatrixXd>& Y)
+{
+    unsigned int k = X.rows();
+    if(this->windowSize > 0){
+        // only the newest data points fit into the window
+        if(k > this->windowSize){
+            k = this->windowSize;
+        }
+        const unsigned int n = this->getN();
+        if(n+k > this->windowSize){
+            this->removeOldest(n+k-this->windowSize);
+        }
+    }
+
+    const unsigned int n = this->n;
+    if(n+k > this->getCapacity()){
+        this->reserve(std::max(n+k, 2*this->getCapacity()));
+    }
+    this->X.middleRows(n, k) = X.bottomRows(k);
+    this->Y.middleRows(n, k) = Y.bottomRows(k);
+    this->n += k;
+
+    this->lastChange = {Change::Type::APPEND, n, k};
+    updatedData_trigger();
+}
+
+
+
+void gp::GPData::reserve(const unsigned int capacity)
+{
+    if(capacity > this->getCapacity()){
+        this->X.conservativeResize(capacity, Eigen::NoChange);
+        this->Y.conservativeResize(capacity, Eigen::NoChange);
+    }
+}
+
+
+
+unsigned int gp::GPData::getCapacity() const
+{
     return this->X.rows();
 }
 
 
 
+void gp::GPData::shrinkToFit()
+{
+    this->X.conservativeResize(this->n, Eigen::NoChange);
+    this->Y.conservativeResize(this->n, Eigen::NoChange);
+}
+
+
+
+unsigned int gp::GPData::getN() const{
+    return this->n;
+}
+
+
+
 bool gp::GPData::hasDerivativeData() const {
     return false; // NOT YET IMPLEMENTED.
 }
@@ -185,38 +238,57 @@ unsigned int gp::GPData::getDimY() const {
 }
 
 
-//std::tuple<std::shared_ptr<const Eigen::MatrixXd>, std::shared_ptr<const Eigen::MatrixXd>> gp::GPData::getData() const{
-std::tuple<const Eigen::MatrixXd&, const Eigen::MatrixXd&> gp::GPData::getData() const{
-    const Eigen::MatrixXd& xptr = this->X;
-    const Eigen::MatrixXd& yptr = this->Y;
-    auto data = std::tie(xptr, yptr);
-    return data;
+
+const gp::GPData::Change& gp::GPData::getLastChange() const {
+    return this->lastChange;
+}
+
+unsigned long gp::GPData::getVersion() const {
+    return this->version;
 }
 
+std::tuple<gp::GPData::ConstView, gp::GPData::ConstView> gp::GPData::getData() const{
+    return std::make_tuple(this->X.topRows(this->n), this->Y.topRows(this->n));
+}
 
-std::tuple<const Eigen::MatrixXd&, const Eigen::MatrixXd&> gp::GPData::getNormalizedData() const
+std::tuple<gp::GPData::ConstView, gp::GPData::ConstView> gp::GPData::getNormalizedData() const
 {
     if(!computed_normalized[2]){
         computeYNorm();
     }
-    const Eigen::MatrixXd& xptr = this->X;
-    const Eigen::MatrixXd& yptr = this->obsYnormalized;
-    auto data = std::tie(xptr, yptr);
-    return data;
+    const Eigen::MatrixXd& yNormalized = this->obsYnormalized;
+    return std::make_tuple(this->X.topRows(this->n), yNormalized.topRows(this->n));
+}
+
+gp::GPData::ConstView gp::GPData::getXView() const
+{
+    return this->X.topRows(this->n);
+}
+
+const Eigen::MatrixXf& gp::GPData::getXSingle() const
+{
+    if(!this->computed_single){
+        this->Xsingle = this->X.topRows(this->n).cast<float>();
+        this->computed_single = true;
+    }
+    return this->Xsingle;
 }
 
+gp::GPData::ConstView gp::GPData::getYView() const
+{
+    return this->Y.topRows(this->n);
+}
 
 void gp::GPData::getX(Eigen::MatrixXd& X) const
 {
-    X = this->X;
+    X = this->X.topRows(this->n);
 }
 
 void gp::GPData::getY(Eigen::MatrixXd& Y) const
 {
-    Y = this->Y;
+    Y = this->Y.topRows(this->n);
 }
 
-
 void gp::GPData::getBias(Eigen::RowVectorXd& bias) const
 {
     if(!this->computed_normalized[0]) {
@@ -241,27 +313,33 @@ void gp::GPData::getYNormalized(Eigen::MatrixXd& yNormalized) const
     yNormalized = this->obsYnormalized;
 }
 
+void gp::GPData::precomputeNormalization() const
+{
+    if(!this->computed_normalized[2]) {
+        computeYNorm();
+    }
+}
 
 void gp::GPData::updatedData_trigger()
 {
+    this->version = ++versionCounter;
     resetNormalization();
+    this->computed_single = false;
     notifyAll();
 }
 
-
 void gp::GPData::computeBias() const
 {
-    this->bias = this->Y.colwise().mean();
+    this->bias = this->Y.topRows(this->n).colwise().mean();
     computed_normalized[0] = true;
 }
 
 void gp::GPData::computeScale() const
 {
     this->scale = Eigen::VectorXd::Ones(Y.cols());
-    computed_normalized[2] = true;
+    computed_normalized[1] = true;
 }
 
-
 void gp::GPData::computeYNorm() const
 {
     if(!this->computed_normalized[0])
@@ -272,7 +350,7 @@ void gp::GPData::computeYNorm() const
     {
         computeScale();
     }
-    this->obsYnormalized = (Y.rowwise() + (-bias)).array().rowwise()/scale.array();
+    this->obsYnormalized = (Y.topRows(this->n).rowwise() + (-bias)).array().rowwise()/scale.array();
     computed_normalized[2] = true;
 }
 
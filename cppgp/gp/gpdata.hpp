@@ -38,7 +38,14 @@ namespace gp {
  * Container to manage observation and input data for a Gaussian Process.
  *
  * Holds first and second order observation data used in Gaussian processes.
- * Allows adding new data and signals to all subscribers that the data has changed.
+ * Allows adding and removing data and signals to all subscribers that the data has changed.
+ * Subscribers can query the kind of the most recent change with getLastChange().
+ * Optionally, the container holds at most a fixed number of data points (window mode),
+ * the oldest data points are dropped when new data is added.
+ *
+ * The data is stored in buffers with a capacity that grows geometrically, such that appending
+ * n data points one by one only causes O(log n) reallocations. The stored data is accessed
+ * through views on the active rows of these buffers without copying.
  * Provides access to its data.
  * Provides general information on the stored data (dimensions, number etc).
  *
@@ -48,6 +55,22 @@ namespace gp {
 class GPData : public util::ISubject {
 public:
 
+    /**
+     * Description of the most recent modification of the stored data.
+     */
+    struct Change {
+        enum class Type {APPEND, REMOVE};
+        Type type;          /// appended or removed data points
+        unsigned int index; /// index of the first appended or removed data point
+        unsigned int count; /// number of appended or removed data points
+    };
+
+    /**
+     * Read-only view on the stored data.
+     * A view is invalidated as soon as data is added to or removed from the container.
+     */
+    typedef Eigen::Block<const Eigen::MatrixXd> ConstView;
+
     /**
      * Create a new instance of the GPData class.
      *
@@ -143,6 +166,66 @@ public:
      */
     void addDatum(const Eigen::VectorXd& x, const Eigen::VectorXd& y);
 
+    /*
+    ********* remove data *********
+    */
+
+    /**
+     * Remove count data points, starting at the given index.
+     * The order of the remaining data points is preserved.
+     *
+     * @param index The index of the first data point to remove.
+     * @param count The number of data points to remove.
+     */
+    void removeData(const unsigned int index, const unsigned int count=1);
+
+    /**
+     * Remove the count oldest data points, i.e. the data points that have been added first.
+     *
+     * @param count The number of data points to remove.
+     */
+    void removeOldest(const unsigned int count=1);
+
+    /**
+     * Limit the number of stored data points to windowSize.
+     * If more data is added, the oldest data points are removed before the new data is appended.
+     * If the container already holds more data points, the oldest data points are removed immediately.
+     *
+     * @param windowSize The maximum number of data points, 0 to store an unlimited number of data points.
+     */
+    void setWindowSize(const unsigned int windowSize);
+
+    /**
+     * Get the maximum number of data points of this container.
+     *
+     * @return The maximum number of data points, 0 if unlimited.
+     */
+    unsigned int getWindowSize() const;
+
+    /*
+    ********* storage *********
+    */
+
+    /**
+     * Reserve memory for at least capacity data points.
+     * Adding data does not reallocate memory as long as the number of data points stays below the capacity.
+     *
+     * @param capacity The number of data points for which memory is reserved.
+     */
+    void reserve(const unsigned int capacity);
+
+    /**
+     * Get the number of data points for which memory is reserved.
+     *
+     * @return The capacity of the container.
+     */
+    unsigned int getCapacity() const;
+
+    /**
+     * Release the memory that is reserved but not used by the stored data points.
+     */
+    void shrinkToFit();
+
     /*
     ********* get information *********
     */
@@ -175,32 +258,73 @@ public:
      */
     unsigned int getDimY() const;
 
+    /**
+     * Get the description of the most recent modification of the data.
+     * Subscribers can use this information in their notification handler
+     * to update their precomputations instead of recomputing them.
+     *
+     * @return The most recent change.
+     */
+    const Change& getLastChange() const;
+
+    /**
+     * Get the version of the stored data.
+     * The version increases on every change of the data, such that
+     * precomputations can be tagged with the version of the data they are based on.
+     * Versions are drawn from a global counter, so they are unique across all GPData objects.
+     *
+     * @return The current version of the data.
+     */
+    unsigned long getVersion() const;
+
     /*
     ********* retrieve data *********
     *
-    * TODO: what is the best way to return the data?
-    * As copy, reference or shared pointer?
-    * Currently, the tuple returns a reference and the getX/getY-methods create a copy.
+    * The tuples contain views on the stored data, the getX/getY-methods create a copy.
     */
 
     /**
      * Return all observation data stored in this container.
-     * Currently, the returned tuple containes constant references to the stored data,
-     * these references are invalidated as soon as this container is destroyed.
+     * The returned tuple contains views on the stored data without copying it,
+     * these views are invalidated as soon as this container is modified or destroyed.
      *
-     * @return tuple containing references to the input and target observation data
+     * @return tuple containing views on the input and target observation data
      */
-    std::tuple<const Eigen::MatrixXd&, const Eigen::MatrixXd&> getData() const;
+    std::tuple<ConstView, ConstView> getData() const;
 
     /**
      * Return all observation data stored in this container.
      * The target data is normalized.
-     * Currently, the returned tuple containes constant references to the stored data,
-     * these references are invalidated as soon as this container is destroyed.
+     * The returned tuple contains views on the stored data without copying it,
+     * these views are invalidated as soon as this container is modified or destroyed.
+     *
+     * @return Views on the input and normalized target observation data
+     */
+    std::tuple<ConstView, ConstView> getNormalizedData() const;
+
+    /**
+     * Get a view on the input observation data without copying it.
+     * The view is invalidated as soon as this container is modified or destroyed.
+     *
+     * @return View on the input data, size [getN(), getDimX()]
+     */
+    ConstView getXView() const;
+
+    /**
+     * Get a view on the target observation data without copying it.
+     * The view is invalidated as soon as this container is modified or destroyed.
+     *
+     * @return View on the target data, size [getN(), getDimY()]
+     */
+    ConstView getYView() const;
+
+    /**
+     * Get the input observation data rounded to single precision, e.g. for predictions in single precision.
+     * The copy is computed on first access and kept until the data changes.
      *
-     * @return References to the input and normalized target observation data
+     * @return The input data, size [getN(), getDimX()]
      */
-    std::tuple<const Eigen::MatrixXd&, const Eigen::MatrixXd&> getNormalizedData() const;
+    const Eigen::MatrixXf& getXSingle() const;
 
     /**
      * Get a copy of the input observation data.
@@ -224,6 +348,13 @@ public:
      */
     void getYNormalized(Eigen::MatrixXd& yNormalized) const;
 
+    /**
+     * Compute the normalization (bias, scale and normalized targets) if it is not computed yet.
+     * The normalization is otherwise computed lazily on first access. Calling this method
+     * before the data is shared between threads makes all const methods read-only.
+     */
+    void precomputeNormalization() const;
+
     /**
      * Get the bias of the target data for each dimension.
      *
@@ -241,9 +372,14 @@ public:
     void getScale(Eigen::RowVectorXd& scale) const;
 
 private:
-    Eigen::MatrixXd X; // [n, dimx]
-    Eigen::MatrixXd Y; // [n, dimy]
-
+    Eigen::MatrixXd X; // [capacity, dimx], the first n rows are used
+    Eigen::MatrixXd Y; // [capacity, dimy], the first n rows are used
+    unsigned int n;    // number of stored data points
+    unsigned int windowSize; // maximum number of data points, 0 if unlimited
+    Change lastChange;
+    unsigned long version;
+
+    void append(const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::Ref<const Eigen::MatrixXd>& Y); /// Append the rows of X and Y, respecting the window size.
     void updatedData_trigger(); /// This method is called when the data has changed. It resets normalization and notifies all listeners.
 
     // Normalized data
@@ -256,6 +392,10 @@ private:
     void computeScale() const;
     void computeYNorm() const;
     void resetNormalization() const;
+
+    // Single precision input data
+    mutable bool computed_single; // flag for lazy computation
+    mutable Eigen::MatrixXf Xsingle; // [nData x dimx], lazy computation!
 };
 
 }
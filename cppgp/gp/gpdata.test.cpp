@@ -1,5 +1,6 @@
 
 #include <cppgp/gp/gpdata.hpp>
+#include <cppgp/gp/inputindex.hpp>
 #include <iostream>
 #include <gtest/gtest.h>
 
@@ -211,3 +212,171 @@ TEST(gp_gpdata, get_gpdata_ynormal){
 
     EXPECT_TRUE(yNorm.isApprox(yNormTrue));
 }
+
+TEST(gp_gpdata, remove_gpdata){
+    GPData gpdat(1, 1);
+    Eigen::VectorXd x(6), y(6);
+    x << 0.5, 1.5, 2.5, 3.5, 4.5, 5.5;
+    y << 1.0, 2.0, 3.0, 4.0, 5.0, 6.0;
+    gpdat.addData(x, y);
+
+    gpdat.removeData(2, 2);
+    EXPECT_EQ(gpdat.getN(), 4);
+    EXPECT_EQ(gpdat.getLastChange().type, GPData::Change::Type::REMOVE);
+    EXPECT_EQ(gpdat.getLastChange().index, 2);
+    EXPECT_EQ(gpdat.getLastChange().count, 2);
+
+    gpdat.removeOldest();
+    Eigen::MatrixXd xret, yret;
+    gpdat.getX(xret);
+    gpdat.getY(yret);
+
+    Eigen::Matrix<double, 3, 1> expX, expY;
+    expX << 1.5, 4.5, 5.5;
+    expY << 2.0, 5.0, 6.0;
+    EXPECT_EQ(xret, expX);
+    EXPECT_EQ(yret, expY);
+
+    Eigen::RowVectorXd bias;
+    gpdat.getBias(bias);
+    EXPECT_DOUBLE_EQ(bias(0), 13.0/3.0);
+}
+
+TEST(gp_gpdata, window_gpdata){
+    GPData gpdat(1, 1);
+    gpdat.setWindowSize(3);
+    EXPECT_EQ(gpdat.getWindowSize(), 3);
+
+    for(int i = 0; i < 5; ++i){
+        gpdat.addDatum(i, 2.0*i);
+        EXPECT_EQ(gpdat.getN(), std::min(i+1, 3));
+    }
+    EXPECT_EQ(gpdat.getLastChange().type, GPData::Change::Type::APPEND);
+    EXPECT_EQ(gpdat.getLastChange().index, 2);
+    EXPECT_EQ(gpdat.getLastChange().count, 1);
+
+    Eigen::Matrix<double, 3, 1> expX;
+    expX << 2.0, 3.0, 4.0;
+    EXPECT_EQ(std::get<0>(gpdat.getData()), expX);
+
+    // more data than fits into the window: only the newest data is kept
+    Eigen::VectorXd x(4), y(4);
+    x << 5.0, 6.0, 7.0, 8.0;
+    y << 5.0, 6.0, 7.0, 8.0;
+    gpdat.addData(x, y);
+    expX << 6.0, 7.0, 8.0;
+    EXPECT_EQ(std::get<0>(gpdat.getData()), expX);
+
+    gpdat.setWindowSize(2);
+    EXPECT_EQ(gpdat.getN(), 2);
+    gpdat.setWindowSize(0);
+    gpdat.addData(x, y);
+    EXPECT_EQ(gpdat.getN(), 6);
+}
+
+TEST(gp_gpdata, capacity_gpdata){
+    GPData gpdat(2, 1);
+    gpdat.reserve(10);
+    EXPECT_EQ(gpdat.getCapacity(), 10);
+    EXPECT_EQ(gpdat.getN(), 0);
+
+    gpdat.addDatum(Eigen::Vector2d(0, 0), 0);
+    const double* ptr = std::get<0>(gpdat.getData()).data();
+    for(int i = 1; i < 10; ++i){
+        gpdat.addDatum(Eigen::Vector2d(i, -i), i);
+    }
+    // no reallocation within the reserved capacity
+    EXPECT_EQ(gpdat.getCapacity(), 10);
+    EXPECT_EQ(std::get<0>(gpdat.getData()).data(), ptr);
+
+    // geometric growth
+    gpdat.addDatum(Eigen::Vector2d(10, -10), 10);
+    EXPECT_EQ(gpdat.getCapacity(), 20);
+    EXPECT_EQ(gpdat.getN(), 11);
+
+    gpdat.shrinkToFit();
+    EXPECT_EQ(gpdat.getCapacity(), 11);
+
+    // views access the stored data without copying
+    auto data = gpdat.getData();
+    EXPECT_EQ(std::get<0>(data).rows(), 11);
+    EXPECT_EQ(std::get<0>(data).data(), std::get<0>(gpdat.getData()).data());
+    for(int i = 0; i < 11; ++i){
+        EXPECT_EQ(std::get<0>(data)(i, 0), i);
+        EXPECT_EQ(std::get<0>(data)(i, 1), -i);
+        EXPECT_EQ(std::get<1>(data)(i, 0), i);
+    }
+}
+
+TEST(gp_gpdata, view_gpdata){
+    GPData gpdat(2, 1);
+    Eigen::MatrixXd x(3, 2), y(3, 1);
+    x << 1.0, 2.0,
+         3.0, 4.0,
+         5.0, 6.0;
+    y << 1.0, 2.0, 3.0;
+    gpdat.addData(x, y);
+
+    EXPECT_EQ(gpdat.getXView(), x);
+    EXPECT_EQ(gpdat.getYView(), y);
+    EXPECT_EQ(gpdat.getXView().data(), std::get<0>(gpdat.getData()).data());
+
+    // views bind to Eigen::Ref without copying
+    const Eigen::Ref<const Eigen::MatrixXd> xref = gpdat.getXView();
+    EXPECT_EQ(xref.data(), gpdat.getXView().data());
+}
+
+TEST(gp_gpdata, version_gpdata){
+    GPData gpdat(1, 1);
+    const unsigned long v0 = gpdat.getVersion();
+    gpdat.addDatum(1.0, 2.0);
+    const unsigned long v1 = gpdat.getVersion();
+    EXPECT_GT(v1, v0);
+    gpdat.addDatum(2.0, 3.0);
+    const unsigned long v2 = gpdat.getVersion();
+    EXPECT_GT(v2, v1);
+    gpdat.removeOldest();
+    const unsigned long v3 = gpdat.getVersion();
+    EXPECT_GT(v3, v2);
+    gpdat.reserve(10);
+    EXPECT_EQ(gpdat.getVersion(), v3);
+
+    // versions are unique across objects
+    GPData other(1, 1);
+    other.addDatum(1.0, 2.0);
+    EXPECT_NE(other.getVersion(), v1);
+    EXPECT_GT(other.getVersion(), v3);
+}
+
+TEST(gp_gpdata, input_index){
+    // the index follows appended and removed data points, also in window mode
+    auto gpdata = std::make_shared<gp::GPData>(2, 1);
+    gpdata->setWindowSize(300);
+    gpdata->addData(Eigen::MatrixXd(Eigen::MatrixXd::Random(200, 2)), Eigen::MatrixXd(Eigen::MatrixXd::Random(200, 1)));
+    gp::InputIndex index(gpdata, 8);
+
+    auto check = [&](){
+        const Eigen::MatrixXd X = gpdata->getXView();
+        ASSERT_EQ(index.getTree().size(), X.rows());
+        const Eigen::VectorXd x = Eigen::VectorXd::Random(2);
+        std::vector<Eigen::Index> indices;
+        std::vector<double> distances;
+        index.knnSearch(indices, distances, x, 5);
+        ASSERT_EQ(indices.size(), 5u);
+        Eigen::VectorXd d = (X.rowwise() - x.transpose()).rowwise().norm();
+        std::sort(d.begin(), d.end());
+        for(int i = 0; i < 5; ++i){
+            EXPECT_NEAR(distances[i], d(i), 1e-14);
+            EXPECT_NEAR((X.row(indices[i]).transpose() - x).norm(), d(i), 1e-14);
+        }
+        index.radiusSearch(indices, distances, x, 0.2);
+        EXPECT_EQ(indices.size(), (d.array() < 0.2).count());
+    };
+    check();
+    for(int i = 0; i < 30; ++i){
+        gpdata->addData(Eigen::MatrixXd(Eigen::MatrixXd::Random(10, 2)), Eigen::MatrixXd(Eigen::MatrixXd::Random(10, 1)));
+        check();
+    }
+    gpdata->removeData(50, 20);
+    check();
+}
@@ -0,0 +1,210 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <cppgp/gp/inducingapprox.hpp>
+#include <cppgp/math/cholesky.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+gp::InducingPointApprox::InducingPointApprox(const Eigen::MatrixXd& inducingInputs, const Method method) :
+    method(method),
+    nInducing(inducingInputs.rows()),
+    seed(0),
+    covfun(nullptr),
+    Z(inducingInputs),
+    traceResidual(0.0),
+    noise(0.0)
+{
+    if(inducingInputs.rows() == 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("At least one inducing input is required.");
+    }
+}
+
+gp::InducingPointApprox::InducingPointApprox(const unsigned int nInducing, const Method method, const unsigned int seed) :
+    method(method),
+    nInducing(nInducing),
+    seed(seed),
+    covfun(nullptr),
+    traceResidual(0.0),
+    noise(0.0)
+{
+    if(nInducing == 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("At least one inducing input is required.");
+    }
+}
+
+std::shared_ptr<util::Prototype> gp::InducingPointApprox::copy() const
+{
+    return std::make_shared<InducingPointApprox>(*this);
+}
+
+void gp::InducingPointApprox::getParameters(Eigen::VectorXd& params) const
+{
+    params.resize(0);
+}
+
+void gp::InducingPointApprox::setParameters(const Eigen::VectorXd& params)
+{
+    if(params.size() != 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("InducingPointApprox has no parameters.");
+    }
+}
+
+size_t gp::InducingPointApprox::nParameters() const
+{
+    return 0;
+}
+
+void gp::InducingPointApprox::posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const
+{
+    Eigen::MatrixXd kXStar;
+    this->covfun->K(kXStar, this->Z, Xin);
+    mu.noalias() = kXStar.transpose()*this->alpha;
+}
+
+void gp::InducingPointApprox::posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::VectorXd& var, const Eigen::MatrixXd& Xin) const
+{
+    Eigen::MatrixXd km, ka;
+    this->projectInputs(km, ka, Xin);
+    mu.noalias() = km.transpose()*(this->Lm.triangularView<Eigen::Lower>().transpose()*this->alpha);
+    // k** - Q** + k*m Sigma km* with Sigma = (Kmm + Kmn Lambda^-1 Knm)^-1
+    this->covfun->diagK(var, Xin);
+    var -= km.colwise().squaredNorm().transpose();
+    var += ka.colwise().squaredNorm().transpose();
+}
+
+double gp::InducingPointApprox::computeNegativeLogMarginalLikelihood(const Eigen::Ref<const Eigen::MatrixXd>& obsYnormalized)
+{
+    double nlml = GPApproximation::computeNegativeLogMarginalLikelihood(obsYnormalized);
+    if(this->method == Method::VFE){
+        nlml += 0.5*obsYnormalized.cols()*this->traceResidual/this->noise;
+    }
+    return nlml;
+}
+
+gp::InducingPointApprox::Method gp::InducingPointApprox::getMethod() const
+{
+    return this->method;
+}
+
+void gp::InducingPointApprox::setInducingInputs(const Eigen::MatrixXd& inducingInputs)
+{
+    if(inducingInputs.rows() == 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("At least one inducing input is required.");
+    }
+    this->Z = inducingInputs;
+    this->nInducing = inducingInputs.rows();
+}
+
+const Eigen::MatrixXd& gp::InducingPointApprox::getInducingInputs() const
+{
+    return this->Z;
+}
+
+void gp::InducingPointApprox::updateK(const std::shared_ptr<kernel::GPKernel>& kernel, const Eigen::Ref<const Eigen::MatrixXd>& obsX)
+{
+    this->covfun = kernel->getCovarianceFunction();
+    this->noise = kernel->getNoise();
+    const Eigen::Index n = obsX.rows();
+
+    // draw the inducing inputs at the first fit, and again while there are less than m and the data has grown
+    if(this->Z.rows() < this->nInducing && this->Z.rows() < n){
+        // partial Fisher-Yates shuffle of the observations
+        std::vector<Eigen::Index> indices(n);
+        std::iota(indices.begin(), indices.end(), 0);
+        std::mt19937 rng(this->seed);
+        const Eigen::Index m = std::min<Eigen::Index>(this->nInducing, n);
+        this->Z.resize(m, obsX.cols());
+        for(Eigen::Index i = 0; i < m; ++i){
+            std::uniform_int_distribution<Eigen::Index> draw(i, n-1);
+            std::swap(indices[i], indices[draw(rng)]);
+            this->Z.row(i) = obsX.row(indices[i]);
+        }
+    }
+    const Eigen::Index m = this->Z.rows();
+
+    // Kmm = Lm Lm^T, the inducing inputs may be close to each other
+    this->covfun->K(this->Lm, this->Z);
+    const double meanDiag = this->Lm.diagonal().mean();
+    const double scale = (meanDiag > 0) ? meanDiag : 1.0;
+    Eigen::VectorXd diag;
+    double jitter;
+    if(!math::cholJitter(this->Lm, diag, jitter, 1e-10*scale, 20)){
+        util::exceptions::throwException<util::exceptions::Error>("Failed to decompose the covariance matrix of the inducing inputs.");
+    }
+
+    // V = Lm^-1 Kmn, diag(Q) = colwise squared norms of V
+    this->covfun->K(this->V, this->Z, obsX);
+    this->Lm.triangularView<Eigen::Lower>().solveInPlace(this->V);
+    Eigen::VectorXd residual;
+    this->covfun->diagK(residual, obsX);
+    residual = (residual - this->V.colwise().squaredNorm().transpose()).cwiseMax(0.0);
+    this->traceResidual = residual.sum();
+
+    // a lower bound on the noise keeps Lambda invertible
+    this->noise = std::max(this->noise, 1e-10*scale);
+    this->lambda = Eigen::VectorXd::Constant(n, this->noise);
+    if(this->method == Method::FITC){
+        this->lambda += residual;
+    }
+
+    // A = I + V Lambda^-1 V^T = LA LA^T
+    const Eigen::MatrixXd Vscaled = this->V*this->lambda.cwiseSqrt().cwiseInverse().asDiagonal();
+    this->LA = Eigen::MatrixXd::Identity(m, m);
+    this->LA.selfadjointView<Eigen::Lower>().rankUpdate(Vscaled);
+    if(math::cholInplace(this->LA) != m){
+        util::exceptions::throwException<util::exceptions::Error>("Failed to decompose the inducing point system.");
+    }
+
+    // det(Q + Lambda) = det(Lambda) det(A)
+    this->logDetK = this->lambda.array().log().sum() + 2.0*this->LA.diagonal().array().log().sum();
+}
+
+void gp::InducingPointApprox::updateAD(const Eigen::Ref<const Eigen::MatrixXd>& obsYNormalized)
+{
+    // y^T (Q + Lambda)^-1 y = y^T Lambda^-1 y - ||LA^-1 V Lambda^-1 y||^2
+    const Eigen::MatrixXd Yscaled = this->lambda.cwiseInverse().asDiagonal()*obsYNormalized;
+    this->beta.noalias() = this->V*Yscaled;
+    this->LA.triangularView<Eigen::Lower>().solveInPlace(this->beta);
+    this->innerProducts = (obsYNormalized.array()*Yscaled.array()).colwise().sum().transpose()
+                        - this->beta.colwise().squaredNorm().transpose().array();
+}
+
+void gp::InducingPointApprox::updateAlpha(const Eigen::Ref<const Eigen::MatrixXd>&)
+{
+    this->alpha = this->LA.triangularView<Eigen::Lower>().transpose().solve(this->beta);
+    this->Lm.triangularView<Eigen::Lower>().transpose().solveInPlace(this->alpha);
+}
+
+void gp::InducingPointApprox::projectInputs(Eigen::MatrixXd& km, Eigen::MatrixXd& ka, const Eigen::MatrixXd& Xin) const
+{
+    this->covfun->K(km, this->Z, Xin);
+    this->Lm.triangularView<Eigen::Lower>().solveInPlace(km);
+    ka = this->LA.triangularView<Eigen::Lower>().solve(km);
+}
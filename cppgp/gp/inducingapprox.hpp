@@ -0,0 +1,139 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+
+#include <Eigen/Eigen>
+
+#include <cppgp/gp/gpapproximation.hpp>
+#include <cppgp/kernels/covfun.hpp>
+
+namespace gp {
+
+/**
+ * Sparse approximations with m inducing inputs Z, which replace the covariance matrix of the observations by
+ * \f[
+ * K \approx Q + \Lambda, \quad Q = K_{nm} K_{mm}^{-1} K_{mn},
+ * \f]
+ * with a diagonal \f$ \Lambda \f$ that depends on the #Method. All solves and determinants use the m x m matrix
+ * \f$ A = I + V \Lambda^{-1} V^T \f$ with \f$ V = L_m^{-1} K_{mn} \f$, where \f$ L_m \f$ is the Cholesky factor
+ * of \f$ K_{mm} \f$. Fitting costs O(n m^2) time and O(n m) memory, a predicted mean costs O(m),
+ * a predicted variance O(m^2).
+ *
+ * The inducing inputs are either given or drawn at random from the observations at the first fit.
+ */
+class InducingPointApprox : public GPApproximation {
+public:
+    /**
+     * Approximations of Quiñonero-Candela and Rasmussen (2005) and Titsias (2009).
+     * - DTC: Deterministic training conditional, \f$ \Lambda = \sigma I \f$.
+     * - FITC: Fully independent training conditional, \f$ \Lambda = \mathrm{diag}(K - Q) + \sigma I \f$.
+     * - VFE: Variational free energy, the DTC model whose negative log marginal likelihood is increased
+     *        by the trace term \f$ \frac{d_y}{2\sigma} \mathrm{tr}(K - Q) \f$ to a bound of the exact one.
+     */
+    enum class Method {DTC, FITC, VFE};
+
+    /**
+     * Approximation with the given inducing inputs.
+     *
+     * @param inducingInputs The inducing inputs, size [m, dimX].
+     * @param method The approximation.
+     */
+    InducingPointApprox(const Eigen::MatrixXd& inducingInputs, const Method method=Method::VFE);
+
+    /**
+     * Approximation with m inducing inputs that are drawn without replacement from the observations at the first fit.
+     * All observations are used if there are less than m, then the inducing inputs are drawn again at each fit
+     * until m observations are available.
+     *
+     * @param nInducing The number m of inducing inputs.
+     * @param method The approximation.
+     * @param seed The seed for drawing the inducing inputs.
+     */
+    InducingPointApprox(const unsigned int nInducing, const Method method=Method::VFE, const unsigned int seed=0);
+
+    virtual std::shared_ptr<util::Prototype> copy() const override;
+
+    virtual void getParameters(Eigen::VectorXd& params) const override;
+    virtual void setParameters(const Eigen::VectorXd& params) override;
+    virtual size_t nParameters() const override;
+
+    virtual void posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const override;
+    virtual void posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::VectorXd& var, const Eigen::MatrixXd& Xin) const override;
+
+    /**
+     * Compute the negative log marginal likelihood of the approximated model, including the trace term for Method::VFE.
+     *
+     * @param obsYnormalized The normalized targets that have been passed to #updateKernelPrecomputations.
+     * @return The negative log marginal likelihood.
+     */
+    virtual double computeNegativeLogMarginalLikelihood(const Eigen::Ref<const Eigen::MatrixXd>& obsYnormalized) override;
+
+    /**
+     * @return The approximation.
+     */
+    Method getMethod() const;
+
+    /**
+     * Set the inducing inputs, they are used from the next fit on.
+     *
+     * @param inducingInputs The inducing inputs, size [m, dimX].
+     */
+    void setInducingInputs(const Eigen::MatrixXd& inducingInputs);
+
+    /**
+     * @return The inducing inputs, size [m, dimX], empty before the first fit if they are drawn from the observations.
+     */
+    const Eigen::MatrixXd& getInducingInputs() const;
+
+private:
+    virtual void updateK(const std::shared_ptr<kernel::GPKernel>& kernel, const Eigen::Ref<const Eigen::MatrixXd>& obsX) override;
+    virtual void updateAD(const Eigen::Ref<const Eigen::MatrixXd>& obsYNormalized) override;
+    virtual void updateAlpha(const Eigen::Ref<const Eigen::MatrixXd>& obsYNormalized) override;
+
+    /**
+     * Compute L^-1 Km* for the inputs, with L the product of the Cholesky factors of Kmm and A.
+     * Lm^-1 Km* is returned in km, LA^-1 Lm^-1 Km* in ka.
+     */
+    void projectInputs(Eigen::MatrixXd& km, Eigen::MatrixXd& ka, const Eigen::MatrixXd& Xin) const;
+
+    Method method;
+    unsigned int nInducing;
+    unsigned int seed;
+
+    std::shared_ptr<kernel::CovarianceFunction> covfun;
+    Eigen::MatrixXd Z;          // [m x dimX], inducing inputs
+    Eigen::MatrixXd Lm;         // [m x m], Cholesky factor of Kmm in the lower triangle
+    Eigen::MatrixXd V;          // [m x nData], Lm^-1 Kmn
+    Eigen::VectorXd lambda;     // [nData], diagonal of Lambda
+    Eigen::MatrixXd LA;         // [m x m], Cholesky factor of A = I + V Lambda^-1 V^T in the lower triangle
+    Eigen::MatrixXd beta;       // [m x dimY], LA^-1 V Lambda^-1 y
+    Eigen::MatrixXd alpha;      // [m x dimY], Lm^-T LA^-T beta, the weights of the predicted mean
+    double traceResidual;       // tr(K - Q)
+    double noise;               // noise variance of Lambda
+};
+
+} // namespace gp
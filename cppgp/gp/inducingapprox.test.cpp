@@ -0,0 +1,139 @@
+#include <cppgp/gp/inducingapprox.hpp>
+#include <cppgp/gp/ftcapprox.hpp>
+#include <cppgp/kernels/covfun_rbf.hpp>
+#include <cppgp/gp/testdata.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+using namespace gp;
+using gp::test::get_smooth_data;
+
+namespace {
+    const std::vector<InducingPointApprox::Method> methods = {
+        InducingPointApprox::Method::DTC, InducingPointApprox::Method::FITC, InducingPointApprox::Method::VFE};
+}
+
+TEST(gp_inducingapprox, dense_reference){
+    auto gpdata = get_smooth_data(60);
+    auto covfun = std::make_shared<kernel::RBFCovFun>(3.0, 1.5);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(covfun, 0.05);
+    const Eigen::MatrixXd X = gpdata->getXView();
+    Eigen::MatrixXd Y;
+    gpdata->getYNormalized(Y);
+    const Eigen::MatrixXd Z = Eigen::MatrixXd::Random(8, 2);
+    const Eigen::MatrixXd Xin = Eigen::MatrixXd::Random(12, 2);
+
+    Eigen::MatrixXd Kmm, Kmn, Knn, Kms;
+    Eigen::VectorXd kss;
+    covfun->K(Kmm, Z);
+    covfun->K(Kmn, Z, X);
+    covfun->K(Knn, X);
+    covfun->K(Kms, Z, Xin);
+    covfun->diagK(kss, Xin);
+    const Eigen::MatrixXd Q = Kmn.transpose()*Kmm.llt().solve(Kmn);
+    const Eigen::VectorXd Qss = (Kms.array()*Kmm.llt().solve(Kms).array()).colwise().sum().transpose();
+
+    for(auto method : methods){
+        InducingPointApprox approx(Z, method);
+        approx.updateKernelPrecomputations(gpkernel, X, Y);
+
+        Eigen::VectorXd lambda = Eigen::VectorXd::Constant(60, 0.05);
+        if(method == InducingPointApprox::Method::FITC){
+            lambda += (Knn - Q).diagonal();
+        }
+        const Eigen::MatrixXd C = Q + Eigen::MatrixXd(lambda.asDiagonal());
+        double nlml = 0.5*(Y.transpose()*C.llt().solve(Y)).trace() + std::log(C.determinant()) + 60*std::log(2*M_PI);
+        if(method == InducingPointApprox::Method::VFE){
+            nlml += (Knn - Q).trace()/0.05;
+        }
+        EXPECT_NEAR(approx.computeNegativeLogMarginalLikelihood(Y), nlml, 1e-7*std::abs(nlml));
+        EXPECT_NEAR(approx.getLogDetK(), std::log(C.determinant()), 1e-8);
+
+        const Eigen::MatrixXd Sigma = (Kmm + Kmn*lambda.cwiseInverse().asDiagonal()*Kmn.transpose()).inverse();
+        const Eigen::MatrixXd muExpected = Kms.transpose()*Sigma*Kmn*lambda.cwiseInverse().asDiagonal()*Y;
+        const Eigen::VectorXd varExpected = kss - Qss + (Kms.array()*(Sigma*Kms).array()).colwise().sum().transpose().matrix();
+        Eigen::MatrixXd mu, muOnly;
+        Eigen::VectorXd var;
+        approx.posteriorMeanVar(mu, var, Xin);
+        approx.posteriorMean(muOnly, Xin);
+        EXPECT_TRUE(mu.isApprox(muExpected, 1e-7));
+        EXPECT_TRUE(muOnly.isApprox(mu, 1e-12));
+        EXPECT_TRUE(var.isApprox(varExpected, 1e-7));
+    }
+}
+
+TEST(gp_inducingapprox, exact_with_all_inputs){
+    // with the observations as inducing inputs, Q = K and all approximations are exact
+    auto gpdata = get_smooth_data(20);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(4.0, 1.5), 0.1);
+    const Eigen::MatrixXd X = gpdata->getXView();
+    Eigen::MatrixXd Y;
+    gpdata->getYNormalized(Y);
+    FTC ftc;
+    ftc.updateKernelPrecomputations(gpkernel, X, Y);
+    const Eigen::MatrixXd Xin = Eigen::MatrixXd::Random(10, 2);
+    Eigen::MatrixXd muFTC;
+    Eigen::VectorXd varFTC;
+    ftc.posteriorMeanVar(muFTC, varFTC, Xin);
+
+    for(auto method : methods){
+        InducingPointApprox approx(X, method);
+        approx.updateKernelPrecomputations(gpkernel, X, Y);
+        EXPECT_NEAR(approx.computeNegativeLogMarginalLikelihood(Y), ftc.computeNegativeLogMarginalLikelihood(Y), 1e-5);
+        Eigen::MatrixXd mu;
+        Eigen::VectorXd var;
+        approx.posteriorMeanVar(mu, var, Xin);
+        EXPECT_TRUE(mu.isApprox(muFTC, 1e-5));
+        EXPECT_LT((var - varFTC).cwiseAbs().maxCoeff(), 1e-6);
+    }
+}
+
+TEST(gp_inducingapprox, drawn_inducing_inputs){
+    auto gpdata = get_smooth_data(40);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(4.0, 1.5), 0.1);
+    const Eigen::MatrixXd X = gpdata->getXView();
+    Eigen::MatrixXd Y;
+    gpdata->getYNormalized(Y);
+
+    // with less observations than inducing inputs, all observations are used until enough data is available
+    InducingPointApprox approx(25);
+    approx.updateKernelPrecomputations(gpkernel, X.topRows(10), Y.topRows(10));
+    EXPECT_EQ(approx.getInducingInputs().rows(), 10);
+    approx.updateKernelPrecomputations(gpkernel, X.topRows(20), Y.topRows(20));
+    EXPECT_EQ(approx.getInducingInputs().rows(), 20);
+    approx.updateKernelPrecomputations(gpkernel, X, Y);
+    EXPECT_EQ(approx.getInducingInputs().rows(), 25);
+
+    // afterwards the inducing inputs are kept
+    const Eigen::MatrixXd Z = approx.getInducingInputs();
+    approx.updateKernelPrecomputations(gpkernel, X.topRows(30), Y.topRows(30));
+    EXPECT_EQ(approx.getInducingInputs(), Z);
+}
+
+TEST(gp_inducingapprox, variational_bound){
+    // the drawn inducing inputs are nested for a fixed seed, so the VFE bound tightens with m
+    auto gpdata = get_smooth_data(400);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(4.0, 1.0), 0.01);
+    const Eigen::MatrixXd X = gpdata->getXView();
+    Eigen::MatrixXd Y;
+    gpdata->getYNormalized(Y);
+    FTC ftc;
+    ftc.updateKernelPrecomputations(gpkernel, X, Y);
+    const double nlml = ftc.computeNegativeLogMarginalLikelihood(Y);
+
+    double previous = std::numeric_limits<double>::infinity();
+    for(unsigned int m : {5, 10, 20, 40, 80}){
+        InducingPointApprox approx(m, InducingPointApprox::Method::VFE, 7);
+        EXPECT_EQ(approx.getInducingInputs().rows(), 0);
+        approx.updateKernelPrecomputations(gpkernel, X, Y);
+        ASSERT_EQ(approx.getInducingInputs().rows(), m);
+        const double bound = approx.computeNegativeLogMarginalLikelihood(Y);
+        EXPECT_GE(bound, nlml - 1e-6);
+        EXPECT_LE(bound, previous + 1e-6);
+        previous = bound;
+    }
+    EXPECT_NEAR(previous, nlml, 0.01*std::abs(nlml));
+}
@@ -0,0 +1,71 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <cppgp/gp/inputindex.hpp>
+
+#include <functional>
+
+gp::InputIndex::InputIndex(const std::shared_ptr<GPData>& gpdata, const unsigned int leafSize) :
+    data(gpdata), tree(gpdata->getXView(), leafSize)
+{
+    this->data->subscribe(this, std::bind(&gp::InputIndex::changedData_trigger, this));
+}
+
+gp::InputIndex::~InputIndex()
+{
+    this->data->unsubscribe(this);
+}
+
+void gp::InputIndex::radiusSearch(std::vector<Eigen::Index>& indices, std::vector<double>& distances,
+                                  const Eigen::Ref<const Eigen::VectorXd>& x, const double radius) const
+{
+    this->tree.radiusSearch(indices, distances, x, radius);
+}
+
+void gp::InputIndex::knnSearch(std::vector<Eigen::Index>& indices, std::vector<double>& distances,
+                               const Eigen::Ref<const Eigen::VectorXd>& x, const unsigned int k) const
+{
+    this->tree.knnSearch(indices, distances, x, k);
+}
+
+std::shared_ptr<gp::GPData> gp::InputIndex::getData() const
+{
+    return this->data;
+}
+
+const math::KDTree& gp::InputIndex::getTree() const
+{
+    return this->tree;
+}
+
+void gp::InputIndex::changedData_trigger()
+{
+    const GPData::Change& change = this->data->getLastChange();
+    if(change.type == GPData::Change::Type::APPEND){
+        this->tree.insert(this->data->getXView().middleRows(change.index, change.count));
+    }
+    else {
+        this->tree.remove(change.index, change.count);
+    }
+}
@@ -0,0 +1,99 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Eigen>
+
+#include <cppgp/gp/gpdata.hpp>
+#include <cppgp/math/kdtree.hpp>
+#include <cppgp/util/observer.hpp>
+
+namespace gp {
+
+/**
+ * Spatial index of the inputs of a GPData object for radius and k-nearest-neighbor queries, see math::KDTree.
+ *
+ * The index subscribes to the data and follows its changes: appended data points are inserted into the tree,
+ * the oldest data points that are dropped in window mode are removed in O(1), other removals rebuild the tree.
+ * The indices returned by the queries are the indices of the data points in the GPData object.
+ */
+class InputIndex : public util::IObserver {
+public:
+    /**
+     * Build the index of the given data.
+     *
+     * @param gpdata The data, it must not be nullptr.
+     * @param leafSize The maximum number of data points of a leaf of the tree.
+     */
+    InputIndex(const std::shared_ptr<GPData>& gpdata, const unsigned int leafSize=32);
+
+    InputIndex(const InputIndex&) = delete;
+    InputIndex& operator=(const InputIndex&) = delete;
+
+    ~InputIndex();
+
+    /**
+     * Find all data points whose inputs are closer than the radius to the query point, in no particular order.
+     *
+     * @param indices Returns the indices of the data points.
+     * @param distances Returns the Euclidean distances of the inputs to x.
+     * @param x The query point, size [dimX].
+     * @param radius The radius.
+     */
+    void radiusSearch(std::vector<Eigen::Index>& indices, std::vector<double>& distances,
+                      const Eigen::Ref<const Eigen::VectorXd>& x, const double radius) const;
+
+    /**
+     * Find the k data points whose inputs are closest to the query point, sorted by their distance.
+     *
+     * @param indices Returns the indices of the data points.
+     * @param distances Returns the Euclidean distances of the inputs to x.
+     * @param x The query point, size [dimX].
+     * @param k The number of data points.
+     */
+    void knnSearch(std::vector<Eigen::Index>& indices, std::vector<double>& distances,
+                   const Eigen::Ref<const Eigen::VectorXd>& x, const unsigned int k) const;
+
+    /**
+     * @return The indexed data.
+     */
+    std::shared_ptr<GPData> getData() const;
+
+    /**
+     * @return The tree of the inputs.
+     */
+    const math::KDTree& getTree() const;
+
+private:
+    void changedData_trigger();
+
+    std::shared_ptr<GPData> data;
+    math::KDTree tree;
+};
+
+} // namespace gp
@@ -0,0 +1,297 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <cppgp/gp/randomfeaturegp.hpp>
+#include <cppgp/kernels/covfun_ardrbf.hpp>
+#include <cppgp/kernels/covfun_rbf.hpp>
+#include <cppgp/math/cholesky.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <cmath>
+#include <random>
+
+gp::RandomFeatureGP::RandomFeatureGP(const std::shared_ptr<GPData>& data, const std::shared_ptr<kernel::GPKernel>& kernel, const unsigned int nFeatures, const unsigned int seed) :
+    obsData(data),
+    kernel(kernel),
+    nFeatures(0),
+    seed(seed),
+    batchSize(1024),
+    amplitude(0.0),
+    isFitted(false),
+    dataVersion(0),
+    parameterVersion(0)
+{
+    if(data == nullptr || kernel == nullptr){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The data and the kernel must not be nullptr.");
+    }
+    this->setNumFeatures(nFeatures);
+}
+
+gp::RandomFeatureGP::RandomFeatureGP(const RandomFeatureGP& m) :
+    obsData(m.obsData),
+    kernel(std::dynamic_pointer_cast<kernel::GPKernel>(m.kernel->copy())),
+    nFeatures(m.nFeatures),
+    seed(m.seed),
+    batchSize(m.batchSize),
+    E(m.E),
+    Omega(m.Omega),
+    amplitude(m.amplitude),
+    L(m.L),
+    weights(m.weights),
+    innerProducts(m.innerProducts),
+    isFitted(false),
+    dataVersion(0),
+    parameterVersion(0)
+{}
+
+gp::RandomFeatureGP::~RandomFeatureGP()
+{}
+
+std::shared_ptr<util::Prototype> gp::RandomFeatureGP::copy() const
+{
+    return std::make_shared<RandomFeatureGP>(*this);
+}
+
+void gp::RandomFeatureGP::setObservation(const std::shared_ptr<GPData>& obsData)
+{
+    if(obsData == nullptr){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The data must not be nullptr.");
+    }
+    this->obsData = obsData;
+    this->isFitted = false;
+}
+
+std::shared_ptr<gp::GPData> gp::RandomFeatureGP::getObservation() const
+{
+    return this->obsData;
+}
+
+void gp::RandomFeatureGP::setKernel(const std::shared_ptr<kernel::GPKernel>& kernel)
+{
+    if(kernel == nullptr){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The kernel must not be nullptr.");
+    }
+    this->kernel = kernel;
+    this->isFitted = false;
+}
+
+std::shared_ptr<const gp::kernel::GPKernel> gp::RandomFeatureGP::getKernel() const
+{
+    return this->kernel;
+}
+
+void gp::RandomFeatureGP::setNumFeatures(const unsigned int nFeatures)
+{
+    if(nFeatures == 0 || nFeatures % 2 != 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The number of features must be even and positive.");
+    }
+    this->nFeatures = nFeatures;
+    this->E.resize(0, 0);
+    this->isFitted = false;
+}
+
+unsigned int gp::RandomFeatureGP::getNumFeatures() const
+{
+    return this->nFeatures;
+}
+
+void gp::RandomFeatureGP::setBatchSize(const Eigen::Index batchSize)
+{
+    if(batchSize <= 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The batch size must be positive.");
+    }
+    this->batchSize = batchSize;
+}
+
+Eigen::Index gp::RandomFeatureGP::getBatchSize() const
+{
+    return this->batchSize;
+}
+
+void gp::RandomFeatureGP::setParameters(const Eigen::VectorXd& params)
+{
+    this->kernel->setParameters(params, 0);
+}
+
+void gp::RandomFeatureGP::getParameters(Eigen::VectorXd& params) const
+{
+    params.resize(this->kernel->nParameters());
+    this->kernel->getParameters(params, 0);
+}
+
+size_t gp::RandomFeatureGP::nParameters() const
+{
+    return this->kernel->nParameters();
+}
+
+void gp::RandomFeatureGP::posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::MatrixXd& varSigma, const Eigen::MatrixXd& Xin) const
+{
+    this->update();
+    const double noise = this->kernel->getNoise();
+    mu.resize(Xin.rows(), this->weights.cols());
+    Eigen::VectorXd var(Xin.rows());
+    Eigen::MatrixXd Phi;
+    for(Eigen::Index i = 0; i < Xin.rows(); i += this->batchSize){
+        const Eigen::Index bi = std::min(this->batchSize, Xin.rows() - i);
+        Phi.resize(bi, this->nFeatures);
+        this->featureBatch(Phi, Xin.middleRows(i, bi));
+        mu.middleRows(i, bi).noalias() = Phi*this->weights;
+
+        // Var[phi^T w] = noise * phi^T A^-1 phi
+        Eigen::MatrixXd V = Phi.transpose();
+        this->L.triangularView<Eigen::Lower>().solveInPlace(V);
+        var.segment(i, bi) = noise*V.colwise().squaredNorm().transpose();
+    }
+
+    Eigen::RowVectorXd scale, bias;
+    this->obsData->getScale(scale);
+    this->obsData->getBias(bias);
+    mu = (mu.array().rowwise()*scale.array()).rowwise() + bias.array();
+    varSigma = var.replicate(1, mu.cols()).array().rowwise()*(scale.array()*scale.array());
+}
+
+void gp::RandomFeatureGP::posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const
+{
+    this->update();
+    mu.resize(Xin.rows(), this->weights.cols());
+    Eigen::MatrixXd Phi;
+    for(Eigen::Index i = 0; i < Xin.rows(); i += this->batchSize){
+        const Eigen::Index bi = std::min(this->batchSize, Xin.rows() - i);
+        Phi.resize(bi, this->nFeatures);
+        this->featureBatch(Phi, Xin.middleRows(i, bi));
+        mu.middleRows(i, bi).noalias() = Phi*this->weights;
+    }
+
+    Eigen::RowVectorXd scale, bias;
+    this->obsData->getScale(scale);
+    this->obsData->getBias(bias);
+    mu = (mu.array().rowwise()*scale.array()).rowwise() + bias.array();
+}
+
+double gp::RandomFeatureGP::computeNegativeLogMarginalLikelihood() const
+{
+    this->update();
+    const double noise = this->kernel->getNoise();
+    const double n = this->obsData->getN();
+    const double dimY = this->weights.cols();
+    double nlml = 0.5*this->innerProducts.sum()/noise;
+    nlml += 0.5*dimY*((n - this->nFeatures)*std::log(noise) + math::cholLogDet(this->L));
+    nlml += 0.5*dimY*n*std::log(2*M_PI);
+    return nlml;
+}
+
+void gp::RandomFeatureGP::features(Eigen::MatrixXd& Phi, const Eigen::Ref<const Eigen::MatrixXd>& Xin) const
+{
+    this->updateFrequencies(Xin.cols());
+    Phi.resize(Xin.rows(), this->nFeatures);
+    for(Eigen::Index i = 0; i < Xin.rows(); i += this->batchSize){
+        const Eigen::Index bi = std::min(this->batchSize, Xin.rows() - i);
+        this->featureBatch(Phi.middleRows(i, bi), Xin.middleRows(i, bi));
+    }
+}
+
+void gp::RandomFeatureGP::updateFrequencies(const unsigned int dimX) const
+{
+    const Eigen::Index nFrequencies = this->nFeatures/2;
+    if(this->E.rows() != dimX || this->E.cols() != nFrequencies){
+        std::mt19937 rng(this->seed);
+        std::normal_distribution<double> normal;
+        this->E.resize(dimX, nFrequencies);
+        for(Eigen::Index j = 0; j < nFrequencies; ++j){
+            for(unsigned int k = 0; k < dimX; ++k){
+                this->E(k, j) = normal(rng);
+            }
+        }
+    }
+
+    // the spectral density of the RBF covariance functions is N(0, diag(w))
+    const std::shared_ptr<kernel::CovarianceFunction> covfun = this->kernel->getCovarianceFunction();
+    const Eigen::VectorXd params = covfun->getParameters();
+    if(std::dynamic_pointer_cast<kernel::RBFCovFun>(covfun) != nullptr){
+        this->Omega = std::sqrt(params(0))*this->E;
+        this->amplitude = std::sqrt(params(1)/nFrequencies);
+    }
+    else if(std::dynamic_pointer_cast<kernel::ARDRBFCovFun>(covfun) != nullptr){
+        if(params.size() != dimX + 1){
+            util::exceptions::throwException<util::exceptions::InconsistentInputError>("The dimension of the covariance function does not match the inputs.");
+        }
+        this->Omega = params.head(dimX).cwiseSqrt().asDiagonal()*this->E;
+        this->amplitude = std::sqrt(params(dimX)/nFrequencies);
+    }
+    else {
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Random features are only available for RBFCovFun and ARDRBFCovFun.");
+    }
+}
+
+void gp::RandomFeatureGP::update() const
+{
+    if(this->isFitted && this->dataVersion == this->obsData->getVersion() && this->parameterVersion == this->kernel->getParameterVersion()){
+        return;
+    }
+    const auto [X, Y] = this->obsData->getNormalizedData();
+    if(X.rows() == 0){
+        util::exceptions::throwException<util::exceptions::Error>("No observations are available.");
+    }
+    this->updateFrequencies(X.cols());
+
+    // accumulate A = Phi^T Phi + noise I and Phi^T y batch by batch, only the lower triangle of A is referenced
+    const double noise = this->kernel->getNoise();
+    this->L = Eigen::MatrixXd::Zero(this->nFeatures, this->nFeatures);
+    this->L.diagonal().setConstant(noise);
+    this->weights = Eigen::MatrixXd::Zero(this->nFeatures, Y.cols());
+    this->innerProducts = Y.colwise().squaredNorm().transpose();
+    Eigen::MatrixXd Phi;
+    for(Eigen::Index i = 0; i < X.rows(); i += this->batchSize){
+        const Eigen::Index bi = std::min(this->batchSize, X.rows() - i);
+        Phi.resize(bi, this->nFeatures);
+        this->featureBatch(Phi, X.middleRows(i, bi));
+        this->L.selfadjointView<Eigen::Lower>().rankUpdate(Phi.transpose());
+        this->weights.noalias() += Phi.transpose()*Y.middleRows(i, bi);
+    }
+
+    Eigen::VectorXd diag;
+    double jitter;
+    if(!math::cholJitter(this->L, diag, jitter, 1e-10*this->L.diagonal().mean(), 20)){
+        util::exceptions::throwException<util::exceptions::Error>("Failed to decompose the feature matrix.");
+    }
+
+    // y^T Phi A^-1 Phi^T y = ||L^-1 Phi^T y||^2
+    this->L.triangularView<Eigen::Lower>().solveInPlace(this->weights);
+    this->innerProducts -= this->weights.colwise().squaredNorm().transpose();
+    this->L.triangularView<Eigen::Lower>().transpose().solveInPlace(this->weights);
+
+    this->isFitted = true;
+    this->dataVersion = this->obsData->getVersion();
+    this->parameterVersion = this->kernel->getParameterVersion();
+}
+
+void gp::RandomFeatureGP::featureBatch(Eigen::Ref<Eigen::MatrixXd> Phi, const Eigen::Ref<const Eigen::MatrixXd>& Xin) const
+{
+    const Eigen::Index nFrequencies = this->nFeatures/2;
+    auto cosPart = Phi.leftCols(nFrequencies);
+    auto sinPart = Phi.rightCols(nFrequencies);
+    cosPart.noalias() = Xin*this->Omega;
+    sinPart = this->amplitude*cosPart.array().sin();
+    cosPart = this->amplitude*cosPart.array().cos();
+}
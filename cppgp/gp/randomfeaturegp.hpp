@@ -0,0 +1,159 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+
+#include <Eigen/Eigen>
+
+#include <cppgp/gp/gpdata.hpp>
+#include <cppgp/kernels/gpkernel.hpp>
+#include <cppgp/util/prototype.hpp>
+
+namespace gp {
+
+/**
+ * Gaussian process regression with random Fourier features (Rahimi and Recht, 2007).
+ *
+ * A stationary covariance function is the Fourier transform of its spectral density p(omega), so it is approximated
+ * by the inner products of the D-dimensional feature map
+ * \f[
+ * \phi(x) = \sqrt{\frac{2\sigma_f}{D}} \left[\cos(\Omega^T x), \sin(\Omega^T x)\right]
+ * \f]
+ * with D/2 frequencies \f$ \omega_j \sim p(\omega) \f$ in the columns of \f$ \Omega \f$. The model is the Bayesian linear
+ * regression \f$ y = \phi(x)^T w + \epsilon \f$ with \f$ w \sim N(0, I) \f$ and the noise variance of the kernel,
+ * which is fitted with the D x D matrix \f$ A = \Phi^T \Phi + \sigma I \f$ in O(n D^2) time and O(D^2) memory.
+ * A predicted mean costs O(D d), a predicted variance O(D^2), independent of the number of observations.
+ *
+ * Supported covariance functions are RBFCovFun and ARDRBFCovFun, whose spectral densities are Gaussian.
+ * The frequencies are drawn once for the seed and scaled by the current inverse widths, so the features change
+ * smoothly with the parameters. The features are generated in batches of rows with matrix products and vectorized
+ * trigonometric functions, the observations are accumulated into A batch by batch.
+ * The model is fitted lazily whenever the observations or the parameters have changed.
+ */
+class RandomFeatureGP : public util::Prototype {
+public:
+    /**
+     * @param data The observations.
+     * @param kernel The kernel, it provides the covariance function and the noise variance.
+     * @param nFeatures The number of features D, must be even.
+     * @param seed The seed of the frequencies.
+     */
+    RandomFeatureGP(const std::shared_ptr<GPData>& data, const std::shared_ptr<kernel::GPKernel>& kernel, const unsigned int nFeatures, const unsigned int seed=0);
+
+    /**
+     * Copy constructor, the kernel is copied and the observations are shared.
+     */
+    RandomFeatureGP(const RandomFeatureGP& m);
+
+    virtual ~RandomFeatureGP();
+
+    virtual std::shared_ptr<util::Prototype> copy() const override;
+
+    // Getter/Setter
+    void setObservation(const std::shared_ptr<GPData>& obsData);
+    std::shared_ptr<GPData> getObservation() const;
+
+    void setKernel(const std::shared_ptr<kernel::GPKernel>& kernel);
+    std::shared_ptr<const kernel::GPKernel> getKernel() const;
+
+    /**
+     * \brief Set the number of features D, the frequencies are drawn anew.
+     * \param nFeatures The number of features, must be even.
+     */
+    void setNumFeatures(const unsigned int nFeatures);
+    unsigned int getNumFeatures() const;
+
+    /**
+     * \brief Set the number of rows whose features are generated at once, see #features.
+     * \param batchSize The number of rows, default 1024.
+     */
+    void setBatchSize(const Eigen::Index batchSize);
+    Eigen::Index getBatchSize() const;
+
+    /**
+     * The parameters are the parameters of the kernel.
+     */
+    void setParameters(const Eigen::VectorXd& params);
+    void getParameters(Eigen::VectorXd& params) const;
+    size_t nParameters() const;
+
+    // evaluate
+    void posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::MatrixXd& varSigma, const Eigen::MatrixXd& Xin) const;
+    void posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const;
+
+    /**
+     * Compute the negative log marginal likelihood of the normalized observations under the feature model
+     * \f[
+     * \frac{1}{2\sigma} \sum_{c} (\bar{y}_c^T \bar{y}_c - \bar{y}_c^T \Phi A^{-1} \Phi^T \bar{y}_c)
+     * + \frac{d_y}{2} \left((n - D)\log\sigma + \log\det(A)\right) + \frac{n d_y}{2}\log(2\pi).
+     * \f]
+     *
+     * @return The negative log marginal likelihood.
+     */
+    double computeNegativeLogMarginalLikelihood() const;
+
+    /**
+     * Evaluate the feature map, \f$ \Phi \Phi^T \f$ approximates the covariance matrix of the inputs.
+     *
+     * @param Phi Returns the features, size [nIn, D].
+     * @param Xin The inputs, size [nIn, dimX].
+     */
+    void features(Eigen::MatrixXd& Phi, const Eigen::Ref<const Eigen::MatrixXd>& Xin) const;
+
+private:
+    /**
+     * Draw the standard normal frequencies if required and scale them by the parameters of the covariance function.
+     */
+    void updateFrequencies(const unsigned int dimX) const;
+
+    /**
+     * Fit the weights if the observations or the parameters have changed.
+     */
+    void update() const;
+
+    /**
+     * Compute the features of a batch of inputs with the current frequencies.
+     */
+    void featureBatch(Eigen::Ref<Eigen::MatrixXd> Phi, const Eigen::Ref<const Eigen::MatrixXd>& Xin) const;
+
+    std::shared_ptr<GPData> obsData;
+    std::shared_ptr<kernel::GPKernel> kernel;
+    unsigned int nFeatures;
+    unsigned int seed;
+    Eigen::Index batchSize;
+
+    mutable Eigen::MatrixXd E;              // [dimX x D/2], standard normal samples
+    mutable Eigen::MatrixXd Omega;          // [dimX x D/2], frequencies
+    mutable double amplitude;               // sqrt(2 sigma_f/D)
+    mutable Eigen::MatrixXd L;              // [D x D], Cholesky factor of A in the lower triangle
+    mutable Eigen::MatrixXd weights;        // [D x dimY], posterior mean of the weights
+    mutable Eigen::VectorXd innerProducts;  // [dimY], y_c^T y_c - y_c^T Phi A^-1 Phi^T y_c
+    mutable bool isFitted;
+    mutable unsigned long dataVersion;
+    mutable unsigned long parameterVersion;
+};
+
+} // namespace gp
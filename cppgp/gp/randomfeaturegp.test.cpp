@@ -0,0 +1,100 @@
+#include <cppgp/gp/randomfeaturegp.hpp>
+#include <cppgp/gp/gaussianprocess.hpp>
+#include <cppgp/kernels/covfun_ardrbf.hpp>
+#include <cppgp/kernels/covfun_matern.hpp>
+#include <cppgp/kernels/covfun_rbf.hpp>
+#include <cppgp/util/exceptions.hpp>
+#include <cppgp/gp/testdata.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace gp;
+using gp::test::get_smooth_data;
+
+TEST(gp_randomfeaturegp, kernel_approximation){
+    auto gpdata = get_smooth_data(10);
+    const Eigen::MatrixXd X = Eigen::MatrixXd::Random(30, 2);
+    Eigen::VectorXd widths(2);
+    widths << 0.5, 4.0;
+    const std::vector<std::shared_ptr<kernel::CovarianceFunction>> covfuns = {
+        std::make_shared<kernel::RBFCovFun>(2.0, 1.5), std::make_shared<kernel::ARDRBFCovFun>(widths, 0.7)};
+
+    for(const auto& covfun : covfuns){
+        RandomFeatureGP rff(gpdata, std::make_shared<kernel::GPKernel>(covfun, 0.1), 40000, 3);
+        Eigen::MatrixXd Phi, PhiBatched, K;
+        rff.features(Phi, X);
+        ASSERT_EQ(Phi.rows(), 30);
+        ASSERT_EQ(Phi.cols(), 40000);
+        covfun->K(K, X);
+        EXPECT_LT((Phi*Phi.transpose() - K).cwiseAbs().maxCoeff(), 0.05);
+
+        rff.setBatchSize(7);
+        rff.features(PhiBatched, X);
+        EXPECT_TRUE(PhiBatched.isApprox(Phi, 1e-14));
+    }
+
+    RandomFeatureGP matern(gpdata, std::make_shared<kernel::GPKernel>(std::make_shared<kernel::Matern32CovFun>(1.0, 1.0), 0.1), 100);
+    Eigen::MatrixXd Phi;
+    EXPECT_THROW(matern.features(Phi, X), util::exceptions::InconsistentInputError);
+    EXPECT_THROW(matern.setNumFeatures(101), util::exceptions::InconsistentInputError);
+}
+
+TEST(gp_randomfeaturegp, dense_reference){
+    auto gpdata = get_smooth_data(40);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(3.0, 1.5), 0.05);
+    RandomFeatureGP rff(gpdata, gpkernel, 50, 1);
+    rff.setBatchSize(16);
+    const Eigen::MatrixXd Xin = Eigen::MatrixXd::Random(12, 2);
+
+    for(int round = 0; round < 2; ++round){
+        // the model is refitted when the parameters change
+        Eigen::MatrixXd Phi, PhiIn, Y;
+        rff.features(Phi, gpdata->getXView());
+        rff.features(PhiIn, Xin);
+        gpdata->getYNormalized(Y);
+        Eigen::RowVectorXd bias;
+        gpdata->getBias(bias);
+        const double noise = gpkernel->getNoise();
+        const Eigen::MatrixXd C = Phi*Phi.transpose() + noise*Eigen::MatrixXd::Identity(40, 40);
+        const double nlml = 0.5*(Y.transpose()*C.llt().solve(Y)).trace() + std::log(C.determinant()) + 40*std::log(2*M_PI);
+        EXPECT_NEAR(rff.computeNegativeLogMarginalLikelihood(), nlml, 1e-8*std::abs(nlml));
+
+        Eigen::MatrixXd muExpected = PhiIn*Phi.transpose()*C.llt().solve(Y);
+        muExpected.rowwise() += bias;
+        const Eigen::MatrixXd Kss = PhiIn*PhiIn.transpose() - PhiIn*Phi.transpose()*C.llt().solve(Phi*PhiIn.transpose());
+        Eigen::MatrixXd mu, varSigma, muOnly;
+        rff.posteriorMeanVar(mu, varSigma, Xin);
+        rff.posteriorMean(muOnly, Xin);
+        EXPECT_TRUE(mu.isApprox(muExpected, 1e-8));
+        EXPECT_TRUE(muOnly.isApprox(mu, 1e-12));
+        EXPECT_TRUE(varSigma.col(0).isApprox(Kss.diagonal(), 1e-6));
+        EXPECT_TRUE(varSigma.col(1).isApprox(Kss.diagonal(), 1e-6));
+
+        Eigen::VectorXd params;
+        rff.getParameters(params);
+        params(1) = 1.5;
+        rff.setParameters(params);
+    }
+}
+
+TEST(gp_randomfeaturegp, exact_limit){
+    auto gpdata = get_smooth_data(100);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(1.0, 1.0), 0.01);
+    RandomFeatureGP rff(gpdata, gpkernel, 1000, 2);
+    GaussianProcess gaussianprocess(gpdata, gpkernel);
+    const Eigen::MatrixXd Xin = 0.9*Eigen::MatrixXd::Random(50, 2);
+
+    Eigen::MatrixXd mu, varSigma, muExact, varExact;
+    rff.posteriorMeanVar(mu, varSigma, Xin);
+    gaussianprocess.posteriorMeanVar(muExact, varExact, Xin);
+    EXPECT_LT((mu - muExact).cwiseAbs().mean(), 0.01);
+    EXPECT_LT((varSigma - varExact).cwiseAbs().maxCoeff(), 0.01);
+
+    // copies are fitted independently of the original
+    auto rffCopy = std::dynamic_pointer_cast<RandomFeatureGP>(rff.copy());
+    Eigen::MatrixXd muCopy;
+    rffCopy->posteriorMean(muCopy, Xin);
+    EXPECT_TRUE(muCopy.isApprox(mu, 1e-10));
+}
@@ -0,0 +1,393 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <cppgp/gp/svgp.hpp>
+#include <cppgp/math/cholesky.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <cmath>
+#include <random>
+
+gp::SVGP::SVGP(const std::shared_ptr<kernel::GPKernel>& kernel, const Eigen::MatrixXd& inducingInputs) :
+    kernel(kernel),
+    nInducing(inducingInputs.rows()),
+    seed(0),
+    nData(0),
+    Z(inducingInputs),
+    logDetK(0.0),
+    logDetS(0.0)
+{
+    if(kernel == nullptr){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The kernel must not be nullptr.");
+    }
+    if(inducingInputs.rows() == 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("At least one inducing input is required.");
+    }
+}
+
+gp::SVGP::SVGP(const std::shared_ptr<kernel::GPKernel>& kernel, const unsigned int nInducing, const unsigned int seed) :
+    kernel(kernel),
+    nInducing(nInducing),
+    seed(seed),
+    nData(0),
+    logDetK(0.0),
+    logDetS(0.0)
+{
+    if(kernel == nullptr){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The kernel must not be nullptr.");
+    }
+    if(nInducing == 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("At least one inducing input is required.");
+    }
+}
+
+gp::SVGP::SVGP(const SVGP& svgp) :
+    kernel(std::dynamic_pointer_cast<kernel::GPKernel>(svgp.kernel->copy())),
+    nInducing(svgp.nInducing),
+    seed(svgp.seed),
+    nData(svgp.nData),
+    bias(svgp.bias),
+    Z(svgp.Z),
+    Lk(svgp.Lk),
+    Kinv(svgp.Kinv),
+    logDetK(svgp.logDetK),
+    Lambda(svgp.Lambda),
+    theta(svgp.theta),
+    S(svgp.S),
+    mu(svgp.mu),
+    logDetS(svgp.logDetS),
+    alpha(svgp.alpha),
+    B(svgp.B)
+{}
+
+gp::SVGP::~SVGP()
+{}
+
+std::shared_ptr<util::Prototype> gp::SVGP::copy() const
+{
+    return std::make_shared<SVGP>(*this);
+}
+
+std::vector<double> gp::SVGP::train(DataSource& source, const SVGPOptions& options)
+{
+    if(options.batchSize <= 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The batch size must be positive.");
+    }
+    if(this->nData == 0){
+        this->initialize(source, options.batchSize);
+    }
+
+    optim::Adam adam(options.adam);
+    std::vector<double> elbo;
+    Eigen::MatrixXd Xb, Yb, Kmb;
+    Eigen::VectorXd gData, gKL, params;
+    for(unsigned int epoch = 0; epoch < options.nEpochs; ++epoch){
+        source.rewind();
+        double sum = 0.0;
+        unsigned int nBatches = 0;
+        Eigen::Index k;
+        while((k = source.nextBatch(Xb, Yb, options.batchSize)) > 0){
+            Yb.rowwise() -= this->bias;
+            const double c = static_cast<double>(this->nData)/k;
+
+            this->updateCov();
+            this->kernel->getCovarianceFunction()->K(Kmb, this->Z, Xb);
+            this->naturalStep(Kmb, Yb, c, options.naturalStepSize);
+            this->updateVariational();
+
+            if(options.optimizeParameters){
+                sum += this->dataTerm(Xb, Kmb, Yb, c, &gData) - this->klDivergence(&gKL);
+
+                // Adam ascends the lower bound in the log-parameters
+                this->getParameters(params);
+                Eigen::VectorXd logParams = params.array().log();
+                adam.step(logParams, -((gData - gKL).array()*params.array()).matrix());
+                this->kernel->setParameters(logParams.array().exp().matrix());
+            }
+            else {
+                sum += this->dataTerm(Xb, Kmb, Yb, c, nullptr) - this->klDivergence(nullptr);
+            }
+            ++nBatches;
+        }
+        elbo.push_back(nBatches > 0 ? sum/nBatches : 0.0);
+    }
+
+    this->updateCov();
+    this->updateVariational();
+    return elbo;
+}
+
+double gp::SVGP::computeELBO(DataSource& source, const Eigen::Index batchSize)
+{
+    Eigen::VectorXd gradient;
+    return this->computeELBO(source, gradient, batchSize);
+}
+
+double gp::SVGP::computeELBO(DataSource& source, Eigen::VectorXd& gradient, const Eigen::Index batchSize)
+{
+    if(batchSize <= 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The batch size must be positive.");
+    }
+    if(this->nData == 0){
+        this->initialize(source, batchSize);
+    }
+    this->updateCov();
+    this->updateVariational();
+
+    double elbo = -this->klDivergence(&gradient);
+    gradient = -gradient;
+
+    source.rewind();
+    Eigen::MatrixXd Xb, Yb, Kmb;
+    Eigen::VectorXd gData;
+    while(source.nextBatch(Xb, Yb, batchSize) > 0){
+        Yb.rowwise() -= this->bias;
+        this->kernel->getCovarianceFunction()->K(Kmb, this->Z, Xb);
+        elbo += this->dataTerm(Xb, Kmb, Yb, 1.0, &gData);
+        gradient += gData;
+    }
+    return elbo;
+}
+
+void gp::SVGP::posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::MatrixXd& varSigma, const Eigen::MatrixXd& Xin) const
+{
+    if(this->nData == 0){
+        util::exceptions::throwException<util::exceptions::Error>("The model has not been trained.");
+    }
+    const std::shared_ptr<kernel::CovarianceFunction> covfun = this->kernel->getCovarianceFunction();
+    Eigen::MatrixXd Kms;
+    covfun->K(Kms, this->Z, Xin);
+    Eigen::VectorXd var;
+    covfun->diagK(var, Xin);
+    var -= (Kms.array()*(this->B*Kms).array()).colwise().sum().transpose().matrix();
+
+    mu.noalias() = Kms.transpose()*this->alpha;
+    mu.rowwise() += this->bias;
+    varSigma = var.cwiseMax(0.0).replicate(1, this->alpha.cols());
+}
+
+void gp::SVGP::posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const
+{
+    if(this->nData == 0){
+        util::exceptions::throwException<util::exceptions::Error>("The model has not been trained.");
+    }
+    Eigen::MatrixXd Kms;
+    this->kernel->getCovarianceFunction()->K(Kms, this->Z, Xin);
+    mu.noalias() = Kms.transpose()*this->alpha;
+    mu.rowwise() += this->bias;
+}
+
+void gp::SVGP::setParameters(const Eigen::VectorXd& params)
+{
+    this->kernel->setParameters(params, 0);
+    if(this->nData > 0){
+        this->updateCov();
+        this->updateVariational();
+    }
+}
+
+void gp::SVGP::getParameters(Eigen::VectorXd& params) const
+{
+    params.resize(this->kernel->nParameters());
+    this->kernel->getParameters(params, 0);
+}
+
+size_t gp::SVGP::nParameters() const
+{
+    return this->kernel->nParameters();
+}
+
+std::shared_ptr<gp::kernel::GPKernel> gp::SVGP::getKernel() const
+{
+    return this->kernel;
+}
+
+const Eigen::MatrixXd& gp::SVGP::getInducingInputs() const
+{
+    return this->Z;
+}
+
+const Eigen::MatrixXd& gp::SVGP::getVariationalMean() const
+{
+    return this->mu;
+}
+
+const Eigen::MatrixXd& gp::SVGP::getVariationalCovariance() const
+{
+    return this->S;
+}
+
+void gp::SVGP::initialize(DataSource& source, const Eigen::Index batchSize)
+{
+    const bool drawInducing = (this->Z.rows() == 0);
+    if(drawInducing){
+        this->Z.resize(this->nInducing, source.getDimX());
+    }
+    else if(this->Z.cols() != source.getDimX()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The dimension of the inducing inputs does not match the data.");
+    }
+
+    // reservoir sampling draws the inducing inputs uniformly in a single pass
+    std::mt19937 rng(this->seed);
+    Eigen::RowVectorXd sum = Eigen::RowVectorXd::Zero(source.getDimY());
+    Eigen::Index n = 0;
+    Eigen::MatrixXd Xb, Yb;
+    Eigen::Index k;
+    source.rewind();
+    while((k = source.nextBatch(Xb, Yb, batchSize)) > 0){
+        sum += Yb.colwise().sum();
+        if(drawInducing){
+            for(Eigen::Index i = 0; i < k; ++i, ++n){
+                if(n < this->Z.rows()){
+                    this->Z.row(n) = Xb.row(i);
+                }
+                else {
+                    const Eigen::Index j = std::uniform_int_distribution<Eigen::Index>(0, n)(rng);
+                    if(j < this->Z.rows()){
+                        this->Z.row(j) = Xb.row(i);
+                    }
+                }
+            }
+        }
+        else {
+            n += k;
+        }
+    }
+    if(n == 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The data source holds no observations.");
+    }
+    if(drawInducing && n < this->Z.rows()){
+        this->Z.conservativeResize(n, Eigen::NoChange);
+    }
+    this->nData = n;
+    this->bias = sum/n;
+
+    // q(u) starts at the prior p(u) = N(0, Kmm)
+    this->updateCov();
+    this->Lambda = this->Kinv;
+    this->theta = Eigen::MatrixXd::Zero(this->Z.rows(), source.getDimY());
+    this->updateVariational();
+}
+
+void gp::SVGP::updateCov()
+{
+    this->kernel->getCovarianceFunction()->K(this->Lk, this->Z);
+    const double scale = this->Lk.diagonal().mean();
+    Eigen::VectorXd diag;
+    double jitter;
+    if(!math::cholJitter(this->Lk, diag, jitter, 1e-10*scale, 20)){
+        util::exceptions::throwException<util::exceptions::Error>("Failed to decompose the covariance matrix of the inducing inputs.");
+    }
+    this->logDetK = math::cholLogDet(this->Lk);
+    this->Kinv = Eigen::MatrixXd::Identity(this->Z.rows(), this->Z.rows());
+    this->Lk.triangularView<Eigen::Lower>().solveInPlace(this->Kinv);
+    this->Lk.triangularView<Eigen::Lower>().transpose().solveInPlace(this->Kinv);
+}
+
+void gp::SVGP::updateVariational()
+{
+    Eigen::LLT<Eigen::MatrixXd> llt(this->Lambda);
+    if(llt.info() != Eigen::Success){
+        util::exceptions::throwException<util::exceptions::Error>("Failed to decompose the precision matrix of the variational distribution.");
+    }
+    this->S = llt.solve(Eigen::MatrixXd::Identity(this->Z.rows(), this->Z.rows()));
+    this->mu.noalias() = this->S*this->theta;
+    this->logDetS = -2.0*llt.matrixLLT().diagonal().array().log().sum();
+
+    this->alpha.noalias() = this->Kinv*this->mu;
+    this->B = this->Kinv - this->Kinv*this->S*this->Kinv;
+}
+
+void gp::SVGP::naturalStep(const Eigen::MatrixXd& Kmb, const Eigen::MatrixXd& Yb, const double c, const double rho)
+{
+    // the optimal natural parameters for the batch are Kmm^-1 + c/noise P P^T and c/noise P y with P = Kmm^-1 Kmb
+    const double w = c/this->kernel->getNoise();
+    const Eigen::MatrixXd P = this->Kinv*Kmb;
+    this->Lambda *= 1.0 - rho;
+    this->Lambda += rho*this->Kinv;
+    this->Lambda.selfadjointView<Eigen::Lower>().rankUpdate(P, rho*w);
+    this->Lambda.triangularView<Eigen::StrictlyUpper>() = this->Lambda.transpose();
+    this->theta = (1.0 - rho)*this->theta + (rho*w)*P*Yb;
+}
+
+double gp::SVGP::dataTerm(const Eigen::MatrixXd& Xb, const Eigen::MatrixXd& Kmb, const Eigen::MatrixXd& Yb, const double c, Eigen::VectorXd* gradient) const
+{
+    const std::shared_ptr<kernel::CovarianceFunction> covfun = this->kernel->getCovarianceFunction();
+    const double noise = this->kernel->getNoise();
+    const double dimY = Yb.cols();
+    const double b = Yb.rows();
+
+    // E_q[f] = P^T mu, Var_q[f] = kbb - diag(Kbm P) + diag(P^T S P)
+    const Eigen::MatrixXd P = this->Kinv*Kmb;
+    const Eigen::MatrixXd SP = this->S*P;
+    const Eigen::MatrixXd R = Yb - P.transpose()*this->mu;
+    Eigen::VectorXd kbb;
+    covfun->diagK(kbb, Xb);
+    const double t1 = kbb.sum() - (Kmb.array()*P.array()).sum();
+    const double t2 = (P.array()*SP.array()).sum();
+    const double a = R.squaredNorm() + dimY*(t1 + t2);
+    const double F = -0.5*c/noise*a - 0.5*c*dimY*b*std::log(2*M_PI*noise);
+
+    if(gradient != nullptr){
+        const Eigen::Index m = this->Z.rows();
+        const Eigen::MatrixXd GP = (c/noise)*(this->mu*R.transpose() - dimY*SP + 0.5*dimY*Kmb);
+        const Eigen::MatrixXd dKmb = (0.5*c*dimY/noise)*P + this->Kinv*GP;
+        const Eigen::MatrixXd dK = -this->Kinv*GP*P.transpose();
+
+        // gradient of the covariance matrix of the stacked inputs [Z; Xb]
+        Eigen::MatrixXd X(m + Xb.rows(), Xb.cols());
+        X << this->Z, Xb;
+        Eigen::MatrixXd covGrad = Eigen::MatrixXd::Zero(X.rows(), X.rows());
+        covGrad.topLeftCorner(m, m) = 0.5*(dK + dK.transpose());
+        covGrad.topRightCorner(m, Xb.rows()) = 0.5*dKmb;
+        covGrad.bottomLeftCorner(Xb.rows(), m) = 0.5*dKmb.transpose();
+        covGrad.bottomRightCorner(Xb.rows(), Xb.rows()).diagonal().setConstant(-0.5*c*dimY/noise);
+
+        Eigen::VectorXd gcov;
+        covfun->gradient(gcov, X, covGrad);
+        gradient->resize(1 + gcov.size());
+        (*gradient)(0) = 0.5*c*a/(noise*noise) - 0.5*c*dimY*b/noise;
+        gradient->tail(gcov.size()) = gcov;
+    }
+    return F;
+}
+
+double gp::SVGP::klDivergence(Eigen::VectorXd* gradient) const
+{
+    const double m = this->Z.rows();
+    const double dimY = this->mu.cols();
+    const Eigen::MatrixXd KinvS = this->Kinv*this->S;
+    const double KL = 0.5*(dimY*(KinvS.trace() - m + this->logDetK - this->logDetS) + (this->mu.transpose()*this->alpha).trace());
+
+    if(gradient != nullptr){
+        Eigen::MatrixXd dK = 0.5*(dimY*this->B - this->alpha*this->alpha.transpose());
+        dK = 0.5*(dK + dK.transpose());
+        Eigen::VectorXd gcov;
+        this->kernel->getCovarianceFunction()->gradient(gcov, this->Z, dK);
+        gradient->resize(1 + gcov.size());
+        (*gradient)(0) = 0.0;
+        gradient->tail(gcov.size()) = gcov;
+    }
+    return KL;
+}
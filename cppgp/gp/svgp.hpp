@@ -0,0 +1,214 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Eigen>
+
+#include <cppgp/gp/datasource.hpp>
+#include <cppgp/kernels/gpkernel.hpp>
+#include <cppgp/optim/adam.hpp>
+#include <cppgp/util/prototype.hpp>
+
+namespace gp {
+
+/**
+ * Options of the minibatch training of SVGP.
+ */
+struct SVGPOptions {
+    Eigen::Index batchSize = 256;               // number of observations per step
+    unsigned int nEpochs = 10;                  // number of passes over the data
+    double naturalStepSize = 0.1;               // step size of the natural gradient steps of the variational distribution
+    optim::AdamOptions adam;                    // options of the Adam steps of the log-parameters of the kernel
+    bool optimizeParameters = true;             // optimize the parameters of the kernel if true
+};
+
+
+/**
+ * Stochastic variational Gaussian process (Hensman et al., 2013).
+ *
+ * The latent function is summarized by its values u at m inducing inputs Z with the variational distribution
+ * q(u) = N(mu, S), S is shared by all target dimensions. The model is trained on the evidence lower bound
+ * \f[
+ * \mathcal{L} = \sum_{i} E_{q(f_i)}[\log p(y_i | f_i)] - KL(q(u) || p(u)),
+ * \f]
+ * whose data term is estimated from minibatches of a DataSource. Each step updates q(u) by a natural gradient step
+ * and the log-parameters of the kernel by an Adam step, so training needs O(m^2 + batchSize*m) memory independent
+ * of the number of observations. The inducing inputs are kept fixed.
+ *
+ * As in GPData, the targets are normalized by subtracting their mean, which is computed in a first pass over the data.
+ * The kernel provides the covariance function and the noise variance, its parameters are assumed to be positive.
+ */
+class SVGP : public util::Prototype {
+public:
+    /**
+     * Create a model with the given inducing inputs.
+     *
+     * @param kernel The kernel.
+     * @param inducingInputs The inducing inputs, size [m, dimX].
+     */
+    SVGP(const std::shared_ptr<kernel::GPKernel>& kernel, const Eigen::MatrixXd& inducingInputs);
+
+    /**
+     * Create a model whose inducing inputs are drawn uniformly from the observations in the first pass over the data.
+     *
+     * @param kernel The kernel.
+     * @param nInducing The number of inducing inputs m.
+     * @param seed The seed of the random selection.
+     */
+    SVGP(const std::shared_ptr<kernel::GPKernel>& kernel, const unsigned int nInducing, const unsigned int seed=0);
+
+    /**
+     * Copy constructor, the kernel is copied.
+     */
+    SVGP(const SVGP& svgp);
+
+    virtual ~SVGP();
+
+    virtual std::shared_ptr<util::Prototype> copy() const override;
+
+    /**
+     * Train the model by minibatch steps. The data source is rewound before every pass.
+     *
+     * @param source The observations.
+     * @param options The options of the training.
+     * @return The mean of the minibatch estimates of the evidence lower bound per epoch, size [nEpochs].
+     */
+    std::vector<double> train(DataSource& source, const SVGPOptions& options=SVGPOptions());
+
+    /**
+     * Compute the evidence lower bound in a full pass over the data.
+     *
+     * @param source The observations.
+     * @param batchSize The number of observations that are processed at once.
+     * @return The evidence lower bound.
+     */
+    double computeELBO(DataSource& source, const Eigen::Index batchSize=1024);
+
+    /**
+     * Compute the evidence lower bound and its gradient with respect to the parameters in a full pass over the data.
+     *
+     * @param source The observations.
+     * @param gradient Returns the gradient, size [nParameters()].
+     * @param batchSize The number of observations that are processed at once.
+     * @return The evidence lower bound.
+     */
+    double computeELBO(DataSource& source, Eigen::VectorXd& gradient, const Eigen::Index batchSize=1024);
+
+    /**
+     * Predict the posterior mean and the posterior variance of the latent function.
+     *
+     * @param mu Returns the posterior mean, size [nIn, dimY].
+     * @param varSigma Returns the posterior variance, size [nIn, dimY].
+     * @param Xin The inputs, size [nIn, dimX].
+     */
+    void posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::MatrixXd& varSigma, const Eigen::MatrixXd& Xin) const;
+
+    /**
+     * Predict the posterior mean.
+     *
+     * @param mu Returns the posterior mean, size [nIn, dimY].
+     * @param Xin The inputs, size [nIn, dimX].
+     */
+    void posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const;
+
+    /**
+     * The parameters are the parameters of the kernel.
+     */
+    void setParameters(const Eigen::VectorXd& params);
+    void getParameters(Eigen::VectorXd& params) const;
+    size_t nParameters() const;
+
+    std::shared_ptr<kernel::GPKernel> getKernel() const;
+
+    /**
+     * @return The inducing inputs, size [m, dimX]. Empty until the first pass if they are drawn from the data.
+     */
+    const Eigen::MatrixXd& getInducingInputs() const;
+
+    /**
+     * @return The mean of q(u) for the normalized targets, size [m, dimY].
+     */
+    const Eigen::MatrixXd& getVariationalMean() const;
+
+    /**
+     * @return The covariance of q(u), size [m, m].
+     */
+    const Eigen::MatrixXd& getVariationalCovariance() const;
+
+private:
+    /**
+     * First pass over the data: count the observations, compute the target mean and draw the inducing inputs.
+     * Initializes q(u) to the prior.
+     */
+    void initialize(DataSource& source, const Eigen::Index batchSize);
+
+    /**
+     * Factorize the covariance matrix of the inducing inputs for the current parameters.
+     */
+    void updateCov();
+
+    /**
+     * Compute S and mu from the natural parameters.
+     */
+    void updateVariational();
+
+    /**
+     * Natural gradient step of q(u) with the minibatch estimate of the data term.
+     */
+    void naturalStep(const Eigen::MatrixXd& Kmb, const Eigen::MatrixXd& Yb, const double c, const double rho);
+
+    /**
+     * Compute c times the expected log likelihood of a batch and its gradient with respect to the parameters.
+     */
+    double dataTerm(const Eigen::MatrixXd& Xb, const Eigen::MatrixXd& Kmb, const Eigen::MatrixXd& Yb, const double c, Eigen::VectorXd* gradient) const;
+
+    /**
+     * Compute KL(q(u) || p(u)) and its gradient with respect to the parameters.
+     */
+    double klDivergence(Eigen::VectorXd* gradient) const;
+
+    std::shared_ptr<kernel::GPKernel> kernel;
+    unsigned int nInducing;
+    unsigned int seed;
+
+    Eigen::Index nData;         // number of observations, 0 before the first pass
+    Eigen::RowVectorXd bias;    // [dimY], mean of the targets
+    Eigen::MatrixXd Z;          // [m x dimX], inducing inputs
+    Eigen::MatrixXd Lk;         // [m x m], Cholesky factor of Kmm in the lower triangle
+    Eigen::MatrixXd Kinv;       // [m x m], Kmm^-1
+    double logDetK;             // log determinant of Kmm
+    Eigen::MatrixXd Lambda;     // [m x m], natural parameter S^-1
+    Eigen::MatrixXd theta;      // [m x dimY], natural parameter S^-1 mu
+    Eigen::MatrixXd S;          // [m x m], covariance of q(u)
+    Eigen::MatrixXd mu;         // [m x dimY], mean of q(u)
+    double logDetS;             // log determinant of S
+    Eigen::MatrixXd alpha;      // [m x dimY], Kmm^-1 mu, the weights of the predicted mean
+    Eigen::MatrixXd B;          // [m x m], Kmm^-1 - Kmm^-1 S Kmm^-1 of the predicted variance
+};
+
+} // namespace gp
@@ -0,0 +1,158 @@
+#include <cppgp/gp/svgp.hpp>
+#include <cppgp/gp/datasource.hpp>
+#include <cppgp/gp/inducingapprox.hpp>
+#include <cppgp/kernels/covfun_rbf.hpp>
+#include <cppgp/util/exceptions.hpp>
+#include <cppgp/gp/testdata.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+using namespace gp;
+using gp::test::get_smooth_data;
+
+TEST(gp_svgp, optimal_variational_distribution){
+    // a full natural step on the whole data gives the optimal q(u), whose bound is the VFE bound
+    auto gpdata = get_smooth_data(60);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(3.0, 1.5), 0.05);
+    const Eigen::MatrixXd Z = Eigen::MatrixXd::Random(8, 2);
+    const Eigen::MatrixXd Xin = Eigen::MatrixXd::Random(12, 2);
+    GPDataSource source(gpdata, false);
+
+    SVGP svgp(gpkernel, Z);
+    SVGPOptions options;
+    options.batchSize = 60;
+    options.nEpochs = 1;
+    options.naturalStepSize = 1.0;
+    options.optimizeParameters = false;
+    const std::vector<double> elbo = svgp.train(source, options);
+    ASSERT_EQ(elbo.size(), 1u);
+
+    Eigen::MatrixXd Y;
+    gpdata->getYNormalized(Y);
+    Eigen::RowVectorXd bias;
+    gpdata->getBias(bias);
+    InducingPointApprox vfe(Z, InducingPointApprox::Method::VFE);
+    vfe.updateKernelPrecomputations(gpkernel, gpdata->getXView(), Y);
+    const double nlml = vfe.computeNegativeLogMarginalLikelihood(Y);
+    EXPECT_NEAR(elbo[0], -nlml, 1e-7*std::abs(nlml));
+    EXPECT_NEAR(svgp.computeELBO(source, 7), -nlml, 1e-7*std::abs(nlml));
+
+    Eigen::MatrixXd mu, varSigma, muOnly, muExpected;
+    Eigen::VectorXd varExpected;
+    svgp.posteriorMeanVar(mu, varSigma, Xin);
+    svgp.posteriorMean(muOnly, Xin);
+    vfe.posteriorMeanVar(muExpected, varExpected, Xin);
+    muExpected.rowwise() += bias;
+    EXPECT_TRUE(mu.isApprox(muExpected, 1e-7));
+    EXPECT_TRUE(muOnly.isApprox(mu, 1e-12));
+    EXPECT_TRUE(varSigma.col(0).isApprox(varExpected, 1e-6));
+    EXPECT_TRUE(varSigma.col(1).isApprox(varExpected, 1e-6));
+}
+
+TEST(gp_svgp, elbo_gradient){
+    auto gpdata = get_smooth_data(50);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(2.0, 0.8), 0.1);
+    GPDataSource source(gpdata, true, 3);
+
+    SVGP svgp(gpkernel, 10, 1);
+    SVGPOptions options;
+    options.batchSize = 16;
+    options.nEpochs = 2;
+    options.naturalStepSize = 0.5;
+    options.optimizeParameters = false;
+    svgp.train(source, options);
+
+    Eigen::VectorXd params, gradient;
+    svgp.getParameters(params);
+    svgp.computeELBO(source, gradient, 16);
+    ASSERT_EQ(gradient.size(), params.size());
+    for(Eigen::Index i = 0; i < params.size(); ++i){
+        const double h = 1e-6*params(i);
+        Eigen::VectorXd p = params;
+        p(i) = params(i) + h;
+        svgp.setParameters(p);
+        const double elboPlus = svgp.computeELBO(source, 16);
+        p(i) = params(i) - h;
+        svgp.setParameters(p);
+        const double elboMinus = svgp.computeELBO(source, 16);
+        EXPECT_NEAR(gradient(i), (elboPlus - elboMinus)/(2*h), 1e-5*std::max(1.0, std::abs(gradient(i)))) << "parameter " << i;
+    }
+}
+
+TEST(gp_svgp, minibatch_training){
+    auto gpdata = get_smooth_data(800);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(1.0, 1.0), 0.5);
+    GPDataSource source(gpdata, true, 5);
+
+    SVGP svgp(gpkernel, 20, 2);
+    const double elboPrior = svgp.computeELBO(source);
+    EXPECT_EQ(svgp.getInducingInputs().rows(), 20);
+
+    SVGPOptions options;
+    options.batchSize = 64;
+    options.nEpochs = 15;
+    options.adam.learningRate = 0.05;
+    const std::vector<double> elbo = svgp.train(source, options);
+    ASSERT_EQ(elbo.size(), 15u);
+    EXPECT_GT(elbo.back(), elbo.front());
+    const double elboTrained = svgp.computeELBO(source);
+    EXPECT_GT(elboTrained, elboPrior);
+
+    // the fitted noise approaches the noise of the targets
+    Eigen::VectorXd params;
+    svgp.getParameters(params);
+    EXPECT_LT(params(0), 0.1);
+
+    Eigen::MatrixXd mu, varSigma;
+    const Eigen::MatrixXd Xin = 0.9*Eigen::MatrixXd::Random(100, 2);
+    svgp.posteriorMeanVar(mu, varSigma, Xin);
+    Eigen::MatrixXd Yexpected(100, 2);
+    Yexpected.col(0) = Xin.col(0).array().sin() + Xin.rowwise().sum().array();
+    Yexpected.col(1) = Xin.rowwise().squaredNorm();
+    EXPECT_LT((mu - Yexpected).cwiseAbs().mean(), 0.05);
+    EXPECT_GE(varSigma.minCoeff(), 0.0);
+}
+
+TEST(gp_svgp, data_sources){
+    const std::filesystem::path filename = std::filesystem::temp_directory_path() / "cppgp_svgp_datasource.txt";
+    {
+        std::ofstream file(filename);
+        file << "0.5 1.0 2.0\n-1.5 0.25 3.0\n\n2.0 2.0 -1.0\n0.0 0.0 0.0\n1.0 -1.0 4.5\n";
+    }
+    TextFileDataSource textSource(filename.string(), 2);
+    EXPECT_EQ(textSource.getDimX(), 2u);
+    EXPECT_EQ(textSource.getDimY(), 1u);
+    Eigen::MatrixXd X, Y;
+    for(int pass = 0; pass < 2; ++pass){
+        EXPECT_EQ(textSource.nextBatch(X, Y, 2), 2);
+        EXPECT_EQ(textSource.nextBatch(X, Y, 2), 2);
+        EXPECT_DOUBLE_EQ(X(0, 0), 2.0);
+        EXPECT_DOUBLE_EQ(Y(1, 0), 0.0);
+        EXPECT_EQ(textSource.nextBatch(X, Y, 2), 1);
+        EXPECT_DOUBLE_EQ(X(0, 1), -1.0);
+        EXPECT_DOUBLE_EQ(Y(0, 0), 4.5);
+        EXPECT_EQ(textSource.nextBatch(X, Y, 2), 0);
+        textSource.rewind();
+    }
+    std::filesystem::remove(filename);
+    EXPECT_THROW(TextFileDataSource(filename.string(), 2), util::exceptions::FileReaderError);
+
+    // every observation of GPData is visited once per pass
+    auto gpdata = get_smooth_data(25);
+    GPDataSource dataSource(gpdata, true, 7);
+    for(int pass = 0; pass < 2; ++pass){
+        Eigen::VectorXd sum = Eigen::VectorXd::Zero(2);
+        Eigen::Index n = 0, k;
+        while((k = dataSource.nextBatch(X, Y, 10)) > 0){
+            sum += Y.colwise().sum().transpose();
+            n += k;
+        }
+        EXPECT_EQ(n, 25);
+        EXPECT_TRUE(sum.isApprox(std::get<1>(gpdata->getData()).colwise().sum().transpose(), 1e-12));
+        dataSource.rewind();
+    }
+}
@@ -0,0 +1,52 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+
+#include <Eigen/Eigen>
+
+#include <cppgp/gp/gpdata.hpp>
+
+namespace gp::test {
+
+    /**
+     * Data set for the tests of the approximations, with two smooth targets of random inputs in [-1, 1].
+     *
+     * @param n The number of observations.
+     * @param dimX The dimension of the inputs.
+     * @return The data.
+     */
+    inline std::shared_ptr<GPData> get_smooth_data(const int n, const int dimX=2)
+    {
+        auto gpdata = std::make_shared<GPData>(dimX, 2);
+        const Eigen::MatrixXd X = Eigen::MatrixXd::Random(n, dimX);
+        Eigen::MatrixXd Y(n, 2);
+        Y.col(0) = X.col(0).array().sin() + X.rowwise().sum().array();
+        Y.col(1) = X.rowwise().squaredNorm() + 0.1*Eigen::VectorXd::Random(n);
+        gpdata->addData(X, Y);
+        return gpdata;
+    }
+}
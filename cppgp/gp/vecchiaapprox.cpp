@@ -0,0 +1,293 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <cppgp/gp/vecchiaapprox.hpp>
+#include <cppgp/math/cholesky.hpp>
+#include <cppgp/util/exceptions.hpp>
+#include <cppgp/util/threadpool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+namespace {
+    typedef Eigen::SparseMatrix<double>::StorageIndex StorageIndex;
+    const Eigen::Index blockSize = 256;             // observations per parallel task
+    const Eigen::Index firstNeighborRound = 1024;   // inputs in the tree of the first round of the neighbor search
+}
+
+gp::VecchiaApprox::VecchiaApprox(const unsigned int nNeighbors, const Ordering ordering, const unsigned int seed) :
+    nNeighbors(nNeighbors),
+    ordering(ordering),
+    seed(seed),
+    nThreads(1),
+    covfun(nullptr),
+    noise(0.0),
+    tree(nullptr)
+{
+    if(nNeighbors == 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The number of neighbors must be positive.");
+    }
+}
+
+std::shared_ptr<util::Prototype> gp::VecchiaApprox::copy() const
+{
+    return std::make_shared<VecchiaApprox>(*this);
+}
+
+void gp::VecchiaApprox::getParameters(Eigen::VectorXd& params) const
+{
+    params.resize(0);
+}
+
+void gp::VecchiaApprox::setParameters(const Eigen::VectorXd& params)
+{
+    if(params.size() != 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("VecchiaApprox has no parameters.");
+    }
+}
+
+size_t gp::VecchiaApprox::nParameters() const
+{
+    return 0;
+}
+
+void gp::VecchiaApprox::posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const
+{
+    this->predict(mu, nullptr, Xin);
+}
+
+void gp::VecchiaApprox::posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::VectorXd& var, const Eigen::MatrixXd& Xin) const
+{
+    this->predict(mu, &var, Xin);
+}
+
+unsigned int gp::VecchiaApprox::getNumNeighbors() const
+{
+    return this->nNeighbors;
+}
+
+gp::VecchiaApprox::Ordering gp::VecchiaApprox::getOrdering() const
+{
+    return this->ordering;
+}
+
+void gp::VecchiaApprox::setNumThreads(const unsigned int nThreads)
+{
+    this->nThreads = nThreads;
+    this->pool = (nThreads == 1) ? nullptr : std::make_shared<util::ThreadPool>(nThreads);
+}
+
+unsigned int gp::VecchiaApprox::getNumThreads() const
+{
+    return this->nThreads;
+}
+
+const std::vector<Eigen::Index>& gp::VecchiaApprox::getOrder() const
+{
+    return this->order;
+}
+
+const Eigen::SparseMatrix<double>& gp::VecchiaApprox::getFactor() const
+{
+    return this->U;
+}
+
+void gp::VecchiaApprox::updateK(const std::shared_ptr<kernel::GPKernel>& kernel, const Eigen::Ref<const Eigen::MatrixXd>& obsX)
+{
+    this->covfun = kernel->getCovarianceFunction();
+    this->noise = kernel->getNoise();
+
+    // the conditioning sets only depend on the inputs
+    bool sameInputs = this->tree != nullptr && this->X.rows() == obsX.rows() && this->X.cols() == obsX.cols();
+    for(Eigen::Index i = 0; sameInputs && i < obsX.rows(); ++i){
+        sameInputs = (this->X.row(i) == obsX.row(this->order[i]));
+    }
+    if(!sameInputs){
+        this->updateNeighbors(obsX);
+    }
+
+    // column i: U(N(i), i) = -K(N, N)^-1 K(N, i)/sqrt(d_i), U(i, i) = 1/sqrt(d_i) with the conditional variance d_i,
+    // both follow from the last row of the Cholesky factor of K([N(i), i], [N(i), i])
+    const Eigen::Index n = this->X.rows();
+    const StorageIndex* outer = this->U.outerIndexPtr();
+    const StorageIndex* inner = this->U.innerIndexPtr();
+    double* values = this->U.valuePtr();
+    Eigen::VectorXd logCondVar(n);
+    this->forEachBlock(n, [&](Eigen::Index begin, Eigen::Index end){
+        Eigen::MatrixXd Xi, C;
+        Eigen::VectorXd diag, b;
+        for(Eigen::Index i = begin; i < end; ++i){
+            const Eigen::Index k = outer[i+1] - outer[i];
+            Xi.resize(k, this->X.cols());
+            for(Eigen::Index j = 0; j < k; ++j){
+                Xi.row(j) = this->X.row(inner[outer[i]+j]);
+            }
+            this->factorizeLocal(C, diag, Xi);
+            const double l = C(k-1, k-1);
+            b = C.row(k-1).head(k-1).transpose();
+            C.topLeftCorner(k-1, k-1).triangularView<Eigen::Lower>().transpose().solveInPlace(b);
+            Eigen::Map<Eigen::VectorXd>(values + outer[i], k-1) = -b/l;
+            values[outer[i+1]-1] = 1.0/l;
+            logCondVar(i) = 2.0*std::log(l);
+        }
+    });
+    this->logDetK = logCondVar.sum();
+}
+
+void gp::VecchiaApprox::updateAD(const Eigen::Ref<const Eigen::MatrixXd>& obsYNormalized)
+{
+    this->Y.resize(obsYNormalized.rows(), obsYNormalized.cols());
+    for(Eigen::Index i = 0; i < this->Y.rows(); ++i){
+        this->Y.row(i) = obsYNormalized.row(this->order[i]);
+    }
+    // y^T K^-1 y = ||U^T y||^2
+    const Eigen::MatrixXd Z = this->U.transpose()*this->Y;
+    this->innerProducts = Z.colwise().squaredNorm().transpose();
+}
+
+void gp::VecchiaApprox::updateAlpha(const Eigen::Ref<const Eigen::MatrixXd>&)
+{
+    // the predictions condition on the ordered targets of updateAD, there are no global weights
+}
+
+void gp::VecchiaApprox::updateNeighbors(const Eigen::Ref<const Eigen::MatrixXd>& obsX)
+{
+    const Eigen::Index n = obsX.rows();
+    const Eigen::Index m = this->nNeighbors;
+
+    this->order.resize(n);
+    std::iota(this->order.begin(), this->order.end(), 0);
+    if(this->ordering == Ordering::COORDINATE && obsX.cols() > 0){
+        std::stable_sort(this->order.begin(), this->order.end(),
+                         [&obsX](Eigen::Index a, Eigen::Index b){ return obsX(a, 0) < obsX(b, 0); });
+    }
+    else if(this->ordering == Ordering::RANDOM){
+        std::mt19937 rng(this->seed);
+        std::shuffle(this->order.begin(), this->order.end(), rng);
+    }
+    this->X.resize(n, obsX.cols());
+    for(Eigen::Index i = 0; i < n; ++i){
+        this->X.row(i) = obsX.row(this->order[i]);
+    }
+
+    // the i-th column holds min(i, m) neighbors and the diagonal
+    this->U.resize(n, n);
+    StorageIndex* outer = this->U.outerIndexPtr();
+    outer[0] = 0;
+    for(Eigen::Index i = 0; i < n; ++i){
+        outer[i+1] = outer[i] + static_cast<StorageIndex>(std::min(i, m) + 1);
+    }
+    this->U.resizeNonZeros(outer[n]);
+    StorageIndex* inner = this->U.innerIndexPtr();
+
+    // the tree grows in rounds that double its size, the inputs of a round search their neighbors in parallel
+    // among the preceding inputs, which are at least half of the tree
+    auto tree = std::make_shared<math::KDTree>(obsX.cols());
+    Eigen::Index begin = 0;
+    while(begin < n){
+        const Eigen::Index end = std::min(n, std::max(2*begin, firstNeighborRound));
+        tree->insert(this->X.middleRows(begin, end-begin));
+        this->forEachBlock(end-begin, [&](Eigen::Index blockBegin, Eigen::Index blockEnd){
+            std::vector<Eigen::Index> indices;
+            std::vector<double> distances;
+            for(Eigen::Index i = begin+blockBegin; i < begin+blockEnd; ++i){
+                tree->knnSearch(indices, distances, this->X.row(i).transpose(), m, i);
+                std::sort(indices.begin(), indices.end());
+                std::copy(indices.begin(), indices.end(), inner + outer[i]);
+                inner[outer[i+1]-1] = static_cast<StorageIndex>(i);
+            }
+        });
+        begin = end;
+    }
+    this->tree = tree;
+}
+
+void gp::VecchiaApprox::predict(Eigen::MatrixXd& mu, Eigen::VectorXd* var, const Eigen::MatrixXd& Xin) const
+{
+    if(this->tree == nullptr){
+        util::exceptions::throwException<util::exceptions::Error>("The approximation has not been fitted to observations.");
+    }
+    if(Xin.cols() != this->X.cols()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Data dimension does not match dimension of the observations.");
+    }
+    mu.resize(Xin.rows(), this->Y.cols());
+    if(var != nullptr){
+        this->covfun->diagK(*var, Xin);
+    }
+    this->forEachBlock(Xin.rows(), [&](Eigen::Index begin, Eigen::Index end){
+        std::vector<Eigen::Index> indices;
+        std::vector<double> distances;
+        Eigen::MatrixXd Xn, C, kx;
+        Eigen::VectorXd diag;
+        for(Eigen::Index t = begin; t < end; ++t){
+            this->tree->knnSearch(indices, distances, Xin.row(t).transpose(), this->nNeighbors);
+            const Eigen::Index k = indices.size();
+            Xn.resize(k, this->X.cols());
+            Eigen::MatrixXd Yn(k, this->Y.cols());
+            for(Eigen::Index j = 0; j < k; ++j){
+                Xn.row(j) = this->X.row(indices[j]);
+                Yn.row(j) = this->Y.row(indices[j]);
+            }
+            this->factorizeLocal(C, diag, Xn);
+            this->covfun->K(kx, Xn, Xin.row(t));
+            const auto L = C.triangularView<Eigen::Lower>();
+            L.solveInPlace(kx);
+            L.solveInPlace(Yn);
+            mu.row(t).noalias() = kx.transpose()*Yn;
+            if(var != nullptr){
+                (*var)(t) -= kx.squaredNorm();
+            }
+        }
+    });
+}
+
+void gp::VecchiaApprox::forEachBlock(const Eigen::Index n, const std::function<void(Eigen::Index, Eigen::Index)>& block) const
+{
+    const Eigen::Index nBlocks = (n + blockSize - 1)/blockSize;
+    auto task = [&](std::size_t b){
+        const Eigen::Index begin = b*blockSize;
+        block(begin, std::min(n, begin + blockSize));
+    };
+    if(!this->pool || nBlocks <= 1){
+        for(Eigen::Index b = 0; b < nBlocks; ++b){
+            task(b);
+        }
+        return;
+    }
+    this->pool->parallelFor(nBlocks, task);
+}
+
+void gp::VecchiaApprox::factorizeLocal(Eigen::MatrixXd& C, Eigen::VectorXd& diag, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    this->covfun->K(C, X);
+    C.diagonal().array() += this->noise;
+    const double meanDiag = (C.rows() > 0) ? C.diagonal().mean() : 0.0;
+    const double scale = (meanDiag > 0) ? meanDiag : 1.0;
+    double jitter;
+    if(!math::cholJitter(C, diag, jitter, 1e-10*scale, 20)){
+        util::exceptions::throwException<util::exceptions::Error>("Failed to decompose the covariance matrix of a conditioning set.");
+    }
+}
@@ -0,0 +1,158 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Eigen>
+#include <Eigen/Sparse>
+
+#include <cppgp/gp/gpapproximation.hpp>
+#include <cppgp/kernels/covfun.hpp>
+#include <cppgp/math/kdtree.hpp>
+#include <cppgp/util/threadpool.hpp>
+
+namespace gp {
+
+/**
+ * Vecchia approximation of the noised covariance matrix by nearest neighbor conditioning.
+ *
+ * The observations are put into an order (see #Ordering) and the joint density of the targets is approximated by
+ * \f[
+ * p(y) \approx \prod_i p(y_i \mid y_{N(i)}),
+ * \f]
+ * where N(i) holds the m nearest neighbors of the i-th input among the preceding inputs. This gives a sparse
+ * upper triangular factor U with at most m+1 nonzeros per column, such that \f$ K^{-1} \approx U U^T \f$ in the order
+ * of the observations. Every column only needs the Cholesky factorization of an [m+1, m+1] covariance matrix
+ * of its conditioning set, the columns are computed independently in parallel. Fitting costs O(n m^3),
+ * the log determinant and the inner products y^T K^{-1} y follow from U in O(n m).
+ *
+ * A prediction conditions on the m nearest observations of the test input and costs O(m^3).
+ * The nearest neighbors are determined with the Euclidean distance of the inputs by a math::KDTree, which is built
+ * once for the inputs and reused as long as the inputs do not change, e.g. during the hyperparameter optimization.
+ */
+class VecchiaApprox : public GPApproximation {
+public:
+    /**
+     * Order of the observations, which determines the conditioning sets.
+     * - DATA: The order of the observation data.
+     * - COORDINATE: Sorted by the first input coordinate.
+     * - RANDOM: A random permutation, which is usually more accurate than the other orders in several dimensions.
+     */
+    enum class Ordering {DATA, COORDINATE, RANDOM};
+
+    /**
+     * @param nNeighbors The number m of neighbors that every observation and every prediction conditions on.
+     * @param ordering The order of the observations.
+     * @param seed The seed of the random order.
+     */
+    VecchiaApprox(const unsigned int nNeighbors=30, const Ordering ordering=Ordering::RANDOM, const unsigned int seed=0);
+
+    virtual std::shared_ptr<util::Prototype> copy() const override;
+
+    virtual void getParameters(Eigen::VectorXd& params) const override;
+    virtual void setParameters(const Eigen::VectorXd& params) override;
+    virtual size_t nParameters() const override;
+
+    virtual void posteriorMean(Eigen::MatrixXd& mu, const Eigen::MatrixXd& Xin) const override;
+    virtual void posteriorMeanVar(Eigen::MatrixXd& mu, Eigen::VectorXd& var, const Eigen::MatrixXd& Xin) const override;
+
+    /**
+     * @return The number of neighbors m.
+     */
+    unsigned int getNumNeighbors() const;
+
+    /**
+     * @return The order of the observations.
+     */
+    Ordering getOrdering() const;
+
+    /**
+     * \brief Set the number of threads for the neighbor search, the factor and the predictions.
+     * The covariance function is then evaluated concurrently on small blocks of inputs.
+     * \param nThreads The number of threads, 0 for the number of hardware threads.
+     */
+    void setNumThreads(const unsigned int nThreads);
+
+    /**
+     * \brief Get the number of threads.
+     * \return The number of threads, 0 for the number of hardware threads.
+     */
+    unsigned int getNumThreads() const;
+
+    /**
+     * @return The order of the observations, the i-th entry is the index of the i-th observation in the data.
+     */
+    const std::vector<Eigen::Index>& getOrder() const;
+
+    /**
+     * @return The sparse upper triangular factor U, size [nData, nData], with \f$ K^{-1} \approx U U^T \f$
+     *         for the observations in the order of #getOrder.
+     */
+    const Eigen::SparseMatrix<double>& getFactor() const;
+
+private:
+    virtual void updateK(const std::shared_ptr<kernel::GPKernel>& kernel, const Eigen::Ref<const Eigen::MatrixXd>& obsX) override;
+    virtual void updateAD(const Eigen::Ref<const Eigen::MatrixXd>& obsYNormalized) override;
+    virtual void updateAlpha(const Eigen::Ref<const Eigen::MatrixXd>& obsYNormalized) override;
+
+    /**
+     * Order the inputs, build the tree and the conditioning sets, i.e. the sparsity pattern of the factor.
+     */
+    void updateNeighbors(const Eigen::Ref<const Eigen::MatrixXd>& obsX);
+
+    /**
+     * Predict from the m nearest observations of every input, var is not computed if it is nullptr.
+     */
+    void predict(Eigen::MatrixXd& mu, Eigen::VectorXd* var, const Eigen::MatrixXd& Xin) const;
+
+    /**
+     * Call block(begin, end) for consecutive blocks of [0, n), in parallel if more than one thread is set.
+     */
+    void forEachBlock(const Eigen::Index n, const std::function<void(Eigen::Index, Eigen::Index)>& block) const;
+
+    /**
+     * Cholesky factorization of the noised covariance matrix of the given inputs, in the lower triangle of C.
+     */
+    void factorizeLocal(Eigen::MatrixXd& C, Eigen::VectorXd& diag, const Eigen::Ref<const Eigen::MatrixXd>& X) const;
+
+    unsigned int nNeighbors;
+    Ordering ordering;
+    unsigned int seed;
+    unsigned int nThreads;
+    std::shared_ptr<util::ThreadPool> pool;     // nullptr for a single thread, shared by copies
+
+    std::shared_ptr<kernel::CovarianceFunction> covfun;
+    double noise;
+    std::vector<Eigen::Index> order;            // order[i] is the index of the i-th ordered observation in the data
+    Eigen::MatrixXd X;                          // [nData x dimX], ordered inputs
+    Eigen::MatrixXd Y;                          // [nData x dimY], ordered normalized targets
+    std::shared_ptr<const math::KDTree> tree;   // tree of the ordered inputs, shared by copies
+    Eigen::SparseMatrix<double> U;              // [nData x nData], column i holds the weights of N(i) and i
+};
+
+} // namespace gp
@@ -0,0 +1,169 @@
+#include <cppgp/gp/vecchiaapprox.hpp>
+#include <cppgp/gp/ftcapprox.hpp>
+#include <cppgp/gp/gaussianprocess.hpp>
+#include <cppgp/kernels/covfun_rbf.hpp>
+#include <cppgp/gp/testdata.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace gp;
+using gp::test::get_smooth_data;
+
+namespace {
+    void fit(GPApproximation& approx, const std::shared_ptr<kernel::GPKernel>& kernel, const GPData& gpdata)
+    {
+        Eigen::MatrixXd Y;
+        gpdata.getYNormalized(Y);
+        approx.updateKernelPrecomputations(kernel, gpdata.getXView(), Y);
+    }
+}
+
+TEST(gp_vecchiaapprox, ftc_exact){
+    auto gpdata = get_smooth_data(40, 2);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    GaussianProcess gaussianprocess(gpdata, gpkernel);
+    FTC ftc;
+    fit(ftc, gpkernel, *gpdata);
+
+    Eigen::MatrixXd Y;
+    gpdata->getYNormalized(Y);
+    EXPECT_NEAR(ftc.computeNegativeLogMarginalLikelihood(Y), gaussianprocess.computeNegativeLogMarginalLikelihood(), 1e-9);
+    EXPECT_NEAR(ftc.getLogDetK(), gpkernel->computeNoisedLogDetCov(), 1e-9);
+
+    const Eigen::MatrixXd Xin = Eigen::MatrixXd::Random(15, 2);
+    Eigen::MatrixXd mu, muGP, varGP;
+    Eigen::VectorXd var;
+    ftc.posteriorMeanVar(mu, var, Xin);
+    gaussianprocess.posteriorMeanVar(muGP, varGP, Xin);
+    // the GaussianProcess rescales the normalized predictions
+    Eigen::RowVectorXd scale, bias;
+    gpdata->getScale(scale);
+    gpdata->getBias(bias);
+    const Eigen::MatrixXd muRescaled = (mu.array().rowwise()*scale.array()).rowwise() + bias.array();
+    EXPECT_TRUE(muGP.isApprox(muRescaled, 1e-9));
+    EXPECT_TRUE(varGP.col(0).isApprox(var*scale(0)*scale(0), 1e-9));
+}
+
+TEST(gp_vecchiaapprox, exact_with_all_neighbors){
+    // conditioning on all preceding observations gives the exact inverse covariance
+    auto gpdata = get_smooth_data(30, 3);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(1.0, 1.5), 0.05);
+    gpkernel->registerData(gpdata);
+    FTC ftc;
+    fit(ftc, gpkernel, *gpdata);
+    for(auto ordering : {VecchiaApprox::Ordering::DATA, VecchiaApprox::Ordering::COORDINATE, VecchiaApprox::Ordering::RANDOM}){
+        VecchiaApprox vecchia(30, ordering);
+        fit(vecchia, gpkernel, *gpdata);
+
+        Eigen::MatrixXd K;
+        gpkernel->computeNoisedCov(K);
+        const std::vector<Eigen::Index>& order = vecchia.getOrder();
+        Eigen::MatrixXd Kordered(30, 30);
+        for(int i = 0; i < 30; ++i){
+            for(int j = 0; j < 30; ++j){
+                Kordered(i, j) = K(order[i], order[j]);
+            }
+        }
+        const Eigen::MatrixXd U = vecchia.getFactor();
+        EXPECT_TRUE(U.isUpperTriangular());
+        EXPECT_TRUE((U*U.transpose()*Kordered).isIdentity(1e-8));
+
+        Eigen::MatrixXd Y;
+        gpdata->getYNormalized(Y);
+        EXPECT_NEAR(vecchia.computeNegativeLogMarginalLikelihood(Y), ftc.computeNegativeLogMarginalLikelihood(Y), 1e-8);
+
+        const Eigen::MatrixXd Xin = Eigen::MatrixXd::Random(10, 3);
+        Eigen::MatrixXd mu, muFTC;
+        Eigen::VectorXd var, varFTC;
+        vecchia.posteriorMeanVar(mu, var, Xin);
+        ftc.posteriorMeanVar(muFTC, varFTC, Xin);
+        EXPECT_TRUE(mu.isApprox(muFTC, 1e-8));
+        EXPECT_TRUE(var.isApprox(varFTC, 1e-8));
+    }
+}
+
+TEST(gp_vecchiaapprox, neighbors){
+    // more observations than the first round of the neighbor search, sequential and parallel
+    const int n = 3000;
+    const unsigned int m = 6;
+    auto gpdata = get_smooth_data(n, 2);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(20.0, 1.0), 0.01);
+    VecchiaApprox sequential(m, VecchiaApprox::Ordering::RANDOM, 3);
+    fit(sequential, gpkernel, *gpdata);
+    VecchiaApprox parallel(m, VecchiaApprox::Ordering::RANDOM, 3);
+    parallel.setNumThreads(4);
+    fit(parallel, gpkernel, *gpdata);
+    EXPECT_EQ(parallel.getOrder(), sequential.getOrder());
+    EXPECT_TRUE(parallel.getFactor().isApprox(sequential.getFactor()));
+    EXPECT_EQ(parallel.getLogDetK(), sequential.getLogDetK());
+
+    // the conditioning sets are the nearest preceding observations
+    const Eigen::MatrixXd X = gpdata->getXView();
+    const std::vector<Eigen::Index>& order = sequential.getOrder();
+    const Eigen::SparseMatrix<double>& U = sequential.getFactor();
+    for(int i : {0, 1, 5, 700, 1023, 1024, 1500, 2048, n-1}){
+        std::vector<std::pair<double, Eigen::Index>> preceding;
+        for(int j = 0; j < i; ++j){
+            preceding.emplace_back((X.row(order[i]) - X.row(order[j])).squaredNorm(), j);
+        }
+        std::sort(preceding.begin(), preceding.end());
+        preceding.resize(std::min<size_t>(m, preceding.size()));
+        std::vector<Eigen::Index> expected;
+        for(const auto& p : preceding){
+            expected.push_back(p.second);
+        }
+        expected.push_back(i);
+        std::sort(expected.begin(), expected.end());
+        std::vector<Eigen::Index> pattern;
+        for(Eigen::SparseMatrix<double>::InnerIterator it(U, i); it; ++it){
+            pattern.push_back(it.row());
+        }
+        EXPECT_EQ(pattern, expected) << "column " << i;
+    }
+
+}
+
+TEST(gp_vecchiaapprox, accuracy){
+    // the approximation approaches the exact model with the number of neighbors
+    auto gpdata = get_smooth_data(2000, 2);
+    auto gpkernel = std::make_shared<kernel::GPKernel>(std::make_shared<kernel::RBFCovFun>(4.0, 1.0), 0.01);
+    Eigen::MatrixXd Y;
+    gpdata->getYNormalized(Y);
+    FTC ftc;
+    fit(ftc, gpkernel, *gpdata);
+    const double nlml = ftc.computeNegativeLogMarginalLikelihood(Y);
+    const Eigen::MatrixXd Xin = 0.9*Eigen::MatrixXd::Random(200, 2);
+    Eigen::MatrixXd muFTC;
+    Eigen::VectorXd varFTC;
+    ftc.posteriorMeanVar(muFTC, varFTC, Xin);
+
+    double previous = std::numeric_limits<double>::infinity();
+    for(unsigned int m : {5, 10, 20, 40}){
+        VecchiaApprox vecchia(m);
+        vecchia.setNumThreads(4);
+        fit(vecchia, gpkernel, *gpdata);
+        const double nlmlVecchia = vecchia.computeNegativeLogMarginalLikelihood(Y);
+        EXPECT_LT(nlmlVecchia, previous);
+        EXPECT_GT(nlmlVecchia, nlml);
+        previous = nlmlVecchia;
+        if(m == 40){
+            EXPECT_NEAR(nlmlVecchia, nlml, 0.03*std::abs(nlml));
+        }
+
+        Eigen::MatrixXd mu;
+        Eigen::VectorXd var;
+        vecchia.posteriorMeanVar(mu, var, Xin);
+        if(m >= 20){
+            EXPECT_LT((mu - muFTC).cwiseAbs().mean(), 0.02);
+            EXPECT_LT((var - varFTC).cwiseAbs().maxCoeff(), 0.002);
+        }
+        EXPECT_GE(var.minCoeff(), -1e-10);
+        Eigen::MatrixXd muOnly;
+        vecchia.posteriorMean(muOnly, Xin);
+        EXPECT_EQ(muOnly, mu);
+    }
+}
@@ -0,0 +1,538 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+
+#include <cppgp/kernels/covfactorization.hpp>
+#include <cppgp/math/cholesky.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+
+
+gp::kernel::CovFactorization::CovFactorization() :
+    lowRankNoise(0.0), iterativeLogDet(0.0), is_logdet_estimated(false), iterations(0),
+    n(0), jitter(0.0), maxTries(20), strategy(math::JitterStrategy::RESTART), dataVersion(0), parameterVersion(0),
+    mode(Mode::DENSE), is_valid(false), is_alpha_computed(false)
+{}
+
+
+void gp::kernel::CovFactorization::factorize(const std::function<void(Eigen::MatrixXd&)>& assemble, const unsigned long dataVersion, const unsigned long parameterVersion)
+{
+    this->is_valid = false;
+    this->is_alpha_computed = false;
+
+    assemble(this->L);
+    const double meanDiag = (this->L.rows() > 0) ? this->L.diagonal().mean() : 0.0;
+    const double scale = (meanDiag > 0) ? meanDiag : 1.0;
+    if(!math::cholJitter(this->L, this->diag, this->jitter, 1e-10*scale, this->maxTries, this->strategy)){
+        util::exceptions::throwException<util::exceptions::Error>("Failed to decompose the noised covariance matrix.");
+    }
+    this->n = this->L.rows();
+    this->dataVersion = dataVersion;
+    this->parameterVersion = parameterVersion;
+    this->mode = Mode::DENSE;
+    this->is_valid = true;
+}
+
+
+void gp::kernel::CovFactorization::factorizeSparse(const std::function<void(Eigen::SparseMatrix<double>&)>& assemble, const unsigned long dataVersion, const unsigned long parameterVersion)
+{
+    this->is_valid = false;
+    this->is_alpha_computed = false;
+    this->L.resize(0, 0);
+
+    Eigen::SparseMatrix<double> A;
+    assemble(A);
+    const double meanDiag = (A.rows() > 0) ? A.diagonal().mean() : 0.0;
+    const double scale = (meanDiag > 0) ? meanDiag : 1.0;
+    Eigen::SparseMatrix<double> identity(A.rows(), A.cols());
+    identity.setIdentity();
+
+    this->jitter = 0.0;
+    this->sparseL.analyzePattern(A);
+    this->sparseL.factorize(A);
+    for(unsigned int i = 1; i < this->maxTries && this->sparseL.info() != Eigen::Success; ++i){
+        const double nextJitter = 1e-10*scale*std::pow(10.0, i-1);
+        A += (nextJitter - this->jitter)*identity;
+        this->jitter = nextJitter;
+        this->sparseL.factorize(A);
+    }
+    if(this->sparseL.info() != Eigen::Success){
+        util::exceptions::throwException<util::exceptions::Error>("Failed to decompose the noised covariance matrix.");
+    }
+    this->n = A.rows();
+    this->dataVersion = dataVersion;
+    this->parameterVersion = parameterVersion;
+    this->mode = Mode::SPARSE;
+    this->is_valid = true;
+}
+
+
+void gp::kernel::CovFactorization::factorizeLowRank(const Eigen::MatrixXd& U, const double noise, const unsigned long dataVersion, const unsigned long parameterVersion)
+{
+    this->is_valid = false;
+    this->is_alpha_computed = false;
+    this->L.resize(0, 0);
+
+    this->factorizeWoodbury(U, noise);
+    this->n = U.rows();
+    this->dataVersion = dataVersion;
+    this->parameterVersion = parameterVersion;
+    this->mode = Mode::LOWRANK;
+    this->is_valid = true;
+}
+
+
+void gp::kernel::CovFactorization::factorizeIterative(const math::LinearOperator& multiply, const Eigen::MatrixXd& U, const double noise, const IterativeOptions& options,
+                                                      const unsigned long dataVersion, const unsigned long parameterVersion)
+{
+    this->is_valid = false;
+    this->is_alpha_computed = false;
+    this->L.resize(0, 0);
+
+    // the preconditioner U U^T + noise I
+    this->factorizeWoodbury(U, noise);
+    this->multiply = multiply;
+    this->options = options;
+    this->is_logdet_estimated = false;
+    this->n = U.rows();
+    this->dataVersion = dataVersion;
+    this->parameterVersion = parameterVersion;
+    this->mode = Mode::ITERATIVE;
+    this->is_valid = true;
+}
+
+
+bool gp::kernel::CovFactorization::append(const Eigen::MatrixXd& Knew, const unsigned long dataVersion)
+{
+    this->is_alpha_computed = false;
+    if(!this->is_valid){
+        return false;
+    }
+    switch(this->mode){
+    case Mode::SPARSE:
+    case Mode::LOWRANK:
+    case Mode::ITERATIVE:
+        return false;
+    case Mode::DENSE:
+        break;
+    }
+    bool success;
+    if(this->jitter > 0){
+        Eigen::MatrixXd Kjitter = Knew;
+        Kjitter.bottomRows(Knew.cols()).diagonal().array() += this->jitter;
+        success = math::cholAppend(this->L, Kjitter);
+    }
+    else {
+        success = math::cholAppend(this->L, Knew);
+    }
+    if(success){
+        this->n = this->L.rows();
+        this->dataVersion = dataVersion;
+    }
+    return success;
+}
+
+
+void gp::kernel::CovFactorization::remove(const unsigned int index, const unsigned int count, const unsigned long dataVersion)
+{
+    this->is_alpha_computed = false;
+    if(!this->is_valid){
+        return;
+    }
+    switch(this->mode){
+    case Mode::SPARSE:
+    case Mode::LOWRANK:
+    case Mode::ITERATIVE:
+        this->is_valid = false;
+        break;
+    case Mode::DENSE:
+        math::cholDelete(this->L, index, count);
+        this->n = this->L.rows();
+        this->dataVersion = dataVersion;
+        break;
+    }
+}
+
+
+void gp::kernel::CovFactorization::invalidate()
+{
+    this->is_valid = false;
+    this->is_alpha_computed = false;
+}
+
+
+void gp::kernel::CovFactorization::invalidateAlpha()
+{
+    this->is_alpha_computed = false;
+}
+
+
+void gp::kernel::CovFactorization::computeAlpha(const Eigen::Ref<const Eigen::MatrixXd>& Y)
+{
+    this->solve(this->alpha, Y);
+    this->is_alpha_computed = true;
+}
+
+
+const Eigen::MatrixXd& gp::kernel::CovFactorization::getAlpha() const
+{
+    return this->alpha;
+}
+
+
+void gp::kernel::CovFactorization::solve(Eigen::MatrixXd& X, const Eigen::Ref<const Eigen::MatrixXd>& B) const
+{
+    switch(this->mode){
+    case Mode::DENSE:
+        X = this->matrixL().solve(B);
+        this->matrixL().transpose().solveInPlace(X);
+        break;
+    case Mode::SPARSE:
+        X = this->sparseL.solve(B);
+        break;
+    case Mode::LOWRANK:
+        this->solveWoodbury(X, B);
+        break;
+    case Mode::ITERATIVE: {
+        const math::CGResult result = math::conjugateGradients(X, B, this->multiply,
+            [this](Eigen::MatrixXd& Z, const Eigen::Ref<const Eigen::MatrixXd>& R){ this->solveWoodbury(Z, R); },
+            this->options.tolerance, this->options.maxIterations);
+        this->iterations = result.iterations;
+        if(!result.converged){
+            util::exceptions::throwException<util::exceptions::Error>("The conjugate gradients did not converge within the maximum number of iterations.");
+        }
+        break;
+    }
+    }
+}
+
+
+void gp::kernel::CovFactorization::inverse(Eigen::MatrixXd& Kinv) const
+{
+    switch(this->mode){
+    case Mode::DENSE:
+        // solve in place, such that the storage of Kinv is reused
+        Kinv.setIdentity(this->n, this->n);
+        this->matrixL().solveInPlace(Kinv);
+        this->matrixL().transpose().solveInPlace(Kinv);
+        break;
+    case Mode::SPARSE:
+        Kinv.setIdentity(this->n, this->n);
+        Kinv = this->sparseL.solve(Kinv);
+        break;
+    case Mode::LOWRANK: {
+        const Eigen::MatrixXd W = this->LA.triangularView<Eigen::Lower>().solve(this->U.transpose());
+        Kinv.setIdentity(this->n, this->n);
+        Kinv.noalias() -= (1.0/this->lowRankNoise)*W.transpose()*W;
+        Kinv /= this->lowRankNoise;
+        break;
+    }
+    case Mode::ITERATIVE:
+        util::exceptions::throwException<util::exceptions::Error>("The inverse of an iterative factorization is not available.");
+        break;
+    }
+}
+
+
+void gp::kernel::CovFactorization::selectedInverse(Eigen::SparseMatrix<double>& Kinv) const
+{
+    if(this->mode != Mode::SPARSE){
+        util::exceptions::throwException<util::exceptions::Error>("The selected inverse is only available for sparse factorizations.");
+    }
+    // Takahashi recurrence for Z = (L L^T)^-1 on the pattern of L, column by column from the last one:
+    // Z_ij = delta_ij/L_jj^2 - 1/L_jj sum_{k > j} Z_ik L_kj for the rows i >= j of column j.
+    // The rows k > j of column j form a clique in the pattern of L, so all Z_ik it needs are stored.
+    const Eigen::SparseMatrix<double>& L = this->sparseL.matrixL().nestedExpression();
+    Eigen::SparseMatrix<double> Z = L;
+    const int* outer = L.outerIndexPtr();
+    const int* inner = L.innerIndexPtr();
+    const double* l = L.valuePtr();
+    double* z = Z.valuePtr();
+    // Z_ik of the lower triangle, the rows of a column are sorted with the diagonal first
+    auto entry = [&](const int i, const int k){
+        const int* row = std::lower_bound(inner + outer[std::min(i, k)], inner + outer[std::min(i, k) + 1], std::max(i, k));
+        return z[row - inner];
+    };
+    for(Eigen::Index j = L.cols() - 1; j >= 0; --j){
+        const int begin = outer[j];
+        const int end = outer[j+1];
+        const double ljj = l[begin];
+        for(int p = begin + 1; p < end; ++p){
+            double sum = 0.0;
+            for(int q = begin + 1; q < end; ++q){
+                sum += entry(inner[p], inner[q])*l[q];
+            }
+            z[p] = -sum/ljj;
+        }
+        double sum = 0.0;
+        for(int q = begin + 1; q < end; ++q){
+            sum += z[q]*l[q];
+        }
+        z[begin] = 1.0/(ljj*ljj) - sum/ljj;
+    }
+    // A^-1 = P^-1 Z P for the fill-reducing permutation P
+    Kinv = Z.selfadjointView<Eigen::Lower>().twistedBy(this->sparseL.permutationPinv());
+}
+
+
+void gp::kernel::CovFactorization::quadraticForm(Eigen::VectorXd& q, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    switch(this->mode){
+    case Mode::DENSE:
+        q = this->matrixL().solve(X).colwise().squaredNorm().transpose();
+        break;
+    case Mode::SPARSE: {
+        // A = P^T L L^T P for the fill-reducing permutation P
+        Eigen::MatrixXd Y = this->sparseL.permutationP()*X;
+        this->sparseL.matrixL().solveInPlace(Y);
+        q = Y.colwise().squaredNorm().transpose();
+        break;
+    }
+    case Mode::LOWRANK: {
+        const Eigen::MatrixXd W = this->LA.triangularView<Eigen::Lower>().solve(this->U.transpose()*X);
+        q = (X.colwise().squaredNorm() - W.colwise().squaredNorm()/this->lowRankNoise).transpose()/this->lowRankNoise;
+        break;
+    }
+    case Mode::ITERATIVE: {
+        Eigen::MatrixXd S;
+        this->solve(S, X);
+        q = (X.array()*S.array()).colwise().sum().transpose();
+        break;
+    }
+    }
+}
+
+
+double gp::kernel::CovFactorization::logDet() const
+{
+    double value = 0.0;
+    switch(this->mode){
+    case Mode::DENSE:
+        value = math::cholLogDet(this->L);
+        break;
+    case Mode::SPARSE:
+        value = 2.0*this->sparseL.matrixL().nestedExpression().diagonal().array().log().sum();
+        break;
+    case Mode::LOWRANK:
+        // determinant lemma: det(U U^T + s I) = s^n det(I + U^T U/s)
+        value = this->n*std::log(this->lowRankNoise) + math::cholLogDet(this->LA);
+        break;
+    case Mode::ITERATIVE:
+        if(!this->is_logdet_estimated){
+            this->iterativeLogDet = this->estimateLogDet();
+            this->is_logdet_estimated = true;
+        }
+        value = this->iterativeLogDet;
+        break;
+    }
+    return value;
+}
+
+
+const Eigen::MatrixXd& gp::kernel::CovFactorization::getProbeSolves() const
+{
+    if(this->mode != Mode::ITERATIVE){
+        util::exceptions::throwException<util::exceptions::Error>("Probe vectors are only available for iterative factorizations.");
+    }
+    this->logDet();
+    return this->probeSolves;
+}
+
+
+const Eigen::MatrixXd& gp::kernel::CovFactorization::getPreconditionedProbes() const
+{
+    if(this->mode != Mode::ITERATIVE){
+        util::exceptions::throwException<util::exceptions::Error>("Probe vectors are only available for iterative factorizations.");
+    }
+    this->logDet();
+    return this->preconditionedProbes;
+}
+
+
+const Eigen::TriangularView<const Eigen::MatrixXd, Eigen::Lower> gp::kernel::CovFactorization::matrixL() const
+{
+    return this->L.triangularView<Eigen::Lower>();
+}
+
+
+bool gp::kernel::CovFactorization::isValid() const
+{
+    return this->is_valid;
+}
+
+
+gp::kernel::CovFactorization::Mode gp::kernel::CovFactorization::getMode() const
+{
+    return this->mode;
+}
+
+
+bool gp::kernel::CovFactorization::isSparse() const
+{
+    return this->mode == Mode::SPARSE;
+}
+
+
+bool gp::kernel::CovFactorization::isLowRank() const
+{
+    return this->mode == Mode::LOWRANK;
+}
+
+
+const Eigen::MatrixXd& gp::kernel::CovFactorization::getLowRankFactor() const
+{
+    return this->U;
+}
+
+
+bool gp::kernel::CovFactorization::isIterative() const
+{
+    return this->mode == Mode::ITERATIVE;
+}
+
+
+unsigned int gp::kernel::CovFactorization::getIterations() const
+{
+    return this->iterations;
+}
+
+
+bool gp::kernel::CovFactorization::isAlphaComputed() const
+{
+    return this->is_alpha_computed;
+}
+
+
+bool gp::kernel::CovFactorization::isCurrent(const unsigned long dataVersion, const unsigned long parameterVersion) const
+{
+    return this->is_valid && this->dataVersion == dataVersion && this->parameterVersion == parameterVersion;
+}
+
+
+unsigned int gp::kernel::CovFactorization::getN() const
+{
+    return this->n;
+}
+
+
+double gp::kernel::CovFactorization::getJitter() const
+{
+    return this->jitter;
+}
+
+
+void gp::kernel::CovFactorization::setMaxTries(const unsigned int maxTries)
+{
+    this->maxTries = (maxTries > 0) ? maxTries : 1;
+}
+
+
+unsigned int gp::kernel::CovFactorization::getMaxTries() const
+{
+    return this->maxTries;
+}
+
+
+void gp::kernel::CovFactorization::setJitterStrategy(const math::JitterStrategy strategy)
+{
+    this->strategy = strategy;
+}
+
+
+math::JitterStrategy gp::kernel::CovFactorization::getJitterStrategy() const
+{
+    return this->strategy;
+}
+
+
+void gp::kernel::CovFactorization::factorizeWoodbury(const Eigen::MatrixXd& U, const double noise)
+{
+    this->U = U;
+    const double meanDiag = (U.rows() > 0) ? U.squaredNorm()/U.rows() + noise : 0.0;
+    const double scale = (meanDiag > 0) ? meanDiag : 1.0;
+    this->lowRankNoise = std::max(noise, 1e-10*scale);
+    this->jitter = this->lowRankNoise - noise;
+
+    // A = I + U^T U/noise is well conditioned for any rank of U
+    this->LA.setIdentity(U.cols(), U.cols());
+    this->LA.selfadjointView<Eigen::Lower>().rankUpdate(U.transpose(), 1.0/this->lowRankNoise);
+    if(math::cholInplace(this->LA) != this->LA.rows()){
+        util::exceptions::throwException<util::exceptions::Error>("Failed to decompose the low-rank noised covariance matrix.");
+    }
+}
+
+
+void gp::kernel::CovFactorization::solveWoodbury(Eigen::MatrixXd& X, const Eigen::Ref<const Eigen::MatrixXd>& B) const
+{
+    // (U U^T + s I)^-1 = (I - U A^-1 U^T/s)/s
+    Eigen::MatrixXd W = this->U.transpose()*B;
+    this->LA.triangularView<Eigen::Lower>().solveInPlace(W);
+    this->LA.triangularView<Eigen::Lower>().transpose().solveInPlace(W);
+    X = B;
+    X.noalias() -= (1.0/this->lowRankNoise)*this->U*W;
+    X /= this->lowRankNoise;
+}
+
+
+double gp::kernel::CovFactorization::estimateLogDet() const
+{
+    // probe vectors z = U e1 + sqrt(s) e2 ~ N(0, P) for standard normal e1, e2
+    const Eigen::Index nProbes = std::max(this->options.nProbes, 1u);
+    std::mt19937 rng(this->options.seed);
+    std::normal_distribution<double> normal;
+    Eigen::MatrixXd E1(this->U.cols(), nProbes), Z(this->n, nProbes);
+    for(Eigen::Index j = 0; j < nProbes; ++j){
+        for(Eigen::Index i = 0; i < E1.rows(); ++i){
+            E1(i, j) = normal(rng);
+        }
+        for(Eigen::Index i = 0; i < Z.rows(); ++i){
+            Z(i, j) = std::sqrt(this->lowRankNoise)*normal(rng);
+        }
+    }
+    Z.noalias() += this->U*E1;
+
+    Eigen::MatrixXd& X = this->probeSolves;
+    Eigen::MatrixXd& PinvZ = this->preconditionedProbes;
+    const auto Pinv = [this](Eigen::MatrixXd& Y, const Eigen::Ref<const Eigen::MatrixXd>& R){ this->solveWoodbury(Y, R); };
+    const math::CGResult result = math::conjugateGradients(X, Z, this->multiply, Pinv, this->options.tolerance, this->options.maxIterations);
+    this->iterations = result.iterations;
+    if(!result.converged){
+        util::exceptions::throwException<util::exceptions::Error>("The conjugate gradients did not converge within the maximum number of iterations.");
+    }
+    this->solveWoodbury(PinvZ, Z);
+    const Eigen::VectorXd norms = (Z.array()*PinvZ.array()).colwise().sum().transpose();
+
+    // log det(A) = log det(P) + tr(log(P^-1/2 A P^-1/2))
+    double trace = 0.0;
+    const auto log = [](double x){ return std::log(x); };
+    for(Eigen::Index j = 0; j < nProbes; ++j){
+        const Eigen::Index m = result.columnIterations(j);
+        trace += norms(j)*math::lanczosQuadrature(result.alpha.col(j).head(m), result.beta.col(j).head(m), log);
+    }
+    return this->n*std::log(this->lowRankNoise) + math::cholLogDet(this->LA) + trace/nProbes;
+}
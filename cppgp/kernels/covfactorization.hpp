@@ -0,0 +1,406 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+
+#pragma once
+
+#include <functional>
+#include <Eigen/Eigen>
+
+#include <cppgp/math/cg.hpp>
+#include <cppgp/math/cholesky.hpp>
+
+namespace gp::kernel {
+
+/**
+ * Options of the matrix-free factorization, see CovFactorization::factorizeIterative.
+ */
+struct IterativeOptions {
+    double tolerance = 1e-6;                // relative residual norm at which the conjugate gradients stop
+    unsigned int maxIterations = 1000;      // maximum number of conjugate gradient iterations
+    unsigned int preconditionerRank = 50;   // rank of the pivoted Cholesky preconditioner, 0 for the noise only
+    unsigned int nProbes = 20;              // number of probe vectors of the stochastic Lanczos quadrature
+    unsigned int seed = 0;                  // seed of the probe vectors
+};
+
+
+/**
+ * Cache for the Cholesky factorization of the noised covariance matrix \f$ K + \sigma I \f$
+ * and the quantities derived from it.
+ *
+ * The factorization is owned by a GPKernel and shared with all classes that need to solve
+ * with the noised covariance matrix, e.g. the GaussianProcess for predictions and the marginal likelihood.
+ * It is tagged with the versions of the data and the kernel parameters it has been computed for,
+ * such that it is computed only once per change.
+ *
+ * If the matrix is numerically not positive definite, a growing jitter is added to its diagonal, see math::cholJitter.
+ * The jitter is reported by #getJitter and also used for data points that are appended later on.
+ *
+ * Sparse matrices, e.g. of covariance functions with compact support, are factorized by a sparse
+ * Cholesky factorization with fill-reducing ordering instead, see #factorizeSparse. Its memory and time scale
+ * with the number of nonzeros of the factor. Appending and removing data points is not supported for it.
+ *
+ * A low-rank approximation \f$ U U^T + \sigma I \f$ of the noised covariance matrix, e.g. the Nystrom approximation,
+ * is factorized by #factorizeLowRank instead. Solves and the determinant follow from the Woodbury identity and the
+ * matrix determinant lemma with the Cholesky factor of the m x m matrix \f$ I + U^T U/\sigma \f$ in O(n m^2).
+ * Appending and removing data points is not supported for it either.
+ *
+ * Without storing the matrix, the noised covariance matrix is represented by its product with vectors, which is
+ * computed on the fly, see #factorizeIterative. Solves use preconditioned conjugate gradients, the log determinant
+ * is estimated by stochastic Lanczos quadrature. The memory is O(n (r + k)) for the preconditioner rank r
+ * and k right-hand sides.
+ */
+class CovFactorization {
+
+public:
+    /**
+     * The representation of the noised covariance matrix, set by the method that computed the factorization:
+     * - DENSE: Dense Cholesky factor, see #factorize.
+     * - SPARSE: Sparse Cholesky factor, see #factorizeSparse.
+     * - LOWRANK: Low-rank factor and the Woodbury identity, see #factorizeLowRank.
+     * - ITERATIVE: Products with the matrix and conjugate gradients, see #factorizeIterative.
+     */
+    enum class Mode {DENSE, SPARSE, LOWRANK, ITERATIVE};
+
+    /**
+     * Create an empty, invalid factorization.
+     */
+    CovFactorization();
+
+    /*
+    ********* update the factorization *********
+    */
+
+    /**
+     * Compute the factorization from scratch.
+     * The matrix is assembled by the given function into the internal storage and factorized in place,
+     * the storage is reused as long as the size does not change.
+     * If the factorization fails, a jitter is added to the diagonal for at most #getMaxTries tries,
+     * following the strategy set by #setJitterStrategy.
+     * Throws an exception if all tries fail.
+     *
+     * @param assemble Function that writes the noised covariance matrix into the given matrix.
+     * @param dataVersion The version of the data the matrix is based on.
+     * @param parameterVersion The version of the kernel parameters the matrix is based on.
+     */
+    void factorize(const std::function<void(Eigen::MatrixXd&)>& assemble, const unsigned long dataVersion, const unsigned long parameterVersion);
+
+    /**
+     * Compute the factorization of a sparse matrix from scratch with a simplicial Cholesky factorization.
+     * The matrix is reordered to reduce the fill-in of the factor. If the factorization fails, a jitter is added
+     * to the diagonal for at most #getMaxTries tries, the jitter strategy is always math::JitterStrategy::RESTART.
+     * Throws an exception if all tries fail.
+     *
+     * @param assemble Function that writes the sparse noised covariance matrix into the given matrix.
+     * @param dataVersion The version of the data the matrix is based on.
+     * @param parameterVersion The version of the kernel parameters the matrix is based on.
+     */
+    void factorizeSparse(const std::function<void(Eigen::SparseMatrix<double>&)>& assemble, const unsigned long dataVersion, const unsigned long parameterVersion);
+
+    /**
+     * Compute the factorization of the low-rank matrix \f$ U U^T + \sigma I \f$ from scratch.
+     * If the noise is too small to keep the matrix well conditioned, it is raised to a jitter of 1e-10 times
+     * the mean of the diagonal, see #getJitter.
+     * Throws an exception if the factorization fails.
+     *
+     * @param U The low-rank factor, size [n, m]. It is stored by the factorization.
+     * @param noise The noise \f$ \sigma \f$.
+     * @param dataVersion The version of the data the matrix is based on.
+     * @param parameterVersion The version of the kernel parameters the matrix is based on.
+     */
+    void factorizeLowRank(const Eigen::MatrixXd& U, const double noise, const unsigned long dataVersion, const unsigned long parameterVersion);
+
+    /**
+     * Set up the matrix-free representation of the noised covariance matrix \f$ A = K + \sigma I \f$.
+     * Solves with A are computed by preconditioned conjugate gradients with all right-hand sides in one batch,
+     * see math::conjugateGradients. The preconditioner is the low-rank matrix \f$ U U^T + \sigma I \f$,
+     * e.g. from a partial pivoted Cholesky factorization of K, which is inverted by the Woodbury identity.
+     * The log determinant is estimated lazily by stochastic Lanczos quadrature
+     * \f[
+     * \log\det(A) \approx \log\det(P) + \frac{1}{t} \sum_{i=1}^t (z_i^T P^{-1} z_i) e_1^T \log(T_i) e_1
+     * \f]
+     * with t probe vectors \f$ z_i \sim N(0, P) \f$ and the Lanczos tridiagonal matrices \f$ T_i \f$ of their
+     * conjugate gradient runs, see math::lanczosQuadrature. The estimate is deterministic for a fixed seed.
+     *
+     * @param multiply Computes the product of A with a block of vectors.
+     * @param U The low-rank factor of the preconditioner, size [n, r]. It is stored by the factorization.
+     * @param noise The noise \f$ \sigma \f$.
+     * @param options The tolerance of the conjugate gradients and the options of the log determinant.
+     * @param dataVersion The version of the data the matrix is based on.
+     * @param parameterVersion The version of the kernel parameters the matrix is based on.
+     */
+    void factorizeIterative(const math::LinearOperator& multiply, const Eigen::MatrixXd& U, const double noise, const IterativeOptions& options,
+                            const unsigned long dataVersion, const unsigned long parameterVersion);
+
+    /**
+     * Extend the factorization by new data points, see math::cholAppend.
+     * The current jitter is added to the diagonal of the new points.
+     *
+     * @param Knew The new columns of the noised covariance matrix, size [getN()+k, k].
+     * @param dataVersion The version of the data including the new points.
+     * @return True if the factorization has been extended, false if it needs to be recomputed, e.g. if it is not dense.
+     */
+    bool append(const Eigen::MatrixXd& Knew, const unsigned long dataVersion);
+
+    /**
+     * Remove data points from the factorization, see math::cholDelete.
+     *
+     * @param index The index of the first data point to remove.
+     * @param count The number of data points to remove.
+     * @param dataVersion The version of the data without the removed points.
+     */
+    void remove(const unsigned int index, const unsigned int count, const unsigned long dataVersion);
+
+    /**
+     * Mark the factorization as invalid, e.g. after the kernel parameters have changed.
+     */
+    void invalidate();
+
+    /**
+     * Mark alpha as outdated, e.g. after the targets or their normalization have changed.
+     */
+    void invalidateAlpha();
+
+    /**
+     * Compute and store the product of the inverse noised covariance matrix with the given targets.
+     *
+     * @param Y The (normalized) target observations, size [getN(), dimY].
+     */
+    void computeAlpha(const Eigen::Ref<const Eigen::MatrixXd>& Y);
+
+    /*
+    ********* use the factorization *********
+    */
+
+    /**
+     * Get the product of the inverse noised covariance matrix and the targets, see #computeAlpha.
+     *
+     * @return alpha, size [getN(), dimY].
+     */
+    const Eigen::MatrixXd& getAlpha() const;
+
+    /**
+     * Solve the system \f$ (K + \sigma I) X = B \f$.
+     * An iterative factorization throws an error if the conjugate gradients do not converge within the maximum
+     * number of iterations, see IterativeOptions.
+     *
+     * @param X Returns the solution, size [getN(), k].
+     * @param B The right-hand side, size [getN(), k].
+     */
+    void solve(Eigen::MatrixXd& X, const Eigen::Ref<const Eigen::MatrixXd>& B) const;
+
+    /**
+     * Compute the inverse of the noised covariance matrix from the factorization in O(n^3).
+     * The storage of Kinv is reused if it has the right size already.
+     * An iterative factorization throws an error, it never stores n x n matrices, see #getProbeSolves instead.
+     *
+     * @param Kinv Returns \f$ (K + \sigma I)^{-1} \f$, size [getN(), getN()].
+     */
+    void inverse(Eigen::MatrixXd& Kinv) const;
+
+    /**
+     * Compute the entries of the inverse of the noised covariance matrix on the pattern of the Cholesky factor of a
+     * sparse factorization, see #isSparse. The pattern includes the pattern of the matrix, the entries are computed
+     * by the Takahashi recurrence from the factor, such that the time and memory scale with the number of nonzeros
+     * of the factor instead of n^2. The other entries of the inverse are not zero in general, but not computed.
+     * Throws an exception for factorizations that are not sparse.
+     *
+     * @param Kinv Returns the selected entries of \f$ (K + \sigma I)^{-1} \f$, size [getN(), getN()].
+     */
+    void selectedInverse(Eigen::SparseMatrix<double>& Kinv) const;
+
+    /**
+     * Compute the quadratic forms \f$ x_j^T (K + \sigma I)^{-1} x_j \f$ for all columns \f$ x_j \f$ of X.
+     *
+     * @param q Returns the quadratic forms, size [k].
+     * @param X The vectors, size [getN(), k].
+     */
+    void quadraticForm(Eigen::VectorXd& q, const Eigen::Ref<const Eigen::MatrixXd>& X) const;
+
+    /**
+     * Compute the logarithm of the determinant of the noised covariance matrix.
+     *
+     * @return log(det(K + sigma I))
+     */
+    double logDet() const;
+
+    /**
+     * Get the solutions \f$ A^{-1} z_i \f$ for the probe vectors of the log determinant estimate of an iterative
+     * factorization, see #factorizeIterative. Together with #getPreconditionedProbes, they estimate traces
+     * \f[
+     * \mathrm{tr}(A^{-1} M) \approx \frac{1}{t} \sum_{i=1}^t (P^{-1} z_i)^T M (A^{-1} z_i)
+     * \f]
+     * since \f$ E[z_i z_i^T] = P \f$. The log determinant is estimated if it has not been yet.
+     *
+     * @return The solutions, size [getN(), t].
+     */
+    const Eigen::MatrixXd& getProbeSolves() const;
+
+    /**
+     * Get the products \f$ P^{-1} z_i \f$ of the inverse preconditioner with the probe vectors, see #getProbeSolves.
+     *
+     * @return The preconditioned probe vectors, size [getN(), t].
+     */
+    const Eigen::MatrixXd& getPreconditionedProbes() const;
+
+    /**
+     * Get the lower Cholesky factor of a dense factorization, see #isSparse, #isLowRank and #isIterative.
+     *
+     * @return View on the lower triangular factor, size [getN(), getN()].
+     */
+    const Eigen::TriangularView<const Eigen::MatrixXd, Eigen::Lower> matrixL() const;
+
+    /*
+    ********* getter and setter *********
+    */
+
+    /**
+     * @return True, if the factorization has been computed and not been invalidated since.
+     */
+    bool isValid() const;
+
+    /**
+     * @return The representation of the last factorization, DENSE for an empty factorization.
+     */
+    Mode getMode() const;
+
+    /**
+     * @return True, if the factorization has been computed by #factorizeSparse.
+     */
+    bool isSparse() const;
+
+    /**
+     * @return True, if the factorization has been computed by #factorizeLowRank.
+     */
+    bool isLowRank() const;
+
+    /**
+     * Get the factor U of a low-rank factorization, see #factorizeLowRank.
+     *
+     * @return The low-rank factor, size [getN(), m].
+     */
+    const Eigen::MatrixXd& getLowRankFactor() const;
+
+    /**
+     * @return True, if the factorization has been set up by #factorizeIterative.
+     */
+    bool isIterative() const;
+
+    /**
+     * @return The number of conjugate gradient iterations of the last solve of an iterative factorization.
+     */
+    unsigned int getIterations() const;
+
+    /**
+     * @return True, if alpha is available for the current factorization.
+     */
+    bool isAlphaComputed() const;
+
+    /**
+     * Check whether the factorization is up to date.
+     *
+     * @param dataVersion The current version of the data.
+     * @param parameterVersion The current version of the kernel parameters.
+     * @return True, if the factorization is valid and has been computed for the given versions.
+     *         Data points that have been appended are included only if #getN matches the size of the data.
+     */
+    bool isCurrent(const unsigned long dataVersion, const unsigned long parameterVersion) const;
+
+    /**
+     * @return The number of data points covered by the factorization.
+     */
+    unsigned int getN() const;
+
+    /**
+     * @return The jitter that has been added to the diagonal in addition to the kernel noise.
+     *         With math::JitterStrategy::RESUME, it has been added to the trailing part of the diagonal only.
+     */
+    double getJitter() const;
+
+    /**
+     * Set the maximum number of tries of the factorization, see #factorize. A value of 1 disables the jitter.
+     *
+     * @param maxTries The maximum number of tries, at least 1.
+     */
+    void setMaxTries(const unsigned int maxTries);
+
+    /**
+     * @return The maximum number of tries of the factorization.
+     */
+    unsigned int getMaxTries() const;
+
+    /**
+     * Set the strategy for the retries of the factorization, see math::JitterStrategy.
+     *
+     * @param strategy The new strategy.
+     */
+    void setJitterStrategy(const math::JitterStrategy strategy);
+
+    /**
+     * @return The strategy for the retries of the factorization.
+     */
+    math::JitterStrategy getJitterStrategy() const;
+
+private:
+    /**
+     * Compute the Cholesky factor of I + U^T U/noise for the Woodbury identity.
+     */
+    void factorizeWoodbury(const Eigen::MatrixXd& U, const double noise);
+
+    /**
+     * Solve with U U^T + lowRankNoise I by the Woodbury identity.
+     */
+    void solveWoodbury(Eigen::MatrixXd& X, const Eigen::Ref<const Eigen::MatrixXd>& B) const;
+
+    /**
+     * Estimate the log determinant of an iterative factorization, see #factorizeIterative.
+     */
+    double estimateLogDet() const;
+
+    Eigen::MatrixXd L; // lower triangle holds the Cholesky factor of the first n data points
+    Eigen::VectorXd diag; // workspace for the jitter retries
+    Eigen::SimplicialLLT<Eigen::SparseMatrix<double>> sparseL; // factorization of sparse matrices
+    Eigen::MatrixXd U; // low-rank factor of low-rank matrices
+    Eigen::MatrixXd LA; // lower triangle holds the Cholesky factor of I + U^T U/lowRankNoise
+    double lowRankNoise; // noise including the jitter of low-rank matrices
+    math::LinearOperator multiply; // product with the noised covariance matrix of iterative factorizations
+    IterativeOptions options;
+    mutable double iterativeLogDet; // cached estimate of the log determinant
+    mutable bool is_logdet_estimated;
+    mutable Eigen::MatrixXd probeSolves; // A^-1 z_i of the probe vectors of the log determinant estimate
+    mutable Eigen::MatrixXd preconditionedProbes; // P^-1 z_i of the probe vectors
+    mutable unsigned int iterations; // conjugate gradient iterations of the last solve
+    Eigen::MatrixXd alpha;
+    unsigned int n;
+    double jitter;
+    unsigned int maxTries;
+    math::JitterStrategy strategy;
+    unsigned long dataVersion;
+    unsigned long parameterVersion;
+    Mode mode;
+    bool is_valid;
+    bool is_alpha_computed;
+};
+
+} // namespace gp::kernel
@@ -1,36 +1,270 @@
 #include <cppgp/kernels/covfun.hpp>
 #include "covfun.hpp"
+#include <cppgp/util/exceptions.hpp>
+#include <cppgp/util/threadpool.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    const Eigen::Index defaultParallelTileSize = 256;
+
+    /**
+     * Disables the input caches while the tiles are evaluated concurrently.
+     */
+    class SuspendInputVersion {
+    public:
+        SuspendInputVersion(bool& hasInputVersion) : hasInputVersion(hasInputVersion), previous(hasInputVersion)
+        {
+            hasInputVersion = false;
+        }
+        ~SuspendInputVersion()
+        {
+            hasInputVersion = previous;
+        }
+    private:
+        bool& hasInputVersion;
+        const bool previous;
+    };
+}
 
 
 gp::kernel::CovarianceFunction::CovarianceFunction():
-    parameters(0)
+    parameters(0),
+    nThreads(1),
+    tileSize(0),
+    hasInputVersion(false),
+    inputVersion(0)
 {}
 
 gp::kernel::CovarianceFunction::CovarianceFunction(const Eigen::VectorXd &params):
-    parameters(params)
+    parameters(params),
+    nThreads(1),
+    tileSize(0),
+    hasInputVersion(false),
+    inputVersion(0)
 {}
 
 gp::kernel::CovarianceFunction::~CovarianceFunction()
 {}
 
-void gp::kernel::CovarianceFunction::K(Eigen::MatrixXd &K, const Eigen::MatrixXd &X)
+void gp::kernel::CovarianceFunction::K(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X)
+{
+    const Eigen::Index b = this->effectiveTileSize();
+    const Eigen::Index n = X.rows();
+    if(b == 0 || n <= b){
+        this->covariancefunction(K, X);
+        return;
+    }
+    // tiles of the lower triangle, the diagonal tiles use the symmetric covariance function
+    const Eigen::Index nb = (n + b - 1)/b;
+    std::vector<std::pair<Eigen::Index, Eigen::Index>> tiles;
+    tiles.reserve(nb*(nb+1)/2);
+    for(Eigen::Index j = 0; j < nb; ++j){
+        for(Eigen::Index i = j; i < nb; ++i){
+            tiles.emplace_back(i*b, j*b);
+        }
+    }
+    K.resize(n, n);
+    SuspendInputVersion suspend(this->hasInputVersion);
+    this->forEachTile(tiles.size(), [&](std::size_t t){
+        const Eigen::Index i = tiles[t].first;
+        const Eigen::Index j = tiles[t].second;
+        const Eigen::Index bi = std::min(b, n-i);
+        const Eigen::Index bj = std::min(b, n-j);
+        Eigen::MatrixXd tile;
+        if(i == j){
+            this->covariancefunction(tile, X.middleRows(i, bi));
+            K.block(i, j, bi, bj) = tile;
+        }
+        else {
+            this->covariancefunction(tile, X.middleRows(i, bi), X.middleRows(j, bj));
+            K.block(i, j, bi, bj) = tile;
+            K.block(j, i, bj, bi) = tile.transpose();
+        }
+    });
+}
+
+void gp::kernel::CovarianceFunction::K(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X1, const Eigen::Ref<const Eigen::MatrixXd> &X2)
+{
+    const Eigen::Index b = this->effectiveTileSize();
+    const Eigen::Index n1 = X1.rows();
+    const Eigen::Index n2 = X2.rows();
+    if(b == 0 || (n1 <= b && n2 <= b)){
+        this->covariancefunction(K, X1, X2);
+        return;
+    }
+    if(X1.cols() != X2.cols()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Data dimension does not match dimension of centres");
+    }
+    K.resize(n1, n2);
+    SuspendInputVersion suspend(this->hasInputVersion);
+    this->forEachCrossTile(n1, n2, b, [&](Eigen::Index i, Eigen::Index j, Eigen::Index bi, Eigen::Index bj){
+        Eigen::MatrixXd tile;
+        this->covariancefunction(tile, X1.middleRows(i, bi), X2.middleRows(j, bj));
+        K.block(i, j, bi, bj) = tile;
+    });
+}
+
+void gp::kernel::CovarianceFunction::K(Eigen::MatrixXf &K, const Eigen::Ref<const Eigen::MatrixXf> &X1, const Eigen::Ref<const Eigen::MatrixXf> &X2)
 {
-    this->covariancefunction(K, X, X);
+    const Eigen::Index b = this->effectiveTileSize();
+    const Eigen::Index n1 = X1.rows();
+    const Eigen::Index n2 = X2.rows();
+    if(X1.cols() != X2.cols()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Data dimension does not match dimension of centres");
+    }
+    if(b == 0 || (n1 <= b && n2 <= b)){
+        this->covariancefunctionSingle(K, X1, X2);
+        return;
+    }
+    K.resize(n1, n2);
+    SuspendInputVersion suspend(this->hasInputVersion);
+    this->forEachCrossTile(n1, n2, b, [&](Eigen::Index i, Eigen::Index j, Eigen::Index bi, Eigen::Index bj){
+        Eigen::MatrixXf tile;
+        this->covariancefunctionSingle(tile, X1.middleRows(i, bi), X2.middleRows(j, bj));
+        K.block(i, j, bi, bj) = tile;
+    });
+}
+
+void gp::kernel::CovarianceFunction::multiplyK(Eigen::MatrixXd& R, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::Ref<const Eigen::MatrixXd>& V)
+{
+    if(V.rows() != X.rows()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Size of the matrix does not match the input data");
+    }
+    const Eigen::Index b = (this->effectiveTileSize() > 0) ? this->effectiveTileSize() : defaultParallelTileSize;
+    const Eigen::Index n = X.rows();
+    const Eigen::Index nb = (n + b - 1)/b;
+    R.setZero(n, V.cols());
+    SuspendInputVersion suspend(this->hasInputVersion);
+    this->forEachTile(nb, [&](std::size_t t){
+        // the rows i, ..., i+bi-1 of the product are owned by this task
+        const Eigen::Index i = t*b;
+        const Eigen::Index bi = std::min(b, n-i);
+        Eigen::MatrixXd tile;
+        for(Eigen::Index j = 0; j < n; j += b){
+            const Eigen::Index bj = std::min(b, n-j);
+            if(i == j){
+                this->covariancefunction(tile, X.middleRows(i, bi));
+            }
+            else {
+                this->covariancefunction(tile, X.middleRows(i, bi), X.middleRows(j, bj));
+            }
+            R.middleRows(i, bi).noalias() += tile*V.middleRows(j, bj);
+        }
+    });
+}
+
+void gp::kernel::CovarianceFunction::sparseK(Eigen::SparseMatrix<double>& K, const Eigen::Ref<const Eigen::MatrixXd>& X)
+{
+    this->covariancefunctionSparse(K, X);
 }
 
-void gp::kernel::CovarianceFunction::K(Eigen::MatrixXd &K, const Eigen::MatrixXd &X1, const Eigen::MatrixXd &X2)
+bool gp::kernel::CovarianceFunction::hasCompactSupport() const
 {
-    this->covariancefunction(K, X1, X2);
+    return false;
 }
 
-void gp::kernel::CovarianceFunction::diagK(Eigen::VectorXd &K, const Eigen::MatrixXd &X)
+bool gp::kernel::CovarianceFunction::isDistanceBased() const
+{
+    return false;
+}
+
+void gp::kernel::CovarianceFunction::KFromSquaredDistances(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& D2, const Eigen::Index dim)
+{
+    this->covariancefunctionFromSquaredDistances(K, D2, dim);
+}
+
+void gp::kernel::CovarianceFunction::diagK(Eigen::VectorXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X)
 {
     this->covariancefunctionDiag(K, X);
 }
 
-void gp::kernel::CovarianceFunction::dK_dP()
+void gp::kernel::CovarianceFunction::dK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X)
 {
-    //TODO
+    this->covariancefunctionDK_dP(dK, X);
+}
+
+void gp::kernel::CovarianceFunction::gradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad)
+{
+    if(covGrad.rows() != X.rows() || covGrad.cols() != X.rows()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Size of the covariance gradient does not match the input data");
+    }
+    this->covariancefunctionGradient(g, X, covGrad);
+}
+
+void gp::kernel::CovarianceFunction::gradientLowRank(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::Ref<const Eigen::MatrixXd>& A, const Eigen::Ref<const Eigen::MatrixXd>& B)
+{
+    if(A.rows() != X.rows() || B.rows() != X.rows() || A.cols() != B.cols()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Size of the covariance gradient does not match the input data");
+    }
+    const Eigen::Index b = (this->effectiveTileSize() > 0) ? this->effectiveTileSize() : defaultParallelTileSize;
+    SuspendInputVersion suspend(this->hasInputVersion);
+    this->tiledGradient(g, X, b,
+        [&](Eigen::MatrixXd& C, Eigen::Index i, Eigen::Index j, Eigen::Index bi, Eigen::Index bj){
+            C.noalias() = A.middleRows(i, bi)*B.middleRows(j, bj).transpose();
+        },
+        [this](Eigen::VectorXd& gt, const Eigen::Ref<const Eigen::MatrixXd>& Xt, const Eigen::MatrixXd& C){
+            this->covariancefunctionGradient(gt, Xt, C);
+        }, true);
+}
+
+void gp::kernel::CovarianceFunction::gradientSparse(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::SparseMatrix<double>& covGrad)
+{
+    if(covGrad.rows() != X.rows() || covGrad.cols() != X.rows()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Size of the covariance gradient does not match the input data");
+    }
+    this->covariancefunctionGradientSparse(g, X, covGrad);
+}
+
+void gp::kernel::CovarianceFunction::tiledGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::Index b,
+                                                   const std::function<void(Eigen::MatrixXd&, Eigen::Index, Eigen::Index, Eigen::Index, Eigen::Index)>& covGradBlock,
+                                                   const std::function<void(Eigen::VectorXd&, const Eigen::Ref<const Eigen::MatrixXd>&, const Eigen::MatrixXd&)>& tileGradient,
+                                                   const bool parallel) const
+{
+    const Eigen::Index n = X.rows();
+    const Eigen::Index nb = (n + b - 1)/b;
+    std::vector<std::pair<Eigen::Index, Eigen::Index>> tiles;
+    tiles.reserve(nb*(nb+1)/2);
+    for(Eigen::Index j = 0; j < nb; ++j){
+        for(Eigen::Index i = j; i < nb; ++i){
+            tiles.emplace_back(i*b, j*b);
+        }
+    }
+    // one gradient per tile, summed in a fixed order such that the result does not depend on the number of threads
+    std::vector<Eigen::VectorXd> partial(tiles.size());
+    auto tile = [&](std::size_t t){
+        const Eigen::Index i = tiles[t].first;
+        const Eigen::Index j = tiles[t].second;
+        const Eigen::Index bi = std::min(b, n-i);
+        const Eigen::Index bj = std::min(b, n-j);
+        Eigen::MatrixXd C;
+        covGradBlock(C, i, j, bi, bj);
+        if(i == j){
+            tileGradient(partial[t], X.middleRows(i, bi), C);
+            return;
+        }
+        // the tiles (i, j) and (j, i) are the off-diagonal blocks of the covariance matrix of both row blocks
+        Eigen::MatrixXd Xij(bi + bj, X.cols());
+        Xij << X.middleRows(i, bi), X.middleRows(j, bj);
+        Eigen::MatrixXd covGrad = Eigen::MatrixXd::Zero(bi + bj, bi + bj);
+        covGrad.topRightCorner(bi, bj) = C;
+        covGradBlock(C, j, i, bj, bi);
+        covGrad.bottomLeftCorner(bj, bi) = C;
+        tileGradient(partial[t], Xij, covGrad);
+    };
+    if(parallel){
+        this->forEachTile(tiles.size(), tile);
+    }
+    else {
+        for(std::size_t t = 0; t < tiles.size(); ++t){
+            tile(t);
+        }
+    }
+    g.setZero(this->nParameters());
+    for(const Eigen::VectorXd& p : partial){
+        g += p;
+    }
 }
 
 void gp::kernel::CovarianceFunction::dK_dX()
@@ -52,6 +286,7 @@ void gp::kernel::CovarianceFunction::setParameters(const Eigen::VectorXd& params
 {
     const unsigned int n = this->nParameters();
     this->parameters = params(Eigen::seq(index, index+n-1));
+    this->updatedParameters_trigger();
 }
 
 void gp::kernel::CovarianceFunction::getParameters(Eigen::VectorXd& params, const unsigned int index) const
@@ -75,3 +310,127 @@ Eigen::VectorXd gp::kernel::CovarianceFunction::getParameters() const
 {
     return this->parameters;
 }
+
+void gp::kernel::CovarianceFunction::setNumThreads(const unsigned int nThreads)
+{
+    this->nThreads = nThreads;
+    this->pool = (nThreads == 1) ? nullptr : std::make_shared<util::ThreadPool>(nThreads);
+}
+
+unsigned int gp::kernel::CovarianceFunction::getNumThreads() const
+{
+    return this->nThreads;
+}
+
+void gp::kernel::CovarianceFunction::setTileSize(const Eigen::Index tileSize)
+{
+    if(tileSize < 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The tile size must not be negative");
+    }
+    this->tileSize = tileSize;
+}
+
+Eigen::Index gp::kernel::CovarianceFunction::getTileSize() const
+{
+    return this->tileSize;
+}
+
+void gp::kernel::CovarianceFunction::setInputVersion(const unsigned long version)
+{
+    this->hasInputVersion = true;
+    this->inputVersion = version;
+}
+
+void gp::kernel::CovarianceFunction::clearInputVersion()
+{
+    this->hasInputVersion = false;
+}
+
+void gp::kernel::CovarianceFunction::attachDistanceCache(const std::shared_ptr<DistanceCache>& /*cache*/)
+{}
+
+bool gp::kernel::CovarianceFunction::isCached(const InputKey& key, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    return this->hasInputVersion && key.version == this->inputVersion && key.data == X.data()
+        && key.rows == X.rows() && key.cols == X.cols() && key.outerStride == X.outerStride();
+}
+
+void gp::kernel::CovarianceFunction::updatedParameters_trigger()
+{}
+
+bool gp::kernel::CovarianceFunction::makeInputKey(InputKey& key, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    if(!this->hasInputVersion){
+        return false;
+    }
+    key = InputKey{X.data(), X.rows(), X.cols(), X.outerStride(), this->inputVersion};
+    return true;
+}
+
+Eigen::Index gp::kernel::CovarianceFunction::effectiveTileSize() const
+{
+    if(this->tileSize == 0 && this->nThreads != 1){
+        return defaultParallelTileSize;
+    }
+    return this->tileSize;
+}
+
+void gp::kernel::CovarianceFunction::forEachTile(const std::size_t nTiles, const std::function<void(std::size_t)>& tile) const
+{
+    if(!this->pool || nTiles <= 1){
+        for(std::size_t t = 0; t < nTiles; ++t){
+            tile(t);
+        }
+        return;
+    }
+    this->pool->parallelFor(nTiles, tile);
+}
+
+void gp::kernel::CovarianceFunction::forEachCrossTile(const Eigen::Index n1, const Eigen::Index n2, const Eigen::Index b,
+                                                      const std::function<void(Eigen::Index, Eigen::Index, Eigen::Index, Eigen::Index)>& tile) const
+{
+    const Eigen::Index nb1 = (n1 + b - 1)/b;
+    const Eigen::Index nb2 = (n2 + b - 1)/b;
+    this->forEachTile(nb1*nb2, [&](std::size_t t){
+        const Eigen::Index i = (t % nb1)*b;
+        const Eigen::Index j = (t / nb1)*b;
+        tile(i, j, std::min(b, n1-i), std::min(b, n2-j));
+    });
+}
+
+void gp::kernel::CovarianceFunction::covariancefunctionSingle(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X1, const Eigen::Ref<const Eigen::MatrixXf>& X2) const
+{
+    Eigen::MatrixXd Kdouble;
+    this->covariancefunction(Kdouble, X1.cast<double>(), X2.cast<double>());
+    K = Kdouble.cast<float>();
+}
+
+void gp::kernel::CovarianceFunction::covariancefunctionSparse(Eigen::SparseMatrix<double>& /*K*/, const Eigen::Ref<const Eigen::MatrixXd>& /*X*/) const
+{
+    util::exceptions::throwException<util::exceptions::Error>("Sparse covariance matrices are not supported by this covariance function.");
+}
+
+void gp::kernel::CovarianceFunction::covariancefunctionFromSquaredDistances(Eigen::MatrixXd& /*K*/, const Eigen::Ref<const Eigen::MatrixXd>& /*D2*/, const Eigen::Index /*dim*/) const
+{
+    util::exceptions::throwException<util::exceptions::Error>("Covariances from distances are not supported by this covariance function.");
+}
+
+void gp::kernel::CovarianceFunction::covariancefunctionGradientSparse(Eigen::VectorXd& /*g*/, const Eigen::Ref<const Eigen::MatrixXd>& /*X*/, const Eigen::SparseMatrix<double>& /*covGrad*/) const
+{
+    util::exceptions::throwException<util::exceptions::Error>("Sparse covariance gradients are not supported by this covariance function.");
+}
+
+void gp::kernel::CovarianceFunction::covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& /*dK*/, const Eigen::Ref<const Eigen::MatrixXd>& /*X*/) const
+{
+    util::exceptions::throwException<util::exceptions::Error>("Parameter derivatives are not implemented for this covariance function.");
+}
+
+void gp::kernel::CovarianceFunction::covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const
+{
+    std::vector<Eigen::MatrixXd> dK;
+    this->covariancefunctionDK_dP(dK, X);
+    g.resize(dK.size());
+    for(size_t i = 0; i < dK.size(); ++i){
+        g(i) = (covGrad.array()*dK[i].array()).sum();
+    }
+}
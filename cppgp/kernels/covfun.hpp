@@ -24,13 +24,32 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <vector>
 #include <autodiff/forward/real/eigen.hpp>
 
 #include <cppgp/util/prototype.hpp>
+#include <cppgp/util/threadpool.hpp>
 
 namespace gp::kernel {
 
+/**
+ * Identifies the input data of a cached precomputation: the address and size of the data
+ * and the version of its content, see CovarianceFunction::setInputVersion.
+ */
+struct InputKey {
+    const double* data = nullptr;
+    Eigen::Index rows = -1;
+    Eigen::Index cols = -1;
+    Eigen::Index outerStride = -1;
+    unsigned long version = 0;
+
+    bool operator==(const InputKey& other) const = default;
+};
+
+class DistanceCache;
+
 /**
  * The CovarianceFunction class is an abstract superclass for all CovarianceFunction classes
  * that implement kernel functions. These kernel functions constitute a kernel class.
@@ -66,21 +85,79 @@ public:
     /**
      * Compute the covariance matrix (Gram matrix) for this covariance function
      * using the given input data.
+     * The input data is passed as Eigen::Ref, such that views on the data
+     * (e.g. GPData::getXView()) are used without copying.
+     * If tiled assembly is enabled (see #setTileSize and #setNumThreads), only the tiles
+     * of the lower triangle are computed and mirrored.
      *
      * @param K Returns the computed covariance matrix, size [n, n]
      * @param X The input data to compute the covariance matrix, size [n, k]
      */
-    void K(Eigen::MatrixXd& K, const Eigen::MatrixXd& X);
+    void K(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X);
 
     /**
      * Compute the cross covariance (Gram matrix) for this covariance function
-     * using the given input data.
+     * using the given input data, tile by tile if tiled assembly is enabled.
+     *
+     * @param K Returns the computed covariance matrix, size [n1, n2]
+     * @param X1 Input data to compute the covariance matrix, size [n1, k]
+     * @param X2 Input data to compute the covariance matrix, size [n2, k]
+     */
+    void K(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2);
+
+    /**
+     * Compute the cross covariance in single precision, e.g. for predictions with many data points,
+     * where it halves the memory traffic. Tiled assembly is used as for the double precision version.
      *
      * @param K Returns the computed covariance matrix, size [n1, n2]
      * @param X1 Input data to compute the covariance matrix, size [n1, k]
      * @param X2 Input data to compute the covariance matrix, size [n2, k]
      */
-    void K(Eigen::MatrixXd& K, const Eigen::MatrixXd& X1, const Eigen::MatrixXd& X2);
+    void K(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X1, const Eigen::Ref<const Eigen::MatrixXf>& X2);
+
+    /**
+     * Compute the covariance matrix as a sparse matrix, for covariance functions with compact support,
+     * see #hasCompactSupport. Only the entries within the support are stored, such that the memory
+     * scales with the number of nonzeros instead of n^2.
+     *
+     * @param K Returns the computed covariance matrix, size [n, n]
+     * @param X The input data to compute the covariance matrix, size [n, k]
+     */
+    void sparseK(Eigen::SparseMatrix<double>& K, const Eigen::Ref<const Eigen::MatrixXd>& X);
+
+    /**
+     * Compute the product of the covariance matrix with a matrix without storing the covariance matrix.
+     * The covariance matrix is computed on the fly in square tiles of rows and columns (see #setTileSize,
+     * a tile size of 0 uses the default of 256), each block of rows of the product is accumulated by one thread.
+     * The memory is O(b^2) per thread for the tile size b, the work is that of #K.
+     *
+     * @param R Returns the product K V, size [n, k]
+     * @param X The input data to compute the covariance matrix, size [n, d]
+     * @param V The matrix to multiply, size [n, k]
+     */
+    void multiplyK(Eigen::MatrixXd& R, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::Ref<const Eigen::MatrixXd>& V);
+
+    /**
+     * @return True, if the covariance function has compact support and computes sparse covariance matrices, see #sparseK.
+     */
+    virtual bool hasCompactSupport() const;
+
+    /**
+     * @return True, if the covariance function depends on the Euclidean distance between the inputs only,
+     *         such that it can compute covariances from given distances, see #KFromSquaredDistances.
+     */
+    virtual bool isDistanceBased() const;
+
+    /**
+     * Compute covariances from the squared Euclidean distances between the inputs, for covariance functions
+     * that depend on the distance only, see #isDistanceBased. Composite covariance functions compute the
+     * distances once and share them between such parts.
+     *
+     * @param K Returns the covariances, size [n1, n2]
+     * @param D2 The squared distances, size [n1, n2]
+     * @param dim The dimension of the inputs.
+     */
+    void KFromSquaredDistances(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& D2, const Eigen::Index dim);
 
     /**
      * Compute the entries on the diagonal of the covariance matrix.
@@ -88,13 +165,53 @@ public:
      * @param K The diagonal entries as a vector, size [n]
      * @param X The input data to compute the covariance matrix, size [n, k]
      */
-    void diagK(Eigen::VectorXd& K, const Eigen::MatrixXd& X);
+    void diagK(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X);
+
+    /**
+     * Compute the derivatives of the covariance matrix with respect to the parameter vector.
+     *
+     * @param dK Returns one matrix per parameter, dK[i] is the derivative with respect to parameter i, size [n, n]
+     * @param X The input data to compute the covariance matrix, size [n, k]
+     */
+    void dK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X);
+
+    /**
+     * Compute the gradient of a scalar function \f$ f(K) \f$ of the covariance matrix with respect to the parameters
+     * via the chain rule, given the partial derivatives of f with respect to the entries of K:
+     * \f[
+     * g_i = \sum_{j,k} \frac{\partial f}{\partial K_{jk}} \frac{\partial K_{jk}}{\partial p_i}
+     * \f]
+     * Covariance functions with analytic derivatives compute the sum without forming the matrices of #dK_dP.
+     *
+     * @param g Returns the gradient, size [nParameters()]
+     * @param X The input data to compute the covariance matrix, size [n, k]
+     * @param covGrad The partial derivatives of f with respect to K, size [n, n]
+     */
+    void gradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad);
+
+    /**
+     * Compute the gradient of #gradient for the partial derivatives \f$ A B^T \f$ of low rank without storing them.
+     * The sum runs over tiles of the covariance matrix as for #multiplyK, each pair of tiles off the diagonal is
+     * evaluated as one tile of twice the size, such that the memory is O(b^2) per thread and the work is about
+     * twice that of #gradient.
+     *
+     * @param g Returns the gradient, size [nParameters()]
+     * @param X The input data to compute the covariance matrix, size [n, k]
+     * @param A The left factor of the partial derivatives, size [n, r]
+     * @param B The right factor of the partial derivatives, size [n, r]
+     */
+    void gradientLowRank(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::Ref<const Eigen::MatrixXd>& A, const Eigen::Ref<const Eigen::MatrixXd>& B);
 
     /**
-     * Compute the derivative of the covariance matrix with respect to the parameter vector.
+     * Compute the gradient of #gradient for partial derivatives that are stored on a sparsity pattern only,
+     * for covariance functions with compact support, see #hasCompactSupport. The pattern must include the
+     * pattern of #sparseK, the entries outside of the support do not contribute.
      *
+     * @param g Returns the gradient, size [nParameters()]
+     * @param X The input data to compute the covariance matrix, size [n, k]
+     * @param covGrad The partial derivatives of f with respect to K, size [n, n]
      */
-    void dK_dP();
+    void gradientSparse(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::SparseMatrix<double>& covGrad);
 
     /**
      * Compute the derivative of the covariance matrix with respect to the input data.
@@ -155,12 +272,173 @@ public:
      */
     Eigen::VectorXd getParameters() const;
 
+    /**
+     * \brief Set the number of threads used to assemble the covariance matrices.
+     * With more than one thread, #K splits the matrix into tiles that are processed in parallel.
+     * The tiling only depends on the tile size, so the result does not depend on the number of threads.
+     * The worker threads are started here and kept alive for all later assemblies, copies share them.
+     *
+     * \param nThreads The number of threads, 0 for the number of hardware threads, default 1.
+     */
+    void setNumThreads(const unsigned int nThreads);
+
+    /**
+     * \brief Get the number of threads used to assemble the covariance matrices.
+     *
+     * \return The number of threads, 0 for the number of hardware threads.
+     */
+    unsigned int getNumThreads() const;
+
+    /**
+     * \brief Set the size of the square tiles in which #K assembles the covariance matrices.
+     * A tile size of 0 computes the whole matrix at once, unless more than one thread is used,
+     * then a default tile size of 256 is used.
+     *
+     * \param tileSize The number of rows and columns of a tile, default 0.
+     */
+    void setTileSize(const Eigen::Index tileSize);
+
+    /**
+     * \brief Get the size of the tiles in which the covariance matrices are assembled.
+     *
+     * \return The tile size, 0 if the matrices are not tiled.
+     */
+    Eigen::Index getTileSize() const;
+
+    /**
+     * \brief Declare the version of the input data of the following calls.
+     * Covariance functions may cache precomputations of their input data, e.g. scaled inputs or distances.
+     * A cache is used only while an input version is set, and only for input data at the same address,
+     * of the same size and with the same version as when the cache was filled.
+     * The owner of the data, e.g. GPKernel with GPData::getVersion, sets the version before evaluating
+     * the covariance function and clears it afterwards.
+     *
+     * \param version The version of the input data.
+     */
+    void setInputVersion(const unsigned long version);
+
+    /**
+     * \brief Clear the input version, which disables the caches, see #setInputVersion.
+     */
+    void clearInputVersion();
+
+    /**
+     * \brief Attach the distance cache of the owner of the input data, e.g. of a GPKernel.
+     * Covariance functions that depend on the distances only take the distances between the training inputs
+     * from it, composite covariance functions forward it to their parts. The cache is not owned by the covariance
+     * function, it is released together with its owner. The default implementation ignores the cache.
+     *
+     * \param cache The cache, nullptr to detach it.
+     */
+    virtual void attachDistanceCache(const std::shared_ptr<DistanceCache>& cache);
+
 protected:
-    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::MatrixXd& X1, const Eigen::MatrixXd& X2) const = 0;
-    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::MatrixXd& X) const = 0;
-    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::MatrixXd& X) const = 0;
+    /**
+     * Check whether a cache filled for the given key can be used for the input data X.
+     *
+     * @return False if no input version is set or if the key does not match.
+     */
+    bool isCached(const InputKey& key, const Eigen::Ref<const Eigen::MatrixXd>& X) const;
+
+    /**
+     * Create the key for a cache of the input data X.
+     *
+     * @param key Returns the key.
+     * @param X The input data.
+     * @return False if no input version is set, then the precomputation must not be cached.
+     */
+    bool makeInputKey(InputKey& key, const Eigen::Ref<const Eigen::MatrixXd>& X) const;
+
+    /**
+     * Sum the gradient of #gradient over the tiles of the lower triangle of the covariance matrix, such that the
+     * partial derivatives are never stored for all entries. Each pair of tiles off the diagonal is evaluated as one
+     * tile of twice the size, whose diagonal blocks have zero partial derivatives. The partial gradients are summed
+     * in a fixed order, such that the result does not depend on the number of threads.
+     *
+     * @param g Returns the gradient, size [nParameters()]
+     * @param X The input data to compute the covariance matrix, size [n, k]
+     * @param b The tile size.
+     * @param covGradBlock covGradBlock(C, i, j, bi, bj) returns the partial derivatives for the rows [i, i+bi) and the columns [j, j+bj)
+     * @param tileGradient tileGradient(g, Xt, C) returns the gradient for the input data of a tile and its partial derivatives
+     * @param parallel Whether the tiles are evaluated by the threads of #setNumThreads, which must not be in use by the caller.
+     */
+    void tiledGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::Index b,
+                       const std::function<void(Eigen::MatrixXd&, Eigen::Index, Eigen::Index, Eigen::Index, Eigen::Index)>& covGradBlock,
+                       const std::function<void(Eigen::VectorXd&, const Eigen::Ref<const Eigen::MatrixXd>&, const Eigen::MatrixXd&)>& tileGradient,
+                       const bool parallel) const;
+
+    /**
+     * This method is called by #setParameters after the parameters have been set.
+     * The default implementation does nothing, composite covariance functions forward the parameters to their parts.
+     */
+    virtual void updatedParameters_trigger();
+
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2) const = 0;
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const = 0;
+    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const = 0;
+
+    /**
+     * Cross covariance in single precision, see #K.
+     * The default implementation evaluates the covariance function in double precision and rounds the result,
+     * covariance functions override it to compute in single precision directly.
+     */
+    virtual void covariancefunctionSingle(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X1, const Eigen::Ref<const Eigen::MatrixXf>& X2) const;
+
+    /**
+     * Sparse covariance matrix, see #sparseK.
+     * The default implementation throws an exception, covariance functions with compact support override it.
+     */
+    virtual void covariancefunctionSparse(Eigen::SparseMatrix<double>& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const;
+
+    /**
+     * Covariances from squared distances, see #KFromSquaredDistances.
+     * The default implementation throws an exception, covariance functions that depend on the distance only override it.
+     */
+    virtual void covariancefunctionFromSquaredDistances(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& D2, const Eigen::Index dim) const;
+
+    /**
+     * Derivatives of the covariance matrix with respect to the parameters, see #dK_dP.
+     * The default implementation throws an exception, covariance functions that support
+     * hyperparameter optimization override it.
+     */
+    virtual void covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const;
+
+    /**
+     * Gradient of a scalar function of the covariance matrix, see #gradient.
+     * The default implementation contracts covGrad with the matrices of #covariancefunctionDK_dP.
+     */
+    virtual void covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const;
+
+    /**
+     * Gradient for sparse partial derivatives, see #gradientSparse.
+     * The default implementation throws an exception, covariance functions with compact support override it.
+     */
+    virtual void covariancefunctionGradientSparse(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::SparseMatrix<double>& covGrad) const;
 
     Eigen::VectorXd parameters;
+
+private:
+    /**
+     * The tile size that is used for the assembly, 0 if the matrices are computed at once.
+     */
+    Eigen::Index effectiveTileSize() const;
+
+    /**
+     * Call tile(t) for all t in [0, nTiles), in parallel if more than one thread is configured.
+     */
+    void forEachTile(const std::size_t nTiles, const std::function<void(std::size_t)>& tile) const;
+
+    /**
+     * Call tile(i, j, bi, bj) for all tiles of a [n1, n2] matrix, see #forEachTile.
+     */
+    void forEachCrossTile(const Eigen::Index n1, const Eigen::Index n2, const Eigen::Index b,
+                          const std::function<void(Eigen::Index, Eigen::Index, Eigen::Index, Eigen::Index)>& tile) const;
+
+    unsigned int nThreads;
+    std::shared_ptr<util::ThreadPool> pool; // nullptr for a single thread
+    Eigen::Index tileSize;
+    bool hasInputVersion;
+    unsigned long inputVersion;
 };
 
 
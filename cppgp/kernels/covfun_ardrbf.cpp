@@ -0,0 +1,147 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "covfun_ardrbf.hpp"
+#include "covfun_rbf.hpp"
+
+#include <cppgp/util/exceptions.hpp>
+
+gp::kernel::ARDRBFCovFun::ARDRBFCovFun(const unsigned int dim) :
+    CovarianceFunction(Eigen::VectorXd::Ones(dim+1))
+{}
+
+gp::kernel::ARDRBFCovFun::ARDRBFCovFun(const Eigen::VectorXd& inverseWidths, const double variance) :
+    CovarianceFunction(Eigen::VectorXd(inverseWidths.size()+1))
+{
+    this->parameters << inverseWidths, variance;
+}
+
+gp::kernel::ARDRBFCovFun::ARDRBFCovFun(const Eigen::VectorXd& params) :
+    CovarianceFunction(params)
+{
+    assert(params.size() >= 2);
+}
+
+gp::kernel::ARDRBFCovFun::~ARDRBFCovFun()
+{}
+
+std::shared_ptr<util::Prototype> gp::kernel::ARDRBFCovFun::copy() const
+{
+    CovarianceFunction* cfun = new ARDRBFCovFun(*this);
+    return std::shared_ptr<CovarianceFunction>(cfun);
+}
+
+unsigned int gp::kernel::ARDRBFCovFun::getDimension() const
+{
+    return this->parameters.size() - 1;
+}
+
+void gp::kernel::ARDRBFCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X1, const Eigen::Ref<const Eigen::MatrixXd> &X2) const
+{
+    Eigen::MatrixXd workspace1, workspace2;
+    const Eigen::MatrixXd& Z1 = this->scaledInputs(X1, workspace1, true);
+    const Eigen::MatrixXd& Z2 = this->scaledInputs(X2, workspace2, false);
+    RBFCovFun(1.0, this->parameters(this->getDimension())).K(K, Z1, Z2);
+}
+
+void gp::kernel::ARDRBFCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X) const
+{
+    Eigen::MatrixXd workspace;
+    const Eigen::MatrixXd& Z = this->scaledInputs(X, workspace, true);
+    RBFCovFun(1.0, this->parameters(this->getDimension())).K(K, Z);
+}
+
+void gp::kernel::ARDRBFCovFun::covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    K = Eigen::VectorXd::Constant(X.rows(), this->parameters(this->getDimension()));
+}
+
+void gp::kernel::ARDRBFCovFun::covariancefunctionSingle(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X1, const Eigen::Ref<const Eigen::MatrixXf>& X2) const
+{
+    const unsigned int d = this->getDimension();
+    if(X1.cols() != d || X2.cols() != d){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Data dimension does not match the number of inverse widths");
+    }
+    const Eigen::RowVectorXf scale = this->parameters.head(d).cast<float>().cwiseSqrt().transpose();
+    const Eigen::MatrixXf Z1 = X1.array().rowwise()*scale.array();
+    const Eigen::MatrixXf Z2 = X2.array().rowwise()*scale.array();
+    RBFCovFun(1.0, this->parameters(d)).K(K, Z1, Z2);
+}
+
+void gp::kernel::ARDRBFCovFun::covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    const unsigned int d = this->getDimension();
+    const Eigen::Index n = X.rows();
+    const double variance = this->parameters(d);
+    Eigen::MatrixXd workspace;
+    const Eigen::MatrixXd& Z = this->scaledInputs(X, workspace, true);
+
+    dK.resize(d+1);
+    // dk/dvariance = exp(-1/2 sum_k w_k (x_k - x'_k)^2), dk/dw_k = -1/2 variance (x_k - x'_k)^2 dk/dvariance
+    RBFCovFun(1.0, 1.0).K(dK[d], Z);
+    for(unsigned int k = 0; k < d; ++k){
+        const Eigen::ArrayXXd diff = X.col(k).replicate(1, n) - X.col(k).transpose().replicate(n, 1);
+        dK[k] = -0.5*variance*(diff.square()*dK[d].array());
+    }
+}
+
+void gp::kernel::ARDRBFCovFun::covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const
+{
+    const unsigned int d = this->getDimension();
+    const double variance = this->parameters(d);
+    Eigen::MatrixXd workspace;
+    const Eigen::MatrixXd& Z = this->scaledInputs(X, workspace, true);
+
+    // W = covGrad o exp(-1/2 sum_k w_k (x_k - x'_k)^2)
+    Eigen::MatrixXd W;
+    RBFCovFun(1.0, 1.0).K(W, Z);
+    W.array() *= covGrad.array();
+
+    // sum_ij W_ij (x_ik - x_jk)^2 = sum_i (r_i + c_i) x_ik^2 - 2 sum_i x_ik (W X)_ik for the row sums r and column sums c of W
+    const Eigen::VectorXd rc = W.rowwise().sum() + W.colwise().sum().transpose();
+    const Eigen::MatrixXd WX = W*X;
+    g.resize(d+1);
+    g.head(d) = -0.5*variance*(X.array().square().matrix().transpose()*rc - 2.0*(X.array()*WX.array()).colwise().sum().matrix().transpose());
+    g(d) = W.sum();
+}
+
+const Eigen::MatrixXd& gp::kernel::ARDRBFCovFun::scaledInputs(const Eigen::Ref<const Eigen::MatrixXd>& X, Eigen::MatrixXd& workspace, const bool cache) const
+{
+    const unsigned int d = this->getDimension();
+    if(X.cols() != d){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Data dimension does not match the number of inverse widths");
+    }
+    const auto inverseWidths = this->parameters.head(d);
+    if(cache && this->isCached(this->scaledKey, X) && this->scaledWidths.size() == d && this->scaledWidths == inverseWidths){
+        return this->scaledX;
+    }
+    InputKey key;
+    Eigen::MatrixXd& Z = (cache && this->makeInputKey(key, X)) ? this->scaledX : workspace;
+    Z = X.array().rowwise()*inverseWidths.array().sqrt().transpose();
+    if(&Z == &this->scaledX){
+        this->scaledKey = key;
+        this->scaledWidths = inverseWidths;
+    }
+    return Z;
+}
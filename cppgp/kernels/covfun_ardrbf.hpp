@@ -0,0 +1,105 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <cppgp/kernels/covfun.hpp>
+
+namespace gp::kernel
+{
+
+/**
+ * Radial basis function with automatic relevance determination (ARD), i.e. one inverse width per input dimension.
+ *
+ * This class has d+1 parameters for d-dimensional inputs:\par
+ * - [0, ..., d-1]: inverse widths,  default = 1.0\par
+ * - [d]: variance,                  default = 1.0
+ *
+ * \f$ k(x, x') = \sigma_f \exp\left(-\frac{1}{2} \sum_k w_k (x_k - x'_k)^2\right) \f$ for the inverse widths \f$ w_k \f$ and the variance \f$ \sigma_f \f$.
+ *
+ * The inputs are scaled by \f$ \sqrt{w_k} \f$ and evaluated by RBFCovFun with unit inverse width.
+ * The scaled training inputs are cached for the current parameters while an input version is set,
+ * see CovarianceFunction::setInputVersion. The gradient with respect to all inverse widths is computed
+ * with a single matrix product, without forming a distance matrix per dimension.
+*/
+class ARDRBFCovFun : public CovarianceFunction {
+public:
+
+    /**
+     * Constructor with default parameters.
+     *
+     * @param dim The input dimension d.
+     */
+    ARDRBFCovFun(const unsigned int dim);
+
+    /**
+     * Constructor taking the inverse widths and the variance.
+     *
+     * @param inverseWidths The inverse widths, size [d]
+     * @param variance The variance
+     */
+    ARDRBFCovFun(const Eigen::VectorXd& inverseWidths, const double variance);
+
+    /**
+     * Constructor taking the parameters as parameter vector, size [d+1]
+     */
+    ARDRBFCovFun(const Eigen::VectorXd& params);
+
+    /**
+     * Deconstructor
+     */
+    virtual ~ARDRBFCovFun();
+
+    /**
+     * Create a deep copy of the object.
+     *
+     * @return The deep copy of the object.
+     */
+    virtual std::shared_ptr<util::Prototype> copy() const override;
+
+    /**
+     * @return The input dimension d.
+     */
+    unsigned int getDimension() const;
+
+protected:
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2) const override;
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionSingle(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X1, const Eigen::Ref<const Eigen::MatrixXf>& X2) const override;
+    virtual void covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const override;
+private:
+    /**
+     * Get the inputs scaled by the square roots of the inverse widths.
+     * If cache is true, the cached scaled inputs are returned or refilled, otherwise they are computed into workspace.
+     */
+    const Eigen::MatrixXd& scaledInputs(const Eigen::Ref<const Eigen::MatrixXd>& X, Eigen::MatrixXd& workspace, const bool cache) const;
+
+    mutable Eigen::MatrixXd scaledX;        // cached scaled training inputs
+    mutable InputKey scaledKey;             // input data of scaledX
+    mutable Eigen::VectorXd scaledWidths;   // inverse widths of scaledX
+};
+
+} // namespace gp::kernel
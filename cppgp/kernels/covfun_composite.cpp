@@ -0,0 +1,344 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "covfun_composite.hpp"
+
+#include <cppgp/math/distance.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+    const Eigen::Index panelSize = 256; // number of columns of the panels in which parts are combined
+
+    /**
+     * Forward the input version of the composite to its parts for the lifetime of the object.
+     */
+    class PartsInputVersionScope {
+    public:
+        PartsInputVersionScope(const std::vector<std::shared_ptr<gp::kernel::CovarianceFunction>>& covfuns,
+                               const gp::kernel::InputKey* key) :
+            covfuns(covfuns), active(key != nullptr)
+        {
+            if(this->active){
+                for(const auto& covfun : covfuns){
+                    covfun->setInputVersion(key->version);
+                }
+            }
+        }
+        ~PartsInputVersionScope()
+        {
+            if(this->active){
+                for(const auto& covfun : this->covfuns){
+                    covfun->clearInputVersion();
+                }
+            }
+        }
+    private:
+        const std::vector<std::shared_ptr<gp::kernel::CovarianceFunction>>& covfuns;
+        const bool active;
+    };
+}
+
+gp::kernel::CompositeCovFun::CompositeCovFun(const std::vector<std::shared_ptr<CovarianceFunction>>& covfuns)
+{
+    if(covfuns.empty()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("A composite covariance function needs at least one covariance function");
+    }
+    unsigned int n = 0;
+    for(const auto& covfun : covfuns){
+        this->covfuns.push_back(std::dynamic_pointer_cast<CovarianceFunction>(covfun->copy()));
+        n += covfun->nParameters();
+    }
+    this->parameters = Eigen::VectorXd(n);
+    for(unsigned int i = 0; i < this->covfuns.size(); ++i){
+        this->covfuns[i]->getParameters(this->parameters, this->parameterOffset(i));
+    }
+}
+
+gp::kernel::CompositeCovFun::CompositeCovFun(const CompositeCovFun& other) :
+    CovarianceFunction(other)
+{
+    for(const auto& covfun : other.covfuns){
+        this->covfuns.push_back(std::dynamic_pointer_cast<CovarianceFunction>(covfun->copy()));
+    }
+}
+
+gp::kernel::CompositeCovFun::~CompositeCovFun()
+{}
+
+unsigned int gp::kernel::CompositeCovFun::nCovFuns() const
+{
+    return this->covfuns.size();
+}
+
+std::shared_ptr<const gp::kernel::CovarianceFunction> gp::kernel::CompositeCovFun::getCovFun(const unsigned int i) const
+{
+    return this->covfuns.at(i);
+}
+
+void gp::kernel::CompositeCovFun::attachDistanceCache(const std::shared_ptr<DistanceCache>& cache)
+{
+    for(const auto& covfun : this->covfuns){
+        covfun->attachDistanceCache(cache);
+    }
+}
+
+unsigned int gp::kernel::CompositeCovFun::parameterOffset(const unsigned int i) const
+{
+    unsigned int offset = 0;
+    for(unsigned int j = 0; j < i; ++j){
+        offset += this->covfuns[j]->nParameters();
+    }
+    return offset;
+}
+
+void gp::kernel::CompositeCovFun::updatedParameters_trigger()
+{
+    for(unsigned int i = 0; i < this->covfuns.size(); ++i){
+        this->covfuns[i]->setParameters(this->parameters, this->parameterOffset(i));
+    }
+}
+
+void gp::kernel::CompositeCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X1, const Eigen::Ref<const Eigen::MatrixXd> &X2) const
+{
+    InputKey key;
+    PartsInputVersionScope scope(this->covfuns, this->makeInputKey(key, X1) ? &key : nullptr);
+    const Eigen::Index n2 = X2.rows();
+    K.resize(X1.rows(), n2);
+    for(Eigen::Index j = 0; j < n2; j += panelSize){
+        const Eigen::Index bj = std::min(panelSize, n2-j);
+        this->panel(K.middleCols(j, bj), X1, X2.middleRows(j, bj), false);
+    }
+}
+
+void gp::kernel::CompositeCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X) const
+{
+    InputKey key;
+    PartsInputVersionScope scope(this->covfuns, this->makeInputKey(key, X) ? &key : nullptr);
+    // the panels of the lower triangle are mirrored in the end, no part forms a covariance matrix of its own
+    const Eigen::Index n = X.rows();
+    K.resize(n, n);
+    for(Eigen::Index j = 0; j < n; j += panelSize){
+        const Eigen::Index bj = std::min(panelSize, n-j);
+        this->panel(K.block(j, j, n-j, bj), X.middleRows(j, n-j), X.middleRows(j, bj), true);
+    }
+    K.triangularView<Eigen::StrictlyUpper>() = K.transpose();
+}
+
+void gp::kernel::CompositeCovFun::panel(Eigen::Ref<Eigen::MatrixXd> K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2,
+                                        const bool diagonal) const
+{
+    // the squared distances are computed once for all parts that depend on the distance only
+    const bool shared = std::count_if(this->covfuns.begin(), this->covfuns.end(),
+                                      [](const std::shared_ptr<CovarianceFunction>& covfun){ return covfun->isDistanceBased(); }) > 1;
+    Eigen::MatrixXd D2, Kpart;
+    if(shared){
+        math::dist2(D2, X1, X2);
+        if(diagonal){
+            D2.topRows(X2.rows()).diagonal().setZero();
+        }
+    }
+    for(unsigned int i = 0; i < this->covfuns.size(); ++i){
+        if(shared && this->covfuns[i]->isDistanceBased()){
+            this->covfuns[i]->KFromSquaredDistances(Kpart, D2, X1.cols());
+        }
+        else {
+            this->covfuns[i]->K(Kpart, X1, X2);
+        }
+        if(i == 0){
+            K = Kpart;
+        }
+        else {
+            this->combine(K, Kpart);
+        }
+    }
+}
+
+void gp::kernel::CompositeCovFun::covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    this->covfuns[0]->diagK(K, X);
+    Eigen::VectorXd Kpart;
+    for(unsigned int i = 1; i < this->covfuns.size(); ++i){
+        this->covfuns[i]->diagK(Kpart, X);
+        this->combine(K, Kpart);
+    }
+}
+
+void gp::kernel::CompositeCovFun::covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const
+{
+    if(X.rows() > 2*panelSize){
+        // the parts are evaluated on pairs of panels, the tiles are not cached
+        this->tiledGradient(g, X, panelSize,
+            [&covGrad](Eigen::MatrixXd& C, Eigen::Index i, Eigen::Index j, Eigen::Index bi, Eigen::Index bj){
+                C = covGrad.block(i, j, bi, bj);
+            },
+            [this](Eigen::VectorXd& gt, const Eigen::Ref<const Eigen::MatrixXd>& Xt, const Eigen::MatrixXd& C){
+                this->partsGradient(gt, Xt, C);
+            }, false);
+        return;
+    }
+    InputKey key;
+    PartsInputVersionScope scope(this->covfuns, this->makeInputKey(key, X) ? &key : nullptr);
+    this->partsGradient(g, X, covGrad);
+}
+
+void gp::kernel::CompositeCovFun::covariancefunctionSingle(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X1, const Eigen::Ref<const Eigen::MatrixXf>& X2) const
+{
+    this->covfuns[0]->K(K, X1, X2);
+    const Eigen::Index n2 = X2.rows();
+    Eigen::MatrixXf panel;
+    for(unsigned int i = 1; i < this->covfuns.size(); ++i){
+        for(Eigen::Index j = 0; j < n2; j += panelSize){
+            const Eigen::Index bj = std::min(panelSize, n2-j);
+            this->covfuns[i]->K(panel, X1, X2.middleRows(j, bj));
+            this->combine(K.middleCols(j, bj), panel);
+        }
+    }
+}
+
+
+gp::kernel::SumCovFun::SumCovFun(const std::vector<std::shared_ptr<CovarianceFunction>>& covfuns) :
+    CompositeCovFun(covfuns)
+{}
+
+gp::kernel::SumCovFun::SumCovFun(const std::shared_ptr<CovarianceFunction>& covfun1, const std::shared_ptr<CovarianceFunction>& covfun2) :
+    CompositeCovFun({covfun1, covfun2})
+{}
+
+gp::kernel::SumCovFun::~SumCovFun()
+{}
+
+std::shared_ptr<util::Prototype> gp::kernel::SumCovFun::copy() const
+{
+    CovarianceFunction* cfun = new SumCovFun(*this);
+    return std::shared_ptr<CovarianceFunction>(cfun);
+}
+
+void gp::kernel::SumCovFun::combine(Eigen::Ref<Eigen::MatrixXd> K, const Eigen::Ref<const Eigen::MatrixXd>& Kpart) const
+{
+    K += Kpart;
+}
+
+void gp::kernel::SumCovFun::combine(Eigen::Ref<Eigen::MatrixXf> K, const Eigen::Ref<const Eigen::MatrixXf>& Kpart) const
+{
+    K += Kpart;
+}
+
+void gp::kernel::SumCovFun::covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    InputKey key;
+    PartsInputVersionScope scope(this->covfuns, this->makeInputKey(key, X) ? &key : nullptr);
+    dK.clear();
+    dK.reserve(this->nParameters());
+    std::vector<Eigen::MatrixXd> dKpart;
+    for(const auto& covfun : this->covfuns){
+        covfun->dK_dP(dKpart, X);
+        std::move(dKpart.begin(), dKpart.end(), std::back_inserter(dK));
+    }
+}
+
+void gp::kernel::SumCovFun::partsGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const
+{
+    g.resize(this->nParameters());
+    Eigen::VectorXd gpart;
+    for(unsigned int i = 0; i < this->covfuns.size(); ++i){
+        this->covfuns[i]->gradient(gpart, X, covGrad);
+        g.segment(this->parameterOffset(i), gpart.size()) = gpart;
+    }
+}
+
+
+gp::kernel::ProductCovFun::ProductCovFun(const std::vector<std::shared_ptr<CovarianceFunction>>& covfuns) :
+    CompositeCovFun(covfuns)
+{}
+
+gp::kernel::ProductCovFun::ProductCovFun(const std::shared_ptr<CovarianceFunction>& covfun1, const std::shared_ptr<CovarianceFunction>& covfun2) :
+    CompositeCovFun({covfun1, covfun2})
+{}
+
+gp::kernel::ProductCovFun::~ProductCovFun()
+{}
+
+std::shared_ptr<util::Prototype> gp::kernel::ProductCovFun::copy() const
+{
+    CovarianceFunction* cfun = new ProductCovFun(*this);
+    return std::shared_ptr<CovarianceFunction>(cfun);
+}
+
+void gp::kernel::ProductCovFun::combine(Eigen::Ref<Eigen::MatrixXd> K, const Eigen::Ref<const Eigen::MatrixXd>& Kpart) const
+{
+    K.array() *= Kpart.array();
+}
+
+void gp::kernel::ProductCovFun::combine(Eigen::Ref<Eigen::MatrixXf> K, const Eigen::Ref<const Eigen::MatrixXf>& Kpart) const
+{
+    K.array() *= Kpart.array();
+}
+
+void gp::kernel::ProductCovFun::covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    InputKey key;
+    PartsInputVersionScope scope(this->covfuns, this->makeInputKey(key, X) ? &key : nullptr);
+    // d(prod_j k_j)/dp = dk_i/dp prod_{j != i} k_j for the parameters p of factor i
+    dK.clear();
+    dK.reserve(this->nParameters());
+    std::vector<Eigen::MatrixXd> dKpart;
+    Eigen::MatrixXd P;
+    for(unsigned int i = 0; i < this->covfuns.size(); ++i){
+        this->covfuns[i]->dK_dP(dKpart, X);
+        this->otherFactors(P, X, i);
+        for(Eigen::MatrixXd& dKp : dKpart){
+            dKp.array() *= P.array();
+            dK.push_back(std::move(dKp));
+        }
+    }
+}
+
+void gp::kernel::ProductCovFun::partsGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const
+{
+    // the gradient of factor i with respect to covGrad o prod_{j != i} k_j
+    g.resize(this->nParameters());
+    Eigen::VectorXd gpart;
+    Eigen::MatrixXd weighted;
+    for(unsigned int i = 0; i < this->covfuns.size(); ++i){
+        this->otherFactors(weighted, X, i);
+        weighted.array() *= covGrad.array();
+        this->covfuns[i]->gradient(gpart, X, weighted);
+        g.segment(this->parameterOffset(i), gpart.size()) = gpart;
+    }
+}
+
+void gp::kernel::ProductCovFun::otherFactors(Eigen::MatrixXd& P, const Eigen::Ref<const Eigen::MatrixXd>& X, const unsigned int i) const
+{
+    P = Eigen::MatrixXd::Ones(X.rows(), X.rows());
+    Eigen::MatrixXd Kpart;
+    for(unsigned int j = 0; j < this->covfuns.size(); ++j){
+        if(j != i){
+            this->covfuns[j]->K(Kpart, X);
+            P.array() *= Kpart.array();
+        }
+    }
+}
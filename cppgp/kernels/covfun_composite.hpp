@@ -0,0 +1,210 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <cppgp/kernels/covfun.hpp>
+
+#include <vector>
+
+namespace gp::kernel
+{
+
+/**
+ * Base class of covariance functions that combine other covariance functions (their parts) element-wise.
+ *
+ * The parameter vector is the concatenation of the parameters of the parts, in the order of the parts.
+ * The parts are deep copies, so they cannot be changed other than through the composite.
+ *
+ * The parts are evaluated in panels of columns and combined into the output matrix, so that the assembly
+ * needs a single covariance matrix and one panel of memory. If several parts depend on the distance only
+ * (see CovarianceFunction::isDistanceBased), the distances of a panel are computed once and shared between them.
+ * For more than two panels, the gradient is summed over pairs of panels as well, see CovarianceFunction::tiledGradient.
+ * The input version is forwarded to the parts, so they can use their caches, e.g. the blocks of the distances
+ * in a DistanceCache.
+*/
+class CompositeCovFun : public CovarianceFunction {
+public:
+
+    /**
+     * Deconstructor
+     */
+    virtual ~CompositeCovFun();
+
+    /**
+     * @return The number of parts.
+     */
+    unsigned int nCovFuns() const;
+
+    /**
+     * @param i The index of the part.
+     * @return The part.
+     */
+    std::shared_ptr<const CovarianceFunction> getCovFun(const unsigned int i) const;
+
+    /**
+     * Attach the distance cache to all parts.
+     */
+    virtual void attachDistanceCache(const std::shared_ptr<DistanceCache>& cache) override;
+
+protected:
+    /**
+     * Constructor taking the parts, of which deep copies are stored.
+     *
+     * @param covfuns The parts, at least one.
+     */
+    CompositeCovFun(const std::vector<std::shared_ptr<CovarianceFunction>>& covfuns);
+
+    /**
+     * Copy constructor, creates deep copies of the parts.
+     */
+    CompositeCovFun(const CompositeCovFun& other);
+
+    /**
+     * Combine the covariances of a part with the covariances of the previous parts.
+     *
+     * @param K The covariances of the previous parts, returns the combined covariances.
+     * @param Kpart The covariances of the part, the same size as K.
+     */
+    virtual void combine(Eigen::Ref<Eigen::MatrixXd> K, const Eigen::Ref<const Eigen::MatrixXd>& Kpart) const = 0;
+
+    /**
+     * Combine the covariances of a part in single precision, see #combine.
+     */
+    virtual void combine(Eigen::Ref<Eigen::MatrixXf> K, const Eigen::Ref<const Eigen::MatrixXf>& Kpart) const = 0;
+
+    /**
+     * Compute the gradient of the parts, see #gradient, on input data of the size of a pair of panels at most.
+     */
+    virtual void partsGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const = 0;
+
+    virtual void updatedParameters_trigger() override;
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2) const override;
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionSingle(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X1, const Eigen::Ref<const Eigen::MatrixXf>& X2) const override;
+    virtual void covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const override;
+
+    /**
+     * The index of the first parameter of each part in the parameter vector.
+     */
+    unsigned int parameterOffset(const unsigned int i) const;
+
+    std::vector<std::shared_ptr<CovarianceFunction>> covfuns;
+
+private:
+    /**
+     * Evaluate and combine all parts on a panel of the covariance matrix.
+     *
+     * @param K Returns the combined covariances, size [n1, n2].
+     * @param X1 The rows of the panel, size [n1, k].
+     * @param X2 The columns of the panel, size [n2, k].
+     * @param diagonal True, if the first n2 rows of X1 are X2.
+     */
+    void panel(Eigen::Ref<Eigen::MatrixXd> K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2, const bool diagonal) const;
+};
+
+/**
+ * Sum of covariance functions, \f$ k(x, x') = \sum_i k_i(x, x') \f$.
+*/
+class SumCovFun : public CompositeCovFun {
+public:
+
+    /**
+     * Constructor taking the summands.
+     *
+     * @param covfuns The summands, at least one.
+     */
+    SumCovFun(const std::vector<std::shared_ptr<CovarianceFunction>>& covfuns);
+
+    /**
+     * Constructor taking two summands.
+     */
+    SumCovFun(const std::shared_ptr<CovarianceFunction>& covfun1, const std::shared_ptr<CovarianceFunction>& covfun2);
+
+    /**
+     * Deconstructor
+     */
+    virtual ~SumCovFun();
+
+    /**
+     * Create a deep copy of the object.
+     *
+     * @return The deep copy of the object.
+     */
+    virtual std::shared_ptr<util::Prototype> copy() const override;
+
+protected:
+    virtual void combine(Eigen::Ref<Eigen::MatrixXd> K, const Eigen::Ref<const Eigen::MatrixXd>& Kpart) const override;
+    virtual void combine(Eigen::Ref<Eigen::MatrixXf> K, const Eigen::Ref<const Eigen::MatrixXf>& Kpart) const override;
+    virtual void partsGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const override;
+    virtual void covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+};
+
+/**
+ * Product of covariance functions, \f$ k(x, x') = \prod_i k_i(x, x') \f$.
+ *
+ * A covariance function is scaled by the product with a ConstantCovFun.
+*/
+class ProductCovFun : public CompositeCovFun {
+public:
+
+    /**
+     * Constructor taking the factors.
+     *
+     * @param covfuns The factors, at least one.
+     */
+    ProductCovFun(const std::vector<std::shared_ptr<CovarianceFunction>>& covfuns);
+
+    /**
+     * Constructor taking two factors.
+     */
+    ProductCovFun(const std::shared_ptr<CovarianceFunction>& covfun1, const std::shared_ptr<CovarianceFunction>& covfun2);
+
+    /**
+     * Deconstructor
+     */
+    virtual ~ProductCovFun();
+
+    /**
+     * Create a deep copy of the object.
+     *
+     * @return The deep copy of the object.
+     */
+    virtual std::shared_ptr<util::Prototype> copy() const override;
+
+protected:
+    virtual void combine(Eigen::Ref<Eigen::MatrixXd> K, const Eigen::Ref<const Eigen::MatrixXd>& Kpart) const override;
+    virtual void combine(Eigen::Ref<Eigen::MatrixXf> K, const Eigen::Ref<const Eigen::MatrixXf>& Kpart) const override;
+    virtual void partsGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const override;
+    virtual void covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+
+private:
+    /**
+     * Compute the product of the covariance matrices of all factors except factor i.
+     */
+    void otherFactors(Eigen::MatrixXd& P, const Eigen::Ref<const Eigen::MatrixXd>& X, const unsigned int i) const;
+};
+
+} // namespace gp::kernel
@@ -0,0 +1,69 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "covfun_constant.hpp"
+
+gp::kernel::ConstantCovFun::ConstantCovFun(const double variance) :
+    CovarianceFunction(Eigen::VectorXd::Constant(1, variance))
+{}
+
+gp::kernel::ConstantCovFun::~ConstantCovFun()
+{}
+
+std::shared_ptr<util::Prototype> gp::kernel::ConstantCovFun::copy() const
+{
+    CovarianceFunction* cfun = new ConstantCovFun(*this);
+    return std::shared_ptr<CovarianceFunction>(cfun);
+}
+
+void gp::kernel::ConstantCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X1, const Eigen::Ref<const Eigen::MatrixXd> &X2) const
+{
+    K = Eigen::MatrixXd::Constant(X1.rows(), X2.rows(), this->parameters(0));
+}
+
+void gp::kernel::ConstantCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X) const
+{
+    K = Eigen::MatrixXd::Constant(X.rows(), X.rows(), this->parameters(0));
+}
+
+void gp::kernel::ConstantCovFun::covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    K = Eigen::VectorXd::Constant(X.rows(), this->parameters(0));
+}
+
+void gp::kernel::ConstantCovFun::covariancefunctionSingle(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X1, const Eigen::Ref<const Eigen::MatrixXf>& X2) const
+{
+    K = Eigen::MatrixXf::Constant(X1.rows(), X2.rows(), this->parameters(0));
+}
+
+void gp::kernel::ConstantCovFun::covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    dK.resize(1);
+    dK[0] = Eigen::MatrixXd::Ones(X.rows(), X.rows());
+}
+
+void gp::kernel::ConstantCovFun::covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& /*X*/, const Eigen::MatrixXd& covGrad) const
+{
+    g = Eigen::VectorXd::Constant(1, covGrad.sum());
+}
@@ -0,0 +1,71 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <cppgp/kernels/covfun.hpp>
+
+namespace gp::kernel
+{
+
+/**
+ * Constant covariance function, \f$ k(x, x') = \sigma_f \f$.
+ *
+ * This class has one parameter:\par
+ * - [0]: variance,       default = 1.0
+ *
+ * Models a constant offset in a SumCovFun, or scales another covariance function in a ProductCovFun.
+*/
+class ConstantCovFun : public CovarianceFunction {
+public:
+
+    /**
+     * Constructor taking the variance
+     *
+     * @param variance The variance
+     */
+    ConstantCovFun(const double variance=1.0);
+
+    /**
+     * Deconstructor
+     */
+    virtual ~ConstantCovFun();
+
+    /**
+     * Create a deep copy of the object.
+     *
+     * @return The deep copy of the object.
+     */
+    virtual std::shared_ptr<util::Prototype> copy() const override;
+
+protected:
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2) const override;
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionSingle(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X1, const Eigen::Ref<const Eigen::MatrixXf>& X2) const override;
+    virtual void covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const override;
+};
+
+} // namespace gp::kernel
@@ -0,0 +1,207 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "covfun_matern.hpp"
+
+#include <cppgp/math/distance.hpp>
+#include <cppgp/math/simd.hpp>
+
+#include <cmath>
+
+gp::kernel::MaternCovFun::MaternCovFun(const double inverseWidth, const double variance) :
+    CovarianceFunction(Eigen::Vector2d(inverseWidth, variance)),
+    distanceCache(nullptr)
+{}
+
+gp::kernel::MaternCovFun::~MaternCovFun()
+{}
+
+void gp::kernel::MaternCovFun::setDistanceCache(const std::shared_ptr<DistanceCache>& cache)
+{
+    this->distanceCache = cache;
+}
+
+std::shared_ptr<gp::kernel::DistanceCache> gp::kernel::MaternCovFun::getDistanceCache() const
+{
+    return (this->distanceCache != nullptr) ? this->distanceCache : this->attachedCache.lock();
+}
+
+void gp::kernel::MaternCovFun::attachDistanceCache(const std::shared_ptr<DistanceCache>& cache)
+{
+    this->attachedCache = cache;
+}
+
+bool gp::kernel::MaternCovFun::isDistanceBased() const
+{
+    return true;
+}
+
+void gp::kernel::MaternCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X1, const Eigen::Ref<const Eigen::MatrixXd> &X2) const
+{
+    // row blocks of cached training inputs, e.g. tiles of a composite covariance function, reuse the distances
+    Eigen::MatrixXd D;
+    InputKey key1, key2;
+    const std::shared_ptr<DistanceCache> cache = this->getDistanceCache();
+    if(cache == nullptr || !this->makeInputKey(key1, X1) || !this->makeInputKey(key2, X2) || !cache->block(D, key1, key2)){
+        math::dist2(D, X1, X2);
+        D = D.cwiseSqrt();
+    }
+    this->fromDistances(K, nullptr, D);
+}
+
+void gp::kernel::MaternCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X) const
+{
+    this->fromDistances(K, nullptr, *this->distances(X));
+}
+
+void gp::kernel::MaternCovFun::covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    K = Eigen::VectorXd::Constant(X.rows(), this->parameters(1));
+}
+
+void gp::kernel::MaternCovFun::covariancefunctionFromSquaredDistances(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& D2, const Eigen::Index /*dim*/) const
+{
+    this->fromDistances(K, nullptr, D2.cwiseSqrt());
+}
+
+void gp::kernel::MaternCovFun::covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    dK.resize(2);
+    this->fromDistances(dK[1], &dK[0], *this->distances(X));
+    // dk/dvariance = k/variance
+    dK[1] /= this->parameters(1);
+}
+
+void gp::kernel::MaternCovFun::covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const
+{
+    Eigen::MatrixXd K, dK_dw;
+    this->fromDistances(K, &dK_dw, *this->distances(X));
+    g.resize(2);
+    g(0) = (covGrad.array()*dK_dw.array()).sum();
+    g(1) = (covGrad.array()*K.array()).sum()/this->parameters(1);
+}
+
+std::shared_ptr<const Eigen::MatrixXd> gp::kernel::MaternCovFun::distances(const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    InputKey key;
+    const std::shared_ptr<DistanceCache> cache = this->getDistanceCache();
+    if(cache != nullptr && this->makeInputKey(key, X)){
+        return cache->distances(key, X);
+    }
+    auto D = std::make_shared<Eigen::MatrixXd>();
+    DistanceCache::computeDistances(*D, X);
+    return D;
+}
+
+void gp::kernel::MaternCovFun::fromDistances(Eigen::MatrixXd& K, Eigen::MatrixXd* dK_dw, const Eigen::MatrixXd& D) const
+{
+    const double inverseWidth = this->parameters(0);
+    const double variance = this->parameters(1);
+    const double c = this->distanceScale();
+
+    const Eigen::ArrayXXd A = (c*std::sqrt(inverseWidth))*D.array();
+    Eigen::ArrayXXd E = -A;
+    math::simd::exp(E.data(), E.size());
+    Eigen::ArrayXXd P, G;
+    this->polynomial(P, dK_dw != nullptr ? &G : nullptr, A);
+    K = variance*(P*E).matrix();
+    if(dK_dw != nullptr){
+        // dk/dw = variance (P'(a) - P(a)) exp(-a) da/dw with da/dw = a/(2w) and a^2/w = c^2 r^2
+        *dK_dw = (0.5*variance*c*c)*(D.array().square()*G*E).matrix();
+    }
+}
+
+gp::kernel::Matern32CovFun::Matern32CovFun() :
+    MaternCovFun(1.0, 1.0)
+{}
+
+gp::kernel::Matern32CovFun::Matern32CovFun(const double inverseWidth, const double variance) :
+    MaternCovFun(inverseWidth, variance)
+{}
+
+gp::kernel::Matern32CovFun::Matern32CovFun(const Eigen::VectorXd &params) :
+    MaternCovFun(params(0), params(1))
+{
+    assert(params.size() == 2);
+}
+
+gp::kernel::Matern32CovFun::~Matern32CovFun()
+{}
+
+std::shared_ptr<util::Prototype> gp::kernel::Matern32CovFun::copy() const
+{
+    CovarianceFunction* cfun = new Matern32CovFun(*this);
+    return std::shared_ptr<CovarianceFunction>(cfun);
+}
+
+double gp::kernel::Matern32CovFun::distanceScale() const
+{
+    return std::sqrt(3.0);
+}
+
+void gp::kernel::Matern32CovFun::polynomial(Eigen::ArrayXXd& P, Eigen::ArrayXXd* G, const Eigen::ArrayXXd& A) const
+{
+    // P = 1 + a, (P' - P)/a = -1
+    P = 1.0 + A;
+    if(G != nullptr){
+        *G = Eigen::ArrayXXd::Constant(A.rows(), A.cols(), -1.0);
+    }
+}
+
+gp::kernel::Matern52CovFun::Matern52CovFun() :
+    MaternCovFun(1.0, 1.0)
+{}
+
+gp::kernel::Matern52CovFun::Matern52CovFun(const double inverseWidth, const double variance) :
+    MaternCovFun(inverseWidth, variance)
+{}
+
+gp::kernel::Matern52CovFun::Matern52CovFun(const Eigen::VectorXd &params) :
+    MaternCovFun(params(0), params(1))
+{
+    assert(params.size() == 2);
+}
+
+gp::kernel::Matern52CovFun::~Matern52CovFun()
+{}
+
+std::shared_ptr<util::Prototype> gp::kernel::Matern52CovFun::copy() const
+{
+    CovarianceFunction* cfun = new Matern52CovFun(*this);
+    return std::shared_ptr<CovarianceFunction>(cfun);
+}
+
+double gp::kernel::Matern52CovFun::distanceScale() const
+{
+    return std::sqrt(5.0);
+}
+
+void gp::kernel::Matern52CovFun::polynomial(Eigen::ArrayXXd& P, Eigen::ArrayXXd* G, const Eigen::ArrayXXd& A) const
+{
+    // P = 1 + a + a^2/3, (P' - P)/a = -(1 + a)/3
+    P = 1.0 + A*(1.0 + A/3.0);
+    if(G != nullptr){
+        *G = -(1.0 + A)/3.0;
+    }
+}
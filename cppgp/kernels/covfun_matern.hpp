@@ -0,0 +1,206 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <cppgp/kernels/covfun.hpp>
+#include <cppgp/kernels/distancecache.hpp>
+
+namespace gp::kernel
+{
+
+/**
+ * Base class of the Matérn covariance functions with half-integer smoothness \f$ \nu = p + 1/2 \f$.
+ *
+ * This class has two parameters:\par
+ * - [0]: inverse width,  default = 1.0\par
+ * - [1]: variance,       default = 1.0
+ *
+ * \f$ k(x, x') = \sigma_f P(a) \exp(-a) \f$ with \f$ a = \sqrt{2\nu w} \|x - x'\| \f$ for the inverse width w,
+ * the variance \f$ \sigma_f \f$ and a polynomial P of degree p that is defined by the subclasses.
+ *
+ * The covariance functions depend on the Euclidean distances between the inputs. The distances between the
+ * training inputs are taken from a DistanceCache while an input version is set, see CovarianceFunction::setInputVersion.
+ * By default the Matérn covariance functions use the cache of their GPKernel (see #attachDistanceCache), so composing
+ * them computes the distances once per data version, and the distances are released with the kernel. A cache set by
+ * #setDistanceCache takes precedence, e.g. to share the distances between kernels on the same GPData. Cross covariances between
+ * row blocks of the cached training inputs, e.g. the tiles of a composite covariance function, use the cache as well.
+*/
+class MaternCovFun : public CovarianceFunction {
+public:
+
+    /**
+     * Deconstructor
+     */
+    virtual ~MaternCovFun();
+
+    /**
+     * \brief Set the cache of the distances between the training inputs, which is kept alive by the covariance function.
+     * \param cache The cache, nullptr to use the cache of the kernel again.
+     */
+    void setDistanceCache(const std::shared_ptr<DistanceCache>& cache);
+
+    /**
+     * \brief Get the cache of the distances between the training inputs, nullptr if caching is disabled.
+     */
+    std::shared_ptr<DistanceCache> getDistanceCache() const;
+
+    virtual void attachDistanceCache(const std::shared_ptr<DistanceCache>& cache) override;
+
+    /**
+     * \brief True, the covariances depend on the distance only.
+     */
+    virtual bool isDistanceBased() const override;
+
+protected:
+    /**
+     * Constructor taking the two parameters
+     *
+     * @param inverseWidth The inverse width
+     * @param variance The variance
+     */
+    MaternCovFun(const double inverseWidth, const double variance);
+
+    /**
+     * @return The factor \f$ \sqrt{2\nu} \f$ of the scaled distance a.
+     */
+    virtual double distanceScale() const = 0;
+
+    /**
+     * Evaluate the polynomial terms of the covariance function element-wise.
+     *
+     * @param P Returns P(a), the same size as A.
+     * @param G If not nullptr, returns (P'(a) - P(a))/a, the same size as A.
+     * @param A The scaled distances a.
+     */
+    virtual void polynomial(Eigen::ArrayXXd& P, Eigen::ArrayXXd* G, const Eigen::ArrayXXd& A) const = 0;
+
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2) const override;
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionFromSquaredDistances(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& D2, const Eigen::Index dim) const override;
+    virtual void covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const override;
+private:
+    /**
+     * Get the distances between the rows of X, from the cache if an input version is set.
+     */
+    std::shared_ptr<const Eigen::MatrixXd> distances(const Eigen::Ref<const Eigen::MatrixXd>& X) const;
+
+    /**
+     * Compute the covariances and optionally the derivatives with respect to the inverse width from the distances.
+     */
+    void fromDistances(Eigen::MatrixXd& K, Eigen::MatrixXd* dK_dw, const Eigen::MatrixXd& D) const;
+
+    std::shared_ptr<DistanceCache> distanceCache;   // set by setDistanceCache
+    std::weak_ptr<DistanceCache> attachedCache;     // attached by the kernel
+};
+
+/**
+ * Matérn covariance function with smoothness 3/2, \f$ k(x, x') = \sigma_f (1 + a) \exp(-a) \f$ with \f$ a = \sqrt{3 w} \|x - x'\| \f$.
+ *
+ * The sample paths are once differentiable. See MaternCovFun for the parameters.
+*/
+class Matern32CovFun : public MaternCovFun {
+public:
+
+    /**
+     * Default constructor
+     */
+    Matern32CovFun();
+
+    /**
+     * Constructor taking the two parameters
+     *
+     * @param inverseWidth The inverse width
+     * @param variance The variance
+     */
+    Matern32CovFun(const double inverseWidth, const double variance);
+
+    /**
+     * Constructor taking the two parameters as parameter vector
+     */
+    Matern32CovFun(const Eigen::VectorXd& params);
+
+    /**
+     * Deconstructor
+     */
+    virtual ~Matern32CovFun();
+
+    /**
+     * Create a deep copy of the object. The copy shares the distance cache.
+     *
+     * @return The deep copy of the object.
+     */
+    virtual std::shared_ptr<util::Prototype> copy() const override;
+
+protected:
+    virtual double distanceScale() const override;
+    virtual void polynomial(Eigen::ArrayXXd& P, Eigen::ArrayXXd* G, const Eigen::ArrayXXd& A) const override;
+};
+
+/**
+ * Matérn covariance function with smoothness 5/2, \f$ k(x, x') = \sigma_f (1 + a + a^2/3) \exp(-a) \f$ with \f$ a = \sqrt{5 w} \|x - x'\| \f$.
+ *
+ * The sample paths are twice differentiable. See MaternCovFun for the parameters.
+*/
+class Matern52CovFun : public MaternCovFun {
+public:
+
+    /**
+     * Default constructor
+     */
+    Matern52CovFun();
+
+    /**
+     * Constructor taking the two parameters
+     *
+     * @param inverseWidth The inverse width
+     * @param variance The variance
+     */
+    Matern52CovFun(const double inverseWidth, const double variance);
+
+    /**
+     * Constructor taking the two parameters as parameter vector
+     */
+    Matern52CovFun(const Eigen::VectorXd& params);
+
+    /**
+     * Deconstructor
+     */
+    virtual ~Matern52CovFun();
+
+    /**
+     * Create a deep copy of the object. The copy shares the distance cache.
+     *
+     * @return The deep copy of the object.
+     */
+    virtual std::shared_ptr<util::Prototype> copy() const override;
+
+protected:
+    virtual double distanceScale() const override;
+    virtual void polynomial(Eigen::ArrayXXd& P, Eigen::ArrayXXd* G, const Eigen::ArrayXXd& A) const override;
+};
+
+} // namespace gp::kernel
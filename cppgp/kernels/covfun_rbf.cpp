@@ -25,6 +25,14 @@
 #include "covfun_rbf.hpp"
 
 #include <cppgp/math/distance.hpp>
+#include <cppgp/math/simd.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <algorithm>
+
+namespace {
+    const Eigen::Index cacheTileSize = 64; // 64x64 doubles fit into the L2 cache
+}
 
 gp::kernel::RBFCovFun::RBFCovFun()
 {
@@ -51,38 +59,131 @@ gp::kernel::RBFCovFun::~RBFCovFun()
 
 std::shared_ptr<util::Prototype> gp::kernel::RBFCovFun::copy() const
 {
-    CovarianceFunction* cfun = new RBFCovFun(this->getParameters());
+    CovarianceFunction* cfun = new RBFCovFun(*this);
     return std::shared_ptr<CovarianceFunction>(cfun);
 }
 
-void gp::kernel::RBFCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::MatrixXd &X1, const Eigen::MatrixXd &X2) const
+void gp::kernel::RBFCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X1, const Eigen::Ref<const Eigen::MatrixXd> &X2) const
 {
-    Eigen::MatrixXd n2;
-    math::dist2(n2, X1, X2);
-    //math::dist2(n2, (X1.array().rowwise()*this->inputScales.array()).matrix(),
-    //      (X2.array().rowwise()*this->inputScales.array()).matrix());
-    this->kerncompute(K, n2);
+    if(X1.cols() != X2.cols()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Data dimension does not match dimension of centres");
+    }
+    const Eigen::Index n1 = X1.rows();
+    const Eigen::Index n2 = X2.rows();
+    const Eigen::VectorXd sq1 = X1.rowwise().squaredNorm();
+    const Eigen::VectorXd sq2 = X2.rowwise().squaredNorm();
+    K.resize(n1, n2);
+    for(Eigen::Index j = 0; j < n2; j += cacheTileSize){
+        const Eigen::Index bj = std::min(cacheTileSize, n2-j);
+        for(Eigen::Index i = 0; i < n1; i += cacheTileSize){
+            const Eigen::Index bi = std::min(cacheTileSize, n1-i);
+            this->kerncomputeTile(K.block(i, j, bi, bj), X1.middleRows(i, bi), X2.middleRows(j, bj), sq1.segment(i, bi), sq2.segment(j, bj));
+        }
+    }
+}
+
+void gp::kernel::RBFCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X) const
+{
+    // only the tiles of the lower triangle are computed, each one is mirrored while it is in cache
+    const Eigen::Index n = X.rows();
+    const Eigen::VectorXd sq = X.rowwise().squaredNorm();
+    K.resize(n, n);
+    for(Eigen::Index j = 0; j < n; j += cacheTileSize){
+        const Eigen::Index bj = std::min(cacheTileSize, n-j);
+        for(Eigen::Index i = j; i < n; i += cacheTileSize){
+            const Eigen::Index bi = std::min(cacheTileSize, n-i);
+            this->kerncomputeTile(K.block(i, j, bi, bj), X.middleRows(i, bi), X.middleRows(j, bj), sq.segment(i, bi), sq.segment(j, bj));
+            if(i != j){
+                K.block(j, i, bj, bi) = K.block(i, j, bi, bj).transpose();
+            }
+            else {
+                K.block(j, j, bj, bj).triangularView<Eigen::StrictlyUpper>() = K.block(j, j, bj, bj).transpose();
+            }
+        }
+    }
 }
 
-void gp::kernel::RBFCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::MatrixXd &X) const
+void gp::kernel::RBFCovFun::covariancefunctionSingle(Eigen::MatrixXf &K, const Eigen::Ref<const Eigen::MatrixXf> &X1, const Eigen::Ref<const Eigen::MatrixXf> &X2) const
 {
-    //const Eigen::MatrixXd xsc = (X.array().rowwise()*this->inputScales.array()).matrix();
-    Eigen::MatrixXd dist;
-    math::dist2(dist, X, X);
-    //math::dist2(dist, xsc, xsc);
-    this->kerncompute(K, dist);
+    if(X1.cols() != X2.cols()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Data dimension does not match dimension of centres");
+    }
+    const float scale = -0.5f*static_cast<float>(this->parameters(0));
+    const float variance = static_cast<float>(this->parameters(1));
+    const Eigen::Index n1 = X1.rows();
+    const Eigen::Index n2 = X2.rows();
+    const Eigen::VectorXf sq1 = X1.rowwise().squaredNorm();
+    const Eigen::VectorXf sq2 = X2.rowwise().squaredNorm();
+    K.resize(n1, n2);
+    for(Eigen::Index j = 0; j < n2; j += cacheTileSize){
+        const Eigen::Index bj = std::min(cacheTileSize, n2-j);
+        for(Eigen::Index i = 0; i < n1; i += cacheTileSize){
+            const Eigen::Index bi = std::min(cacheTileSize, n1-i);
+            auto tile = K.block(i, j, bi, bj);
+            tile.noalias() = X1.middleRows(i, bi)*X2.middleRows(j, bj).transpose();
+            tile.array() = variance*((((-2.0f*tile.array()).colwise() + sq1.segment(i, bi).array()).rowwise()
+                                      + sq2.segment(j, bj).transpose().array()).max(0.0f)*scale).exp();
+        }
+    }
 }
 
-void gp::kernel::RBFCovFun::covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::MatrixXd& X) const
+bool gp::kernel::RBFCovFun::isDistanceBased() const
+{
+    return true;
+}
+
+void gp::kernel::RBFCovFun::covariancefunctionFromSquaredDistances(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& D2, const Eigen::Index /*dim*/) const
+{
+    K = -0.5*this->parameters(0)*D2;
+    math::simd::exp(K.data(), K.size());
+    K *= this->parameters(1);
+}
+
+void gp::kernel::RBFCovFun::covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const
 {
     const double variance = this->parameters(1);
     K = Eigen::VectorXd::Ones(X.rows())*variance;
 }
 
-void gp::kernel::RBFCovFun::kerncompute(Eigen::MatrixXd& k, const Eigen::MatrixXd& n2) const {
+void gp::kernel::RBFCovFun::covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    const double inverseWidth = this->parameters(0);
+    const double variance = this->parameters(1);
+
+    Eigen::MatrixXd n2;
+    math::dist2(n2, X, X);
+    dK.resize(2);
+    // dk/dvariance = exp(-w/2 n2), dk/dw = -1/2 n2 k
+    dK[1] = -0.5*inverseWidth*n2;
+    math::simd::exp(dK[1].data(), dK[1].size());
+    dK[0] = -0.5*variance*(n2.array()*dK[1].array());
+}
+
+void gp::kernel::RBFCovFun::covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const
+{
+    const double inverseWidth = this->parameters(0);
+    const double variance = this->parameters(1);
+
+    Eigen::MatrixXd n2;
+    math::dist2(n2, X, X);
+    // both derivatives share the factor exp(-w/2 n2), contract it with covGrad once
+    Eigen::ArrayXXd weighted = -0.5*inverseWidth*n2.array();
+    math::simd::exp(weighted.data(), weighted.size());
+    weighted *= covGrad.array();
+    g.resize(2);
+    g(0) = -0.5*variance*(weighted*n2.array()).sum();
+    g(1) = weighted.sum();
+}
+
+void gp::kernel::RBFCovFun::kerncomputeTile(Eigen::Ref<Eigen::MatrixXd> K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2,
+                                            const Eigen::Ref<const Eigen::VectorXd>& sq1, const Eigen::Ref<const Eigen::VectorXd>& sq2) const
+{
     const double inverseWidth = this->parameters(0);
     const double variance = this->parameters(1);
 
-    const double wi2 = (0.5 * inverseWidth);
-    k = variance * (-n2*wi2).array().exp();
+    // squared distance ||x1||^2 + ||x2||^2 - 2 x1^T x2 and exp in one pass over each column of the tile
+    K.noalias() = X1*X2.transpose();
+    for(Eigen::Index j = 0; j < K.cols(); ++j){
+        math::simd::sqExpFromInnerProducts(K.col(j).data(), sq1.data(), sq2(j), K.rows(), -0.5*inverseWidth, variance);
+    }
 }
@@ -36,6 +36,14 @@ namespace gp::kernel
  * - [0]: inverse width,  default = 1.0\par
  * - [1]: variance,       default = 1.0
  *
+ * \f$ k(x, x') = \sigma_f \exp\left(-\frac{w}{2} \|x - x'\|^2\right) \f$ for the inverse width w and the variance \f$ \sigma_f \f$.
+ * The derivatives with respect to the parameters are computed analytically.
+ * The covariance matrix is assembled in cache-sized tiles, computing the distances and the exponential
+ * in a single pass per tile. For symmetric covariance matrices only the lower tiles are computed.
+ * The exponential is evaluated by the vectorized kernels of math::simd, selected at runtime for the CPU.
+ * The single precision cross covariance is computed in float throughout, the squared distances
+ * have an absolute error of about 1e-7 times the squared norms of the inputs.
+ *
 */
 class RBFCovFun : public CovarianceFunction {
 public:
@@ -70,12 +78,25 @@ public:
      */
     virtual std::shared_ptr<util::Prototype> copy() const override;
 
+    /**
+     * @return True, the covariances depend on the distance only.
+     */
+    virtual bool isDistanceBased() const override;
+
 protected:
-    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::MatrixXd& X1, const Eigen::MatrixXd& X2) const override;
-    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::MatrixXd& X) const override;
-    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::MatrixXd& X) const override;
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2) const override;
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionFromSquaredDistances(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& D2, const Eigen::Index dim) const override;
+    virtual void covariancefunctionSingle(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X1, const Eigen::Ref<const Eigen::MatrixXf>& X2) const override;
+    virtual void covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const override;
 private:
-    void kerncompute(Eigen::MatrixXd& k, const Eigen::MatrixXd& n2) const;
+    /**
+     * Compute a tile of the covariance matrix from the inputs and their squared norms.
+     */
+    void kerncomputeTile(Eigen::Ref<Eigen::MatrixXd> K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2,
+                         const Eigen::Ref<const Eigen::VectorXd>& sq1, const Eigen::Ref<const Eigen::VectorXd>& sq2) const;
 };
 
 } // namespace gp::kernel
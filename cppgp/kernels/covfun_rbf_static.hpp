@@ -0,0 +1,183 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Eigen>
+
+#include <cppgp/kernels/covfun_static.hpp>
+
+namespace gp::kernel
+{
+
+/**
+ * Radial basis function with compile-time input dimension D and scalar type Scalar.
+ *
+ * Same covariance function and parameters as RBFCovFun:\par
+ * - [0]: inverse width,  default = 1.0\par
+ * - [1]: variance,       default = 1.0
+ *
+ * The squared distances are accumulated directly from the coordinate differences. The loop over
+ * the D coordinates is unrolled at compile time and the loop over the data points is vectorized.
+ * Use StaticRBFCovFun to plug it into a GPKernel.
+ */
+template<int D, class Scalar_ = double>
+class StaticRBF {
+public:
+    static_assert(D > 0, "The input dimension must be positive");
+
+    typedef Scalar_ Scalar;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, D> Input;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Matrix;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> Vector;
+
+    static constexpr int dimension = D;
+    static constexpr unsigned int nParameters = 2;
+
+    /**
+     * Constructor taking the two parameters as parameter vector.
+     */
+    StaticRBF(const Eigen::VectorXd& params) :
+        inverseWidth(static_cast<Scalar>(params(0))), variance(static_cast<Scalar>(params(1)))
+    {}
+
+    /**
+     * @return The default parameters.
+     */
+    static Eigen::VectorXd defaultParameters()
+    {
+        return Eigen::VectorXd::Ones(nParameters);
+    }
+
+    /**
+     * Compute the cross covariance.
+     *
+     * @param K Returns the covariance matrix, size [n1, n2]
+     * @param X1 Input data, size [n1, D]
+     * @param X2 Input data, size [n2, D]
+     */
+    void K(Matrix& K, const Eigen::Ref<const Input>& X1, const Eigen::Ref<const Input>& X2) const
+    {
+        K.resize(X1.rows(), X2.rows());
+        for(Eigen::Index j = 0; j < X2.rows(); ++j){
+            auto k = K.col(j);
+            sqDist(k, X1, X2, j);
+            k.array() = variance*(scale()*k.array()).exp();
+        }
+    }
+
+    /**
+     * Compute the covariance matrix, only the lower triangle is evaluated.
+     *
+     * @param K Returns the covariance matrix, size [n, n]
+     * @param X Input data, size [n, D]
+     */
+    void K(Matrix& K, const Eigen::Ref<const Input>& X) const
+    {
+        const Eigen::Index n = X.rows();
+        K.resize(n, n);
+        for(Eigen::Index j = 0; j < n; ++j){
+            auto k = K.col(j).tail(n-j);
+            sqDist(k, X.bottomRows(n-j), X, j);
+            k.array() = variance*(scale()*k.array()).exp();
+        }
+        K.template triangularView<Eigen::StrictlyUpper>() = K.transpose();
+    }
+
+    /**
+     * Compute the diagonal of the covariance matrix.
+     */
+    void diagK(Eigen::VectorXd& K, const Eigen::Ref<const Input>& X) const
+    {
+        K = Eigen::VectorXd::Constant(X.rows(), variance);
+    }
+
+    /**
+     * Compute the derivatives of the covariance matrix with respect to the parameters, see CovarianceFunction::dK_dP.
+     */
+    void dK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Input>& X) const
+    {
+        const Eigen::Index n = X.rows();
+        dK.assign(2, Eigen::MatrixXd(n, n));
+        Vector d(n);
+        for(Eigen::Index j = 0; j < n; ++j){
+            sqDist(d, X, X, j);
+            const Eigen::Array<Scalar, Eigen::Dynamic, 1> e = (scale()*d.array()).exp();
+            dK[1].col(j) = e.template cast<double>().matrix();
+            dK[0].col(j) = (-0.5*static_cast<double>(variance))*(d.array()*e).template cast<double>().matrix();
+        }
+    }
+
+    /**
+     * Compute the gradient of a scalar function of the covariance matrix, see CovarianceFunction::gradient.
+     */
+    void gradient(Eigen::VectorXd& g, const Eigen::Ref<const Input>& X, const Eigen::MatrixXd& covGrad) const
+    {
+        const Eigen::Index n = X.rows();
+        g = Eigen::VectorXd::Zero(2);
+        Vector d(n);
+        for(Eigen::Index j = 0; j < n; ++j){
+            sqDist(d, X, X, j);
+            const Eigen::ArrayXd e = (scale()*d.array()).exp().template cast<double>();
+            const Eigen::ArrayXd weighted = covGrad.col(j).array()*e;
+            g(0) += (weighted*d.array().template cast<double>()).sum();
+            g(1) += weighted.sum();
+        }
+        g(0) *= -0.5*static_cast<double>(variance);
+    }
+
+private:
+    /**
+     * The factor of the squared distance in the exponent, -w/2.
+     */
+    Scalar scale() const
+    {
+        return Scalar(-0.5)*inverseWidth;
+    }
+
+    /**
+     * Squared distances between the rows of X1 and the row j of X2, unrolled over the D coordinates.
+     */
+    template<class Out>
+    static void sqDist(Out&& d, const Eigen::Ref<const Input>& X1, const Eigen::Ref<const Input>& X2, const Eigen::Index j)
+    {
+        d = (X1.col(0).array() - X2(j, 0)).square().matrix();
+        for(int c = 1; c < D; ++c){
+            d.array() += (X1.col(c).array() - X2(j, c)).square();
+        }
+    }
+
+    Scalar inverseWidth;
+    Scalar variance;
+};
+
+/**
+ * The radial basis function with compile-time input dimension as CovarianceFunction, see StaticRBF.
+ */
+template<int D, class Scalar = double>
+using StaticRBFCovFun = StaticCovFunAdapter<StaticRBF<D, Scalar>>;
+
+} // namespace gp::kernel
@@ -0,0 +1,177 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Eigen>
+
+#include <cppgp/kernels/covfun.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+namespace gp::kernel
+{
+
+/**
+ * Adapter that makes a covariance function with compile-time input dimension and scalar type
+ * usable as CovarianceFunction, e.g. within a GPKernel.
+ *
+ * The wrapped class StaticCovFun is evaluated without virtual calls and on inputs of the type
+ * Eigen::Matrix<Scalar, Eigen::Dynamic, D>, such that loops over the input dimension are unrolled
+ * at compile time. It has to provide:\par
+ * - the typedefs Scalar, Input (= Eigen::Matrix<Scalar, Eigen::Dynamic, D>) and Matrix,\par
+ * - the constants dimension (= D) and nParameters,\par
+ * - a constructor from the parameter vector and a static method defaultParameters(),\par
+ * - the const methods K(Matrix&, X1, X2), K(Matrix&, X), diagK(Eigen::VectorXd&, X),
+ *   dK_dP(std::vector<Eigen::MatrixXd>&, X) and gradient(Eigen::VectorXd&, X, covGrad).
+ *
+ * Double precision inputs are mapped without copying if Scalar is double, otherwise they are converted.
+ * See StaticRBF for an example.
+ */
+template<class StaticCovFun>
+class StaticCovFunAdapter : public CovarianceFunction {
+public:
+    typedef typename StaticCovFun::Scalar Scalar;
+    typedef typename StaticCovFun::Input Input;
+
+    /**
+     * Default constructor, uses the default parameters of StaticCovFun.
+     */
+    StaticCovFunAdapter() :
+        CovarianceFunction(StaticCovFun::defaultParameters())
+    {}
+
+    /**
+     * Constructor taking the parameters as parameter vector.
+     *
+     * @param params The parameters, size [StaticCovFun::nParameters]
+     */
+    StaticCovFunAdapter(const Eigen::VectorXd& params) :
+        CovarianceFunction(params)
+    {
+        assert(params.size() == StaticCovFun::nParameters);
+    }
+
+    /**
+     * Deconstructor
+     */
+    virtual ~StaticCovFunAdapter() {}
+
+    /**
+     * Create a deep copy of the object.
+     *
+     * @return The deep copy of the object.
+     */
+    virtual std::shared_ptr<util::Prototype> copy() const override
+    {
+        return std::make_shared<StaticCovFunAdapter>(*this);
+    }
+
+protected:
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2) const override
+    {
+        const StaticCovFun covfun(this->parameters);
+        if constexpr(std::is_same_v<Scalar, double>){
+            covfun.K(K, toInput(X1), toInput(X2));
+        }
+        else {
+            typename StaticCovFun::Matrix Ks;
+            covfun.K(Ks, toInput(X1), toInput(X2));
+            K = Ks.template cast<double>();
+        }
+    }
+
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override
+    {
+        const StaticCovFun covfun(this->parameters);
+        if constexpr(std::is_same_v<Scalar, double>){
+            covfun.K(K, toInput(X));
+        }
+        else {
+            typename StaticCovFun::Matrix Ks;
+            covfun.K(Ks, toInput(X));
+            K = Ks.template cast<double>();
+        }
+    }
+
+    virtual void covariancefunctionSingle(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X1, const Eigen::Ref<const Eigen::MatrixXf>& X2) const override
+    {
+        const StaticCovFun covfun(this->parameters);
+        if constexpr(std::is_same_v<Scalar, float>){
+            checkDimension(X1);
+            checkDimension(X2);
+            const Eigen::Map<const Input, 0, Eigen::OuterStride<>> X1s(X1.data(), X1.rows(), StaticCovFun::dimension, Eigen::OuterStride<>(X1.outerStride()));
+            const Eigen::Map<const Input, 0, Eigen::OuterStride<>> X2s(X2.data(), X2.rows(), StaticCovFun::dimension, Eigen::OuterStride<>(X2.outerStride()));
+            covfun.K(K, X1s, X2s);
+        }
+        else {
+            Eigen::MatrixXd Kd;
+            this->covariancefunction(Kd, X1.cast<double>(), X2.cast<double>());
+            K = Kd.cast<float>();
+        }
+    }
+
+    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override
+    {
+        StaticCovFun(this->parameters).diagK(K, toInput(X));
+    }
+
+    virtual void covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const override
+    {
+        StaticCovFun(this->parameters).dK_dP(dK, toInput(X));
+    }
+
+    virtual void covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const override
+    {
+        StaticCovFun(this->parameters).gradient(g, toInput(X), covGrad);
+    }
+
+private:
+    template<class Derived>
+    static void checkDimension(const Eigen::MatrixBase<Derived>& X)
+    {
+        if(X.cols() != StaticCovFun::dimension){
+            util::exceptions::throwException<util::exceptions::InconsistentInputError>("Data dimension does not match the dimension of the covariance function");
+        }
+    }
+
+    /**
+     * View on the input data with the compile-time dimension, a converted copy if Scalar is not double.
+     */
+    static auto toInput(const Eigen::Ref<const Eigen::MatrixXd>& X)
+    {
+        checkDimension(X);
+        if constexpr(std::is_same_v<Scalar, double>){
+            return Eigen::Map<const Input, 0, Eigen::OuterStride<>>(X.data(), X.rows(), StaticCovFun::dimension, Eigen::OuterStride<>(X.outerStride()));
+        }
+        else {
+            return Input(X.template cast<Scalar>());
+        }
+    }
+};
+
+} // namespace gp::kernel
@@ -0,0 +1,203 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "covfun_wendland.hpp"
+#include "distancecache.hpp"
+
+#include <cppgp/math/distance.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <cmath>
+
+gp::kernel::WendlandCovFun::WendlandCovFun(const unsigned int smoothness, const double radius, const double variance) :
+    CovarianceFunction(Eigen::Vector2d(radius, variance)),
+    smoothness(smoothness)
+{
+    if(smoothness > 2){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The smoothness of the Wendland covariance function must be 0, 1 or 2");
+    }
+}
+
+gp::kernel::WendlandCovFun::WendlandCovFun(const unsigned int smoothness, const Eigen::VectorXd& params) :
+    WendlandCovFun(smoothness, params(0), params(1))
+{
+    assert(params.size() == 2);
+}
+
+gp::kernel::WendlandCovFun::~WendlandCovFun()
+{}
+
+std::shared_ptr<util::Prototype> gp::kernel::WendlandCovFun::copy() const
+{
+    CovarianceFunction* cfun = new WendlandCovFun(*this);
+    return std::shared_ptr<CovarianceFunction>(cfun);
+}
+
+bool gp::kernel::WendlandCovFun::hasCompactSupport() const
+{
+    return true;
+}
+
+bool gp::kernel::WendlandCovFun::isDistanceBased() const
+{
+    return true;
+}
+
+unsigned int gp::kernel::WendlandCovFun::getSmoothness() const
+{
+    return this->smoothness;
+}
+
+void gp::kernel::WendlandCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X1, const Eigen::Ref<const Eigen::MatrixXd> &X2) const
+{
+    math::dist2(K, X1, X2);
+    K = K.cwiseSqrt();
+    this->wendland(Eigen::Map<Eigen::ArrayXd>(K.data(), K.size()), nullptr, X1.cols());
+    K *= this->parameters(1);
+}
+
+void gp::kernel::WendlandCovFun::covariancefunction(Eigen::MatrixXd &K, const Eigen::Ref<const Eigen::MatrixXd> &X) const
+{
+    DistanceCache::computeDistances(K, X);
+    this->wendland(Eigen::Map<Eigen::ArrayXd>(K.data(), K.size()), nullptr, X.cols());
+    K *= this->parameters(1);
+}
+
+void gp::kernel::WendlandCovFun::covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    K = Eigen::VectorXd::Constant(X.rows(), this->parameters(1));
+}
+
+void gp::kernel::WendlandCovFun::covariancefunctionSparse(Eigen::SparseMatrix<double>& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    math::sparseDist(K, X, X, this->radius());
+    Eigen::Map<Eigen::ArrayXd> values(K.valuePtr(), K.nonZeros());
+    this->wendland(values, nullptr, X.cols());
+    values *= this->parameters(1);
+}
+
+void gp::kernel::WendlandCovFun::covariancefunctionFromSquaredDistances(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& D2, const Eigen::Index dim) const
+{
+    K = D2.cwiseSqrt();
+    this->wendland(Eigen::Map<Eigen::ArrayXd>(K.data(), K.size()), nullptr, dim);
+    K *= this->parameters(1);
+}
+
+void gp::kernel::WendlandCovFun::covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const
+{
+    const Eigen::Index n = X.rows();
+    dK.resize(2);
+    DistanceCache::computeDistances(dK[1], X);
+    Eigen::ArrayXd dRadius;
+    this->wendland(Eigen::Map<Eigen::ArrayXd>(dK[1].data(), dK[1].size()), &dRadius, X.cols());
+    // dk/dradius = variance dphi/dradius, dk/dvariance = phi
+    dK[0] = this->parameters(1)*dRadius.reshaped(n, n).matrix();
+}
+
+void gp::kernel::WendlandCovFun::covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const
+{
+    // only the pairs within the support radius contribute
+    Eigen::SparseMatrix<double> D;
+    math::sparseDist(D, X, X, this->radius());
+    Eigen::Map<Eigen::ArrayXd> values(D.valuePtr(), D.nonZeros());
+    Eigen::ArrayXd dRadius;
+    this->wendland(values, &dRadius, X.cols());
+    g = Eigen::VectorXd::Zero(2);
+    Eigen::Index k = 0;
+    for(Eigen::Index j = 0; j < D.outerSize(); ++j){
+        for(Eigen::SparseMatrix<double>::InnerIterator it(D, j); it; ++it, ++k){
+            const double c = covGrad(it.row(), it.col());
+            g(0) += c*dRadius(k);
+            g(1) += c*it.value();
+        }
+    }
+    g(0) *= this->parameters(1);
+}
+
+void gp::kernel::WendlandCovFun::covariancefunctionGradientSparse(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::SparseMatrix<double>& covGrad) const
+{
+    // the distances of the stored pairs, the pairs outside of the support radius evaluate to zero
+    Eigen::ArrayXd values(covGrad.nonZeros());
+    Eigen::ArrayXd c(covGrad.nonZeros());
+    Eigen::Index k = 0;
+    for(Eigen::Index j = 0; j < covGrad.outerSize(); ++j){
+        for(Eigen::SparseMatrix<double>::InnerIterator it(covGrad, j); it; ++it, ++k){
+            values(k) = (X.row(it.row()) - X.row(it.col())).norm();
+            c(k) = it.value();
+        }
+    }
+    Eigen::ArrayXd dRadius;
+    this->wendland(values, &dRadius, X.cols());
+    g.resize(2);
+    g(0) = this->parameters(1)*(c*dRadius).sum();
+    g(1) = (c*values).sum();
+}
+
+void gp::kernel::WendlandCovFun::wendland(Eigen::Ref<Eigen::ArrayXd> values, Eigen::ArrayXd* dRadius, const Eigen::Index dim) const
+{
+    const double rho = this->radius();
+    const double l = dim/2 + this->smoothness + 1;
+    if(dRadius != nullptr){
+        dRadius->resize(values.size());
+    }
+    for(Eigen::Index i = 0; i < values.size(); ++i){
+        const double t = values(i)/rho;
+        if(t >= 1.0){
+            values(i) = 0.0;
+            if(dRadius != nullptr){
+                (*dRadius)(i) = 0.0;
+            }
+            continue;
+        }
+        const double s = 1.0 - t;
+        double phi, dphi; // phi(t) and dphi/dt
+        switch(this->smoothness){
+        case 0:
+            phi = std::pow(s, l);
+            dphi = -l*std::pow(s, l-1);
+            break;
+        case 1:
+            phi = std::pow(s, l+1)*((l+1)*t + 1);
+            dphi = -(l+1)*(l+2)*t*std::pow(s, l);
+            break;
+        default:
+            phi = std::pow(s, l+2)*(((l*l + 4*l + 3)*t + 3*l + 6)*t + 3)/3.0;
+            dphi = -(l+3)*(l+4)/3.0*t*std::pow(s, l+1)*((l+1)*t + 1);
+            break;
+        }
+        values(i) = phi;
+        if(dRadius != nullptr){
+            // dt/drho = -t/rho
+            (*dRadius)(i) = -dphi*t/rho;
+        }
+    }
+}
+
+double gp::kernel::WendlandCovFun::radius() const
+{
+    if(this->parameters(0) <= 0){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The support radius must be positive");
+    }
+    return this->parameters(0);
+}
@@ -0,0 +1,120 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <cppgp/kernels/covfun.hpp>
+
+namespace gp::kernel
+{
+
+/**
+ * Compactly supported covariance functions of Wendland.
+ *
+ * This class has two parameters:\par
+ * - [0]: support radius, default = 1.0\par
+ * - [1]: variance,       default = 1.0
+ *
+ * \f$ k(x, x') = \sigma_f \phi_{d,q}(\|x - x'\|/\rho) \f$ for the support radius \f$ \rho \f$ and the variance \f$ \sigma_f \f$.
+ * The Wendland functions vanish for distances beyond the support radius and are positive definite for inputs of dimension d,
+ * with \f$ l = \lfloor d/2 \rfloor + q + 1 \f$ and \f$ t = r/\rho < 1 \f$:\par
+ * - q = 0: \f$ \phi(t) = (1-t)^l \f$, continuous\par
+ * - q = 1: \f$ \phi(t) = (1-t)^{l+1} ((l+1)t + 1) \f$, twice differentiable\par
+ * - q = 2: \f$ \phi(t) = (1-t)^{l+2} ((l^2+4l+3)t^2 + (3l+6)t + 3)/3 \f$, four times differentiable
+ *
+ * The covariance matrices are sparse, see CovarianceFunction::sparseK. The pairs within the support radius are
+ * found by a spatial neighbor search, see math::sparseDist, and the gradient is accumulated over these pairs only.
+*/
+class WendlandCovFun : public CovarianceFunction {
+public:
+
+    /**
+     * Constructor taking the smoothness and the two parameters
+     *
+     * @param smoothness The smoothness q, 0, 1 or 2.
+     * @param radius The support radius
+     * @param variance The variance
+     */
+    WendlandCovFun(const unsigned int smoothness=1, const double radius=1.0, const double variance=1.0);
+
+    /**
+     * Constructor taking the smoothness and the two parameters as parameter vector
+     */
+    WendlandCovFun(const unsigned int smoothness, const Eigen::VectorXd& params);
+
+    /**
+     * Deconstructor
+     */
+    virtual ~WendlandCovFun();
+
+    /**
+     * Create a deep copy of the object.
+     *
+     * @return The deep copy of the object.
+     */
+    virtual std::shared_ptr<util::Prototype> copy() const override;
+
+    /**
+     * @return True, the covariance matrices are sparse.
+     */
+    virtual bool hasCompactSupport() const override;
+
+    /**
+     * @return True, the covariances depend on the distance only.
+     */
+    virtual bool isDistanceBased() const override;
+
+    /**
+     * @return The smoothness q.
+     */
+    unsigned int getSmoothness() const;
+
+protected:
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2) const override;
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionSparse(Eigen::SparseMatrix<double>& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionFromSquaredDistances(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& D2, const Eigen::Index dim) const override;
+    virtual void covariancefunctionDK_dP(std::vector<Eigen::MatrixXd>& dK, const Eigen::Ref<const Eigen::MatrixXd>& X) const override;
+    virtual void covariancefunctionGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::MatrixXd& covGrad) const override;
+    virtual void covariancefunctionGradientSparse(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& X, const Eigen::SparseMatrix<double>& covGrad) const override;
+private:
+    /**
+     * Evaluate the Wendland function on distances in place, optionally with its derivative with respect to the support radius.
+     *
+     * @param values The distances on input, returns \f$ \phi(r/\rho) \f$.
+     * @param dRadius If not nullptr, returns \f$ d\phi/d\rho \f$, the same size as values.
+     * @param dim The input dimension d.
+     */
+    void wendland(Eigen::Ref<Eigen::ArrayXd> values, Eigen::ArrayXd* dRadius, const Eigen::Index dim) const;
+
+    /**
+     * @return The support radius, throws an exception if it is not positive.
+     */
+    double radius() const;
+
+    unsigned int smoothness;
+};
+
+} // namespace gp::kernel
@@ -0,0 +1,96 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "distancecache.hpp"
+
+#include <cppgp/math/distance.hpp>
+
+#include <functional>
+
+gp::kernel::DistanceCache::DistanceCache() :
+    D(nullptr), computations(0)
+{}
+
+std::shared_ptr<const Eigen::MatrixXd> gp::kernel::DistanceCache::distances(const InputKey& key, const Eigen::Ref<const Eigen::MatrixXd>& X)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if(this->D == nullptr || !(this->key == key)){
+        auto distances = std::make_shared<Eigen::MatrixXd>();
+        computeDistances(*distances, X);
+        this->D = distances;
+        this->key = key;
+        ++this->computations;
+    }
+    return this->D;
+}
+
+bool gp::kernel::DistanceCache::block(Eigen::MatrixXd& D, const InputKey& key1, const InputKey& key2) const
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if(this->D == nullptr){
+        return false;
+    }
+    const Eigen::Index offset1 = this->rowOffset(key1);
+    const Eigen::Index offset2 = this->rowOffset(key2);
+    if(offset1 < 0 || offset2 < 0){
+        return false;
+    }
+    D = this->D->block(offset1, offset2, key1.rows, key2.rows);
+    return true;
+}
+
+void gp::kernel::DistanceCache::clear()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->D = nullptr;
+}
+
+unsigned long gp::kernel::DistanceCache::getComputations() const
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->computations;
+}
+
+void gp::kernel::DistanceCache::computeDistances(Eigen::MatrixXd& D, const Eigen::Ref<const Eigen::MatrixXd>& X)
+{
+    math::dist2(D, X, X);
+    D = D.cwiseSqrt();
+    // remove the rounding errors of the squared norms on the diagonal and between the triangles
+    D.diagonal().setZero();
+    D.triangularView<Eigen::StrictlyUpper>() = D.transpose();
+}
+
+Eigen::Index gp::kernel::DistanceCache::rowOffset(const InputKey& key) const
+{
+    // a row block shares the columns of the cached data, its first entry lies in the first column
+    if(key.version != this->key.version || key.cols != this->key.cols || key.outerStride != this->key.outerStride){
+        return -1;
+    }
+    const std::less<const double*> less;
+    if(less(key.data, this->key.data) || !less(key.data, this->key.data + this->key.rows)){
+        return -1;
+    }
+    const Eigen::Index offset = key.data - this->key.data;
+    return (offset + key.rows <= this->key.rows) ? offset : -1;
+}
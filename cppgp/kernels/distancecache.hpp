@@ -0,0 +1,109 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include <Eigen/Eigen>
+
+#include <cppgp/kernels/covfun.hpp>
+
+namespace gp::kernel {
+
+/**
+ * Cache for the Euclidean distances between the training inputs, shared between covariance functions
+ * that depend on the distance only, e.g. the Matérn covariance functions.
+ *
+ * The cache holds the distance matrix of the most recently requested input data, identified by its InputKey.
+ * Covariance functions that are evaluated on the same GPData in turn, or that are composed, therefore
+ * compute the distances once per data version. By default, each GPKernel owns a cache, which it attaches
+ * to its covariance function (see CovarianceFunction::attachDistanceCache) and clears when the data changes,
+ * such that the distances are released together with the kernel. A cache can also be shared explicitly
+ * between the covariance functions of several kernels on the same data, see MaternCovFun::setDistanceCache.
+ *
+ * All methods are thread safe. The distance matrices are handed out as shared pointers, so they stay valid
+ * while they are used, even if the cache moves on to other data.
+ */
+class DistanceCache {
+public:
+    /**
+     * Create an empty cache.
+     */
+    DistanceCache();
+
+    /**
+     * Get the Euclidean distances between the rows of X. They are computed only if the cache does not hold
+     * the distances for the given key. Concurrent requests for the same key compute the distances once.
+     *
+     * @param key The key of the input data, see CovarianceFunction::setInputVersion.
+     * @param X The input data, size [n, k].
+     * @return The distance matrix, size [n, n].
+     */
+    std::shared_ptr<const Eigen::MatrixXd> distances(const InputKey& key, const Eigen::Ref<const Eigen::MatrixXd>& X);
+
+    /**
+     * Get the distances between two row blocks of the cached input data, e.g. for a tile of a covariance matrix,
+     * without computing any distances.
+     *
+     * @param D Returns the distances, size [n1, n2].
+     * @param key1 The key of the first input data, size [n1, k].
+     * @param key2 The key of the second input data, size [n2, k].
+     * @return False if the cache does not hold input data that contains both row blocks, then D is not changed.
+     */
+    bool block(Eigen::MatrixXd& D, const InputKey& key1, const InputKey& key2) const;
+
+    /**
+     * Release the cached distances.
+     */
+    void clear();
+
+    /**
+     * @return The number of distance matrices that have been computed by this cache.
+     */
+    unsigned long getComputations() const;
+
+    /**
+     * Compute the Euclidean distances between the rows of X without caching.
+     * The matrix is exactly symmetric with a zero diagonal.
+     *
+     * @param D Returns the distance matrix, size [n, n].
+     * @param X The input data, size [n, k].
+     */
+    static void computeDistances(Eigen::MatrixXd& D, const Eigen::Ref<const Eigen::MatrixXd>& X);
+
+private:
+    /**
+     * Get the first row of the cached input data that is the first row of the given key, -1 if the key is not a row block.
+     */
+    Eigen::Index rowOffset(const InputKey& key) const;
+
+    mutable std::mutex mutex;
+    InputKey key;
+    std::shared_ptr<const Eigen::MatrixXd> D;
+    unsigned long computations;
+};
+
+} // namespace gp::kernel
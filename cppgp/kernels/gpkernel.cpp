@@ -23,27 +23,82 @@
 */
 
 #include <cppgp/kernels/gpkernel.hpp>
-
+#include <cppgp/math/cholesky.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace {
+    /**
+     * Declares the version of the registered data to the covariance function for the lifetime of the object,
+     * such that it can cache precomputations of the training inputs.
+     */
+    class InputVersionScope {
+    public:
+        InputVersionScope(gp::kernel::CovarianceFunction& covfun, const gp::GPData& data) : covfun(covfun)
+        {
+            covfun.setInputVersion(data.getVersion());
+        }
+        ~InputVersionScope()
+        {
+            covfun.clearInputVersion();
+        }
+    private:
+        gp::kernel::CovarianceFunction& covfun;
+    };
+}
 
 gp::kernel::GPKernel::GPKernel(const std::shared_ptr<gp::kernel::CovarianceFunction> &covfun):
-    covfun(covfun), data(nullptr), is_alpha_computed(false)
-{}
+    covfun(covfun), distanceCache(std::make_shared<DistanceCache>()), data(nullptr), noise(0.0),
+    parameterVersion(0),
+    nLandmarks(0), landmarkSelection(LandmarkSelection::PIVOTED_CHOLESKY), landmarkSeed(0), landmarkDataVersion(0),
+    matrixFree(false)
+{
+    if(this->covfun != nullptr){
+        this->covfun->attachDistanceCache(this->distanceCache);
+    }
+}
 
 
 gp::kernel::GPKernel::GPKernel(const std::shared_ptr<gp::kernel::CovarianceFunction> covfun, const double noise):
-    covfun(covfun), noise(noise), is_alpha_computed(false)
-{}
+    covfun(covfun), distanceCache(std::make_shared<DistanceCache>()), data(nullptr), noise(noise),
+    parameterVersion(0),
+    nLandmarks(0), landmarkSelection(LandmarkSelection::PIVOTED_CHOLESKY), landmarkSeed(0), landmarkDataVersion(0),
+    matrixFree(false)
+{
+    if(this->covfun != nullptr){
+        this->covfun->attachDistanceCache(this->distanceCache);
+    }
+}
 
 
 gp::kernel::GPKernel::GPKernel(const GPKernel &gpkernel):
     covfun(std::dynamic_pointer_cast<CovarianceFunction>(gpkernel.covfun->copy())),
+    distanceCache(std::make_shared<DistanceCache>()),
     data(gpkernel.data),
-    is_alpha_computed(false)
-{}
+    noise(gpkernel.noise),
+    parameterVersion(0),
+    nLandmarks(gpkernel.nLandmarks), landmarkSelection(gpkernel.landmarkSelection), landmarkSeed(gpkernel.landmarkSeed),
+    landmarks(gpkernel.landmarks), landmarkDataVersion(gpkernel.landmarkDataVersion),
+    matrixFree(gpkernel.matrixFree), iterativeOptions(gpkernel.iterativeOptions)
+{
+    this->covfun->attachDistanceCache(this->distanceCache);
+    if(this->data != nullptr){
+        this->data->subscribe(this, std::bind(&gp::kernel::GPKernel::changedData_trigger, this));
+    }
+}
 
 
 gp::kernel::GPKernel::~GPKernel()
-{}
+{
+    if(this->data != nullptr){
+        this->data->unsubscribe(this);
+    }
+}
 
 
 std::shared_ptr<util::Prototype> gp::kernel::GPKernel::copy() const
@@ -58,13 +113,12 @@ void gp::kernel::GPKernel::registerData(const std::shared_ptr<gp::GPData> gpdata
         this->data->unsubscribe(this);
     }
     this->data = gpdata;
+    this->landmarks.clear();
+    this->distanceCache->clear();
     if(gpdata != nullptr){
         this->data->subscribe(this, std::bind(&gp::kernel::GPKernel::changedData_trigger, this));
-        changedData_trigger();
-    }
-    else {
-        is_alpha_computed = false;
     }
+    invalidateDecomposition();
 }
 
 
@@ -74,9 +128,8 @@ void gp::kernel::GPKernel::computeCov(Eigen::MatrixXd& K) const
         K = Eigen::MatrixXd(0, 0);
         return;
     }
-    Eigen::MatrixXd X;
-    data->getX(X);
-    covfun->K(K, X);
+    InputVersionScope scope(*this->covfun, *this->data);
+    covfun->K(K, data->getXView());
 }
 
 
@@ -86,23 +139,91 @@ void gp::kernel::GPKernel::computeNoisedCov(Eigen::MatrixXd &K) const
         K = Eigen::MatrixXd(0, 0);
         return;
     }
-    Eigen::MatrixXd X;
-    data->getX(X);
-    int n = X.rows();
-    covfun->K(K, X);
-    K = K + this->noise*Eigen::MatrixXd::Identity(n, n);
+    InputVersionScope scope(*this->covfun, *this->data);
+    covfun->K(K, data->getXView());
+    K.diagonal().array() += this->noise;
+}
+
+
+void gp::kernel::GPKernel::computeNoisedSparseCov(Eigen::SparseMatrix<double>& K) const
+{
+    if(this->data == nullptr){
+        K = Eigen::SparseMatrix<double>(0, 0);
+        return;
+    }
+    InputVersionScope scope(*this->covfun, *this->data);
+    covfun->sparseK(K, data->getXView());
+    Eigen::SparseMatrix<double> noise(K.rows(), K.cols());
+    noise.setIdentity();
+    K += this->noise*noise;
 }
 
 
-void gp::kernel::GPKernel::computeCrossCov(Eigen::MatrixXd& K, const Eigen::MatrixXd& X2) const
+void gp::kernel::GPKernel::computeCrossCov(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X2) const
 {
     if(this->data == nullptr){
         K = Eigen::MatrixXd(0, 0);
         return;
     }
-    Eigen::MatrixXd X1;
-    data->getX(X1);
-    covfun->K(K, X1, X2);
+    InputVersionScope scope(*this->covfun, *this->data);
+    covfun->K(K, data->getXView(), X2);
+}
+
+
+void gp::kernel::GPKernel::computeCrossCov(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X2) const
+{
+    if(this->data == nullptr){
+        K = Eigen::MatrixXf(0, 0);
+        return;
+    }
+    covfun->K(K, data->getXSingle(), X2);
+}
+
+
+void gp::kernel::GPKernel::computeNoisedCovGradient(Eigen::VectorXd& g, const Eigen::MatrixXd& covGrad) const
+{
+    g.resize(this->nParameters());
+    if(this->data == nullptr){
+        g.setZero();
+        return;
+    }
+    Eigen::VectorXd gcov;
+    InputVersionScope scope(*this->covfun, *this->data);
+    this->covfun->gradient(gcov, data->getXView(), covGrad);
+    // d(K + sigma I)/dsigma = I
+    g(0) = covGrad.trace();
+    g.tail(gcov.size()) = gcov;
+}
+
+
+void gp::kernel::GPKernel::computeNoisedCovGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& A, const Eigen::Ref<const Eigen::MatrixXd>& B) const
+{
+    g.resize(this->nParameters());
+    if(this->data == nullptr){
+        g.setZero();
+        return;
+    }
+    Eigen::VectorXd gcov;
+    this->covfun->gradientLowRank(gcov, data->getXView(), A, B);
+    // d(K + sigma I)/dsigma = I, the trace of A B^T
+    g(0) = (A.array()*B.array()).sum();
+    g.tail(gcov.size()) = gcov;
+}
+
+
+void gp::kernel::GPKernel::computeNoisedCovGradient(Eigen::VectorXd& g, const Eigen::SparseMatrix<double>& covGrad) const
+{
+    g.resize(this->nParameters());
+    if(this->data == nullptr){
+        g.setZero();
+        return;
+    }
+    Eigen::VectorXd gcov;
+    InputVersionScope scope(*this->covfun, *this->data);
+    this->covfun->gradientSparse(gcov, data->getXView(), covGrad);
+    // d(K + sigma I)/dsigma = I
+    g(0) = covGrad.diagonal().sum();
+    g.tail(gcov.size()) = gcov;
 }
 
 
@@ -112,9 +233,8 @@ void gp::kernel::GPKernel::computeCovDiag(Eigen::VectorXd& K) const
         K = Eigen::VectorXd(0);
         return;
     }
-    Eigen::MatrixXd X;
-    data->getX(X);
-    this->covfun->diagK(K, X);
+    InputVersionScope scope(*this->covfun, *this->data);
+    this->covfun->diagK(K, data->getXView());
 }
 
 void gp::kernel::GPKernel::testing()
@@ -122,12 +242,67 @@ void gp::kernel::GPKernel::testing()
 
 }
 
+void gp::kernel::GPKernel::setNystrom(const unsigned int nLandmarks, const LandmarkSelection selection, const unsigned int seed)
+{
+    this->nLandmarks = nLandmarks;
+    this->landmarkSelection = selection;
+    this->landmarkSeed = seed;
+    this->landmarks.clear();
+    invalidateDecomposition();
+}
+
+
+void gp::kernel::GPKernel::setMatrixFree(const bool matrixFree, const IterativeOptions& options)
+{
+    this->matrixFree = matrixFree;
+    this->iterativeOptions = options;
+    invalidateDecomposition();
+}
+
+
+bool gp::kernel::GPKernel::isMatrixFree() const
+{
+    return this->matrixFree;
+}
+
+
+const gp::kernel::IterativeOptions& gp::kernel::GPKernel::getIterativeOptions() const
+{
+    return this->iterativeOptions;
+}
+
+
+unsigned int gp::kernel::GPKernel::getNumLandmarks() const
+{
+    return this->nLandmarks;
+}
+
+
+gp::kernel::LandmarkSelection gp::kernel::GPKernel::getLandmarkSelection() const
+{
+    return this->landmarkSelection;
+}
+
+
+const std::vector<Eigen::Index>& gp::kernel::GPKernel::getLandmarks() const
+{
+    return this->landmarks;
+}
+
+
 void gp::kernel::GPKernel::getAlpha(Eigen::MatrixXd& alpha) const
 {
-    if(!is_alpha_computed){
-        precomputeAlpha();
+    alpha = this->getFactorization().getAlpha();
+}
+
+
+const gp::kernel::CovFactorization& gp::kernel::GPKernel::getFactorization() const
+{
+    this->updateDecomposition();
+    if(!this->factorization.isAlphaComputed() && this->data != nullptr){
+        this->factorization.computeAlpha(std::get<1>(this->data->getNormalizedData()));
     }
-    alpha = this->alpha;
+    return this->factorization;
 }
 
 
@@ -139,6 +314,7 @@ void gp::kernel::GPKernel::setNoise(const double noise)
     else {
         this->noise =  noise;
     }
+    invalidateDecomposition();
 }
 
 
@@ -148,29 +324,15 @@ double gp::kernel::GPKernel::getNoise() const
 }
 
 
-/*
-void gp::kernel::GPKernel::getNoisedInvCov(Eigen::MatrixXd& ICov) const
-{
-    this->computeNoisedCov(ICov, );
-}
-*/
-
-
 void gp::kernel::GPKernel::getNoisedInvCov(Eigen::MatrixXd& ICov, const Eigen::MatrixXd &B) const
 {
-    if(!is_alpha_computed){
-        precomputeAlpha();
-    }
-    ICov = this->noisedCovDecomp.solve(B);
+    this->getFactorization().solve(ICov, B);
 }
 
 
 double gp::kernel::GPKernel::computeNoisedLogDetCov() const
 {
-    if(!is_alpha_computed){
-        precomputeAlpha();
-    }
-    return this->noisedCovDecomp.vectorD().array().log().sum();
+    return this->getFactorization().logDet();
 }
 
 
@@ -178,7 +340,7 @@ void gp::kernel::GPKernel::setParameters(const Eigen::VectorXd& params, const un
 {
     this->noise = params(index);
     this->covfun->setParameters(params, index+1);
-    changedData_trigger();
+    invalidateDecomposition();
 }
 
 
@@ -195,6 +357,12 @@ unsigned int gp::kernel::GPKernel::nParameters() const
 }
 
 
+unsigned long gp::kernel::GPKernel::getParameterVersion() const
+{
+    return this->parameterVersion;
+}
+
+
 std::shared_ptr<gp::GPData> gp::kernel::GPKernel::getData() const
 {
     return this->data;
@@ -214,25 +382,186 @@ int gp::kernel::GPKernel::getN() const
 }
 
 
-void gp::kernel::GPKernel::precomputeAlpha() const
+void gp::kernel::GPKernel::updateDecomposition() const
 {
     if(this->data == nullptr){
         return;
     }
-    auto data = this->data->getNormalizedData();
-    Eigen::MatrixXd K;
-    this->computeNoisedCov(K);
-    noisedCovDecomp = K.ldlt();
-    auto tmp = std::get<1>(data);
-    alpha = noisedCovDecomp.solve(tmp);
-    is_alpha_computed = true;
+    const unsigned int n = this->getN();
+    const unsigned long dataVersion = this->data->getVersion();
+    if(factorization.isCurrent(dataVersion, parameterVersion) && factorization.getN() == n){
+        return;
+    }
+
+    // matrix-free: only the preconditioner is computed
+    if(this->matrixFree){
+        this->factorizeMatrixFree(dataVersion);
+        return;
+    }
+
+    // Nystrom approximation: low-rank factorization, which is always recomputed
+    if(this->nLandmarks > 0 && this->nLandmarks < n){
+        this->factorizeNystrom(dataVersion);
+        return;
+    }
+
+    // compact support: sparse factorization, which is always recomputed
+    if(this->covfun->hasCompactSupport()){
+        factorization.factorizeSparse([this](Eigen::SparseMatrix<double>& K){ this->computeNoisedSparseCov(K); }, dataVersion, parameterVersion);
+        return;
+    }
+
+    // data has only been appended: extend the existing decomposition by the new points
+    const unsigned int nFactored = factorization.getN();
+    if(factorization.isValid() && nFactored < n){
+        Eigen::MatrixXd Knew;
+        this->computeCrossCov(Knew, data->getXView().bottomRows(n-nFactored));
+        Knew.bottomRows(n-nFactored).diagonal().array() += this->noise;
+        if(factorization.append(Knew, dataVersion)){
+            return;
+        }
+        // numerical drift detected, fall back to full refactorization
+    }
+
+    factorization.factorize([this](Eigen::MatrixXd& K){ this->computeNoisedCov(K); }, dataVersion, parameterVersion);
+}
+
+
+void gp::kernel::GPKernel::factorizeNystrom(const unsigned long dataVersion) const
+{
+    // keep the landmarks while only the parameters change
+    if(this->landmarks.empty() || this->landmarkDataVersion != dataVersion){
+        this->selectLandmarks();
+        this->landmarkDataVersion = dataVersion;
+    }
+    const GPData::ConstView X = this->data->getXView();
+    Eigen::MatrixXd Xm(this->landmarks.size(), X.cols());
+    for(size_t i = 0; i < this->landmarks.size(); ++i){
+        Xm.row(i) = X.row(this->landmarks[i]);
+    }
+
+    // U = Knm Lmm^-T for the Cholesky factor Lmm of Kmm
+    Eigen::MatrixXd Lmm, U;
+    this->covfun->K(Lmm, Xm);
+    const double meanDiag = (Lmm.rows() > 0) ? Lmm.diagonal().mean() : 0.0;
+    const double scale = (meanDiag > 0) ? meanDiag : 1.0;
+    Eigen::VectorXd diag;
+    double jitter;
+    if(!math::cholJitter(Lmm, diag, jitter, 1e-10*scale, this->factorization.getMaxTries())){
+        util::exceptions::throwException<util::exceptions::Error>("Failed to decompose the covariance matrix of the landmark points.");
+    }
+    this->computeCrossCov(U, Xm);
+    Lmm.triangularView<Eigen::Lower>().transpose().solveInPlace<Eigen::OnTheRight>(U);
+    this->factorization.factorizeLowRank(U, this->noise, dataVersion, this->parameterVersion);
+}
+
+
+void gp::kernel::GPKernel::factorizeMatrixFree(const unsigned long dataVersion) const
+{
+    Eigen::MatrixXd F;
+    std::vector<Eigen::Index> pivots;
+    this->pivotedCholesky(F, pivots, this->iterativeOptions.preconditionerRank);
+
+    // the shared pointers keep the product valid independent of the lifetime of the kernel
+    const auto multiply = [covfun = this->covfun, data = this->data, noise = this->noise](Eigen::MatrixXd& Y, const Eigen::Ref<const Eigen::MatrixXd>& V){
+        covfun->multiplyK(Y, data->getXView(), V);
+        Y.noalias() += noise*V;
+    };
+    this->factorization.factorizeIterative(multiply, F, this->noise, this->iterativeOptions, dataVersion, this->parameterVersion);
+}
+
+
+void gp::kernel::GPKernel::pivotedCholesky(Eigen::MatrixXd& F, std::vector<Eigen::Index>& pivots, const unsigned int r) const
+{
+    const GPData::ConstView X = this->data->getXView();
+    const Eigen::Index n = X.rows();
+    const Eigen::Index m = std::min<Eigen::Index>(r, n);
+    pivots.clear();
+
+    // d holds the diagonal of K - F F^T
+    Eigen::VectorXd d;
+    this->computeCovDiag(d);
+    const double tolerance = 1e-10*std::max(d.mean(), 0.0);
+    F.resize(n, m);
+    Eigen::MatrixXd column;
+    for(Eigen::Index k = 0; k < m; ++k){
+        Eigen::Index pivot;
+        const double dmax = d.maxCoeff(&pivot);
+        if(dmax <= tolerance){
+            break;
+        }
+        pivots.push_back(pivot);
+        this->computeCrossCov(column, X.row(pivot));
+        F.col(k) = (column.col(0) - F.leftCols(k)*F.row(pivot).head(k).transpose())/std::sqrt(dmax);
+        d -= F.col(k).cwiseAbs2();
+        d(pivot) = 0.0;
+    }
+    F.conservativeResize(Eigen::NoChange, pivots.size());
+}
+
+
+void gp::kernel::GPKernel::selectLandmarks() const
+{
+    const GPData::ConstView X = this->data->getXView();
+    const Eigen::Index n = X.rows();
+    const Eigen::Index m = std::min<Eigen::Index>(this->nLandmarks, n);
+    std::mt19937 rng(this->landmarkSeed);
+    this->landmarks.clear();
+
+    switch(this->landmarkSelection){
+    case LandmarkSelection::UNIFORM: {
+        // partial Fisher-Yates shuffle
+        std::vector<Eigen::Index> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        for(Eigen::Index i = 0; i < m; ++i){
+            std::swap(order[i], order[std::uniform_int_distribution<Eigen::Index>(i, n-1)(rng)]);
+        }
+        this->landmarks.assign(order.begin(), order.begin() + m);
+        break;
+    }
+    case LandmarkSelection::KMEANSPP: {
+        // d holds the squared distances to the closest landmark
+        Eigen::Index next = std::uniform_int_distribution<Eigen::Index>(0, n-1)(rng);
+        Eigen::VectorXd d = Eigen::VectorXd::Constant(n, std::numeric_limits<double>::infinity());
+        while(true){
+            this->landmarks.push_back(next);
+            d = d.cwiseMin((X.rowwise() - X.row(next)).rowwise().squaredNorm());
+            if(static_cast<Eigen::Index>(this->landmarks.size()) == m || d.sum() <= 0){
+                break;
+            }
+            next = std::discrete_distribution<Eigen::Index>(d.data(), d.data() + n)(rng);
+        }
+        break;
+    }
+    case LandmarkSelection::PIVOTED_CHOLESKY: {
+        Eigen::MatrixXd F;
+        this->pivotedCholesky(F, this->landmarks, m);
+        break;
+    }
+    }
 }
 
 
 void gp::kernel::GPKernel::changedData_trigger()
 {
-    if(this->data != nullptr)
-    {
-        this->precomputeAlpha();
+    // the distances of the old data are not used anymore
+    this->distanceCache->clear();
+
+    // appended data points are added lazily to the decomposition, see updateDecomposition
+    const GPData::Change& change = this->data->getLastChange();
+    const unsigned int nFactored = factorization.getN();
+    if(change.type != GPData::Change::Type::REMOVE || !factorization.isValid() || change.index >= nFactored){
+        factorization.invalidateAlpha();
+        return;
     }
+    // removed data points that have been decomposed already
+    const unsigned int count = std::min(change.count, nFactored-change.index);
+    factorization.remove(change.index, count, this->data->getVersion());
+}
+
+
+void gp::kernel::GPKernel::invalidateDecomposition()
+{
+    ++parameterVersion;
+    factorization.invalidate();
 }
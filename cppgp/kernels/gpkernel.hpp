@@ -26,19 +26,42 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <Eigen/Eigen>
 
 #include <cppgp/kernels/covfun.hpp>
+#include <cppgp/kernels/covfactorization.hpp>
+#include <cppgp/kernels/distancecache.hpp>
 #include <cppgp/gp/gpdata.hpp>
 #include <cppgp/util/observer.hpp>
 #include <cppgp/util/prototype.hpp>
 
 namespace gp::kernel {
 
+/**
+ * Selection of the landmark points of the Nystrom approximation, see GPKernel::setNystrom.
+ * - UNIFORM: A uniformly random subset of the data points.
+ * - KMEANSPP: k-means++ seeding, each landmark is drawn with a probability proportional to its squared distance
+ *             to the closest landmark drawn before, which spreads the landmarks over the inputs.
+ * - PIVOTED_CHOLESKY: Greedy pivoted Cholesky factorization of the covariance matrix, each landmark is the data point
+ *                     with the largest residual variance given the landmarks before. It depends on the parameters
+ *                     at the time of the selection.
+ */
+enum class LandmarkSelection {UNIFORM, KMEANSPP, PIVOTED_CHOLESKY};
+
 
 /**
      * Kernel class for Gaussian processes based on a given covariance function.
      * Receives notifications from the GPData class as soon as the data changes.
+     * Removed data points are downdated from the cached decomposition immediately,
+     * appended data points are added to the decomposition lazily.
+     * The decomposition is owned by the kernel and shared with its users, see #getFactorization.
+     * For covariance functions with compact support, the sparse noised covariance matrix is decomposed
+     * by a sparse Cholesky factorization, see CovarianceFunction::hasCompactSupport.
+     * In Nystrom mode, the covariance matrix is replaced by a low-rank approximation from m landmark points
+     * whose factorization costs O(n m^2), see #setNystrom.
+     * In matrix-free mode, the covariance matrix is never stored, solves and the log determinant are computed
+     * iteratively from products of the covariance matrix with vectors, see #setMatrixFree.
      */
 class GPKernel : public util::IObserver, public util::Prototype {
 
@@ -112,6 +135,14 @@ class GPKernel : public util::IObserver, public util::Prototype {
      */
     void computeNoisedCov(Eigen::MatrixXd& K) const;
 
+    /**
+     * Compute the noised covariance matrix \f$(K + \sigma I)\f$ as a sparse matrix,
+     * for covariance functions with compact support, see CovarianceFunction::sparseK.
+     *
+     * @param K Returns the sparse covariance matrix, size [getN(), getN()].
+     */
+    void computeNoisedSparseCov(Eigen::SparseMatrix<double>& K) const;
+
     /**
      * Compute the cross covariance matrix using the covariance function
      * based on the registered data and the given data.
@@ -123,7 +154,46 @@ class GPKernel : public util::IObserver, public util::Prototype {
      * @param K Returns the covariance matrix, size [getN(), getN()].
      * @param X2 The data that is used together with the registered GPData to compute the cross covariance. Size [k, getData()->getDimX()], where k is arbitrary.
      */
-    void computeCrossCov(Eigen::MatrixXd& K, const Eigen::MatrixXd& X2) const;
+    void computeCrossCov(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X2) const;
+
+    /**
+     * Compute the cross covariance matrix in single precision, see CovarianceFunction::K.
+     * The registered data is used in single precision, see GPData::getXSingle.
+     *
+     * @param K Returns the covariance matrix, size [getN(), k].
+     * @param X2 The data in single precision, size [k, getData()->getDimX()].
+     */
+    void computeCrossCov(Eigen::MatrixXf& K, const Eigen::Ref<const Eigen::MatrixXf>& X2) const;
+
+    /**
+     * Compute the gradient of a scalar function \f$ f(K + \sigma I) \f$ of the noised covariance matrix
+     * with respect to the kernel parameters (see #getParameters), given the partial derivatives of f
+     * with respect to the entries of the noised covariance matrix. See also CovarianceFunction::gradient.
+     *
+     * @param g Returns the gradient, size [nParameters()].
+     * @param covGrad The partial derivatives of f, size [getN(), getN()].
+     */
+    void computeNoisedCovGradient(Eigen::VectorXd& g, const Eigen::MatrixXd& covGrad) const;
+
+    /**
+     * Compute the gradient of #computeNoisedCovGradient for partial derivatives of low rank \f$ A B^T \f$,
+     * without storing them or the covariance matrix, see CovarianceFunction::gradientLowRank.
+     *
+     * @param g Returns the gradient, size [nParameters()].
+     * @param A The left factor of the partial derivatives, size [getN(), r].
+     * @param B The right factor of the partial derivatives, size [getN(), r].
+     */
+    void computeNoisedCovGradient(Eigen::VectorXd& g, const Eigen::Ref<const Eigen::MatrixXd>& A, const Eigen::Ref<const Eigen::MatrixXd>& B) const;
+
+    /**
+     * Compute the gradient of #computeNoisedCovGradient for partial derivatives that are stored on a sparsity
+     * pattern including the pattern of the covariance matrix, for covariance functions with compact support,
+     * see CovarianceFunction::gradientSparse.
+     *
+     * @param g Returns the gradient, size [nParameters()].
+     * @param covGrad The partial derivatives, size [getN(), getN()].
+     */
+    void computeNoisedCovGradient(Eigen::VectorXd& g, const Eigen::SparseMatrix<double>& covGrad) const;
 
     /**
      * Compute the diagonal of the covariance matrix.
@@ -134,6 +204,11 @@ class GPKernel : public util::IObserver, public util::Prototype {
 
     /**
      * Compute the product of the inverse covariance matrix and the target observation vector.
+     * The Cholesky decomposition of the noised covariance matrix is computed lazily. If data points
+     * have only been appended since the last call, the existing decomposition is extended by the new
+     * points in O(n^2) instead of being recomputed. If the extension is numerically unreliable,
+     * the decomposition is recomputed from scratch.
+     *
      * In formulas:
      * \f[
      * \alpha := (K + \sigma I)^{-1}\bar{y}_{obs}
@@ -145,7 +220,15 @@ class GPKernel : public util::IObserver, public util::Prototype {
      */
     void getAlpha(Eigen::MatrixXd& alpha) const;
 
-    //void getNoisedInvCov(Eigen::MatrixXd& ICov) const;
+    /**
+     * Get the Cholesky factorization of the noised covariance matrix, including alpha (see #getAlpha).
+     * The factorization is brought up to date with the registered data and the kernel parameters
+     * before it is returned. The reference stays valid as long as the kernel exists,
+     * but its content changes with the data and the parameters.
+     *
+     * @return The up to date factorization.
+     */
+    const CovFactorization& getFactorization() const;
 
     /**
      * Set the kernel noise to the the absolute value of the given noise.
@@ -186,6 +269,67 @@ class GPKernel : public util::IObserver, public util::Prototype {
 
     void testing();
 
+    /**
+     * Switch to the Nystrom approximation of the covariance matrix
+     * \f[
+     * K \approx K_{nm} K_{mm}^{-1} K_{mn} = U U^T
+     * \f]
+     * with the cross covariances \f$ K_{nm} \f$ between the data points and m landmark points among them.
+     * The n x m factor U is stored by the factorization, which replaces the solves of #getNoisedInvCov and #getAlpha
+     * by the Woodbury identity and #computeNoisedLogDetCov by the matrix determinant lemma, see CovFactorization::factorizeLowRank.
+     * A factorization costs O(n m^2) time and O(n m) memory instead of O(n^3) and O(n^2).
+     * The landmarks are selected when the data changes and kept while only the parameters change, such that the
+     * approximated likelihood is a smooth function of the parameters. If there are at most m data points, the exact
+     * factorization is used. The cross covariances with test points, e.g. of #computeCrossCov, are not approximated.
+     *
+     * @param nLandmarks The number of landmark points m, 0 to switch back to the exact factorization.
+     * @param selection The selection of the landmark points.
+     * @param seed The seed of the random selections.
+     */
+    void setNystrom(const unsigned int nLandmarks, const LandmarkSelection selection=LandmarkSelection::PIVOTED_CHOLESKY, const unsigned int seed=0);
+
+    /**
+     * Switch to matrix-free inference. The products of the noised covariance matrix with vectors are computed in tiles
+     * on the fly, see CovarianceFunction::multiplyK, which runs on the threads of the covariance function.
+     * #getNoisedInvCov and #getAlpha are computed by batched conjugate gradients, preconditioned by a partial pivoted
+     * Cholesky factorization of the covariance matrix, and #computeNoisedLogDetCov is estimated by stochastic
+     * Lanczos quadrature, see CovFactorization::factorizeIterative. The memory is O(n) for a fixed preconditioner
+     * rank and number of right-hand sides, each iteration costs one pass over the covariance matrix.
+     * The matrix-free mode takes precedence over the Nystrom approximation.
+     *
+     * @param matrixFree True to switch to matrix-free inference, false to switch back to the factorization.
+     * @param options The tolerance of the conjugate gradients, the rank of the preconditioner and the log determinant estimate.
+     */
+    void setMatrixFree(const bool matrixFree, const IterativeOptions& options=IterativeOptions());
+
+    /**
+     * @return True, if the matrix-free mode is enabled.
+     */
+    bool isMatrixFree() const;
+
+    /**
+     * @return The options of the matrix-free mode.
+     */
+    const IterativeOptions& getIterativeOptions() const;
+
+    /**
+     * @return The number of landmark points of the Nystrom approximation, 0 if it is disabled.
+     */
+    unsigned int getNumLandmarks() const;
+
+    /**
+     * @return The selection of the landmark points of the Nystrom approximation.
+     */
+    LandmarkSelection getLandmarkSelection() const;
+
+    /**
+     * Get the indices of the landmark points among the registered data points, as of the last factorization.
+     * The pivoted Cholesky selection stops early if the residual variance vanishes, so there may be less than m.
+     *
+     * @return The indices of the landmark points.
+     */
+    const std::vector<Eigen::Index>& getLandmarks() const;
+
     /*
     ********* getter and setter *********
     */
@@ -216,6 +360,15 @@ class GPKernel : public util::IObserver, public util::Prototype {
      */
     unsigned int nParameters() const;
 
+    /**
+     * Get the version of the kernel parameters.
+     * The version changes whenever the noise, the parameters of the covariance function
+     * or the registered data object change, see also CovFactorization::isCurrent.
+     *
+     * @return The current parameter version.
+     */
+    unsigned long getParameterVersion() const;
+
     /**
      * Get a pointer to the currently registered GPData object.
      *
@@ -239,15 +392,32 @@ class GPKernel : public util::IObserver, public util::Prototype {
     int getN() const;
 
 private:
-    void precomputeAlpha() const;
+    void updateDecomposition() const;
+    void factorizeNystrom(const unsigned long dataVersion) const;
+    void factorizeMatrixFree(const unsigned long dataVersion) const;
+    void selectLandmarks() const;
+
+    /**
+     * Compute a partial pivoted Cholesky factorization K ~ F F^T of rank at most r, which stops early if the
+     * residual variance vanishes.
+     */
+    void pivotedCholesky(Eigen::MatrixXd& F, std::vector<Eigen::Index>& pivots, const unsigned int r) const;
     void changedData_trigger();
+    void invalidateDecomposition();
 
     std::shared_ptr<gp::kernel::CovarianceFunction> covfun;
+    std::shared_ptr<DistanceCache> distanceCache; // attached to the covariance function, cleared when the data changes
     std::shared_ptr<gp::GPData> data;
-    mutable Eigen::MatrixXd alpha;
-    mutable Eigen::LDLT<Eigen::MatrixXd> noisedCovDecomp;
-    mutable bool is_alpha_computed;
     double noise;
+    unsigned long parameterVersion; // incremented whenever noise or covariance function parameters change
+    mutable CovFactorization factorization;
+    unsigned int nLandmarks; // 0 if the Nystrom approximation is disabled
+    LandmarkSelection landmarkSelection;
+    unsigned int landmarkSeed;
+    mutable std::vector<Eigen::Index> landmarks; // indices of the landmark points of the last factorization
+    mutable unsigned long landmarkDataVersion;  // version of the data the landmarks have been selected for
+    bool matrixFree;
+    IterativeOptions iterativeOptions;
 };
 
 } // namespace gp::kernel
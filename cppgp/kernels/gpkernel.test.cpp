@@ -1,4 +1,12 @@
 #include <cppgp/kernels/gpkernel.hpp>
+#include <cppgp/kernels/covfun_rbf.hpp>
+#include <cppgp/kernels/covfun_rbf_static.hpp>
+#include <cppgp/kernels/covfun_ardrbf.hpp>
+#include <cppgp/kernels/covfun_matern.hpp>
+#include <cppgp/kernels/covfun_constant.hpp>
+#include <cppgp/kernels/covfun_composite.hpp>
+#include <cppgp/kernels/covfun_wendland.hpp>
+#include <cppgp/util/exceptions.hpp>
 #include <iostream>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -12,17 +20,17 @@ public:
     virtual ~DummyCovfun1(){}
     virtual std::shared_ptr<util::Prototype> copy() const override {return std::make_shared<DummyCovfun1>(*this);}
 protected:
-    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::MatrixXd& X1, const Eigen::MatrixXd& X2) const
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2) const
     {
         K = Eigen::MatrixXd::Identity(X1.rows(), X2.rows());
     }
 
-    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::MatrixXd& X) const
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const
     {
         K = Eigen::MatrixXd::Identity(X.rows(), X.rows());
     }
 
-    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::MatrixXd& X) const
+    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const
     {
         K = Eigen::VectorXd::Ones(X.rows());
     }
@@ -34,7 +42,7 @@ public:
     virtual ~DummyCovfun2(){}
     virtual std::shared_ptr<util::Prototype> copy() const override {return std::make_shared<DummyCovfun2>(*this);}
 protected:
-    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::MatrixXd& X1, const Eigen::MatrixXd& X2) const
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2) const
     {
         K = Eigen::MatrixXd(X1.rows(), X2.rows());
         for(int i = 0; i < X1.rows(); ++i)
@@ -46,17 +54,37 @@ protected:
         }
     }
 
-    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::MatrixXd& X) const
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const
     {
         covariancefunction(K, X, X);
     }
 
-    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::MatrixXd& X) const
+    virtual void covariancefunctionDiag(Eigen::VectorXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const
     {
         K = (X.array()*X.array()).rowwise().sum();
     }
 };
 
+class CountingRBFCovFun : public kernel::RBFCovFun
+{
+public:
+    CountingRBFCovFun() : evaluations(std::make_shared<int>(0)) {}
+    virtual ~CountingRBFCovFun(){}
+    virtual std::shared_ptr<util::Prototype> copy() const override {return std::make_shared<CountingRBFCovFun>(*this);}
+    std::shared_ptr<int> evaluations; // shared by the copies
+protected:
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X1, const Eigen::Ref<const Eigen::MatrixXd>& X2) const override
+    {
+        ++*this->evaluations;
+        RBFCovFun::covariancefunction(K, X1, X2);
+    }
+    virtual void covariancefunction(Eigen::MatrixXd& K, const Eigen::Ref<const Eigen::MatrixXd>& X) const override
+    {
+        ++*this->evaluations;
+        RBFCovFun::covariancefunction(K, X);
+    }
+};
+
 std::tuple<Eigen::MatrixXd, Eigen::MatrixXd> fill_random_data(std::shared_ptr<GPData>& data, int n)
 {
     Eigen::MatrixXd X = Eigen::MatrixXd::Random(n, data->getDimX());
@@ -355,3 +383,926 @@ TEST(kernels_gpkernel, get_set_noise){
 
     EXPECT_EQ(gpk.getNoise(), -sigma);
 }
+
+TEST(kernels_gpkernel, append_data_incremental){
+    auto gpdat = std::make_shared<GPData>(2, 3);
+    fill_random_data(gpdat, 4);
+    kernel::GPKernel gpk(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    gpk.registerData(gpdat);
+
+    Eigen::MatrixXd alpha, alphaRes;
+    gpk.getAlpha(alpha);
+
+    // add data one by one and in blocks, each time reusing the previous decomposition
+    for(int i = 0; i < 5; ++i){
+        gpdat->addDatum(Eigen::VectorXd::Random(2), Eigen::VectorXd::Random(3));
+        gpk.getAlpha(alpha);
+    }
+    fill_random_data(gpdat, 3);
+    gpk.getAlpha(alpha);
+
+    kernel::GPKernel gpkRes(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    gpkRes.registerData(gpdat);
+    gpkRes.getAlpha(alphaRes);
+
+    Eigen::MatrixXd invK, invKres;
+    gpk.getNoisedInvCov(invK, Eigen::MatrixXd::Identity(12, 12));
+    gpkRes.getNoisedInvCov(invKres, Eigen::MatrixXd::Identity(12, 12));
+
+    EXPECT_EQ(alpha.rows(), 12);
+    EXPECT_TRUE(alpha.isApprox(alphaRes));
+    EXPECT_TRUE(invK.isApprox(invKres));
+    EXPECT_NEAR(gpk.computeNoisedLogDetCov(), gpkRes.computeNoisedLogDetCov(), 1e-10);
+}
+
+TEST(kernels_gpkernel, append_data_drift_fallback){
+    auto gpdat = get_test_data_2();
+    kernel::GPKernel gpk(std::make_shared<DummyCovfun2>(), 1e-12);
+    gpk.registerData(gpdat);
+
+    Eigen::MatrixXd alpha, alphaRes;
+    gpk.getAlpha(alpha);
+
+    // the linear covariance function has rank one for 1d inputs, the incremental update is rejected
+    gpdat->addDatum(0.75, Eigen::Vector3d(0.0, -0.75, 1.5));
+    gpk.getAlpha(alpha);
+
+    kernel::GPKernel gpkRes(std::make_shared<DummyCovfun2>(), 1e-12);
+    gpkRes.registerData(gpdat);
+    gpkRes.getAlpha(alphaRes);
+
+    EXPECT_EQ(alpha, alphaRes);
+    EXPECT_EQ(gpk.computeNoisedLogDetCov(), gpkRes.computeNoisedLogDetCov());
+}
+
+TEST(kernels_gpkernel, remove_data_downdate){
+    auto gpdat = std::make_shared<GPData>(2, 3);
+    fill_random_data(gpdat, 8);
+    kernel::GPKernel gpk(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    gpk.registerData(gpdat);
+
+    Eigen::MatrixXd alpha, alphaRes;
+    gpk.getAlpha(alpha);
+
+    gpdat->removeData(3, 2);
+    gpdat->setWindowSize(5);
+    for(int i = 0; i < 4; ++i){
+        gpdat->addDatum(Eigen::VectorXd::Random(2), Eigen::VectorXd::Random(3));
+        gpk.getAlpha(alpha);
+    }
+    gpdat->removeOldest();
+    gpk.getAlpha(alpha);
+
+    kernel::GPKernel gpkRes(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    gpkRes.registerData(gpdat);
+    gpkRes.getAlpha(alphaRes);
+
+    EXPECT_EQ(alpha.rows(), 4);
+    EXPECT_TRUE(alpha.isApprox(alphaRes));
+    EXPECT_NEAR(gpk.computeNoisedLogDetCov(), gpkRes.computeNoisedLogDetCov(), 1e-10);
+}
+
+TEST(kernels_gpkernel, shared_factorization){
+    auto gpdat = std::make_shared<GPData>(2, 3);
+    fill_random_data(gpdat, 6);
+    kernel::GPKernel gpk(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    gpk.registerData(gpdat);
+
+    const kernel::CovFactorization& fact = gpk.getFactorization();
+    EXPECT_TRUE(fact.isCurrent(gpdat->getVersion(), gpk.getParameterVersion()));
+    EXPECT_EQ(fact.getN(), 6);
+    EXPECT_EQ(fact.getJitter(), 0.0);
+
+    Eigen::MatrixXd K, Y;
+    gpk.computeNoisedCov(K);
+    gpdat->getYNormalized(Y);
+    EXPECT_TRUE((K*fact.getAlpha()).isApprox(Y));
+    EXPECT_NEAR(fact.logDet(), std::log(K.determinant()), 1e-10);
+
+    // the factorization is outdated by changes of the data and the parameters
+    gpdat->addDatum(Eigen::VectorXd::Random(2), Eigen::VectorXd::Random(3));
+    EXPECT_FALSE(fact.isCurrent(gpdat->getVersion(), gpk.getParameterVersion()));
+    EXPECT_EQ(&gpk.getFactorization(), &fact);
+    EXPECT_TRUE(fact.isCurrent(gpdat->getVersion(), gpk.getParameterVersion()));
+    gpk.setNoise(0.2);
+    EXPECT_FALSE(fact.isValid());
+    gpk.getFactorization();
+    EXPECT_TRUE(fact.isCurrent(gpdat->getVersion(), gpk.getParameterVersion()));
+    EXPECT_EQ(fact.getN(), 7);
+}
+
+TEST(kernels_gpkernel, factorization_jitter){
+    auto gpdat = get_test_data_2();
+    kernel::GPKernel gpk(std::make_shared<DummyCovfun2>(), 0.0);
+    gpk.registerData(gpdat);
+
+    // the linear covariance function has rank one for 1d inputs
+    const kernel::CovFactorization& fact = gpk.getFactorization();
+    EXPECT_GT(fact.getJitter(), 0.0);
+
+    Eigen::MatrixXd K;
+    gpk.computeNoisedCov(K);
+    K.diagonal().array() += fact.getJitter();
+    Eigen::MatrixXd L = fact.matrixL();
+    EXPECT_TRUE((L*L.transpose()).isApprox(K));
+}
+
+TEST(kernels_gpkernel, rbf_dK_dP){
+    kernel::RBFCovFun rbf(2.0, 1.5);
+    const Eigen::MatrixXd X = Eigen::MatrixXd::Random(6, 2);
+
+    std::vector<Eigen::MatrixXd> dK;
+    rbf.dK_dP(dK, X);
+    ASSERT_EQ(dK.size(), 2);
+
+    // compare against central differences
+    const double h = 1e-6;
+    for(int i = 0; i < 2; ++i){
+        Eigen::VectorXd params = rbf.getParameters();
+        Eigen::MatrixXd Kplus, Kminus;
+        params(i) += h;
+        rbf.setParameters(params);
+        rbf.K(Kplus, X);
+        params(i) -= 2*h;
+        rbf.setParameters(params);
+        rbf.K(Kminus, X);
+        params(i) += h;
+        rbf.setParameters(params);
+        EXPECT_TRUE(dK[i].isApprox((Kplus-Kminus)/(2*h), 1e-6));
+    }
+
+    // the contraction matches the derivative matrices
+    const Eigen::MatrixXd covGrad = Eigen::MatrixXd::Random(6, 6);
+    Eigen::VectorXd g;
+    rbf.gradient(g, X, covGrad);
+    EXPECT_NEAR(g(0), (covGrad.array()*dK[0].array()).sum(), 1e-12);
+    EXPECT_NEAR(g(1), (covGrad.array()*dK[1].array()).sum(), 1e-12);
+}
+
+TEST(kernels_gpkernel, noised_cov_gradient){
+    auto gpdat = std::make_shared<GPData>(2, 3);
+    fill_random_data(gpdat, 5);
+    kernel::GPKernel gpk(std::make_shared<kernel::RBFCovFun>(2.0, 1.5), 0.1);
+    gpk.registerData(gpdat);
+
+    const Eigen::MatrixXd covGrad = Eigen::MatrixXd::Random(5, 5);
+    Eigen::VectorXd g;
+    gpk.computeNoisedCovGradient(g, covGrad);
+
+    Eigen::VectorXd gcov;
+    gpk.getCovarianceFunction()->gradient(gcov, gpdat->getXView(), covGrad);
+    ASSERT_EQ(g.size(), 3);
+    EXPECT_EQ(g(0), covGrad.trace());
+    EXPECT_EQ(g.tail(2), gcov);
+
+    // covariance functions without analytic derivatives
+    kernel::GPKernel gpkDummy(std::make_shared<DummyCovfun1>(), 0.1);
+    gpkDummy.registerData(gpdat);
+    EXPECT_THROW(gpkDummy.computeNoisedCovGradient(g, covGrad), util::exceptions::Error);
+}
+
+TEST(kernels_gpkernel, rbf_tiled_gram){
+    kernel::RBFCovFun rbf(2.0, 1.5);
+    const Eigen::MatrixXd X1 = Eigen::MatrixXd::Random(150, 3);
+    const Eigen::MatrixXd X2 = Eigen::MatrixXd::Random(70, 3);
+
+    auto rbfNaive = [](const Eigen::MatrixXd& A, const Eigen::MatrixXd& B){
+        Eigen::MatrixXd K(A.rows(), B.rows());
+        for(int i = 0; i < A.rows(); ++i){
+            for(int j = 0; j < B.rows(); ++j){
+                K(i, j) = 1.5*std::exp(-0.5*2.0*(A.row(i) - B.row(j)).squaredNorm());
+            }
+        }
+        return K;
+    };
+
+    // the tiles span several blocks in both dimensions
+    Eigen::MatrixXd K;
+    rbf.K(K, X1);
+    EXPECT_TRUE(K.isApprox(rbfNaive(X1, X1), 1e-12));
+    EXPECT_EQ(K, K.transpose());
+    rbf.K(K, X1, X2);
+    EXPECT_TRUE(K.isApprox(rbfNaive(X1, X2), 1e-12));
+    rbf.K(K, X2, X1);
+    EXPECT_TRUE(K.isApprox(rbfNaive(X2, X1), 1e-12));
+}
+
+TEST(kernels_gpkernel, parallel_tiled_gram){
+    kernel::RBFCovFun rbf(2.0, 1.5);
+    const Eigen::MatrixXd X1 = Eigen::MatrixXd::Random(300, 3);
+    const Eigen::MatrixXd X2 = Eigen::MatrixXd::Random(130, 3);
+    Eigen::MatrixXd Kref, Kref12;
+    rbf.K(Kref, X1);
+    rbf.K(Kref12, X1, X2);
+
+    // same tiling for all thread counts gives bitwise identical results
+    rbf.setTileSize(48);
+    Eigen::MatrixXd Kserial, Kserial12;
+    rbf.K(Kserial, X1);
+    rbf.K(Kserial12, X1, X2);
+    EXPECT_TRUE(Kserial.isApprox(Kref, 1e-12));
+    EXPECT_TRUE(Kserial12.isApprox(Kref12, 1e-12));
+    EXPECT_EQ(Kserial, Kserial.transpose());
+    for(unsigned int nThreads : {2u, 3u, 8u}){
+        rbf.setNumThreads(nThreads);
+        Eigen::MatrixXd K, K12;
+        rbf.K(K, X1);
+        rbf.K(K12, X1, X2);
+        EXPECT_EQ(K, Kserial);
+        EXPECT_EQ(K12, Kserial12);
+    }
+
+    // the settings are kept by copies
+    auto rbfCopy = std::dynamic_pointer_cast<kernel::CovarianceFunction>(rbf.copy());
+    EXPECT_EQ(rbfCopy->getNumThreads(), 8);
+    EXPECT_EQ(rbfCopy->getTileSize(), 48);
+    EXPECT_THROW(rbf.setTileSize(-1), util::exceptions::InconsistentInputError);
+}
+
+TEST(kernels_gpkernel, cross_cov_single){
+    auto gpdata = std::make_shared<GPData>(3, 1);
+    const Eigen::MatrixXd X = Eigen::MatrixXd::Random(90, 3);
+    const Eigen::MatrixXd Y = Eigen::MatrixXd::Random(90, 1);
+    gpdata->addData(X, Y);
+    const Eigen::MatrixXd X2 = Eigen::MatrixXd::Random(70, 3);
+
+    // RBFCovFun computes in single precision, DummyCovfun2 uses the default conversion
+    std::vector<std::shared_ptr<kernel::CovarianceFunction>> covfuns = {std::make_shared<kernel::RBFCovFun>(2.0, 1.5), std::make_shared<DummyCovfun2>()};
+    for(auto& covfun : covfuns){
+        kernel::GPKernel gpkernel(covfun);
+        gpkernel.registerData(gpdata);
+        Eigen::MatrixXd K;
+        Eigen::MatrixXf Ksingle;
+        gpkernel.computeCrossCov(K, X2);
+        gpkernel.computeCrossCov(Ksingle, X2.cast<float>());
+        ASSERT_EQ(Ksingle.rows(), 90);
+        ASSERT_EQ(Ksingle.cols(), 70);
+        EXPECT_TRUE(Ksingle.cast<double>().isApprox(K, 1e-6));
+    }
+    EXPECT_EQ(gpdata->getXSingle(), gpdata->getXView().cast<float>());
+}
+
+TEST(kernels_gpkernel, static_rbf){
+    kernel::RBFCovFun rbf(2.0, 1.5);
+    kernel::StaticRBFCovFun<3> staticRbf(rbf.getParameters());
+    kernel::StaticRBFCovFun<3, float> staticRbfSingle(rbf.getParameters());
+    const Eigen::MatrixXd X1 = Eigen::MatrixXd::Random(40, 3);
+    const Eigen::MatrixXd X2 = Eigen::MatrixXd::Random(25, 3);
+
+    Eigen::MatrixXd K, Kstatic;
+    rbf.K(K, X1);
+    staticRbf.K(Kstatic, X1);
+    EXPECT_TRUE(Kstatic.isApprox(K, 1e-12));
+    EXPECT_EQ(Kstatic, Kstatic.transpose());
+    staticRbfSingle.K(Kstatic, X1);
+    EXPECT_TRUE(Kstatic.isApprox(K, 1e-6));
+
+    rbf.K(K, X1, X2);
+    staticRbf.K(Kstatic, X1, X2);
+    EXPECT_TRUE(Kstatic.isApprox(K, 1e-12));
+    // views with an outer stride are mapped without copying
+    staticRbf.K(Kstatic, X1.topRows(10), X2.topRows(5));
+    EXPECT_TRUE(Kstatic.isApprox(K.topLeftCorner(10, 5), 1e-12));
+
+    const Eigen::MatrixXd covGrad = Eigen::MatrixXd::Random(40, 40);
+    Eigen::VectorXd g, gstatic;
+    rbf.gradient(g, X1, covGrad);
+    staticRbf.gradient(gstatic, X1, covGrad);
+    EXPECT_TRUE(gstatic.isApprox(g, 1e-12));
+
+    EXPECT_THROW(staticRbf.K(Kstatic, Eigen::MatrixXd::Random(5, 2)), util::exceptions::InconsistentInputError);
+
+    // pluggable into a GPKernel
+    auto gpdata = std::make_shared<GPData>(3, 1);
+    const Eigen::MatrixXd Y = Eigen::MatrixXd::Random(40, 1);
+    gpdata->addData(X1, Y);
+    kernel::GPKernel gpkernel(std::make_shared<kernel::StaticRBFCovFun<3>>(rbf.getParameters()), 0.1);
+    kernel::GPKernel gpkernelDynamic(std::make_shared<kernel::RBFCovFun>(rbf.getParameters()), 0.1);
+    gpkernel.registerData(gpdata);
+    gpkernelDynamic.registerData(gpdata);
+    EXPECT_NEAR(gpkernel.getFactorization().logDet(), gpkernelDynamic.getFactorization().logDet(), 1e-10);
+}
+
+TEST(kernels_gpkernel, ard_rbf){
+    Eigen::VectorXd widths(4);
+    widths << 0.5, 2.0, 1.0, 4.0;
+    kernel::ARDRBFCovFun ard(widths, 1.5);
+    EXPECT_EQ(ard.nParameters(), 5);
+    EXPECT_EQ(ard.getDimension(), 4);
+    const Eigen::MatrixXd X1 = Eigen::MatrixXd::Random(30, 4);
+    const Eigen::MatrixXd X2 = Eigen::MatrixXd::Random(20, 4);
+
+    auto ardNaive = [&widths](const Eigen::MatrixXd& A, const Eigen::MatrixXd& B){
+        Eigen::MatrixXd K(A.rows(), B.rows());
+        for(int i = 0; i < A.rows(); ++i){
+            for(int j = 0; j < B.rows(); ++j){
+                K(i, j) = 1.5*std::exp(-0.5*((A.row(i) - B.row(j)).array().square()*widths.transpose().array()).sum());
+            }
+        }
+        return K;
+    };
+    Eigen::MatrixXd K;
+    ard.K(K, X1);
+    EXPECT_TRUE(K.isApprox(ardNaive(X1, X1), 1e-12));
+    ard.K(K, X1, X2);
+    EXPECT_TRUE(K.isApprox(ardNaive(X1, X2), 1e-12));
+    EXPECT_THROW(ard.K(K, X1.leftCols(3)), util::exceptions::InconsistentInputError);
+
+    // the fast gradient matches the contraction with the derivative matrices
+    const Eigen::MatrixXd covGrad = Eigen::MatrixXd::Random(30, 30);
+    std::vector<Eigen::MatrixXd> dK;
+    ard.dK_dP(dK, X1);
+    Eigen::VectorXd g;
+    ard.gradient(g, X1, covGrad);
+    ASSERT_EQ(g.size(), 5);
+    for(int i = 0; i < 5; ++i){
+        EXPECT_NEAR(g(i), (covGrad.array()*dK[i].array()).sum(), 1e-10);
+    }
+    // and central differences
+    const double h = 1e-6;
+    for(int i = 0; i < 5; ++i){
+        Eigen::VectorXd p = ard.getParameters();
+        p(i) += h;
+        kernel::ARDRBFCovFun ardPlus(p);
+        p(i) -= 2*h;
+        kernel::ARDRBFCovFun ardMinus(p);
+        Eigen::MatrixXd Kplus, Kminus;
+        ardPlus.K(Kplus, X1);
+        ardMinus.K(Kminus, X1);
+        EXPECT_NEAR(g(i), (covGrad.array()*(Kplus - Kminus).array()).sum()/(2*h), 1e-6);
+    }
+}
+
+TEST(kernels_gpkernel, ard_rbf_cached_inputs){
+    // the scaled inputs are cached per data version and parameters
+    auto gpdata = std::make_shared<GPData>(2, 1);
+    gpdata->setWindowSize(20);
+    Eigen::MatrixXd X = Eigen::MatrixXd::Random(20, 2);
+    Eigen::MatrixXd Y = Eigen::MatrixXd::Random(20, 1);
+    gpdata->addData(X, Y);
+    Eigen::VectorXd widths(2);
+    widths << 0.5, 3.0;
+    auto ard = std::make_shared<kernel::ARDRBFCovFun>(widths, 1.0);
+    kernel::GPKernel gpkernel(ard);
+    gpkernel.registerData(gpdata);
+
+    auto check = [&](){
+        Eigen::MatrixXd K, Kref;
+        gpkernel.computeCov(K);
+        kernel::ARDRBFCovFun(ard->getParameters()).K(Kref, gpdata->getXView());
+        EXPECT_TRUE(K.isApprox(Kref, 1e-12));
+    };
+    check();
+    check();
+    // same address and size, new content
+    const Eigen::MatrixXd Xnew = Eigen::MatrixXd::Random(5, 2);
+    const Eigen::MatrixXd Ynew = Eigen::MatrixXd::Random(5, 1);
+    gpdata->addData(Xnew, Ynew);
+    check();
+    // new parameters
+    widths << 2.0, 0.1;
+    Eigen::VectorXd params(4);
+    params << 0.0, widths, 1.0;
+    gpkernel.setParameters(params);
+    check();
+}
+
+TEST(kernels_gpkernel, matern){
+    const Eigen::MatrixXd X1 = Eigen::MatrixXd::Random(25, 3);
+    const Eigen::MatrixXd X2 = Eigen::MatrixXd::Random(15, 3);
+    const double w = 2.5;
+    const double var = 1.3;
+    auto maternNaive = [&](const Eigen::MatrixXd& A, const Eigen::MatrixXd& B, const bool smooth){
+        Eigen::MatrixXd K(A.rows(), B.rows());
+        for(int i = 0; i < A.rows(); ++i){
+            for(int j = 0; j < B.rows(); ++j){
+                const double r = (A.row(i) - B.row(j)).norm();
+                const double a = std::sqrt((smooth ? 5.0 : 3.0)*w)*r;
+                K(i, j) = var*(smooth ? 1.0 + a + a*a/3.0 : 1.0 + a)*std::exp(-a);
+            }
+        }
+        return K;
+    };
+    kernel::Matern32CovFun matern32(w, var);
+    kernel::Matern52CovFun matern52(w, var);
+    for(kernel::MaternCovFun* matern : {static_cast<kernel::MaternCovFun*>(&matern32), static_cast<kernel::MaternCovFun*>(&matern52)}){
+        const bool smooth = (matern == &matern52);
+        Eigen::MatrixXd K;
+        matern->K(K, X1);
+        EXPECT_TRUE(K.isApprox(maternNaive(X1, X1, smooth), 1e-12));
+        matern->K(K, X1, X2);
+        EXPECT_TRUE(K.isApprox(maternNaive(X1, X2, smooth), 1e-12));
+        Eigen::VectorXd diag;
+        matern->diagK(diag, X1);
+        EXPECT_TRUE(diag.isApprox(Eigen::VectorXd::Constant(25, var)));
+
+        const Eigen::MatrixXd covGrad = Eigen::MatrixXd::Random(25, 25);
+        std::vector<Eigen::MatrixXd> dK;
+        matern->dK_dP(dK, X1);
+        Eigen::VectorXd g;
+        matern->gradient(g, X1, covGrad);
+        ASSERT_EQ(g.size(), 2);
+        const double h = 1e-6;
+        for(int i = 0; i < 2; ++i){
+            EXPECT_NEAR(g(i), (covGrad.array()*dK[i].array()).sum(), 1e-10);
+            Eigen::VectorXd p = matern->getParameters();
+            p(i) += h;
+            auto plus = std::dynamic_pointer_cast<kernel::CovarianceFunction>(matern->copy());
+            plus->setParameters(p);
+            p(i) -= 2*h;
+            auto minus = std::dynamic_pointer_cast<kernel::CovarianceFunction>(matern->copy());
+            minus->setParameters(p);
+            Eigen::MatrixXd Kplus, Kminus;
+            plus->K(Kplus, X1);
+            minus->K(Kminus, X1);
+            EXPECT_NEAR(g(i), (covGrad.array()*(Kplus - Kminus).array()).sum()/(2*h), 1e-6);
+        }
+    }
+}
+
+TEST(kernels_gpkernel, matern_shared_distances){
+    // switching between Matérn kernels on the same data computes the distances once per data version
+    auto gpdata = std::make_shared<GPData>(2, 1);
+    gpdata->setWindowSize(30);
+    Eigen::MatrixXd X = Eigen::MatrixXd::Random(30, 2);
+    Eigen::MatrixXd Y = Eigen::MatrixXd::Random(30, 1);
+    gpdata->addData(X, Y);
+    auto cache = std::make_shared<kernel::DistanceCache>();
+    auto matern32 = std::make_shared<kernel::Matern32CovFun>(1.5, 1.0);
+    auto matern52 = std::make_shared<kernel::Matern52CovFun>(0.5, 2.0);
+    matern32->setDistanceCache(cache);
+    matern52->setDistanceCache(cache);
+    kernel::GPKernel gpkernel32(matern32);
+    kernel::GPKernel gpkernel52(matern52);
+    gpkernel32.registerData(gpdata);
+    gpkernel52.registerData(gpdata);
+
+    auto check = [&](){
+        Eigen::MatrixXd K, Kref;
+        gpkernel32.computeCov(K);
+        kernel::Matern32CovFun(1.5, 1.0).K(Kref, gpdata->getXView());
+        EXPECT_TRUE(K.isApprox(Kref, 1e-12));
+        gpkernel52.computeCov(K);
+        kernel::Matern52CovFun(0.5, 2.0).K(Kref, gpdata->getXView());
+        EXPECT_TRUE(K.isApprox(Kref, 1e-12));
+        Eigen::VectorXd g;
+        gpkernel52.computeNoisedCovGradient(g, Eigen::MatrixXd::Identity(30, 30));
+    };
+    check();
+    EXPECT_EQ(cache->getComputations(), 1);
+    check();
+    EXPECT_EQ(cache->getComputations(), 1);
+    // same address and size, new content
+    const Eigen::MatrixXd Xnew = Eigen::MatrixXd::Random(5, 2);
+    const Eigen::MatrixXd Ynew = Eigen::MatrixXd::Random(5, 1);
+    gpdata->addData(Xnew, Ynew);
+    check();
+    EXPECT_EQ(cache->getComputations(), 2);
+    // back to the cache of the kernel
+    matern32->setDistanceCache(nullptr);
+    check();
+    EXPECT_EQ(cache->getComputations(), 2);
+
+    // the cache of a kernel is released together with the kernel
+    std::weak_ptr<kernel::DistanceCache> kernelCache = matern32->getDistanceCache();
+    ASSERT_FALSE(kernelCache.expired());
+    EXPECT_EQ(kernelCache.lock()->getComputations(), 1);
+    gpdata->addData(Xnew, Ynew);
+    check();
+    EXPECT_EQ(kernelCache.lock()->getComputations(), 2);
+    {
+        auto matern = std::make_shared<kernel::Matern32CovFun>(1.5, 1.0);
+        auto gpkernel = std::make_shared<kernel::GPKernel>(matern);
+        gpkernel->registerData(gpdata);
+        Eigen::MatrixXd K;
+        gpkernel->computeCov(K);
+        kernelCache = matern->getDistanceCache();
+        EXPECT_EQ(kernelCache.lock()->getComputations(), 1);
+        gpkernel.reset();
+        EXPECT_TRUE(kernelCache.expired());
+        EXPECT_EQ(matern->getDistanceCache(), nullptr);
+    }
+}
+
+TEST(kernels_gpkernel, composite){
+    // more points than the panel size of the composite
+    const Eigen::MatrixXd X1 = Eigen::MatrixXd::Random(300, 2);
+    const Eigen::MatrixXd X2 = Eigen::MatrixXd::Random(270, 2);
+    auto rbf = std::make_shared<kernel::RBFCovFun>(2.0, 0.7);
+    auto matern = std::make_shared<kernel::Matern52CovFun>(0.5, 1.2);
+    auto constant = std::make_shared<kernel::ConstantCovFun>(3.0);
+    kernel::SumCovFun sum(rbf, matern);
+    kernel::ProductCovFun product({constant, rbf, matern});
+    EXPECT_EQ(sum.nParameters(), 4);
+    EXPECT_EQ(product.nParameters(), 5);
+    Eigen::VectorXd expectedParams(5);
+    expectedParams << 3.0, 2.0, 0.7, 0.5, 1.2;
+    EXPECT_TRUE(product.getParameters().isApprox(expectedParams));
+
+    Eigen::MatrixXd Krbf, Kmatern, K;
+    rbf->K(Krbf, X1);
+    matern->K(Kmatern, X1);
+    sum.K(K, X1);
+    EXPECT_TRUE(K.isApprox(Krbf + Kmatern, 1e-12));
+    product.K(K, X1);
+    EXPECT_TRUE(K.isApprox(3.0*Krbf.cwiseProduct(Kmatern), 1e-12));
+    rbf->K(Krbf, X1, X2);
+    matern->K(Kmatern, X1, X2);
+    sum.K(K, X1, X2);
+    EXPECT_TRUE(K.isApprox(Krbf + Kmatern, 1e-12));
+    Eigen::MatrixXf Ksingle;
+    product.K(Ksingle, X1.cast<float>(), X2.cast<float>());
+    EXPECT_TRUE(Ksingle.cast<double>().isApprox(3.0*Krbf.cwiseProduct(Kmatern), 1e-5));
+    Eigen::VectorXd diag;
+    product.diagK(diag, X1);
+    EXPECT_TRUE(diag.isApprox(Eigen::VectorXd::Constant(300, 3.0*0.7*1.2)));
+
+    // the parameters are forwarded to the parts, the parts given to the constructor are not changed
+    expectedParams << 2.0, 1.0, 0.3, 2.0, 0.5;
+    product.setParameters(expectedParams);
+    EXPECT_TRUE(product.getCovFun(2)->getParameters().isApprox(Eigen::Vector2d(2.0, 0.5)));
+    EXPECT_TRUE(matern->getParameters().isApprox(Eigen::Vector2d(0.5, 1.2)));
+    product.K(K, X1);
+    kernel::RBFCovFun(1.0, 0.3).K(Krbf, X1);
+    kernel::Matern52CovFun(2.0, 0.5).K(Kmatern, X1);
+    EXPECT_TRUE(K.isApprox(2.0*Krbf.cwiseProduct(Kmatern), 1e-12));
+
+    // gradients of both composites by central differences
+    const Eigen::MatrixXd X = X1.topRows(40);
+    const Eigen::MatrixXd covGrad = Eigen::MatrixXd::Random(40, 40);
+    for(kernel::CompositeCovFun* composite : {static_cast<kernel::CompositeCovFun*>(&sum), static_cast<kernel::CompositeCovFun*>(&product)}){
+        std::vector<Eigen::MatrixXd> dK;
+        composite->dK_dP(dK, X);
+        Eigen::VectorXd g;
+        composite->gradient(g, X, covGrad);
+        ASSERT_EQ(g.size(), composite->nParameters());
+        ASSERT_EQ(dK.size(), composite->nParameters());
+        const double h = 1e-6;
+        for(unsigned int i = 0; i < composite->nParameters(); ++i){
+            EXPECT_NEAR(g(i), (covGrad.array()*dK[i].array()).sum(), 1e-9);
+            auto plus = std::dynamic_pointer_cast<kernel::CovarianceFunction>(composite->copy());
+            auto minus = std::dynamic_pointer_cast<kernel::CovarianceFunction>(composite->copy());
+            Eigen::VectorXd p = composite->getParameters();
+            p(i) += h;
+            plus->setParameters(p);
+            p(i) -= 2*h;
+            minus->setParameters(p);
+            Eigen::MatrixXd Kplus, Kminus;
+            plus->K(Kplus, X);
+            minus->K(Kminus, X);
+            EXPECT_NEAR(g(i), (covGrad.array()*(Kplus - Kminus).array()).sum()/(2*h), 1e-6);
+        }
+    }
+
+    // more than two panels, the gradient is summed over pairs of panels
+    const Eigen::MatrixXd Xlarge = Eigen::MatrixXd::Random(600, 2);
+    const Eigen::MatrixXd covGradLarge = Eigen::MatrixXd::Random(600, 600);
+    for(kernel::CompositeCovFun* composite : {static_cast<kernel::CompositeCovFun*>(&sum), static_cast<kernel::CompositeCovFun*>(&product)}){
+        std::vector<Eigen::MatrixXd> dK;
+        composite->dK_dP(dK, Xlarge);
+        Eigen::VectorXd g;
+        composite->gradient(g, Xlarge, covGradLarge);
+        ASSERT_EQ(g.size(), composite->nParameters());
+        for(unsigned int i = 0; i < composite->nParameters(); ++i){
+            const double expected = (covGradLarge.array()*dK[i].array()).sum();
+            EXPECT_NEAR(g(i), expected, 1e-9*std::max(1.0, std::abs(expected)));
+        }
+    }
+}
+
+TEST(kernels_gpkernel, composite_shared_distances){
+    // the panels of a composite share their distances, Matérn parts share the distances of the cache for the gradient
+    auto gpdata = std::make_shared<GPData>(3, 1);
+    Eigen::MatrixXd X = Eigen::MatrixXd::Random(300, 3);
+    Eigen::MatrixXd Y = Eigen::MatrixXd::Random(300, 1);
+    gpdata->addData(X, Y);
+    auto cache = std::make_shared<kernel::DistanceCache>();
+    auto matern32 = std::make_shared<kernel::Matern32CovFun>(1.5, 1.0);
+    auto matern52 = std::make_shared<kernel::Matern52CovFun>(0.5, 2.0);
+    matern32->setDistanceCache(cache);
+    matern52->setDistanceCache(cache);
+    auto sum = std::make_shared<kernel::SumCovFun>(std::vector<std::shared_ptr<kernel::CovarianceFunction>>{std::make_shared<kernel::RBFCovFun>(), matern32, matern52});
+    kernel::GPKernel gpkernel(sum);
+    gpkernel.registerData(gpdata);
+
+    Eigen::MatrixXd K, Kref, Kpart;
+    gpkernel.computeCov(K);
+    kernel::RBFCovFun().K(Kref, X);
+    kernel::Matern32CovFun(1.5, 1.0).K(Kpart, X);
+    Kref += Kpart;
+    kernel::Matern52CovFun(0.5, 2.0).K(Kpart, X);
+    Kref += Kpart;
+    EXPECT_TRUE(K.isApprox(Kref, 1e-12));
+    EXPECT_EQ(cache->getComputations(), 0);
+    Eigen::VectorXd g;
+    gpkernel.computeNoisedCovGradient(g, Eigen::MatrixXd::Identity(300, 300));
+    EXPECT_EQ(cache->getComputations(), 1);
+
+    // the parts that depend on the distance only take the covariances from the distances of the panels
+    auto counting = std::make_shared<CountingRBFCovFun>();
+    kernel::SumCovFun shared({counting, std::make_shared<kernel::Matern32CovFun>(1.5, 1.0), std::make_shared<kernel::WendlandCovFun>(1, 0.8, 2.0)});
+    Eigen::MatrixXd Kshared;
+    shared.K(Kshared, X);
+    kernel::WendlandCovFun(1, 0.8, 2.0).K(Kpart, X);
+    Kref = Kpart;
+    kernel::RBFCovFun().K(Kpart, X);
+    Kref += Kpart;
+    kernel::Matern32CovFun(1.5, 1.0).K(Kpart, X);
+    Kref += Kpart;
+    EXPECT_TRUE(Kshared.isApprox(Kref, 1e-12));
+    const Eigen::MatrixXd X2 = Eigen::MatrixXd::Random(280, 3);
+    shared.K(Kshared, X, X2);
+    kernel::WendlandCovFun(1, 0.8, 2.0).K(Kref, X, X2);
+    kernel::RBFCovFun().K(Kpart, X, X2);
+    Kref += Kpart;
+    kernel::Matern32CovFun(1.5, 1.0).K(Kpart, X, X2);
+    Kref += Kpart;
+    EXPECT_TRUE(Kshared.isApprox(Kref, 1e-12));
+    EXPECT_EQ(*counting->evaluations, 0);
+}
+
+TEST(kernels_gpkernel, wendland){
+    const Eigen::MatrixXd X1 = Eigen::MatrixXd::Random(60, 3);
+    const Eigen::MatrixXd X2 = Eigen::MatrixXd::Random(40, 3);
+    const double radius = 0.8;
+    for(unsigned int q = 0; q <= 2; ++q){
+        kernel::WendlandCovFun wendland(q, radius, 1.4);
+        EXPECT_TRUE(wendland.hasCompactSupport());
+        // l = floor(3/2) + q + 1
+        const double l = 2 + q;
+        auto wendlandNaive = [&](const Eigen::MatrixXd& A, const Eigen::MatrixXd& B){
+            Eigen::MatrixXd K(A.rows(), B.rows());
+            for(int i = 0; i < A.rows(); ++i){
+                for(int j = 0; j < B.rows(); ++j){
+                    const double t = (A.row(i) - B.row(j)).norm()/radius;
+                    const double s = std::max(1.0 - t, 0.0);
+                    const double phi = (q == 0) ? std::pow(s, l)
+                                     : (q == 1) ? std::pow(s, l+1)*((l+1)*t + 1)
+                                     : std::pow(s, l+2)*((l*l + 4*l + 3)*t*t + (3*l + 6)*t + 3)/3.0;
+                    K(i, j) = 1.4*phi;
+                }
+            }
+            return K;
+        };
+        Eigen::MatrixXd K;
+        wendland.K(K, X1);
+        EXPECT_TRUE(K.isApprox(wendlandNaive(X1, X1), 1e-12));
+        wendland.K(K, X1, X2);
+        EXPECT_TRUE(K.isApprox(wendlandNaive(X1, X2), 1e-12));
+
+        Eigen::SparseMatrix<double> Ksparse;
+        wendland.sparseK(Ksparse, X1);
+        EXPECT_TRUE(Eigen::MatrixXd(Ksparse).isApprox(wendlandNaive(X1, X1), 1e-12));
+        EXPECT_LT(Ksparse.nonZeros(), 60*60);
+
+        const Eigen::MatrixXd covGrad = Eigen::MatrixXd::Random(60, 60);
+        std::vector<Eigen::MatrixXd> dK;
+        wendland.dK_dP(dK, X1);
+        Eigen::VectorXd g;
+        wendland.gradient(g, X1, covGrad);
+        ASSERT_EQ(g.size(), 2);
+        const double h = 1e-6;
+        for(int i = 0; i < 2; ++i){
+            EXPECT_NEAR(g(i), (covGrad.array()*dK[i].array()).sum(), 1e-9);
+            Eigen::VectorXd p = wendland.getParameters();
+            p(i) += h;
+            kernel::WendlandCovFun plus(q, p);
+            p(i) -= 2*h;
+            kernel::WendlandCovFun minus(q, p);
+            Eigen::MatrixXd Kplus, Kminus;
+            plus.K(Kplus, X1);
+            minus.K(Kminus, X1);
+            EXPECT_NEAR(g(i), (covGrad.array()*(Kplus - Kminus).array()).sum()/(2*h), 1e-6);
+        }
+        // the partial derivatives on the pattern of the sparse covariance matrix give the same gradient
+        Eigen::SparseMatrix<double> covGradSparse = Ksparse;
+        for(Eigen::Index j = 0; j < covGradSparse.outerSize(); ++j){
+            for(Eigen::SparseMatrix<double>::InnerIterator it(covGradSparse, j); it; ++it){
+                it.valueRef() = covGrad(it.row(), it.col());
+            }
+        }
+        Eigen::VectorXd gSparse;
+        wendland.gradientSparse(gSparse, X1, covGradSparse);
+        EXPECT_TRUE(gSparse.isApprox(g, 1e-12));
+    }
+    EXPECT_THROW(kernel::WendlandCovFun(3), util::exceptions::InconsistentInputError);
+}
+
+TEST(kernels_gpkernel, sparse_factorization){
+    auto gpdata = std::make_shared<GPData>(2, 1);
+    Eigen::MatrixXd X = 5.0*Eigen::MatrixXd::Random(400, 2);
+    Eigen::MatrixXd Y = Eigen::MatrixXd::Random(400, 1);
+    gpdata->addData(X, Y);
+    kernel::GPKernel gpkernel(std::make_shared<kernel::WendlandCovFun>(1, 0.7, 1.0), 0.1);
+    gpkernel.registerData(gpdata);
+
+    auto check = [&](){
+        const kernel::CovFactorization& factorization = gpkernel.getFactorization();
+        EXPECT_TRUE(factorization.isSparse());
+        Eigen::MatrixXd K;
+        gpkernel.computeNoisedCov(K);
+        const Eigen::LLT<Eigen::MatrixXd> llt(K);
+        const Eigen::MatrixXd B = Eigen::MatrixXd::Random(K.rows(), 3);
+        Eigen::MatrixXd sol;
+        gpkernel.getNoisedInvCov(sol, B);
+        EXPECT_TRUE(sol.isApprox(llt.solve(B), 1e-10));
+        EXPECT_NEAR(gpkernel.computeNoisedLogDetCov(), 2.0*llt.matrixL().toDenseMatrix().diagonal().array().log().sum(), 1e-8);
+        Eigen::VectorXd q;
+        factorization.quadraticForm(q, B);
+        EXPECT_TRUE(q.isApprox((B.array()*llt.solve(B).array()).colwise().sum().matrix().transpose(), 1e-10));
+        Eigen::MatrixXd alpha;
+        gpkernel.getAlpha(alpha);
+        EXPECT_TRUE(alpha.isApprox(llt.solve(std::get<1>(gpdata->getNormalizedData())), 1e-10));
+        // the selected inverse matches the inverse on its pattern, which includes the pattern of K
+        Eigen::SparseMatrix<double> KinvSelected;
+        factorization.selectedInverse(KinvSelected);
+        const Eigen::MatrixXd Kinv = llt.solve(Eigen::MatrixXd::Identity(K.rows(), K.cols()));
+        EXPECT_LT(KinvSelected.nonZeros(), K.size());
+        Eigen::Index nonZerosK = 0;
+        for(Eigen::Index j = 0; j < KinvSelected.outerSize(); ++j){
+            for(Eigen::SparseMatrix<double>::InnerIterator it(KinvSelected, j); it; ++it){
+                EXPECT_NEAR(it.value(), Kinv(it.row(), it.col()), 1e-10);
+                nonZerosK += (K(it.row(), it.col()) != 0.0);
+            }
+        }
+        EXPECT_EQ(nonZerosK, (K.array() != 0.0).count());
+    };
+    check();
+    // appended and removed data points lead to a new factorization
+    const Eigen::MatrixXd Xnew = 5.0*Eigen::MatrixXd::Random(20, 2);
+    const Eigen::MatrixXd Ynew = Eigen::MatrixXd::Random(20, 1);
+    gpdata->addData(Xnew, Ynew);
+    check();
+    gpdata->removeData(10, 5);
+    check();
+}
+
+TEST(kernels_gpkernel, nystrom_factorization){
+    auto gpdata = std::make_shared<GPData>(2, 2);
+    Eigen::MatrixXd X = Eigen::MatrixXd::Random(120, 2);
+    Eigen::MatrixXd Y = Eigen::MatrixXd::Random(120, 2);
+    gpdata->addData(X, Y);
+    auto covfun = std::make_shared<kernel::RBFCovFun>(2.0, 1.5);
+    kernel::GPKernel gpkernel(covfun, 0.1);
+    gpkernel.registerData(gpdata);
+
+    auto check = [&](const unsigned int m){
+        const kernel::CovFactorization& factorization = gpkernel.getFactorization();
+        EXPECT_TRUE(factorization.isLowRank());
+        std::vector<Eigen::Index> landmarks = gpkernel.getLandmarks();
+        EXPECT_EQ(landmarks.size(), m);
+        std::sort(landmarks.begin(), landmarks.end());
+        EXPECT_TRUE(std::adjacent_find(landmarks.begin(), landmarks.end()) == landmarks.end());
+
+        // dense reference Knm Kmm^-1 Kmn + noise I
+        const GPData::ConstView Xdata = gpdata->getXView();
+        Eigen::MatrixXd Xm(m, 2), Kmm, Knm;
+        for(unsigned int i = 0; i < m; ++i){
+            Xm.row(i) = Xdata.row(landmarks[i]);
+        }
+        covfun->K(Kmm, Xm);
+        covfun->K(Knm, Xdata, Xm);
+        Eigen::MatrixXd Q = Knm*Kmm.llt().solve(Knm.transpose());
+        Q.diagonal().array() += 0.1;
+        const Eigen::LLT<Eigen::MatrixXd> llt(Q);
+
+        const Eigen::MatrixXd B = Eigen::MatrixXd::Random(Q.rows(), 3);
+        Eigen::MatrixXd sol, alpha, Qinv;
+        gpkernel.getNoisedInvCov(sol, B);
+        EXPECT_TRUE(sol.isApprox(llt.solve(B), 1e-8));
+        EXPECT_NEAR(gpkernel.computeNoisedLogDetCov(), 2.0*llt.matrixL().toDenseMatrix().diagonal().array().log().sum(), 1e-7);
+        Eigen::VectorXd q;
+        factorization.quadraticForm(q, B);
+        EXPECT_TRUE(q.isApprox((B.array()*llt.solve(B).array()).colwise().sum().matrix().transpose(), 1e-8));
+        factorization.inverse(Qinv);
+        EXPECT_TRUE(Qinv.isApprox(llt.solve(Eigen::MatrixXd::Identity(Q.rows(), Q.rows())), 1e-8));
+        gpkernel.getAlpha(alpha);
+        EXPECT_TRUE(alpha.isApprox(llt.solve(std::get<1>(gpdata->getNormalizedData())), 1e-8));
+    };
+
+    for(auto selection : {kernel::LandmarkSelection::UNIFORM, kernel::LandmarkSelection::KMEANSPP, kernel::LandmarkSelection::PIVOTED_CHOLESKY}){
+        gpkernel.setNystrom(15, selection, 3);
+        check(15);
+    }
+    // appended and removed data points lead to a new factorization
+    const Eigen::MatrixXd Xnew = Eigen::MatrixXd::Random(10, 2);
+    const Eigen::MatrixXd Ynew = Eigen::MatrixXd::Random(10, 2);
+    gpdata->addData(Xnew, Ynew);
+    check(15);
+    gpdata->removeData(3, 4);
+    check(15);
+
+    // the pivoted Cholesky selection is close to the exact factorization for smooth covariance functions
+    Eigen::MatrixXd K;
+    gpkernel.computeNoisedCov(K);
+    gpkernel.setNystrom(60);
+    EXPECT_NEAR(gpkernel.computeNoisedLogDetCov(), std::log(K.determinant()), 1e-6*std::abs(std::log(K.determinant())));
+
+    // with at most m data points the factorization is exact
+    gpkernel.setNystrom(200);
+    EXPECT_FALSE(gpkernel.getFactorization().isLowRank());
+    EXPECT_NEAR(gpkernel.computeNoisedLogDetCov(), std::log(K.determinant()), 1e-8);
+    gpkernel.setNystrom(0);
+    EXPECT_FALSE(gpkernel.getFactorization().isLowRank());
+
+    // the landmarks are kept while only the parameters change, and selected again for new data
+    gpkernel.setNystrom(15);
+    gpkernel.getFactorization();
+    const std::vector<Eigen::Index> landmarks = gpkernel.getLandmarks();
+    Eigen::VectorXd params(gpkernel.nParameters());
+    gpkernel.getParameters(params);
+    params(1) *= 3.0;
+    gpkernel.setParameters(params);
+    gpkernel.getFactorization();
+    EXPECT_EQ(gpkernel.getLandmarks(), landmarks);
+    gpdata->removeData(0, 20);
+    check(15);
+}
+
+TEST(kernels_gpkernel, matrix_free){
+    auto gpdata = std::make_shared<GPData>(2, 2);
+    Eigen::MatrixXd X = Eigen::MatrixXd::Random(150, 2);
+    Eigen::MatrixXd Y = Eigen::MatrixXd::Random(150, 2);
+    gpdata->addData(X, Y);
+    auto covfun = std::make_shared<kernel::Matern32CovFun>(1.0, 0.5);
+    covfun->setTileSize(32);
+    kernel::GPKernel gpkernel(covfun, 0.05);
+    gpkernel.registerData(gpdata);
+
+    kernel::IterativeOptions options;
+    options.tolerance = 1e-10;
+    options.preconditionerRank = 20;
+    options.nProbes = 30;
+    auto check = [&](){
+        Eigen::MatrixXd K;
+        gpkernel.setMatrixFree(false);
+        gpkernel.computeNoisedCov(K);
+        const double logDet = gpkernel.computeNoisedLogDetCov();
+        gpkernel.setMatrixFree(true, options);
+        const kernel::CovFactorization& factorization = gpkernel.getFactorization();
+        EXPECT_TRUE(factorization.isIterative());
+        const Eigen::LLT<Eigen::MatrixXd> llt(K);
+
+        // the tiled product agrees with the dense covariance matrix
+        const Eigen::MatrixXd B = Eigen::MatrixXd::Random(K.rows(), 3);
+        Eigen::MatrixXd KB, Kf;
+        covfun->multiplyK(KB, gpdata->getXView(), B);
+        covfun->K(Kf, gpdata->getXView());
+        EXPECT_TRUE(KB.isApprox(Kf*B, 1e-12));
+
+        Eigen::MatrixXd sol, alpha;
+        gpkernel.getNoisedInvCov(sol, B);
+        EXPECT_TRUE(sol.isApprox(llt.solve(B), 1e-7));
+        gpkernel.getAlpha(alpha);
+        EXPECT_TRUE(alpha.isApprox(llt.solve(std::get<1>(gpdata->getNormalizedData())), 1e-7));
+        Eigen::VectorXd q;
+        factorization.quadraticForm(q, B);
+        EXPECT_TRUE(q.isApprox((B.array()*llt.solve(B).array()).colwise().sum().matrix().transpose(), 1e-7));
+        EXPECT_NEAR(gpkernel.computeNoisedLogDetCov(), logDet, 0.02*std::abs(logDet));
+    };
+    check();
+
+    // the tiled gradient for partial derivatives of low rank agrees with the dense one
+    const Eigen::MatrixXd Ag = Eigen::MatrixXd::Random(150, 3);
+    const Eigen::MatrixXd Bg = Eigen::MatrixXd::Random(150, 3);
+    Eigen::VectorXd gLowRank, gDense;
+    gpkernel.computeNoisedCovGradient(gLowRank, Ag, Bg);
+    gpkernel.computeNoisedCovGradient(gDense, Eigen::MatrixXd(Ag*Bg.transpose()));
+    EXPECT_TRUE(gLowRank.isApprox(gDense, 1e-10));
+
+    // the preconditioner reduces the number of iterations
+    Eigen::MatrixXd sol;
+    const Eigen::MatrixXd B = Eigen::MatrixXd::Random(150, 1);
+    gpkernel.getNoisedInvCov(sol, B);
+    const unsigned int preconditioned = gpkernel.getFactorization().getIterations();
+    options.preconditionerRank = 0;
+    gpkernel.setMatrixFree(true, options);
+    gpkernel.getNoisedInvCov(sol, B);
+    EXPECT_LT(preconditioned, gpkernel.getFactorization().getIterations());
+    options.preconditionerRank = 20;
+
+    // solves that do not converge are reported
+    options.maxIterations = 2;
+    gpkernel.setMatrixFree(true, options);
+    EXPECT_THROW(gpkernel.getNoisedInvCov(sol, B), util::exceptions::Error);
+    options.maxIterations = 1000;
+
+    // appended and removed data points and new parameters lead to a new factorization
+    const Eigen::MatrixXd Xnew = Eigen::MatrixXd::Random(10, 2);
+    const Eigen::MatrixXd Ynew = Eigen::MatrixXd::Random(10, 2);
+    gpdata->addData(Xnew, Ynew);
+    check();
+    gpdata->removeData(3, 4);
+    check();
+    Eigen::VectorXd params(gpkernel.nParameters());
+    gpkernel.getParameters(params);
+    params(0) = 0.2;
+    gpkernel.setParameters(params);
+    covfun->setNumThreads(3);
+    check();
+
+    // the copy keeps the mode
+    kernel::GPKernel copy(gpkernel);
+    EXPECT_TRUE(copy.isMatrixFree());
+    EXPECT_EQ(copy.getIterativeOptions().preconditionerRank, 20u);
+}
@@ -0,0 +1,93 @@
+#include <cppgp/math/cg.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+math::CGResult math::conjugateGradients(Eigen::MatrixXd& X, const Eigen::Ref<const Eigen::MatrixXd>& B,
+                                        const LinearOperator& A, const LinearOperator& Pinv,
+                                        const double tolerance, const unsigned int maxIterations)
+{
+    const Eigen::Index n = B.rows();
+    const Eigen::Index k = B.cols();
+    CGResult result;
+    result.columnIterations = Eigen::VectorXi::Zero(k);
+    result.alpha = Eigen::MatrixXd::Zero(maxIterations, k);
+    result.beta = Eigen::MatrixXd::Zero(maxIterations, k);
+
+    X.setZero(n, k);
+    Eigen::MatrixXd R = B;
+    Eigen::MatrixXd Z, P, AP;
+    if(Pinv){
+        Pinv(Z, R);
+    }
+    else {
+        Z = R;
+    }
+    P = Z;
+    Eigen::ArrayXd rz = (R.array()*Z.array()).colwise().sum().transpose();
+    const Eigen::ArrayXd threshold = tolerance*B.colwise().norm().transpose().array();
+
+    unsigned int iteration = 0;
+    for(; iteration < maxIterations; ++iteration){
+        const Eigen::Array<bool, Eigen::Dynamic, 1> active = R.colwise().norm().transpose().array() > threshold;
+        if(!active.any()){
+            break;
+        }
+        A(AP, P);
+        for(Eigen::Index j = 0; j < k; ++j){
+            if(!active(j)){
+                continue;
+            }
+            const double a = rz(j)/P.col(j).dot(AP.col(j));
+            X.col(j).noalias() += a*P.col(j);
+            R.col(j).noalias() -= a*AP.col(j);
+            result.alpha(iteration, j) = a;
+        }
+        if(Pinv){
+            Pinv(Z, R);
+        }
+        else {
+            Z = R;
+        }
+        for(Eigen::Index j = 0; j < k; ++j){
+            if(!active(j)){
+                continue;
+            }
+            const double rzNew = R.col(j).dot(Z.col(j));
+            const double b = rzNew/rz(j);
+            P.col(j) = Z.col(j) + b*P.col(j);
+            rz(j) = rzNew;
+            result.beta(iteration, j) = b;
+            result.columnIterations(j) = iteration + 1;
+        }
+    }
+    result.iterations = iteration;
+    result.converged = (R.colwise().norm().transpose().array() <= threshold).all();
+    result.alpha.conservativeResize(iteration, Eigen::NoChange);
+    result.beta.conservativeResize(iteration, Eigen::NoChange);
+    return result;
+}
+
+double math::lanczosQuadrature(const Eigen::Ref<const Eigen::VectorXd>& alpha, const Eigen::Ref<const Eigen::VectorXd>& beta,
+                               const std::function<double(double)>& f)
+{
+    const Eigen::Index m = alpha.size();
+    if(m == 0){
+        return 0.0;
+    }
+    // T(i, i) = 1/alpha_i + beta_{i-1}/alpha_{i-1}, T(i, i+1) = sqrt(beta_i)/alpha_i
+    Eigen::VectorXd diag(m), subdiag(std::max<Eigen::Index>(m-1, 0));
+    for(Eigen::Index i = 0; i < m; ++i){
+        diag(i) = 1.0/alpha(i) + ((i > 0) ? beta(i-1)/alpha(i-1) : 0.0);
+        if(i+1 < m){
+            subdiag(i) = std::sqrt(beta(i))/alpha(i);
+        }
+    }
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig;
+    eig.computeFromTridiagonal(diag, subdiag, Eigen::ComputeEigenvectors);
+    double quadrature = 0.0;
+    for(Eigen::Index i = 0; i < m; ++i){
+        quadrature += eig.eigenvectors()(0, i)*eig.eigenvectors()(0, i)*f(eig.eigenvalues()(i));
+    }
+    return quadrature;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+
+#include <Eigen/Eigen>
+
+namespace math {
+
+    /**
+     * Product of an operator with a block of vectors, Y = A V. The first argument returns Y, size [n, k],
+     * the second argument is V, size [n, k].
+     */
+    typedef std::function<void(Eigen::MatrixXd&, const Eigen::Ref<const Eigen::MatrixXd>&)> LinearOperator;
+
+    /**
+     * Result of #conjugateGradients.
+     */
+    struct CGResult {
+        unsigned int iterations = 0;        // number of iterations of the slowest right-hand side
+        bool converged = false;             // true if all right-hand sides reached the tolerance
+        Eigen::VectorXi columnIterations;   // [k], number of iterations of each right-hand side
+        Eigen::MatrixXd alpha;              // [iterations x k], step lengths of each right-hand side
+        Eigen::MatrixXd beta;               // [iterations x k], conjugation coefficients of each right-hand side
+    };
+
+    /**
+     * @brief Solves A X = B for a symmetric positive definite operator A by preconditioned conjugate gradients.
+     *
+     * All right-hand sides are iterated together, such that each iteration needs a single product of A and of the
+     * preconditioner with a block of vectors. A right-hand side is frozen once its residual norm is below
+     * tolerance times the norm of its right-hand side. The coefficients of the iterations are returned, they define
+     * the Lanczos tridiagonal matrices of the preconditioned operator, see #lanczosQuadrature.
+     *
+     * @param X Returns the solution, size [n, k]. The iteration starts at zero.
+     * @param B The right-hand sides, size [n, k].
+     * @param A The operator.
+     * @param Pinv The inverse of the preconditioner, nullptr for none.
+     * @param tolerance The relative residual norm at which a right-hand side has converged.
+     * @param maxIterations The maximum number of iterations.
+     * @return The number of iterations and the coefficients.
+     */
+    CGResult conjugateGradients(Eigen::MatrixXd& X, const Eigen::Ref<const Eigen::MatrixXd>& B,
+                                const LinearOperator& A, const LinearOperator& Pinv,
+                                const double tolerance, const unsigned int maxIterations);
+
+    /**
+     * @brief Computes the Gauss quadrature \f$ e_1^T f(T) e_1 \f$ of the Lanczos tridiagonal matrix T of a conjugate gradient run.
+     *
+     * For a conjugate gradient run with the preconditioner P started at the right-hand side b, T is the Lanczos
+     * tridiagonal matrix of \f$ P^{-1/2} A P^{-1/2} \f$ with the start vector \f$ P^{-1/2} b \f$, such that
+     * \f$ (b^T P^{-1} b) e_1^T f(T) e_1 \f$ approximates \f$ b^T P^{-1/2} f(P^{-1/2} A P^{-1/2}) P^{-1/2} b \f$,
+     * e.g. for the stochastic Lanczos quadrature of log determinants.
+     *
+     * @param alpha The step lengths of the run, size [m].
+     * @param beta The conjugation coefficients of the run, size [m], the last one is not used.
+     * @param f The function, e.g. the logarithm.
+     * @return The quadrature, 0 for m = 0.
+     */
+    double lanczosQuadrature(const Eigen::Ref<const Eigen::VectorXd>& alpha, const Eigen::Ref<const Eigen::VectorXd>& beta,
+                             const std::function<double(double)>& f);
+}
@@ -0,0 +1,67 @@
+#include <cppgp/math/cg.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+
+namespace {
+
+    Eigen::MatrixXd random_spd_matrix(int n){
+        Eigen::MatrixXd A = Eigen::MatrixXd::Random(n, n);
+        return A*A.transpose() + 0.1*Eigen::MatrixXd::Identity(n, n);
+    }
+}
+
+TEST(math_cg, solve){
+    const Eigen::MatrixXd A = random_spd_matrix(40);
+    const Eigen::MatrixXd B = Eigen::MatrixXd::Random(40, 3);
+    const math::LinearOperator multiply = [&](Eigen::MatrixXd& Y, const Eigen::Ref<const Eigen::MatrixXd>& V){ Y = A*V; };
+    const Eigen::MatrixXd expected = A.llt().solve(B);
+
+    Eigen::MatrixXd X;
+    math::CGResult result = math::conjugateGradients(X, B, multiply, nullptr, 1e-10, 1000);
+    EXPECT_TRUE(result.converged);
+    EXPECT_EQ(result.columnIterations.maxCoeff(), static_cast<int>(result.iterations));
+    EXPECT_TRUE(X.isApprox(expected, 1e-8));
+
+    // an exact preconditioner converges in a single iteration
+    const Eigen::LLT<Eigen::MatrixXd> llt(A);
+    const math::LinearOperator precondition = [&](Eigen::MatrixXd& Y, const Eigen::Ref<const Eigen::MatrixXd>& V){ Y = llt.solve(V); };
+    result = math::conjugateGradients(X, B, multiply, precondition, 1e-10, 1000);
+    EXPECT_TRUE(result.converged);
+    EXPECT_EQ(result.iterations, 1u);
+    EXPECT_TRUE(X.isApprox(expected, 1e-8));
+
+    // zero right-hand sides and the iteration limit
+    result = math::conjugateGradients(X, Eigen::MatrixXd::Zero(40, 2), multiply, nullptr, 1e-10, 1000);
+    EXPECT_EQ(result.iterations, 0u);
+    EXPECT_TRUE(X.isZero());
+    result = math::conjugateGradients(X, B, multiply, nullptr, 1e-10, 2);
+    EXPECT_FALSE(result.converged);
+    EXPECT_EQ(result.iterations, 2u);
+}
+
+TEST(math_cg, lanczos_quadrature){
+    const int n = 30;
+    const Eigen::MatrixXd A = random_spd_matrix(n);
+    const Eigen::VectorXd b = Eigen::VectorXd::Random(n);
+    const math::LinearOperator multiply = [&](Eigen::MatrixXd& Y, const Eigen::Ref<const Eigen::MatrixXd>& V){ Y = A*V; };
+
+    // b^T log(A) b / ||b||^2
+    const Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(A);
+    const Eigen::VectorXd c = eig.eigenvectors().transpose()*b;
+    const double expected = (c.array().square()*eig.eigenvalues().array().log()).sum()/b.squaredNorm();
+
+    Eigen::MatrixXd X;
+    const math::CGResult result = math::conjugateGradients(X, b, multiply, nullptr, 1e-12, 1000);
+    const Eigen::Index m = result.columnIterations(0);
+    ASSERT_GT(m, 0);
+    const double quadrature = math::lanczosQuadrature(result.alpha.col(0).head(m), result.beta.col(0).head(m), [](double x){ return std::log(x); });
+    EXPECT_NEAR(quadrature, expected, 1e-6*std::abs(expected));
+
+    // f(x) = 1/x gives b^T A^-1 b / ||b||^2
+    const double inverse = math::lanczosQuadrature(result.alpha.col(0).head(m), result.beta.col(0).head(m), [](double x){ return 1.0/x; });
+    EXPECT_NEAR(inverse, b.dot(A.llt().solve(b))/b.squaredNorm(), 1e-6*inverse);
+    EXPECT_EQ(math::lanczosQuadrature(Eigen::VectorXd(), Eigen::VectorXd(), [](double x){ return x; }), 0.0);
+}
@@ -0,0 +1,155 @@
+#include <cppgp/math/cholesky.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const Eigen::Index cholBlockSize = 64;
+}
+
+Eigen::Index math::cholInplace(Eigen::Ref<Eigen::MatrixXd> A, const Eigen::Index start){
+    const Eigen::Index n = A.rows();
+    if(A.cols() != n || start < 0 || start > n){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Cholesky factorization requires a square matrix");
+    }
+    Eigen::Matrix<double, Eigen::Dynamic, 1, 0, cholBlockSize, 1> blockDiag;
+
+    for(Eigen::Index j = start; j < n; j += cholBlockSize){
+        const Eigen::Index b = std::min(cholBlockSize, n-j);
+        const Eigen::Index m = n-j-b;
+        blockDiag = A.diagonal().segment(j, b);
+
+        // apply the columns 0, ..., j-1 of the factor to the panel A(j:n, j:j+b), lower triangle only
+        if(j > 0){
+            A.block(j, j, b, b).selfadjointView<Eigen::Lower>().rankUpdate(A.block(j, 0, b, j), -1.0);
+            A.block(j+b, j, m, b).noalias() -= A.block(j+b, 0, m, j)*A.block(j, 0, b, j).transpose();
+        }
+
+        // unblocked left-looking factorization of the panel
+        for(Eigen::Index c = j; c < j+b; ++c){
+            const Eigen::Index r = n-c;
+            if(c > j){
+                A.block(c, c, r, 1).noalias() -= A.block(c, j, r, c-j)*A.block(c, j, 1, c-j).transpose();
+            }
+            const double pivot = A(c, c);
+            if(!(pivot > 0.0)){
+                // revert the unfinished columns of the panel, the columns right of the panel are untouched
+                for(Eigen::Index k = c; k < j+b; ++k){
+                    A.block(k+1, k, n-k-1, 1) = A.block(k, k+1, 1, n-k-1).transpose();
+                    A(k, k) = blockDiag(k-j);
+                }
+                return c;
+            }
+            A(c, c) = std::sqrt(pivot);
+            A.block(c+1, c, r-1, 1) /= A(c, c);
+        }
+    }
+    return n;
+}
+
+void math::cholRestore(Eigen::Ref<Eigen::MatrixXd> A, const Eigen::Ref<const Eigen::VectorXd>& diag, const Eigen::Index start, const Eigen::Index end){
+    const Eigen::Index n = A.rows();
+    const Eigen::Index last = (end < 0) ? n : end;
+    for(Eigen::Index k = start; k < last; ++k){
+        A.block(k+1, k, n-k-1, 1) = A.block(k, k+1, 1, n-k-1).transpose();
+        A(k, k) = diag(k);
+    }
+}
+
+bool math::cholJitter(Eigen::Ref<Eigen::MatrixXd> A, Eigen::VectorXd& diag, double& jitter, const double initialJitter,
+                      const unsigned int maxTries, const JitterStrategy strategy){
+    const Eigen::Index n = A.rows();
+    diag = A.diagonal();
+    jitter = 0.0;
+
+    Eigen::Index failed = math::cholInplace(A);
+    double delta = initialJitter;
+    for(unsigned int i = 1; i < maxTries && failed < n; ++i, delta *= 10){
+        if(strategy == JitterStrategy::RESUME){
+            // the columns left of the failing one are final, jitter the trailing block only
+            jitter += delta;
+            A.diagonal().tail(n-failed).array() += delta;
+            failed = math::cholInplace(A, failed);
+        }
+        else {
+            jitter = delta;
+            math::cholRestore(A, diag, 0, failed);
+            A.diagonal() = diag.array() + jitter;
+            failed = math::cholInplace(A);
+        }
+    }
+    return failed == n;
+}
+
+bool math::cholAppend(Eigen::MatrixXd& L, const Eigen::MatrixXd& Knew, const double relTol){
+    const Eigen::Index n = L.rows();
+    const Eigen::Index k = Knew.cols();
+    if(Knew.rows() != n+k){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Size of the new columns does not match the size of the Cholesky factor");
+    }
+
+    // L21^T = L11^{-1} B
+    Eigen::MatrixXd L21t = Knew.topRows(n);
+    L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solveInPlace(L21t);
+
+    // Schur complement S = C - L21 L21^T
+    Eigen::MatrixXd S = Knew.bottomRows(k);
+    S.selfadjointView<Eigen::Lower>().rankUpdate(L21t.transpose(), -1.0);
+
+    Eigen::LLT<Eigen::Ref<Eigen::MatrixXd>> llt(S);
+    if(llt.info() != Eigen::Success){
+        return false;
+    }
+    // S holds L22 in its lower triangle, compare squared pivots against the diagonal of C
+    const Eigen::ArrayXd pivots = S.diagonal().array().square();
+    if((pivots < relTol*Knew.bottomRows(k).diagonal().array().abs()).any()){
+        return false;
+    }
+
+    L.conservativeResize(n+k, n+k);
+    L.topRightCorner(n, k).setZero();
+    L.bottomLeftCorner(k, n) = L21t.transpose();
+    L.bottomRightCorner(k, k).triangularView<Eigen::Lower>() = S;
+    L.bottomRightCorner(k, k).triangularView<Eigen::StrictlyUpper>().setZero();
+    return true;
+}
+
+void math::cholDelete(Eigen::MatrixXd& L, const Eigen::Index index, const Eigen::Index count){
+    const Eigen::Index n = L.rows();
+    if(index < 0 || count < 0 || index+count > n){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Rows to remove exceed the size of the Cholesky factor");
+    }
+    const Eigen::Index m = n-index-count;
+
+    // L33' L33'^T = L33 L33^T + L32 L32^T
+    Eigen::VectorXd v(m);
+    for(Eigen::Index j = 0; j < count; ++j){
+        v = L.block(index+count, index+j, m, 1);
+        cholRankUpdate(L.bottomRightCorner(m, m), v);
+    }
+
+    Eigen::MatrixXd Lnew(n-count, n-count);
+    Lnew.topLeftCorner(index, index) = L.topLeftCorner(index, index);
+    Lnew.topRightCorner(index, m).setZero();
+    Lnew.bottomLeftCorner(m, index) = L.bottomLeftCorner(m, index);
+    Lnew.bottomRightCorner(m, m) = L.bottomRightCorner(m, m);
+    L.swap(Lnew);
+}
+
+void math::cholRankUpdate(Eigen::Ref<Eigen::MatrixXd> L, Eigen::Ref<Eigen::VectorXd> v){
+    const Eigen::Index n = L.rows();
+    for(Eigen::Index k = 0; k < n; ++k){
+        const double r = std::hypot(L(k, k), v(k));
+        const double c = r/L(k, k);
+        const double s = v(k)/L(k, k);
+        L(k, k) = r;
+        const Eigen::Index m = n-k-1;
+        L.col(k).tail(m) = (L.col(k).tail(m) + s*v.tail(m))/c;
+        v.tail(m) = c*v.tail(m) - s*L.col(k).tail(m);
+    }
+}
+
+double math::cholLogDet(const Eigen::MatrixXd& L){
+    return 2.0*L.diagonal().array().log().sum();
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <Eigen/Eigen>
+
+namespace math {
+
+    /**
+     * Strategy of #cholJitter when the factorization fails.
+     * - RESTART: Restore the matrix and factorize it again with a larger jitter added to the whole diagonal.
+     * - RESUME: Keep the columns that have been factorized successfully and continue at the failing column
+     *           with a jitter added to the remaining part of the diagonal only.
+     */
+    enum class JitterStrategy {RESTART, RESUME};
+
+    /**
+     * @brief Computes a Cholesky factorization in place and reports the failing column.
+     *
+     * Blocked left-looking factorization of the symmetric matrix A, whose lower triangle
+     * is overwritten by the lower Cholesky factor. The strictly upper triangle is neither read nor written,
+     * so it still holds the original matrix afterwards.
+     * The columns 0, ..., start-1 are expected to hold the factor already, e.g. from a previous call that failed.
+     *
+     * If a pivot is not positive at column f, the function returns f. In this case the columns 0, ..., f-1
+     * hold the factor and the lower triangle of the trailing block A(f:n, f:n) holds the input again,
+     * such that the factorization can be resumed at f, e.g. after adding a jitter to the trailing diagonal.
+     *
+     * @param A The matrix to factorize, size [n, n]. Returns the factor in the lower triangle.
+     * @param start The first column to factorize.
+     * @return n on success, otherwise the index of the failing column.
+     */
+    Eigen::Index cholInplace(Eigen::Ref<Eigen::MatrixXd> A, const Eigen::Index start=0);
+
+    /**
+     * @brief Restores the lower triangle of a matrix from its strictly upper triangle and the given diagonal.
+     *
+     * Reverts the columns start, ..., end-1 of the lower triangle after #cholInplace.
+     *
+     * @param A The matrix, size [n, n].
+     * @param diag The diagonal of the original matrix, size [n].
+     * @param start The first column to restore.
+     * @param end One past the last column to restore, -1 for n.
+     */
+    void cholRestore(Eigen::Ref<Eigen::MatrixXd> A, const Eigen::Ref<const Eigen::VectorXd>& diag, const Eigen::Index start=0, const Eigen::Index end=-1);
+
+    /**
+     * @brief Computes a Cholesky factorization in place, adding a growing jitter to the diagonal on failure.
+     *
+     * The first try is done without jitter, the i-th retry adds initialJitter*10^(i-1), see #JitterStrategy.
+     * Only the lower triangle and the diagonal of A are touched, no copies of A are made.
+     *
+     * @param A The symmetric matrix to factorize, size [n, n]. Returns the lower Cholesky factor in the lower triangle,
+     *          the strictly upper triangle keeps the original matrix.
+     * @param diag Workspace, returns the diagonal of the original matrix, size [n].
+     * @param jitter Returns the largest jitter that has been added to the diagonal, 0 if none.
+     * @param initialJitter The jitter of the first retry.
+     * @param maxTries The maximum number of tries including the first one without jitter.
+     * @param strategy Strategy for the retries.
+     * @return True on success, false if all tries failed. In this case A is partially factorized, see #cholInplace.
+     */
+    bool cholJitter(Eigen::Ref<Eigen::MatrixXd> A, Eigen::VectorXd& diag, double& jitter, const double initialJitter,
+                    const unsigned int maxTries, const JitterStrategy strategy=JitterStrategy::RESTART);
+
+    /**
+     * @brief Extends a Cholesky factorization by k new rows and columns.
+     *
+     * Given the lower Cholesky factor L of a symmetric positive definite matrix A of size [n, n],
+     * compute the Cholesky factor of the extended matrix
+     * \f[
+     * \begin{bmatrix} A & B \\ B^T & C \end{bmatrix}
+     * \f]
+     * in O(n^2 k) by reusing L. Only the lower triangle of L is referenced and updated.
+     *
+     * The update is rejected if the Schur complement \f$ C - B^T A^{-1} B \f$ is not numerically
+     * positive definite, i.e. if one of its pivots falls below relTol times the corresponding
+     * diagonal entry of C. In this case L is left unchanged and the caller should refactorize
+     * the extended matrix from scratch.
+     *
+     * @param L The lower Cholesky factor, size [n, n]. Returns the extended factor, size [n+k, n+k].
+     * @param Knew The new columns [B; C] of the extended matrix, size [n+k, k].
+     * @param relTol Relative tolerance for the pivots of the Schur complement.
+     * @return True if L has been extended, false if the update has been rejected.
+     */
+    bool cholAppend(Eigen::MatrixXd& L, const Eigen::MatrixXd& Knew, const double relTol=1e-10);
+
+    /**
+     * @brief Removes rows and columns from a Cholesky factorization.
+     *
+     * Given the lower Cholesky factor L of a symmetric positive definite matrix A of size [n, n],
+     * compute the Cholesky factor of A without the rows and columns index, ..., index+count-1.
+     * The factor of the leading block is kept, the trailing block receives count rank-one updates,
+     * so the costs are O((n-index)^2 count). Removing the first rows is the most expensive case.
+     * Only the lower triangle of L is referenced.
+     *
+     * @param L The lower Cholesky factor, size [n, n]. Returns the reduced factor, size [n-count, n-count].
+     * @param index The index of the first row and column to remove.
+     * @param count The number of rows and columns to remove.
+     */
+    void cholDelete(Eigen::MatrixXd& L, const Eigen::Index index, const Eigen::Index count=1);
+
+    /**
+     * @brief Performs a rank-one update of a Cholesky factorization.
+     *
+     * Given the lower Cholesky factor L of A, compute the factor of \f$ A + v v^T \f$ in place in O(n^2).
+     * Only the lower triangle of L is referenced.
+     *
+     * @param L The lower Cholesky factor, size [n, n]. Returns the updated factor.
+     * @param v The update vector, size [n]. Its content is destroyed.
+     */
+    void cholRankUpdate(Eigen::Ref<Eigen::MatrixXd> L, Eigen::Ref<Eigen::VectorXd> v);
+
+    /**
+     * @brief Computes the logarithm of the determinant from a Cholesky factor.
+     *
+     * @param L The lower Cholesky factor of a matrix A, size [n, n].
+     * @return log(det(A))
+     */
+    double cholLogDet(const Eigen::MatrixXd& L);
+}
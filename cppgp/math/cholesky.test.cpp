@@ -0,0 +1,128 @@
+#include <cppgp/math/cholesky.hpp>
+
+#include <gtest/gtest.h>
+
+
+Eigen::MatrixXd random_spd_matrix(int n){
+    Eigen::MatrixXd A = Eigen::MatrixXd::Random(n, n);
+    return A*A.transpose() + n*Eigen::MatrixXd::Identity(n, n);
+}
+
+TEST(math_cholesky, append_block){
+    Eigen::MatrixXd A = random_spd_matrix(7);
+
+    Eigen::MatrixXd L = A.topLeftCorner(4, 4).llt().matrixL();
+    EXPECT_TRUE(math::cholAppend(L, A.rightCols(3)));
+
+    Eigen::MatrixXd Lres = A.llt().matrixL();
+    EXPECT_EQ(L.rows(), 7);
+    EXPECT_TRUE(L.isApprox(Lres));
+}
+
+TEST(math_cholesky, append_single_from_empty){
+    Eigen::MatrixXd A = random_spd_matrix(5);
+
+    Eigen::MatrixXd L(0, 0);
+    for(int i = 0; i < 5; ++i){
+        EXPECT_TRUE(math::cholAppend(L, A.topLeftCorner(i+1, i+1).rightCols(1)));
+    }
+
+    Eigen::MatrixXd Lres = A.llt().matrixL();
+    EXPECT_TRUE(L.isApprox(Lres));
+    EXPECT_NEAR(math::cholLogDet(L), std::log(A.determinant()), 1e-10);
+}
+
+TEST(math_cholesky, append_reject_singular){
+    Eigen::MatrixXd A = random_spd_matrix(3);
+    Eigen::MatrixXd Aext(4, 4);
+    Aext << A, A.col(0), A.row(0), A(0, 0); // duplicate of the first row and column
+
+    Eigen::MatrixXd L = A.llt().matrixL();
+    Eigen::MatrixXd Lold = L;
+    EXPECT_FALSE(math::cholAppend(L, Aext.rightCols(1)));
+    EXPECT_EQ(L, Lold);
+}
+
+TEST(math_cholesky, delete_rows){
+    Eigen::MatrixXd A = random_spd_matrix(8);
+    std::vector<int> keep = {0, 1, 5, 6, 7};
+
+    Eigen::MatrixXd L = A.llt().matrixL();
+    math::cholDelete(L, 2, 3);
+
+    Eigen::MatrixXd Lres = A(keep, keep).llt().matrixL();
+    EXPECT_EQ(L.rows(), 5);
+    EXPECT_TRUE(L.triangularView<Eigen::Lower>().toDenseMatrix().isApprox(Lres));
+}
+
+TEST(math_cholesky, delete_first_and_last){
+    Eigen::MatrixXd A = random_spd_matrix(6);
+
+    Eigen::MatrixXd L = A.llt().matrixL();
+    math::cholDelete(L, 0);
+    math::cholDelete(L, 4);
+
+    Eigen::MatrixXd Lres = A.block(1, 1, 4, 4).llt().matrixL();
+    EXPECT_TRUE(L.triangularView<Eigen::Lower>().toDenseMatrix().isApprox(Lres));
+}
+
+TEST(math_cholesky, inplace_blocked){
+    Eigen::MatrixXd A = random_spd_matrix(150);
+
+    Eigen::MatrixXd L = A;
+    EXPECT_EQ(math::cholInplace(L), 150);
+
+    Eigen::MatrixXd Lres = A.llt().matrixL();
+    EXPECT_TRUE(L.triangularView<Eigen::Lower>().toDenseMatrix().isApprox(Lres));
+    EXPECT_EQ(L.triangularView<Eigen::StrictlyUpper>().toDenseMatrix(), A.triangularView<Eigen::StrictlyUpper>().toDenseMatrix());
+}
+
+TEST(math_cholesky, inplace_failure_resume){
+    Eigen::MatrixXd A = random_spd_matrix(100);
+    A.row(70) = A.row(3);
+    A.col(70) = A.col(3);
+    A(70, 70) -= 1.0; // the matrix is indefinite, the pivot of column 70 is -1
+
+    Eigen::MatrixXd L = A;
+    EXPECT_EQ(math::cholInplace(L), 70);
+
+    Eigen::MatrixXd Lres = A.topLeftCorner(70, 70).llt().matrixL();
+    EXPECT_TRUE(L.topLeftCorner(70, 70).triangularView<Eigen::Lower>().toDenseMatrix().isApprox(Lres));
+    EXPECT_EQ(L.bottomRightCorner(30, 30).triangularView<Eigen::Lower>().toDenseMatrix(),
+              A.bottomRightCorner(30, 30).triangularView<Eigen::Lower>().toDenseMatrix());
+
+    // resume with a jitter on the trailing diagonal
+    L.diagonal().tail(30).array() += 2.0;
+    EXPECT_EQ(math::cholInplace(L, 70), 100);
+    A.diagonal().tail(30).array() += 2.0;
+    L.triangularView<Eigen::StrictlyUpper>().setZero();
+    Eigen::MatrixXd LLt = L*L.transpose();
+    EXPECT_TRUE(LLt.isApprox(A));
+}
+
+TEST(math_cholesky, jitter_restart_and_resume){
+    Eigen::MatrixXd B = Eigen::MatrixXd::Random(80, 20);
+    Eigen::MatrixXd A = B*B.transpose() - 1e-6*Eigen::MatrixXd::Identity(80, 80); // indefinite after column 20
+
+    Eigen::MatrixXd L = A;
+    Eigen::VectorXd diag;
+    double jitter;
+    EXPECT_FALSE(math::cholJitter(L, diag, jitter, 1e-8, 1));
+    EXPECT_EQ(jitter, 0.0);
+
+    L = A;
+    EXPECT_TRUE(math::cholJitter(L, diag, jitter, 1e-8, 20, math::JitterStrategy::RESTART));
+    EXPECT_GT(jitter, 0.0);
+    EXPECT_EQ(diag, A.diagonal());
+    Eigen::MatrixXd Ajitter = A + jitter*Eigen::MatrixXd::Identity(80, 80);
+    L.triangularView<Eigen::StrictlyUpper>().setZero();
+    Eigen::MatrixXd LLt = L*L.transpose();
+    EXPECT_TRUE(LLt.isApprox(Ajitter));
+
+    // resuming only jitters the trailing block, the leading block is factorized exactly
+    L = A;
+    EXPECT_TRUE(math::cholJitter(L, diag, jitter, 1e-8, 20, math::JitterStrategy::RESUME));
+    EXPECT_GT(jitter, 0.0);
+    Eigen::MatrixXd Lres = A.topLeftCorner(20, 20).llt().matrixL();
+    EXPECT_TRUE(L.topLeftCorner(20, 20).triangularView<Eigen::Lower>().toDenseMatrix().isApprox(Lres));
+}
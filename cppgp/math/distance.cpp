@@ -1,7 +1,11 @@
 #include <cppgp/math/distance.hpp>
+#include <cppgp/math/kdtree.hpp>
+#include <cppgp/math/simd.hpp>
 #include <cppgp/util/exceptions.hpp>
 
-void math::dist2(Eigen::MatrixXd& dist, const Eigen::MatrixXd& x1, const Eigen::MatrixXd& x2){
+#include <vector>
+
+void math::dist2(Eigen::MatrixXd& dist, const Eigen::Ref<const Eigen::MatrixXd>& x1, const Eigen::Ref<const Eigen::MatrixXd>& x2){
     auto n1 = x1.rows();
     auto dim1 = x1.cols();
     auto n2 = x2.rows();
@@ -10,10 +14,33 @@ void math::dist2(Eigen::MatrixXd& dist, const Eigen::MatrixXd& x1, const Eigen::
         util::exceptions::throwException<util::exceptions::InconsistentInputError>("Data dimension does not match dimension of centres");
     }
 
-    dist =
-              x1.array().square().rowwise().sum().rowwise().replicate(n2).matrix()
-            + x2.array().square().rowwise().sum().rowwise().replicate(n1).transpose().matrix()
-            - 2.0 * x1 * x2.transpose();
+    // ||x1||^2 + ||x2||^2 - 2 x1^T x2, converted column by column by the vectorized kernel
+    const Eigen::VectorXd sq1 = x1.rowwise().squaredNorm();
+    dist.noalias() = x1 * x2.transpose();
+    for(Eigen::Index j = 0; j < n2; ++j){
+        math::simd::sqDistFromInnerProducts(dist.col(j).data(), sq1.data(), x2.row(j).squaredNorm(), n1);
+    }
+}
+
+void math::sparseDist(Eigen::SparseMatrix<double>& dist, const Eigen::Ref<const Eigen::MatrixXd>& x1, const Eigen::Ref<const Eigen::MatrixXd>& x2, const double radius){
+    if(x1.cols() != x2.cols()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Data dimension does not match dimension of centres");
+    }
+    dist.resize(x1.rows(), x2.rows());
+    if(x1.rows() == 0 || x2.rows() == 0){
+        dist.setZero();
+        return;
+    }
 
-    dist = dist.cwiseMax(0.0);
+    const math::KDTree tree(x2);
+    std::vector<Eigen::Triplet<double>> pairs;
+    std::vector<Eigen::Index> indices;
+    std::vector<double> distances;
+    for(Eigen::Index i = 0; i < x1.rows(); ++i){
+        tree.radiusSearch(indices, distances, x1.row(i).transpose(), radius);
+        for(size_t k = 0; k < indices.size(); ++k){
+            pairs.emplace_back(i, indices[k], distances[k]);
+        }
+    }
+    dist.setFromTriplets(pairs.begin(), pairs.end());
 }
@@ -7,5 +7,18 @@ namespace math {
     /**
      * @brief Calculates squared distance between two sets of points.
      */
-    void dist2(Eigen::MatrixXd& dist, const Eigen::MatrixXd& x1, const Eigen::MatrixXd& x2);
+    void dist2(Eigen::MatrixXd& dist, const Eigen::Ref<const Eigen::MatrixXd>& x1, const Eigen::Ref<const Eigen::MatrixXd>& x2);
+
+    /**
+     * @brief Calculates the Euclidean distances between all pairs of points that are closer than a radius.
+     *
+     * The pairs are found by radius queries of the points of x1 in a KDTree of the points of x2.
+     * Pairs with distance zero, e.g. the diagonal for x1 = x2, are stored explicitly.
+     *
+     * @param dist Returns the distances of the pairs within the radius, size [n1, n2].
+     * @param x1 The first set of points, size [n1, k].
+     * @param x2 The second set of points, size [n2, k].
+     * @param radius The radius, the distances of all stored pairs are smaller.
+     */
+    void sparseDist(Eigen::SparseMatrix<double>& dist, const Eigen::Ref<const Eigen::MatrixXd>& x1, const Eigen::Ref<const Eigen::MatrixXd>& x2, const double radius);
 }
@@ -9,3 +9,31 @@ TEST(math_distance, dist2_test){
   // Expect equality.
   EXPECT_EQ(7 * 6, 42);
 }
+
+TEST(math_distance, sparse_dist){
+    const Eigen::MatrixXd x1 = Eigen::MatrixXd::Random(200, 3);
+    const Eigen::MatrixXd x2 = Eigen::MatrixXd::Random(150, 3);
+    const double radius = 0.4;
+    Eigen::SparseMatrix<double> dist;
+    math::sparseDist(dist, x1, x2, radius);
+    ASSERT_EQ(dist.rows(), 200);
+    ASSERT_EQ(dist.cols(), 150);
+    Eigen::Index nnz = 0;
+    for(int i = 0; i < 200; ++i){
+        for(int j = 0; j < 150; ++j){
+            const double d = (x1.row(i) - x2.row(j)).norm();
+            if(d < radius){
+                ++nnz;
+                EXPECT_NEAR(dist.coeff(i, j), d, 1e-14);
+            }
+        }
+    }
+    EXPECT_EQ(dist.nonZeros(), nnz);
+
+    // the diagonal is stored although the distances are zero
+    math::sparseDist(dist, x1, x1, radius);
+    Eigen::SparseMatrix<double> pattern = dist;
+    pattern.coeffs().setOnes();
+    EXPECT_EQ(pattern.diagonal().sum(), 200);
+    EXPECT_TRUE(dist.isApprox(Eigen::SparseMatrix<double>(dist.transpose())));
+}
@@ -0,0 +1,312 @@
+#include <cppgp/math/kdtree.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+namespace {
+    const double balance = 0.7; // a subtree is rebuilt if one child holds more than this fraction of its points
+}
+
+math::KDTree::KDTree(const unsigned int dim, const unsigned int leafSize) :
+    dim(dim), leafSize(std::max(leafSize, 1u)), points(dim, 0), nIds(0), nRemoved(0)
+{
+    this->clear();
+}
+
+math::KDTree::KDTree(const Eigen::Ref<const Eigen::MatrixXd>& X, const unsigned int leafSize) :
+    KDTree(X.cols(), leafSize)
+{
+    this->points = X.transpose();
+    this->nIds = X.rows();
+    this->rebuild();
+}
+
+void math::KDTree::insert(const Eigen::Ref<const Eigen::MatrixXd>& X)
+{
+    if(X.cols() != this->dim){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Data dimension does not match the dimension of the tree");
+    }
+    const Eigen::Index k = X.rows();
+    if(this->nIds + k > this->points.cols()){
+        this->points.conservativeResize(Eigen::NoChange, std::max(this->nIds + k, 2*this->points.cols()));
+    }
+    this->points.middleCols(this->nIds, k) = X.transpose();
+    for(Eigen::Index i = 0; i < k; ++i){
+        this->insertPoint(this->nIds++);
+    }
+}
+
+void math::KDTree::remove(const Eigen::Index index, const Eigen::Index count)
+{
+    assert(index >= 0 && index+count <= this->size());
+    if(count == 0){
+        return;
+    }
+    if(index == 0){
+        // the oldest points are skipped by the queries until the tree is rebuilt
+        this->nRemoved += count;
+        if(this->nRemoved > this->size()){
+            this->rebuild();
+        }
+        return;
+    }
+    const Eigen::Index first = this->nRemoved + index;
+    const Eigen::Index tail = this->nIds - first - count;
+    this->points.middleCols(first, tail) = this->points.middleCols(first + count, tail).eval();
+    this->nIds -= count;
+    this->rebuild();
+}
+
+void math::KDTree::clear()
+{
+    this->nIds = 0;
+    this->nRemoved = 0;
+    this->nodes.assign(1, Node());
+    this->freeNodes.clear();
+}
+
+void math::KDTree::rebuild()
+{
+    // discard the removed points, such that the ids start at 0 again
+    const Eigen::Index n = this->size();
+    this->points.leftCols(n) = this->points.middleCols(this->nRemoved, n).eval();
+    this->nIds = n;
+    this->nRemoved = 0;
+
+    std::vector<Eigen::Index> ids(n);
+    std::iota(ids.begin(), ids.end(), 0);
+    this->nodes.clear();
+    this->freeNodes.clear();
+    this->nodes.emplace_back();
+    const unsigned int root = this->build(ids, 0, n);
+    this->nodes[0] = std::move(this->nodes[root]);
+    this->freeNodes.push_back(root);
+}
+
+void math::KDTree::radiusSearch(std::vector<Eigen::Index>& indices, std::vector<double>& distances,
+                                const Eigen::Ref<const Eigen::VectorXd>& x, const double radius) const
+{
+    indices.clear();
+    distances.clear();
+    const double radius2 = radius*radius;
+    std::vector<unsigned int> stack = {0};
+    while(!stack.empty()){
+        const Node& node = this->nodes[stack.back()];
+        stack.pop_back();
+        if(node.splitDim < 0){
+            for(const Eigen::Index id : node.ids){
+                if(id < this->nRemoved){
+                    continue;
+                }
+                const double d2 = (this->points.col(id) - x).squaredNorm();
+                if(d2 < radius2){
+                    indices.push_back(id - this->nRemoved);
+                    distances.push_back(std::sqrt(d2));
+                }
+            }
+            continue;
+        }
+        // the points on the far side are at least |diff| away
+        const double diff = x(node.splitDim) - node.splitValue;
+        if(diff < radius){
+            stack.push_back(node.left);
+        }
+        if(diff > -radius){
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void math::KDTree::knnSearch(std::vector<Eigen::Index>& indices, std::vector<double>& distances,
+                             const Eigen::Ref<const Eigen::VectorXd>& x, const unsigned int k,
+                             const Eigen::Index maxIndex) const
+{
+    indices.clear();
+    distances.clear();
+    if(k == 0){
+        return;
+    }
+    const Eigen::Index endId = (maxIndex < 0) ? this->nIds : std::min(this->nIds, this->nRemoved + maxIndex);
+    // max-heap of the k closest points found so far, subtrees are visited near side first
+    std::priority_queue<std::pair<double, Eigen::Index>> best;
+    std::vector<std::pair<unsigned int, double>> stack = {{0, 0.0}}; // node and lower bound of its squared distance
+    while(!stack.empty()){
+        const auto [index, bound] = stack.back();
+        stack.pop_back();
+        if(best.size() == k && bound >= best.top().first){
+            continue;
+        }
+        const Node& node = this->nodes[index];
+        if(node.splitDim < 0){
+            for(const Eigen::Index id : node.ids){
+                if(id < this->nRemoved || id >= endId){
+                    continue;
+                }
+                const double d2 = (this->points.col(id) - x).squaredNorm();
+                if(best.size() < k){
+                    best.emplace(d2, id);
+                }
+                else if(d2 < best.top().first){
+                    best.pop();
+                    best.emplace(d2, id);
+                }
+            }
+            continue;
+        }
+        const double diff = x(node.splitDim) - node.splitValue;
+        const unsigned int nearNode = (diff < 0) ? node.left : node.right;
+        const unsigned int farNode = (diff < 0) ? node.right : node.left;
+        stack.emplace_back(farNode, std::max(bound, diff*diff));
+        stack.emplace_back(nearNode, bound);
+    }
+    indices.resize(best.size());
+    distances.resize(best.size());
+    for(size_t i = best.size(); i > 0; --i){
+        indices[i-1] = best.top().second - this->nRemoved;
+        distances[i-1] = std::sqrt(best.top().first);
+        best.pop();
+    }
+}
+
+Eigen::Index math::KDTree::size() const
+{
+    return this->nIds - this->nRemoved;
+}
+
+unsigned int math::KDTree::getDim() const
+{
+    return this->dim;
+}
+
+unsigned int math::KDTree::getDepth() const
+{
+    return this->depth(0);
+}
+
+unsigned int math::KDTree::build(std::vector<Eigen::Index>& ids, const size_t begin, const size_t end)
+{
+    const unsigned int index = this->allocateNode();
+    this->nodes[index].count = end - begin;
+
+    // split along the coordinate with the largest spread, points that coincide stay in one leaf
+    Eigen::VectorXd lower = Eigen::VectorXd::Constant(this->dim, std::numeric_limits<double>::infinity());
+    Eigen::VectorXd upper = -lower;
+    for(size_t i = begin; i < end; ++i){
+        lower = lower.cwiseMin(this->points.col(ids[i]));
+        upper = upper.cwiseMax(this->points.col(ids[i]));
+    }
+    Eigen::Index splitDim = 0;
+    const double spread = (end > begin) ? (upper - lower).maxCoeff(&splitDim) : 0.0;
+    if(end - begin <= this->leafSize || spread <= 0){
+        this->nodes[index].ids.assign(ids.begin() + begin, ids.begin() + end);
+        this->nodes[index].coincident = (end > begin && spread <= 0);
+        return index;
+    }
+
+    const size_t mid = begin + (end - begin)/2;
+    std::nth_element(ids.begin() + begin, ids.begin() + mid, ids.begin() + end, [this, splitDim](Eigen::Index a, Eigen::Index b){
+        return this->points(splitDim, a) < this->points(splitDim, b);
+    });
+    // the subtrees reorder their ids
+    const double splitValue = this->points(splitDim, ids[mid]);
+    const unsigned int left = this->build(ids, begin, mid);
+    const unsigned int right = this->build(ids, mid, end);
+    Node& node = this->nodes[index];
+    node.splitDim = splitDim;
+    node.splitValue = splitValue;
+    node.left = left;
+    node.right = right;
+    return index;
+}
+
+void math::KDTree::rebuildSubtree(const unsigned int node)
+{
+    std::vector<Eigen::Index> ids;
+    this->collect(node, ids);
+    const unsigned int root = this->build(ids, 0, ids.size());
+    this->nodes[node] = std::move(this->nodes[root]);
+    this->nodes[root] = Node();
+    this->freeNodes.push_back(root);
+}
+
+void math::KDTree::collect(const unsigned int node, std::vector<Eigen::Index>& ids)
+{
+    std::vector<unsigned int> stack = {node};
+    while(!stack.empty()){
+        const unsigned int index = stack.back();
+        stack.pop_back();
+        Node& current = this->nodes[index];
+        if(current.splitDim < 0){
+            ids.insert(ids.end(), current.ids.begin(), current.ids.end());
+        }
+        else {
+            stack.push_back(current.left);
+            stack.push_back(current.right);
+        }
+        current = Node();
+        if(index != node){
+            this->freeNodes.push_back(index);
+        }
+    }
+}
+
+unsigned int math::KDTree::allocateNode()
+{
+    if(!this->freeNodes.empty()){
+        const unsigned int index = this->freeNodes.back();
+        this->freeNodes.pop_back();
+        return index;
+    }
+    this->nodes.emplace_back();
+    return this->nodes.size() - 1;
+}
+
+unsigned int math::KDTree::depth(const unsigned int node) const
+{
+    const Node& current = this->nodes[node];
+    if(current.splitDim < 0){
+        return 1;
+    }
+    return 1 + std::max(this->depth(current.left), this->depth(current.right));
+}
+
+void math::KDTree::insertPoint(const Eigen::Index id)
+{
+    std::vector<unsigned int> path;
+    unsigned int index = 0;
+    while(true){
+        path.push_back(index);
+        Node& node = this->nodes[index];
+        ++node.count;
+        if(node.splitDim < 0){
+            node.coincident = (node.ids.empty() || (node.coincident && this->points.col(id) == this->points.col(node.ids.front())));
+            node.ids.push_back(id);
+            break;
+        }
+        index = (this->points(node.splitDim, id) < node.splitValue) ? node.left : node.right;
+    }
+    // a leaf of coincident points would be rebuilt into the same leaf, e.g. for repeated inputs
+    if(this->nodes[index].ids.size() > 2*this->leafSize && !this->nodes[index].coincident){
+        this->rebuildSubtree(index);
+    }
+
+    // rebuild the lowest unbalanced subtree on the path if the tree got too deep
+    const double leaves = std::max(1.0, double(this->nodes[0].count)/this->leafSize);
+    const size_t maxDepth = std::ceil(std::log(leaves)/std::log(1.0/balance)) + 2;
+    if(path.size() <= maxDepth){
+        return;
+    }
+    for(auto it = path.rbegin() + 1; it != path.rend(); ++it){
+        const unsigned int node = *it;
+        const Node& current = this->nodes[node];
+        const Eigen::Index larger = std::max(this->nodes[current.left].count, this->nodes[current.right].count);
+        if(larger > balance*current.count){
+            this->rebuildSubtree(node);
+            return;
+        }
+    }
+}
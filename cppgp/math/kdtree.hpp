@@ -0,0 +1,145 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Eigen>
+
+namespace math {
+
+    /**
+     * k-d tree for radius and k-nearest-neighbor queries on a set of points.
+     *
+     * The points are copied into the tree and identified by their index, i.e. the order in which they have been inserted.
+     * The tree is built balanced by median splits along the coordinate with the largest spread, the leaves hold up
+     * to leafSize points. Inserted points are added to their leaf, which is split when it overflows. If an insertion makes
+     * the tree too deep, the largest unbalanced subtree on its path is rebuilt (scapegoat rebalancing), such that
+     * the depth stays logarithmic also for sorted insertions and an insertion costs amortized O(log^2 n).
+     *
+     * Removing the oldest points (see #remove with index 0) takes O(1), the points are dropped from the queries
+     * and discarded when the tree is rebuilt. Removing other points rebuilds the tree.
+     */
+    class KDTree {
+    public:
+        /**
+         * Create an empty tree.
+         *
+         * @param dim The dimension of the points.
+         * @param leafSize The maximum number of points of a leaf.
+         */
+        KDTree(const unsigned int dim, const unsigned int leafSize=32);
+
+        /**
+         * Create a balanced tree of the given points.
+         *
+         * @param X The points, size [n, dim].
+         * @param leafSize The maximum number of points of a leaf.
+         */
+        KDTree(const Eigen::Ref<const Eigen::MatrixXd>& X, const unsigned int leafSize=32);
+
+        /**
+         * Insert points, their indices follow the indices of the points in the tree.
+         *
+         * @param X The new points, size [k, dim].
+         */
+        void insert(const Eigen::Ref<const Eigen::MatrixXd>& X);
+
+        /**
+         * Remove points, the indices of the subsequent points are reduced by count.
+         *
+         * @param index The index of the first point to remove.
+         * @param count The number of points to remove.
+         */
+        void remove(const Eigen::Index index, const Eigen::Index count=1);
+
+        /**
+         * Remove all points.
+         */
+        void clear();
+
+        /**
+         * Rebuild the tree balanced, e.g. after many insertions.
+         */
+        void rebuild();
+
+        /**
+         * Find all points closer than the radius to the query point, in no particular order.
+         *
+         * @param indices Returns the indices of the points.
+         * @param distances Returns the Euclidean distances of the points to x.
+         * @param x The query point, size [dim].
+         * @param radius The radius.
+         */
+        void radiusSearch(std::vector<Eigen::Index>& indices, std::vector<double>& distances,
+                          const Eigen::Ref<const Eigen::VectorXd>& x, const double radius) const;
+
+        /**
+         * Find the k points that are closest to the query point, sorted by their distance.
+         * Fewer points are returned if the tree holds less than k points.
+         * With maxIndex, only the points with an index below maxIndex are considered, e.g. the points
+         * that precede a point in an ordering of the inputs. The search stays efficient as long as
+         * a large fraction of the points is considered.
+         *
+         * @param indices Returns the indices of the points.
+         * @param distances Returns the Euclidean distances of the points to x.
+         * @param x The query point, size [dim].
+         * @param k The number of points.
+         * @param maxIndex Consider only points with an index below maxIndex, -1 for all points.
+         */
+        void knnSearch(std::vector<Eigen::Index>& indices, std::vector<double>& distances,
+                       const Eigen::Ref<const Eigen::VectorXd>& x, const unsigned int k,
+                       const Eigen::Index maxIndex=-1) const;
+
+        /**
+         * @return The number of points.
+         */
+        Eigen::Index size() const;
+
+        /**
+         * @return The dimension of the points.
+         */
+        unsigned int getDim() const;
+
+        /**
+         * @return The number of levels of the tree, 1 for a single leaf.
+         */
+        unsigned int getDepth() const;
+
+    private:
+        struct Node {
+            int splitDim = -1;                  // -1 for leaves
+            double splitValue = 0.0;            // points with a smaller coordinate are in the left subtree
+            unsigned int left = 0;
+            unsigned int right = 0;
+            Eigen::Index count = 0;             // number of points in the subtree, including removed points
+            std::vector<Eigen::Index> ids;      // points of a leaf
+            bool coincident = false;            // all points of the leaf coincide, it cannot be split
+        };
+
+        /**
+         * Build a balanced subtree of the points ids[begin, end) and return its root.
+         */
+        unsigned int build(std::vector<Eigen::Index>& ids, const size_t begin, const size_t end);
+
+        /**
+         * Replace the subtree at the node by a balanced subtree of the same points.
+         */
+        void rebuildSubtree(const unsigned int node);
+
+        /**
+         * Collect the points of a subtree and release its nodes, except for the root.
+         */
+        void collect(const unsigned int node, std::vector<Eigen::Index>& ids);
+
+        unsigned int allocateNode();
+        unsigned int depth(const unsigned int node) const;
+        void insertPoint(const Eigen::Index id);
+
+        unsigned int dim;
+        unsigned int leafSize;
+        Eigen::MatrixXd points;         // column i holds the point with id i
+        Eigen::Index nIds;              // number of ids that have been assigned
+        Eigen::Index nRemoved;          // the points with ids below are removed, the index of a point is id - nRemoved
+        std::vector<Node> nodes;        // nodes[0] is the root
+        std::vector<unsigned int> freeNodes;
+    };
+}
@@ -0,0 +1,136 @@
+#include <cppgp/math/kdtree.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+    std::vector<Eigen::Index> bruteForceRadius(const Eigen::MatrixXd& X, const Eigen::VectorXd& x, const double radius)
+    {
+        std::vector<Eigen::Index> indices;
+        for(Eigen::Index i = 0; i < X.rows(); ++i){
+            if((X.row(i).transpose() - x).norm() < radius){
+                indices.push_back(i);
+            }
+        }
+        return indices;
+    }
+
+    std::vector<double> bruteForceKnn(const Eigen::MatrixXd& X, const Eigen::VectorXd& x, const unsigned int k)
+    {
+        std::vector<double> distances;
+        for(Eigen::Index i = 0; i < X.rows(); ++i){
+            distances.push_back((X.row(i).transpose() - x).norm());
+        }
+        std::sort(distances.begin(), distances.end());
+        distances.resize(std::min<size_t>(k, distances.size()));
+        return distances;
+    }
+
+    void expectQueries(const math::KDTree& tree, const Eigen::MatrixXd& X)
+    {
+        ASSERT_EQ(tree.size(), X.rows());
+        for(int q = 0; q < 20; ++q){
+            const Eigen::VectorXd x = Eigen::VectorXd::Random(X.cols());
+            std::vector<Eigen::Index> indices;
+            std::vector<double> distances;
+            tree.radiusSearch(indices, distances, x, 0.3);
+            std::vector<Eigen::Index> sorted = indices;
+            std::sort(sorted.begin(), sorted.end());
+            EXPECT_EQ(sorted, bruteForceRadius(X, x, 0.3));
+            for(size_t i = 0; i < indices.size(); ++i){
+                EXPECT_NEAR(distances[i], (X.row(indices[i]).transpose() - x).norm(), 1e-14);
+            }
+
+            tree.knnSearch(indices, distances, x, 7);
+            const std::vector<double> expected = bruteForceKnn(X, x, 7);
+            ASSERT_EQ(distances.size(), expected.size());
+            for(size_t i = 0; i < expected.size(); ++i){
+                EXPECT_NEAR(distances[i], expected[i], 1e-14);
+                EXPECT_NEAR(distances[i], (X.row(indices[i]).transpose() - x).norm(), 1e-14);
+            }
+
+            // only the points that precede maxIndex
+            const Eigen::Index maxIndex = X.rows()/3 + q;
+            tree.knnSearch(indices, distances, x, 7, maxIndex);
+            const std::vector<double> expectedPreceding = bruteForceKnn(X.topRows(std::min(maxIndex, X.rows())), x, 7);
+            ASSERT_EQ(distances.size(), expectedPreceding.size());
+            for(size_t i = 0; i < expectedPreceding.size(); ++i){
+                EXPECT_LT(indices[i], maxIndex);
+                EXPECT_NEAR(distances[i], expectedPreceding[i], 1e-14);
+            }
+        }
+    }
+}
+
+TEST(math_kdtree, queries){
+    const Eigen::MatrixXd X = Eigen::MatrixXd::Random(2000, 3);
+    const math::KDTree tree(X, 8);
+    expectQueries(tree, X);
+
+    math::KDTree empty(3);
+    std::vector<Eigen::Index> indices;
+    std::vector<double> distances;
+    empty.knnSearch(indices, distances, Eigen::VectorXd::Zero(3), 5);
+    EXPECT_TRUE(indices.empty());
+}
+
+TEST(math_kdtree, insert_remove){
+    // sorted insertions one by one stay balanced
+    Eigen::MatrixXd X = Eigen::MatrixXd::Random(3000, 2);
+    X.col(0) = Eigen::VectorXd::LinSpaced(3000, -1.0, 1.0);
+    math::KDTree tree(2, 8);
+    for(Eigen::Index i = 0; i < X.rows(); ++i){
+        tree.insert(X.row(i));
+    }
+    expectQueries(tree, X);
+    EXPECT_LE(tree.getDepth(), 40u);
+
+    // duplicates do not split
+    tree.insert(Eigen::MatrixXd::Zero(100, 2));
+    X.conservativeResize(3100, Eigen::NoChange);
+    X.bottomRows(100).setZero();
+    expectQueries(tree, X);
+
+    // window of the newest points and removal in the middle
+    tree.remove(0, 1000);
+    Eigen::MatrixXd Xwindow = X.bottomRows(2100);
+    expectQueries(tree, Xwindow);
+    tree.remove(0, 1200);
+    Xwindow = X.bottomRows(900);
+    expectQueries(tree, Xwindow);
+    tree.remove(100, 50);
+    Eigen::MatrixXd Xremoved(850, 2);
+    Xremoved << Xwindow.topRows(100), Xwindow.bottomRows(750);
+    expectQueries(tree, Xremoved);
+    tree.insert(X.topRows(10));
+    Eigen::MatrixXd Xinserted(860, 2);
+    Xinserted << Xremoved, X.topRows(10);
+    expectQueries(tree, Xinserted);
+}
+
+TEST(math_kdtree, insert_duplicates){
+    // repeated inputs one by one stay in a single leaf, which is split once other points arrive
+    const Eigen::RowVector2d x(0.25, -0.5);
+    math::KDTree tree(2, 8);
+    Eigen::MatrixXd X(2000, 2);
+    for(Eigen::Index i = 0; i < 1000; ++i){
+        tree.insert(x);
+        X.row(i) = x;
+    }
+    EXPECT_EQ(tree.getDepth(), 1u);
+    std::vector<Eigen::Index> indices;
+    std::vector<double> distances;
+    tree.knnSearch(indices, distances, x.transpose(), 5);
+    ASSERT_EQ(indices.size(), 5u);
+    EXPECT_EQ(distances.back(), 0.0);
+
+    X.bottomRows(1000) = Eigen::MatrixXd::Random(1000, 2);
+    for(Eigen::Index i = 1000; i < X.rows(); ++i){
+        tree.insert(X.row(i));
+    }
+    EXPECT_GT(tree.getDepth(), 1u);
+    expectQueries(tree, X);
+}
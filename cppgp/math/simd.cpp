@@ -0,0 +1,304 @@
+#include <cppgp/math/simd.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CPPGP_SIMD_X86
+// the masked AVX-512 intrinsics of some GCC versions trigger false positives
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+    using math::simd::InstructionSet;
+
+    /*
+     * exp(x) = 2^k exp(r) with k = round(x/ln2) and |r| <= ln2/2. exp(r) is evaluated by its Taylor polynomial
+     * of degree 13, whose truncation error is below 1e-18. 2^k is applied as the product of two powers of two,
+     * such that results in the denormal range and overflows to infinity are rounded correctly.
+     */
+    const double expLower = -746.0;        // exp(expLower) underflows to zero
+    const double expUpper = 710.0;         // exp(expUpper) overflows to infinity
+    const double log2e = 1.4426950408889634;
+    const double ln2Hi = 6.93147180369123816490e-01;
+    const double ln2Lo = 1.90821492927058770002e-10;
+    const double roundMagic = 6755399441055744.0; // 1.5*2^52, adding it rounds to an integer in the low mantissa bits
+    const int64_t exponentOffset = 1100;   // makes k nonnegative for the logical shift
+    const double expCoefficients[14] = {
+        1.0, 1.0, 1.0/2.0, 1.0/6.0, 1.0/24.0, 1.0/120.0, 1.0/720.0, 1.0/5040.0, 1.0/40320.0, 1.0/362880.0,
+        1.0/3628800.0, 1.0/39916800.0, 1.0/479001600.0, 1.0/6227020800.0
+    };
+
+    InstructionSet detectInstructionSet()
+    {
+#ifdef CPPGP_SIMD_X86
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f")){
+            return InstructionSet::AVX512;
+        }
+        if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+            return InstructionSet::AVX2;
+        }
+#endif
+        return InstructionSet::SCALAR;
+    }
+
+    const InstructionSet supported = detectInstructionSet();
+    std::atomic<InstructionSet> selected(supported);
+
+    /*
+    ********* scalar fallback *********
+    */
+
+    void expScalar(double* x, const std::size_t n)
+    {
+        for(std::size_t i = 0; i < n; ++i){
+            x[i] = std::exp(x[i]);
+        }
+    }
+
+    void sqDistScalar(double* d, const double* sq1, const double sq2, const std::size_t n)
+    {
+        for(std::size_t i = 0; i < n; ++i){
+            d[i] = std::max(sq1[i] + sq2 - 2.0*d[i], 0.0);
+        }
+    }
+
+    void sqExpScalar(double* k, const double* sq1, const double sq2, const std::size_t n, const double scale, const double variance)
+    {
+        for(std::size_t i = 0; i < n; ++i){
+            k[i] = variance*std::exp(scale*std::max(sq1[i] + sq2 - 2.0*k[i], 0.0));
+        }
+    }
+
+#ifdef CPPGP_SIMD_X86
+
+    /*
+    ********* AVX2 *********
+    */
+
+    __attribute__((target("avx2,fma")))
+    inline __m256d exp256(__m256d x)
+    {
+        // the constant is the first operand, such that NaN is propagated
+        x = _mm256_min_pd(_mm256_set1_pd(expUpper), x);
+        x = _mm256_max_pd(_mm256_set1_pd(expLower), x);
+        const __m256d magic = _mm256_set1_pd(roundMagic);
+        const __m256d t = _mm256_fmadd_pd(x, _mm256_set1_pd(log2e), magic);
+        const __m256d kd = _mm256_sub_pd(t, magic);
+        __m256d r = _mm256_fnmadd_pd(kd, _mm256_set1_pd(ln2Hi), x);
+        r = _mm256_fnmadd_pd(kd, _mm256_set1_pd(ln2Lo), r);
+        __m256d p = _mm256_set1_pd(expCoefficients[13]);
+        for(int c = 12; c >= 0; --c){
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(expCoefficients[c]));
+        }
+        // 2^k = 2^a 2^b with a = floor((k+offset)/2) - offset/2 and b = k - a
+        const __m256i k = _mm256_sub_epi64(_mm256_castpd_si256(t), _mm256_castpd_si256(magic));
+        const __m256i a = _mm256_sub_epi64(_mm256_srli_epi64(_mm256_add_epi64(k, _mm256_set1_epi64x(exponentOffset)), 1), _mm256_set1_epi64x(exponentOffset/2));
+        const __m256i b = _mm256_sub_epi64(k, a);
+        const __m256i bias = _mm256_set1_epi64x(1023);
+        const __m256d scaleA = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(a, bias), 52));
+        const __m256d scaleB = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(b, bias), 52));
+        return _mm256_mul_pd(_mm256_mul_pd(p, scaleA), scaleB);
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline __m256i tailMask256(const std::size_t remaining)
+    {
+        return _mm256_cmpgt_epi64(_mm256_set1_epi64x(remaining), _mm256_setr_epi64x(0, 1, 2, 3));
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline __m256d sqDist256(const __m256d innerProducts, const __m256d sq1, const __m256d sq2)
+    {
+        const __m256d d = _mm256_fnmadd_pd(_mm256_set1_pd(2.0), innerProducts, _mm256_add_pd(sq1, sq2));
+        return _mm256_max_pd(_mm256_setzero_pd(), d);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void expAVX2(double* x, const std::size_t n)
+    {
+        std::size_t i = 0;
+        for(; i + 4 <= n; i += 4){
+            _mm256_storeu_pd(x + i, exp256(_mm256_loadu_pd(x + i)));
+        }
+        if(i < n){
+            const __m256i mask = tailMask256(n - i);
+            _mm256_maskstore_pd(x + i, mask, exp256(_mm256_maskload_pd(x + i, mask)));
+        }
+    }
+
+    __attribute__((target("avx2,fma")))
+    void sqDistAVX2(double* d, const double* sq1, const double sq2, const std::size_t n)
+    {
+        const __m256d sq2v = _mm256_set1_pd(sq2);
+        std::size_t i = 0;
+        for(; i + 4 <= n; i += 4){
+            _mm256_storeu_pd(d + i, sqDist256(_mm256_loadu_pd(d + i), _mm256_loadu_pd(sq1 + i), sq2v));
+        }
+        if(i < n){
+            const __m256i mask = tailMask256(n - i);
+            _mm256_maskstore_pd(d + i, mask, sqDist256(_mm256_maskload_pd(d + i, mask), _mm256_maskload_pd(sq1 + i, mask), sq2v));
+        }
+    }
+
+    __attribute__((target("avx2,fma")))
+    void sqExpAVX2(double* k, const double* sq1, const double sq2, const std::size_t n, const double scale, const double variance)
+    {
+        const __m256d sq2v = _mm256_set1_pd(sq2);
+        const __m256d scalev = _mm256_set1_pd(scale);
+        const __m256d variancev = _mm256_set1_pd(variance);
+        std::size_t i = 0;
+        for(; i + 4 <= n; i += 4){
+            const __m256d d = sqDist256(_mm256_loadu_pd(k + i), _mm256_loadu_pd(sq1 + i), sq2v);
+            _mm256_storeu_pd(k + i, _mm256_mul_pd(variancev, exp256(_mm256_mul_pd(scalev, d))));
+        }
+        if(i < n){
+            const __m256i mask = tailMask256(n - i);
+            const __m256d d = sqDist256(_mm256_maskload_pd(k + i, mask), _mm256_maskload_pd(sq1 + i, mask), sq2v);
+            _mm256_maskstore_pd(k + i, mask, _mm256_mul_pd(variancev, exp256(_mm256_mul_pd(scalev, d))));
+        }
+    }
+
+    /*
+    ********* AVX-512 *********
+    */
+
+    __attribute__((target("avx512f")))
+    inline __m512d exp512(__m512d x)
+    {
+        x = _mm512_min_pd(_mm512_set1_pd(expUpper), x);
+        x = _mm512_max_pd(_mm512_set1_pd(expLower), x);
+        const __m512d magic = _mm512_set1_pd(roundMagic);
+        const __m512d t = _mm512_fmadd_pd(x, _mm512_set1_pd(log2e), magic);
+        const __m512d kd = _mm512_sub_pd(t, magic);
+        __m512d r = _mm512_fnmadd_pd(kd, _mm512_set1_pd(ln2Hi), x);
+        r = _mm512_fnmadd_pd(kd, _mm512_set1_pd(ln2Lo), r);
+        __m512d p = _mm512_set1_pd(expCoefficients[13]);
+        for(int c = 12; c >= 0; --c){
+            p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(expCoefficients[c]));
+        }
+        const __m512i k = _mm512_sub_epi64(_mm512_castpd_si512(t), _mm512_castpd_si512(magic));
+        const __m512i a = _mm512_sub_epi64(_mm512_srli_epi64(_mm512_add_epi64(k, _mm512_set1_epi64(exponentOffset)), 1), _mm512_set1_epi64(exponentOffset/2));
+        const __m512i b = _mm512_sub_epi64(k, a);
+        const __m512i bias = _mm512_set1_epi64(1023);
+        const __m512d scaleA = _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_add_epi64(a, bias), 52));
+        const __m512d scaleB = _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_add_epi64(b, bias), 52));
+        return _mm512_mul_pd(_mm512_mul_pd(p, scaleA), scaleB);
+    }
+
+    __attribute__((target("avx512f")))
+    inline __m512d sqDist512(const __m512d innerProducts, const __m512d sq1, const __m512d sq2)
+    {
+        const __m512d d = _mm512_fnmadd_pd(_mm512_set1_pd(2.0), innerProducts, _mm512_add_pd(sq1, sq2));
+        return _mm512_max_pd(_mm512_setzero_pd(), d);
+    }
+
+    __attribute__((target("avx512f")))
+    void expAVX512(double* x, const std::size_t n)
+    {
+        for(std::size_t i = 0; i < n; i += 8){
+            const __mmask8 mask = (n - i >= 8) ? 0xFF : static_cast<__mmask8>((1u << (n - i)) - 1);
+            _mm512_mask_storeu_pd(x + i, mask, exp512(_mm512_maskz_loadu_pd(mask, x + i)));
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    void sqDistAVX512(double* d, const double* sq1, const double sq2, const std::size_t n)
+    {
+        const __m512d sq2v = _mm512_set1_pd(sq2);
+        for(std::size_t i = 0; i < n; i += 8){
+            const __mmask8 mask = (n - i >= 8) ? 0xFF : static_cast<__mmask8>((1u << (n - i)) - 1);
+            _mm512_mask_storeu_pd(d + i, mask, sqDist512(_mm512_maskz_loadu_pd(mask, d + i), _mm512_maskz_loadu_pd(mask, sq1 + i), sq2v));
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    void sqExpAVX512(double* k, const double* sq1, const double sq2, const std::size_t n, const double scale, const double variance)
+    {
+        const __m512d sq2v = _mm512_set1_pd(sq2);
+        const __m512d scalev = _mm512_set1_pd(scale);
+        const __m512d variancev = _mm512_set1_pd(variance);
+        for(std::size_t i = 0; i < n; i += 8){
+            const __mmask8 mask = (n - i >= 8) ? 0xFF : static_cast<__mmask8>((1u << (n - i)) - 1);
+            const __m512d d = sqDist512(_mm512_maskz_loadu_pd(mask, k + i), _mm512_maskz_loadu_pd(mask, sq1 + i), sq2v);
+            _mm512_mask_storeu_pd(k + i, mask, _mm512_mul_pd(variancev, exp512(_mm512_mul_pd(scalev, d))));
+        }
+    }
+
+#endif // CPPGP_SIMD_X86
+
+} // namespace
+
+math::simd::InstructionSet math::simd::supportedInstructionSet()
+{
+    return supported;
+}
+
+math::simd::InstructionSet math::simd::getInstructionSet()
+{
+    return selected;
+}
+
+void math::simd::setInstructionSet(const InstructionSet instructionSet)
+{
+    if(static_cast<int>(instructionSet) > static_cast<int>(supported)){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("The instruction set is not supported by this CPU");
+    }
+    selected = instructionSet;
+}
+
+void math::simd::exp(double* x, const std::size_t n)
+{
+    switch(selected.load(std::memory_order_relaxed)){
+#ifdef CPPGP_SIMD_X86
+    case InstructionSet::AVX512:
+        expAVX512(x, n);
+        return;
+    case InstructionSet::AVX2:
+        expAVX2(x, n);
+        return;
+#endif
+    default:
+        expScalar(x, n);
+    }
+}
+
+void math::simd::sqDistFromInnerProducts(double* d, const double* sq1, const double sq2, const std::size_t n)
+{
+    switch(selected.load(std::memory_order_relaxed)){
+#ifdef CPPGP_SIMD_X86
+    case InstructionSet::AVX512:
+        sqDistAVX512(d, sq1, sq2, n);
+        return;
+    case InstructionSet::AVX2:
+        sqDistAVX2(d, sq1, sq2, n);
+        return;
+#endif
+    default:
+        sqDistScalar(d, sq1, sq2, n);
+    }
+}
+
+void math::simd::sqExpFromInnerProducts(double* k, const double* sq1, const double sq2, const std::size_t n, const double scale, const double variance)
+{
+    switch(selected.load(std::memory_order_relaxed)){
+#ifdef CPPGP_SIMD_X86
+    case InstructionSet::AVX512:
+        sqExpAVX512(k, sq1, sq2, n, scale, variance);
+        return;
+    case InstructionSet::AVX2:
+        sqExpAVX2(k, sq1, sq2, n, scale, variance);
+        return;
+#endif
+    default:
+        sqExpScalar(k, sq1, sq2, n, scale, variance);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+
+namespace math::simd {
+
+    /**
+     * Instruction sets of the vectorized kernels.
+     * - SCALAR: Portable fallback using std::exp.
+     * - AVX2: 4 doubles per instruction, requires AVX2 and FMA.
+     * - AVX512: 8 doubles per instruction, requires AVX-512F.
+     */
+    enum class InstructionSet {SCALAR, AVX2, AVX512};
+
+    /**
+     * @brief Returns the best instruction set that is supported by the CPU.
+     *
+     * The CPU features are detected at runtime, so the library does not need to be compiled with ISA specific flags.
+     */
+    InstructionSet supportedInstructionSet();
+
+    /**
+     * @brief Returns the instruction set that is used by the kernels, by default #supportedInstructionSet().
+     */
+    InstructionSet getInstructionSet();
+
+    /**
+     * @brief Selects the instruction set that is used by the kernels, e.g. to compare against the scalar fallback.
+     *
+     * Must not be called while kernels are running in other threads.
+     *
+     * @param instructionSet The instruction set, it must be supported by the CPU.
+     */
+    void setInstructionSet(const InstructionSet instructionSet);
+
+    /**
+     * @brief Computes the exponential in place, x[i] = exp(x[i]).
+     *
+     * The vectorized versions are accurate to a few ulp, results that underflow are rounded to denormals or zero.
+     *
+     * @param x The values, length n.
+     * @param n The number of values.
+     */
+    void exp(double* x, const std::size_t n);
+
+    /**
+     * @brief Converts inner products into squared distances in place, d[i] = max(sq1[i] + sq2 - 2 d[i], 0).
+     *
+     * Used for a column of a distance matrix that holds the inner products x1_i^T x2 on input.
+     *
+     * @param d The inner products on input, the squared distances on output, length n.
+     * @param sq1 The squared norms of the first points, length n.
+     * @param sq2 The squared norm of the second point.
+     * @param n The number of values.
+     */
+    void sqDistFromInnerProducts(double* d, const double* sq1, const double sq2, const std::size_t n);
+
+    /**
+     * @brief Converts inner products into squared exponential covariances in place,
+     * k[i] = variance*exp(scale*max(sq1[i] + sq2 - 2 k[i], 0)).
+     *
+     * Fuses #sqDistFromInnerProducts and #exp in one pass over the data.
+     *
+     * @param k The inner products on input, the covariances on output, length n.
+     * @param sq1 The squared norms of the first points, length n.
+     * @param sq2 The squared norm of the second point.
+     * @param n The number of values.
+     * @param scale The factor of the squared distance in the exponent, e.g. -w/2 for the inverse width w.
+     * @param variance The factor of the exponential.
+     */
+    void sqExpFromInnerProducts(double* k, const double* sq1, const double sq2, const std::size_t n, const double scale, const double variance);
+}
@@ -0,0 +1,81 @@
+#include <cppgp/math/simd.hpp>
+#include <cppgp/math/distance.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+    std::vector<math::simd::InstructionSet> availableInstructionSets()
+    {
+        std::vector<math::simd::InstructionSet> sets = {math::simd::InstructionSet::SCALAR};
+        if(math::simd::supportedInstructionSet() != math::simd::InstructionSet::SCALAR){
+            sets.push_back(math::simd::InstructionSet::AVX2);
+        }
+        if(math::simd::supportedInstructionSet() == math::simd::InstructionSet::AVX512){
+            sets.push_back(math::simd::InstructionSet::AVX512);
+        }
+        return sets;
+    }
+}
+
+TEST(math_simd, exp){
+    // odd length to cover the masked tails
+    std::vector<double> x;
+    for(double v = -760.0; v <= 720.0; v += 0.737){
+        x.push_back(v);
+    }
+    x.insert(x.end(), {0.0, -0.0, 1e-300, -1e-10, -745.0, -708.5, 709.7, 709.8, -std::numeric_limits<double>::infinity()});
+    const math::simd::InstructionSet original = math::simd::getInstructionSet();
+    for(math::simd::InstructionSet set : availableInstructionSets()){
+        math::simd::setInstructionSet(set);
+        std::vector<double> y = x;
+        math::simd::exp(y.data(), y.size());
+        for(size_t i = 0; i < x.size(); ++i){
+            const double expected = std::exp(x[i]);
+            if(expected > std::numeric_limits<double>::min() && std::isfinite(expected)){
+                EXPECT_NEAR(y[i]/expected, 1.0, 4e-16) << "x = " << x[i];
+            }
+            else if(std::isinf(expected)){
+                EXPECT_EQ(y[i], expected) << "x = " << x[i];
+            }
+            else {
+                EXPECT_NEAR(y[i], expected, 1e-320) << "x = " << x[i];
+            }
+        }
+        double nan = std::numeric_limits<double>::quiet_NaN();
+        math::simd::exp(&nan, 1);
+        EXPECT_TRUE(std::isnan(nan));
+    }
+    math::simd::setInstructionSet(original);
+}
+
+TEST(math_simd, squared_exponential){
+    const Eigen::MatrixXd X1 = Eigen::MatrixXd::Random(37, 4);
+    const Eigen::MatrixXd X2 = Eigen::MatrixXd::Random(11, 4);
+    const Eigen::VectorXd sq1 = X1.rowwise().squaredNorm();
+    Eigen::MatrixXd expected(37, 11);
+    for(int i = 0; i < 37; ++i){
+        for(int j = 0; j < 11; ++j){
+            expected(i, j) = (X1.row(i) - X2.row(j)).squaredNorm();
+        }
+    }
+    const math::simd::InstructionSet original = math::simd::getInstructionSet();
+    for(math::simd::InstructionSet set : availableInstructionSets()){
+        math::simd::setInstructionSet(set);
+        Eigen::MatrixXd D;
+        math::dist2(D, X1, X2);
+        EXPECT_TRUE(D.isApprox(expected, 1e-13));
+        EXPECT_GE(D.minCoeff(), 0.0);
+
+        Eigen::MatrixXd K = X1*X2.transpose();
+        for(int j = 0; j < 11; ++j){
+            math::simd::sqExpFromInnerProducts(K.col(j).data(), sq1.data(), X2.row(j).squaredNorm(), 37, -0.75, 2.0);
+        }
+        EXPECT_TRUE(K.isApprox(2.0*(-0.75*expected.array()).exp().matrix(), 1e-13));
+    }
+    math::simd::setInstructionSet(original);
+}
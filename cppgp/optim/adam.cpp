@@ -0,0 +1,76 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include <cppgp/optim/adam.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <cmath>
+
+optim::Adam::Adam(const AdamOptions& options) :
+    options(options),
+    m(0),
+    v(0),
+    t(0)
+{}
+
+void optim::Adam::step(Eigen::VectorXd& x, const Eigen::VectorXd& gradient)
+{
+    if(gradient.size() != x.size()){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Size of the gradient does not match the number of variables");
+    }
+    if(this->m.size() != x.size()){
+        this->m = Eigen::VectorXd::Zero(x.size());
+        this->v = Eigen::VectorXd::Zero(x.size());
+        this->t = 0;
+    }
+    ++this->t;
+    this->m = this->options.beta1*this->m + (1.0 - this->options.beta1)*gradient;
+    this->v = this->options.beta2*this->v + (1.0 - this->options.beta2)*gradient.cwiseAbs2();
+    const double mCorrection = 1.0 - std::pow(this->options.beta1, this->t);
+    const double vCorrection = 1.0 - std::pow(this->options.beta2, this->t);
+    x.array() -= this->options.learningRate*(this->m.array()/mCorrection)
+                 /((this->v.array()/vCorrection).sqrt() + this->options.epsilon);
+}
+
+void optim::Adam::reset()
+{
+    this->m.resize(0);
+    this->v.resize(0);
+    this->t = 0;
+}
+
+unsigned int optim::Adam::getIterations() const
+{
+    return this->t;
+}
+
+void optim::Adam::setOptions(const AdamOptions& options)
+{
+    this->options = options;
+}
+
+const optim::AdamOptions& optim::Adam::getOptions() const
+{
+    return this->options;
+}
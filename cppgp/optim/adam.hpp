@@ -0,0 +1,96 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <Eigen/Eigen>
+
+namespace optim {
+
+/**
+ * Options of the Adam optimizer.
+ */
+struct AdamOptions {
+    double learningRate = 0.01;          // step size
+    double beta1 = 0.9;                  // decay rate of the first moment estimate
+    double beta2 = 0.999;                // decay rate of the second moment estimate
+    double epsilon = 1e-8;               // added to the root of the second moment estimate
+};
+
+
+/**
+ * Adam optimizer for stochastic gradients (Kingma and Ba, 2015).
+ *
+ * In contrast to LBFGS, the optimizer does not evaluate the objective itself but performs single steps
+ * with gradients that are provided by the caller, e.g. minibatch estimates. The moment estimates are kept
+ * between the steps.
+ */
+class Adam {
+public:
+    /**
+     * Create a new optimizer.
+     *
+     * @param options The options of the optimizer.
+     */
+    Adam(const AdamOptions& options=AdamOptions());
+
+    /**
+     * Perform a descent step, x <- x - learningRate * m/(sqrt(v) + epsilon) with the bias corrected moment estimates m and v.
+     * The moments are reset if the size of x changes.
+     *
+     * @param x The variables. Returns the variables after the step.
+     * @param gradient The (stochastic) gradient of the objective at x, size [x.size()].
+     */
+    void step(Eigen::VectorXd& x, const Eigen::VectorXd& gradient);
+
+    /**
+     * Reset the moment estimates and the step counter.
+     */
+    void reset();
+
+    /**
+     * @return The number of steps since the last reset.
+     */
+    unsigned int getIterations() const;
+
+    /**
+     * Set the options of the optimizer.
+     *
+     * @param options The new options.
+     */
+    void setOptions(const AdamOptions& options);
+
+    /**
+     * @return The options of the optimizer.
+     */
+    const AdamOptions& getOptions() const;
+
+private:
+    AdamOptions options;
+    Eigen::VectorXd m;      // first moment estimate
+    Eigen::VectorXd v;      // second moment estimate
+    unsigned int t;         // number of steps
+};
+
+} // namespace optim
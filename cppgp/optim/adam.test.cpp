@@ -0,0 +1,37 @@
+#include <cppgp/optim/adam.hpp>
+#include <cppgp/util/exceptions.hpp>
+#include <gtest/gtest.h>
+
+#include <random>
+
+TEST(optim_adam, noisy_quadratic){
+    // minimize 1/2 (x-c)^T D (x-c) from gradients with additive noise
+    const Eigen::Vector3d c(1.0, -2.0, 0.5);
+    const Eigen::Vector3d d(1.0, 10.0, 100.0);
+    std::mt19937 rng(3);
+    std::normal_distribution<double> noise(0.0, 0.1);
+
+    optim::AdamOptions options;
+    options.learningRate = 0.05;
+    optim::Adam adam(options);
+    Eigen::VectorXd x = Eigen::VectorXd::Zero(3);
+    for(int i = 0; i < 3000; ++i){
+        Eigen::VectorXd gradient = d.cwiseProduct(x - c);
+        for(int j = 0; j < 3; ++j){
+            gradient(j) += noise(rng);
+        }
+        adam.step(x, gradient);
+    }
+    EXPECT_EQ(adam.getIterations(), 3000u);
+    EXPECT_LT((x - c).cwiseAbs().maxCoeff(), 0.05);
+
+    // the first step moves every variable by the learning rate
+    adam.reset();
+    EXPECT_EQ(adam.getIterations(), 0u);
+    Eigen::VectorXd y = Eigen::VectorXd::Zero(2);
+    adam.step(y, Eigen::Vector2d(3.0, -0.01));
+    EXPECT_NEAR(y(0), -0.05, 1e-8);
+    EXPECT_NEAR(y(1), 0.05, 1e-6);
+
+    EXPECT_THROW(adam.step(y, Eigen::Vector3d::Zero()), util::exceptions::InconsistentInputError);
+}
@@ -0,0 +1,189 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+
+#include <cppgp/optim/lbfgs.hpp>
+#include <cppgp/util/exceptions.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+    /**
+     * Maximum norm of the projected gradient x - P(x - g).
+     */
+    double projectedGradientNorm(const Eigen::VectorXd& x, const Eigen::VectorXd& g, const Eigen::VectorXd& lower, const Eigen::VectorXd& upper)
+    {
+        return (x - (x - g).cwiseMax(lower).cwiseMin(upper)).lpNorm<Eigen::Infinity>();
+    }
+
+}
+
+
+optim::LBFGS::LBFGS(const LBFGSOptions& options) :
+    options(options)
+{}
+
+
+optim::OptimizationStats optim::LBFGS::minimize(const Objective& f, Eigen::VectorXd& x) const
+{
+    return this->minimize(f, x, Eigen::VectorXd(0), Eigen::VectorXd(0));
+}
+
+
+optim::OptimizationStats optim::LBFGS::minimize(const Objective& f, Eigen::VectorXd& x, const Eigen::VectorXd& lowerBounds, const Eigen::VectorXd& upperBounds) const
+{
+    const auto start = std::chrono::steady_clock::now();
+    const Eigen::Index n = x.size();
+    const double inf = std::numeric_limits<double>::infinity();
+    if((lowerBounds.size() != 0 && lowerBounds.size() != n) || (upperBounds.size() != 0 && upperBounds.size() != n)){
+        util::exceptions::throwException<util::exceptions::InconsistentInputError>("Size of the bounds does not match the size of the initial point");
+    }
+    const Eigen::VectorXd lower = (lowerBounds.size() == n) ? lowerBounds : Eigen::VectorXd::Constant(n, -inf);
+    const Eigen::VectorXd upper = (upperBounds.size() == n) ? upperBounds : Eigen::VectorXd::Constant(n, inf);
+
+    OptimizationStats stats;
+    auto finish = [&](const Status status){
+        stats.status = status;
+        stats.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats;
+    };
+
+    // correction pairs in ring buffers, column (first+i) % m is the i-th oldest pair
+    const unsigned int m = std::max(this->options.memory, 1u);
+    Eigen::MatrixXd S(n, m), Y(n, m);
+    Eigen::VectorXd rho(m), a(m);
+    unsigned int first = 0, count = 0;
+
+    Eigen::VectorXd g(n), gNew(n), xNew(n), d(n), s(n), y(n), free(n);
+    x = x.cwiseMax(lower).cwiseMin(upper);
+    double fx = f(x, g);
+    ++stats.evaluations;
+    stats.value = fx;
+    if(!std::isfinite(fx)){
+        return finish(Status::INVALID_START);
+    }
+
+    while(true){
+        stats.gradientNorm = projectedGradientNorm(x, g, lower, upper);
+        if(stats.gradientNorm <= this->options.gradientTolerance){
+            return finish(Status::CONVERGED_GRADIENT);
+        }
+        if(stats.iterations >= this->options.maxIterations){
+            return finish(Status::MAX_ITERATIONS);
+        }
+
+        // variables at a bound with the gradient pointing outwards are held fixed
+        for(Eigen::Index i = 0; i < n; ++i){
+            const bool atLower = x(i) <= lower(i) && g(i) > 0;
+            const bool atUpper = x(i) >= upper(i) && g(i) < 0;
+            free(i) = (atLower || atUpper) ? 0.0 : 1.0;
+        }
+
+        // two-loop recursion on the free variables
+        d = -g.cwiseProduct(free);
+        for(int i = count-1; i >= 0; --i){
+            const unsigned int j = (first+i) % m;
+            a(j) = rho(j)*S.col(j).dot(d);
+            d -= a(j)*Y.col(j).cwiseProduct(free);
+        }
+        if(count > 0){
+            const unsigned int j = (first+count-1) % m;
+            d *= S.col(j).dot(Y.col(j))/Y.col(j).squaredNorm();
+        }
+        for(unsigned int i = 0; i < count; ++i){
+            const unsigned int j = (first+i) % m;
+            const double b = rho(j)*Y.col(j).dot(d);
+            d += (a(j) - b)*S.col(j).cwiseProduct(free);
+        }
+        if(d.dot(g) >= 0){
+            // not a descent direction, restart from steepest descent
+            d = -g.cwiseProduct(free);
+            count = 0;
+        }
+
+        // backtracking line search along the projected path
+        double step = (count == 0) ? std::min(1.0, 1.0/d.lpNorm<Eigen::Infinity>()) : 1.0;
+        double fNew = inf;
+        bool accepted = false;
+        for(unsigned int k = 0; k < this->options.maxLineSearchSteps; ++k, step *= 0.5){
+            if(stats.evaluations >= this->options.maxEvaluations){
+                return finish(Status::MAX_EVALUATIONS);
+            }
+            xNew = (x + step*d).cwiseMax(lower).cwiseMin(upper);
+            fNew = f(xNew, gNew);
+            ++stats.evaluations;
+            if(std::isfinite(fNew) && fNew <= fx + this->options.armijo*g.dot(xNew - x)){
+                accepted = true;
+                break;
+            }
+        }
+        if(!accepted){
+            return finish(Status::LINE_SEARCH_FAILED);
+        }
+        ++stats.iterations;
+
+        // store the correction pair if it satisfies the curvature condition
+        s = xNew - x;
+        y = gNew - g;
+        const double sy = s.dot(y);
+        if(sy > std::numeric_limits<double>::epsilon()*y.squaredNorm()){
+            const unsigned int j = (first+count) % m;
+            S.col(j) = s;
+            Y.col(j) = y;
+            rho(j) = 1.0/sy;
+            if(count < m){
+                ++count;
+            }
+            else {
+                first = (first+1) % m;
+            }
+        }
+
+        const double decrease = fx - fNew;
+        x.swap(xNew);
+        g.swap(gNew);
+        fx = fNew;
+        stats.value = fx;
+        if(decrease <= this->options.valueTolerance*std::max({std::abs(fx), std::abs(fx+decrease), 1.0})){
+            stats.gradientNorm = projectedGradientNorm(x, g, lower, upper);
+            return finish(Status::CONVERGED_VALUE);
+        }
+    }
+}
+
+
+void optim::LBFGS::setOptions(const LBFGSOptions& options)
+{
+    this->options = options;
+}
+
+
+const optim::LBFGSOptions& optim::LBFGS::getOptions() const
+{
+    return this->options;
+}
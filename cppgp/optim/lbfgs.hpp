@@ -0,0 +1,137 @@
+/*
+* This file is part of the cppgp package.
+* Copyright (c) 2025 kaltertee
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the 'Software'), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+
+#pragma once
+
+#include <functional>
+#include <Eigen/Eigen>
+
+namespace optim {
+
+/**
+ * Objective function for the optimizers.
+ * Evaluates the function at x and writes its gradient into grad (same size as x).
+ * Points at which the function cannot be evaluated are reported by returning infinity.
+ */
+typedef std::function<double(const Eigen::VectorXd& x, Eigen::VectorXd& grad)> Objective;
+
+/**
+ * Reason for the termination of an optimizer.
+ */
+enum class Status {
+    CONVERGED_GRADIENT,  // the projected gradient is below the gradient tolerance
+    CONVERGED_VALUE,     // the relative decrease of the function value is below the value tolerance
+    MAX_ITERATIONS,      // the maximum number of iterations has been reached
+    MAX_EVALUATIONS,     // the maximum number of function evaluations has been reached
+    LINE_SEARCH_FAILED,  // no sufficient decrease could be found along the search direction
+    INVALID_START        // the function cannot be evaluated at the initial point
+};
+
+/**
+ * Convergence statistics of an optimization run.
+ */
+struct OptimizationStats {
+    unsigned int iterations = 0;  // number of iterations
+    unsigned int evaluations = 0; // number of function and gradient evaluations
+    double wallTime = 0.0;        // wall time of the optimization in seconds
+    double value = 0.0;           // final function value
+    double gradientNorm = 0.0;    // maximum norm of the final projected gradient
+    Status status = Status::MAX_ITERATIONS;
+
+    /**
+     * @return True if the optimizer terminated due to one of its convergence criteria.
+     */
+    bool converged() const {return status == Status::CONVERGED_GRADIENT || status == Status::CONVERGED_VALUE;}
+};
+
+/**
+ * Options of the LBFGS optimizer.
+ */
+struct LBFGSOptions {
+    unsigned int memory = 10;            // number of correction pairs of the inverse Hessian approximation
+    unsigned int maxIterations = 200;
+    unsigned int maxEvaluations = 1000;
+    unsigned int maxLineSearchSteps = 30;
+    double gradientTolerance = 1e-5;     // tolerance for the maximum norm of the projected gradient
+    double valueTolerance = 1e-10;       // tolerance for the relative decrease of the function value
+    double armijo = 1e-4;                // parameter of the sufficient decrease condition
+};
+
+
+/**
+ * Limited memory BFGS optimizer for bound constrained minimization.
+ *
+ * The search direction is computed by the two-loop recursion on the variables that are not held
+ * at their bounds, and the step is projected onto the feasible box during a backtracking line search
+ * (projected L-BFGS, a simplified variant of L-BFGS-B without the generalized Cauchy point).
+ * The correction pairs are stored in buffers that are allocated once per run.
+ */
+class LBFGS {
+public:
+    /**
+     * Create a new optimizer.
+     *
+     * @param options The options of the optimizer.
+     */
+    LBFGS(const LBFGSOptions& options=LBFGSOptions());
+
+    /**
+     * Minimize the objective function without bounds.
+     *
+     * @param f The objective function.
+     * @param x The initial point. Returns the minimizer.
+     * @return The convergence statistics.
+     */
+    OptimizationStats minimize(const Objective& f, Eigen::VectorXd& x) const;
+
+    /**
+     * Minimize the objective function subject to lower <= x <= upper.
+     * Infinite bounds are allowed, empty bound vectors represent no bounds.
+     *
+     * @param f The objective function.
+     * @param x The initial point, it is projected onto the bounds first. Returns the minimizer.
+     * @param lower The lower bounds, size [x.size()] or 0.
+     * @param upper The upper bounds, size [x.size()] or 0.
+     * @return The convergence statistics.
+     */
+    OptimizationStats minimize(const Objective& f, Eigen::VectorXd& x, const Eigen::VectorXd& lower, const Eigen::VectorXd& upper) const;
+
+    /**
+     * Set the options of the optimizer.
+     *
+     * @param options The new options.
+     */
+    void setOptions(const LBFGSOptions& options);
+
+    /**
+     * @return The options of the optimizer.
+     */
+    const LBFGSOptions& getOptions() const;
+
+private:
+    LBFGSOptions options;
+};
+
+} // namespace optim
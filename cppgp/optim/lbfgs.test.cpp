@@ -0,0 +1,71 @@
+#include <cppgp/optim/lbfgs.hpp>
+#include <cppgp/util/exceptions.hpp>
+#include <gtest/gtest.h>
+
+#include <limits>
+
+double rosenbrock(const Eigen::VectorXd& x, Eigen::VectorXd& grad)
+{
+    grad.resize(2);
+    grad(0) = -400*x(0)*(x(1) - x(0)*x(0)) - 2*(1 - x(0));
+    grad(1) = 200*(x(1) - x(0)*x(0));
+    return 100*std::pow(x(1) - x(0)*x(0), 2) + std::pow(1 - x(0), 2);
+}
+
+TEST(optim_lbfgs, rosenbrock){
+    optim::LBFGSOptions options;
+    options.gradientTolerance = 1e-8;
+    optim::LBFGS lbfgs(options);
+
+    Eigen::VectorXd x(2);
+    x << -1.2, 1.0;
+    optim::OptimizationStats stats = lbfgs.minimize(rosenbrock, x);
+
+    EXPECT_TRUE(stats.converged());
+    EXPECT_NEAR(x(0), 1.0, 1e-5);
+    EXPECT_NEAR(x(1), 1.0, 1e-5);
+    EXPECT_GT(stats.iterations, 0);
+    EXPECT_GE(stats.evaluations, stats.iterations);
+    EXPECT_GE(stats.wallTime, 0.0);
+    EXPECT_LT(stats.value, 1e-10);
+}
+
+TEST(optim_lbfgs, bounds){
+    // quadratic with its unconstrained minimum at (2, -3, 0.5)
+    const Eigen::Vector3d c(2.0, -3.0, 0.5);
+    auto f = [&c](const Eigen::VectorXd& x, Eigen::VectorXd& grad){
+        grad = 2*(x - c);
+        return (x - c).squaredNorm();
+    };
+    Eigen::VectorXd lower(3), upper(3);
+    lower << -1.0, -1.0, -std::numeric_limits<double>::infinity();
+    upper << 1.0, 1.0, std::numeric_limits<double>::infinity();
+
+    Eigen::VectorXd x = Eigen::VectorXd::Constant(3, 5.0); // infeasible start, projected first
+    optim::OptimizationStats stats = optim::LBFGS().minimize(f, x, lower, upper);
+
+    EXPECT_EQ(stats.status, optim::Status::CONVERGED_GRADIENT);
+    EXPECT_EQ(x(0), 1.0);
+    EXPECT_EQ(x(1), -1.0);
+    EXPECT_NEAR(x(2), 0.5, 1e-6);
+    EXPECT_THROW(optim::LBFGS().minimize(f, x, Eigen::VectorXd(2), upper), util::exceptions::InconsistentInputError);
+}
+
+TEST(optim_lbfgs, invalid_points){
+    // the function is undefined for x <= 0, the line search has to step back
+    auto f = [](const Eigen::VectorXd& x, Eigen::VectorXd& grad){
+        grad.resize(1);
+        if(x(0) <= 0){
+            return std::numeric_limits<double>::infinity();
+        }
+        grad(0) = 1.0 - 1.0/x(0);
+        return x(0) - std::log(x(0));
+    };
+    Eigen::VectorXd x = Eigen::VectorXd::Constant(1, 10.0);
+    optim::OptimizationStats stats = optim::LBFGS().minimize(f, x);
+    EXPECT_TRUE(stats.converged());
+    EXPECT_NEAR(x(0), 1.0, 1e-4);
+
+    x(0) = -1.0;
+    EXPECT_EQ(optim::LBFGS().minimize(f, x).status, optim::Status::INVALID_START);
+}
@@ -0,0 +1,83 @@
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+using namespace util;
+
+ThreadPool::ThreadPool(const unsigned int nThreads) :
+    stopping(false)
+{
+    unsigned int n = (nThreads > 0) ? nThreads : std::thread::hardware_concurrency();
+    if(n == 0){
+        n = 1;
+    }
+    this->threads.reserve(n);
+    for(unsigned int i = 0; i < n; ++i){
+        this->threads.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->condition.notify_all();
+    for(std::thread& thread : this->threads){
+        thread.join();
+    }
+}
+
+void ThreadPool::parallelFor(const std::size_t n, const std::function<void(std::size_t)>& task)
+{
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> failed(false);
+    auto worker = [&](){
+        try {
+            for(std::size_t i = next++; i < n && !failed; i = next++){
+                task(i);
+            }
+        }
+        catch(...){
+            failed = true;
+            throw;
+        }
+    };
+    const std::size_t nWorkers = std::min<std::size_t>(this->size(), n);
+    std::vector<std::future<void>> results;
+    results.reserve(nWorkers);
+    for(std::size_t w = 0; w < nWorkers; ++w){
+        results.push_back(this->submit(worker));
+    }
+    // wait for all workers before rethrowing, they reference the local state
+    for(std::future<void>& result : results){
+        result.wait();
+    }
+    for(std::future<void>& result : results){
+        result.get();
+    }
+}
+
+unsigned int ThreadPool::size() const
+{
+    return this->threads.size();
+}
+
+void ThreadPool::work()
+{
+    while(true){
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->condition.wait(lock, [this](){ return this->stopping || !this->tasks.empty(); });
+            if(this->tasks.empty()){
+                return; // stopping and no pending tasks
+            }
+            task = std::move(this->tasks.front());
+            this->tasks.pop();
+        }
+        task();
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace util {
+
+/**
+ * Fixed size pool of worker threads that process submitted tasks in FIFO order.
+ * The destructor finishes all pending tasks before the threads are joined.
+ */
+class ThreadPool {
+public:
+    /**
+     * \brief Start the worker threads.
+     * \param nThreads The number of threads, 0 for the number of hardware threads.
+     */
+    ThreadPool(const unsigned int nThreads=0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * \brief Submit a task to the pool.
+     * Exceptions thrown by the task are rethrown by the get() method of the returned future.
+     * \param task The callable to execute, it takes no arguments.
+     * \return A future for the result of the task.
+     */
+    template<class F>
+    std::future<std::invoke_result_t<F>> submit(F&& task)
+    {
+        typedef std::invoke_result_t<F> R;
+        auto packaged = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+        std::future<R> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->tasks.emplace([packaged](){ (*packaged)(); });
+        }
+        this->condition.notify_one();
+        return result;
+    }
+
+    /**
+     * \brief Call task(i) for all i in [0, n) and wait until all calls are finished.
+     * The indices are claimed one at a time by the workers, so threads that finish early take over
+     * the remaining work instead of idling behind a fixed partition. The first exception thrown
+     * by a task is rethrown after all workers have stopped.
+     * Must not be called from within a task of the same pool.
+     * \param n The number of indices.
+     * \param task The callable to execute for each index.
+     */
+    void parallelFor(const std::size_t n, const std::function<void(std::size_t)>& task);
+
+    /**
+     * \brief Get the number of worker threads.
+     * \return The number of worker threads.
+     */
+    unsigned int size() const;
+
+private:
+    void work();
+
+    std::vector<std::thread> threads;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping;
+};
+
+} // namespace util
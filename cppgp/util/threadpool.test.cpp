@@ -0,0 +1,47 @@
+#include <cppgp/util/threadpool.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+
+TEST(util_threadpool, results){
+    util::ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4);
+
+    std::vector<std::future<int>> results;
+    for(int i = 0; i < 100; ++i){
+        results.push_back(pool.submit([i](){ return i*i; }));
+    }
+    for(int i = 0; i < 100; ++i){
+        EXPECT_EQ(results[i].get(), i*i);
+    }
+}
+
+TEST(util_threadpool, finish_pending_tasks){
+    std::atomic<int> counter(0);
+    {
+        util::ThreadPool pool(2);
+        for(int i = 0; i < 50; ++i){
+            pool.submit([&counter](){ counter++; });
+        }
+    }
+    EXPECT_EQ(counter, 50);
+}
+
+TEST(util_threadpool, exceptions){
+    util::ThreadPool pool;
+    EXPECT_GE(pool.size(), 1);
+    auto result = pool.submit([](){ throw std::runtime_error("task failed"); });
+    EXPECT_THROW(result.get(), std::runtime_error);
+}
+
+TEST(util_threadpool, parallel_for){
+    util::ThreadPool pool(3);
+    std::vector<int> visited(1000, 0);
+    pool.parallelFor(visited.size(), [&visited](std::size_t i){ visited[i]++; });
+    for(int v : visited){
+        EXPECT_EQ(v, 1);
+    }
+    EXPECT_THROW(pool.parallelFor(10, [](std::size_t i){ if(i == 7){ throw std::runtime_error("task failed"); } }), std::runtime_error);
+}